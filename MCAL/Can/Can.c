@@ -9,6 +9,42 @@
  **********************************************************/
 
 #include "Can.h"
+#include "Mcal_Critical.h"
+
+/**
+ * @def CAN_ID_EXTENDED_FLAG
+ * @brief Can_IdType bit marking an extended (29-bit) identifier.
+ */
+#define CAN_ID_EXTENDED_FLAG        0x80000000UL
+
+/**
+ * @def CAN_TXRL_TOKEN
+ * @brief Cost of one frame in rate limiter units.
+ * 
+ * Buckets count in milli-frames so that a refill of `SustainedRate` frames/s
+ * over CAN_MAIN_FUNCTION_WRITE_PERIOD_MS is the exact integer `rate * period`.
+ */
+#define CAN_TXRL_TOKEN              1000UL
+
+/**
+ * @var Can_TxRateLimitClasses
+ * @brief Example rate limiter classes.
+ * 
+ * Diagnostic responses (standard IDs 0x700-0x7FF) may burst 4 frames and are
+ * limited to 100 frames/s, scaled down to 25 % when the bus load exceeds 70 %.
+ */
+static const Can_TxRateLimitClassType Can_TxRateLimitClasses[] = 
+{
+    {
+        .Id = 0x00000700,                        /**< Standard IDs 0x700-0x7FF */
+        .Mask = 0xC0000700,                      /**< Frame type bits + ID bits 10:8 */
+        .BurstFrames = 4,                        /**< Back-to-back frames allowed */
+        .SustainedRate = 100,                    /**< Frames per second */
+        .AdaptiveLowLoad = 30,                   /**< Full rate up to 30 % bus load */
+        .AdaptiveHighLoad = 70,                  /**< Minimum rate from 70 % bus load */
+        .MinRatePercent = 25                     /**< Rate kept under high load */
+    }
+};
 
 /**
  * @var Can_ConfigData
@@ -39,9 +75,368 @@ Can_ConfigType Can_ConfigData =
         .GPIO_Pin_TX = GPIO_Pin_12,              /**< CAN_TX pin (PA12) */
         .GPIO_Mode = GPIO_Mode_AF_PP,            /**< Alternate function push-pull */
         .GPIO_Speed = GPIO_Speed_50MHz           /**< GPIO speed */
+    },
+    .Can_NotificationConfig = 
+	{
+        .ErrorStateNotification = NULL,          /**< No upper layer attached */
+        .RxIndication = NULL,                    /**< No upper layer attached */
+        .TxConfirmation = NULL,                  /**< No upper layer attached */
+        .WakeupNotification = NULL               /**< No upper layer attached */
+    },
+    .Can_TxRateLimitConfig = 
+	{
+        .Classes = Can_TxRateLimitClasses,       /**< Rate-limited ID classes */
+        .NumClasses = sizeof(Can_TxRateLimitClasses) / sizeof(Can_TxRateLimitClasses[0])
+    },
+    .Can_PartialNetworkConfig = 
+	{
+        .Frames = NULL,                          /**< Pretended networking disabled */
+        .NumFrames = 0
     }
 };
 
+/**
+ * @var Can_ConfigPtr
+ * @brief Configuration passed to Can_Init, used to reach the upper-layer callbacks.
+ */
+static const Can_ConfigType *Can_ConfigPtr = NULL;
+
+/**
+ * @var Can_LecToErrorType
+ * @brief Lookup table translating the 3-bit ESR.LEC field into Can_ErrorType.
+ * 
+ * - 0: No error, 7: Set by software (no new error since last read).
+ * - Bit recessive error: a '1' was sent but '0' was monitored.
+ * - Bit dominant error: a '0' was sent but '1' was monitored.
+ */
+static const Can_ErrorType Can_LecToErrorType[8] = 
+{
+    (Can_ErrorType)0,                 /**< 000: No error */
+    CAN_ERROR_CHECK_STUFFING_FAILED,  /**< 001: Stuff error */
+    CAN_ERROR_CHECK_FORM_FAILED,      /**< 010: Form error */
+    CAN_ERROR_CHECK_ACK_FAILED,       /**< 011: Acknowledgment error */
+    CAN_ERROR_BIT2_MONITORING,        /**< 100: Bit recessive error */
+    CAN_ERROR_BIT_MONITORING,         /**< 101: Bit dominant error */
+    CAN_ERROR_CHECK_CRC_FAILED,       /**< 110: CRC error */
+    (Can_ErrorType)0                  /**< 111: Set by software */
+};
+
+/**
+ * @var Can_ErrorState
+ * @brief Last error state reported to the upper layer, per controller.
+ */
+static Can_ErrorStateType Can_ErrorState[CAN_MAX_CONTROLLERS];
+
+/**
+ * @var Can_ErrorStatistics
+ * @brief Error statistics collected by the error interrupt, per controller.
+ */
+static Can_ErrorStatisticsType Can_ErrorStatistics[CAN_MAX_CONTROLLERS];
+
+/**
+ * @var Can_TxTokens
+ * @brief Current fill level of each rate limiter bucket, in CAN_TXRL_TOKEN units.
+ */
+static uint32 Can_TxTokens[CAN_TXRL_MAX_CLASSES];
+
+/**
+ * @var Can_BitRate
+ * @brief Nominal bit rate of each controller in bit/s, derived from the timing registers.
+ */
+static uint32 Can_BitRate[CAN_MAX_CONTROLLERS];
+
+/**
+ * @var Can_TxBitCount
+ * @brief Free-running count of bits transmitted, written by Can_Write only.
+ */
+static volatile uint32 Can_TxBitCount[CAN_MAX_CONTROLLERS];
+
+/**
+ * @var Can_RxBitCount
+ * @brief Free-running count of bits received, written by the RX interrupt only.
+ */
+static volatile uint32 Can_RxBitCount[CAN_MAX_CONTROLLERS];
+
+/**
+ * @var Can_BusLoadLastBits
+ * @brief Sum of the bit counters at the start of the current measurement window.
+ */
+static uint32 Can_BusLoadLastBits[CAN_MAX_CONTROLLERS];
+
+/**
+ * @var Can_BusLoad
+ * @brief Bus load in percent measured over the last completed window.
+ */
+static uint8 Can_BusLoad[CAN_MAX_CONTROLLERS];
+
+/**
+ * @var Can_BusLoadElapsedMs
+ * @brief Time elapsed in the current bus load measurement window.
+ */
+static uint16 Can_BusLoadElapsedMs = 0;
+
+/**
+ * @brief  Computes the nominal bit rate from the bxCAN timing parameters.
+ * @param  Prescaler: Baudrate prescaler (1 to 1024).
+ * @param  Bs1: CAN_BS1_xtq register encoding (segment length - 1).
+ * @param  Bs2: CAN_BS2_xtq register encoding (segment length - 1).
+ * @retval Bit rate in bit/s.
+ */
+static uint32 Can_ComputeBitRate(uint16 Prescaler, uint8 Bs1, uint8 Bs2)
+{
+    /* One bit = sync segment (1 tq) + BS1 + BS2 */
+    return CAN_APB1_CLOCK_HZ / ((uint32)Prescaler * (3U + Bs1 + Bs2));
+}
+
+/**
+ * @brief  Approximate number of bus bits used by one data frame.
+ * @details Frame overhead plus interframe space, stuff bits are not counted:
+ *          47 bits for a standard and 67 bits for an extended data frame.
+ */
+static uint32 Can_FrameBits(Can_IdType Id, uint8 Length)
+{
+    return ((Id & CAN_ID_EXTENDED_FLAG) ? 67U : 47U) + (8U * Length);
+}
+
+/**
+ * @brief  Finds the rate limiter class of a CAN ID.
+ * @retval Index of the first matching class, or CAN_TXRL_MAX_CLASSES if unlimited.
+ */
+static uint8 Can_FindTxRateLimitClass(Can_IdType Id)
+{
+    const Can_TxRateLimitClassType *classes = Can_ConfigPtr->Can_TxRateLimitConfig.Classes;
+
+    for (uint8 i = 0; (i < Can_ConfigPtr->Can_TxRateLimitConfig.NumClasses) && (i < CAN_TXRL_MAX_CLASSES); i++)
+    {
+        if ((Id & classes[i].Mask) == (classes[i].Id & classes[i].Mask))
+        {
+            return i;
+        }
+    }
+
+    return CAN_TXRL_MAX_CLASSES;
+}
+
+/**
+ * @brief  Refill rate of a class in percent of its sustained rate.
+ * @details Linear from 100 % at AdaptiveLowLoad down to MinRatePercent at
+ *          AdaptiveHighLoad; always 100 % for non-adaptive classes.
+ */
+static uint8 Can_GetAdaptiveRatePercent(const Can_TxRateLimitClassType *Class, uint8 BusLoad)
+{
+    if ((Class->AdaptiveHighLoad == 0) || (BusLoad <= Class->AdaptiveLowLoad))
+    {
+        return 100;
+    }
+    else if (BusLoad >= Class->AdaptiveHighLoad)
+    {
+        return Class->MinRatePercent;
+    }
+
+    return (uint8)(100U - ((uint32)(100U - Class->MinRatePercent) * (BusLoad - Class->AdaptiveLowLoad))
+                          / (Class->AdaptiveHighLoad - Class->AdaptiveLowLoad));
+}
+
+/**
+ * @var Can_TxPduHandle
+ * @brief swPduHandle of the L-PDU currently held by each CAN1 transmit mailbox.
+ */
+static PduIdType Can_TxPduHandle[3];
+
+/**
+ * @var Can_ControllerState
+ * @brief Authoritative controller state, per controller.
+ * 
+ * Updated by Can_Init/Can_DeInit, Can_SetControllerMode and the SLK/WKU
+ * interrupts, so Can_GetControllerMode is a single RAM read. MCR/MSR cannot
+ * tell STARTED from STOPPED reliably (TXM is only set while transmitting) and
+ * pretended sleep keeps the hardware in normal mode.
+ */
+static volatile Can_ControllerStateType Can_ControllerState[CAN_MAX_CONTROLLERS] = {CAN_CS_UNINIT};
+
+/**
+ * @var Can_PnActive
+ * @brief TRUE while the controller pretends to sleep with the wake-up filter set.
+ */
+static volatile boolean Can_PnActive[CAN_MAX_CONTROLLERS];
+
+/**
+ * @var Can_WakeupPending
+ * @brief Set by the interrupts when a wake-up was detected (a valid wake-up
+ *        frame in pretended sleep, or bus activity in bxCAN sleep mode).
+ */
+static volatile boolean Can_WakeupPending[CAN_MAX_CONTROLLERS];
+
+/**
+ * @brief  Programs one 32-bit ID/mask filter bank of CAN1 into FIFO 0.
+ * @param  Bank: Filter bank number.
+ * @param  IdReg: Identifier in CAN_FxR1 layout.
+ * @param  MaskReg: Mask in CAN_FxR2 layout.
+ * @param  Activation: ENABLE to activate the bank, DISABLE to release it.
+ */
+static void Can_ConfigureFilterBank(uint8 Bank, uint32 IdReg, uint32 MaskReg, FunctionalState Activation)
+{
+    CAN_FilterInitTypeDef CAN_FilterInitStruct;
+    CAN_FilterInitStruct.CAN_FilterNumber = Bank;
+    CAN_FilterInitStruct.CAN_FilterMode = CAN_FilterMode_IdMask;
+    CAN_FilterInitStruct.CAN_FilterScale = CAN_FilterScale_32bit;
+    CAN_FilterInitStruct.CAN_FilterIdHigh = (uint16)(IdReg >> 16);
+    CAN_FilterInitStruct.CAN_FilterIdLow = (uint16)(IdReg & 0xFFFF);
+    CAN_FilterInitStruct.CAN_FilterMaskIdHigh = (uint16)(MaskReg >> 16);
+    CAN_FilterInitStruct.CAN_FilterMaskIdLow = (uint16)(MaskReg & 0xFFFF);
+    CAN_FilterInitStruct.CAN_FilterFIFOAssignment = CAN_Filter_FIFO0;
+    CAN_FilterInitStruct.CAN_FilterActivation = Activation;
+    CAN_FilterInit(&CAN_FilterInitStruct);
+}
+
+/**
+ * @brief  Accept-all filter used while the controller is awake.
+ * @details Bank 0 accepts every frame, the banks used by pretended networking
+ *          are released.
+ */
+static void Can_ConfigureDefaultFilter(void)
+{
+    Can_ConfigureFilterBank(0, 0x00000000, 0x00000000, ENABLE);
+
+    for (uint8 bank = 1; bank < CAN_PN_MAX_WAKEUP_FRAMES; bank++)
+    {
+        Can_ConfigureFilterBank(bank, 0x00000000, 0x00000000, DISABLE);
+    }
+}
+
+/**
+ * @brief  Reduced filter set used in pretended sleep: one bank per wake-up frame.
+ * @details The IDE bit is always part of the mask so standard and extended
+ *          wake-up IDs cannot alias each other.
+ */
+static void Can_ConfigurePnFilters(void)
+{
+    const Can_PnWakeupFrameType *frames = Can_ConfigPtr->Can_PartialNetworkConfig.Frames;
+
+    for (uint8 bank = 0; bank < CAN_PN_MAX_WAKEUP_FRAMES; bank++)
+    {
+        if (bank >= Can_ConfigPtr->Can_PartialNetworkConfig.NumFrames)
+        {
+            Can_ConfigureFilterBank(bank, 0x00000000, 0x00000000, DISABLE);
+        }
+        else if (frames[bank].Id & CAN_ID_EXTENDED_FLAG)
+        {
+            Can_ConfigureFilterBank(bank,
+                                    ((frames[bank].Id & 0x1FFFFFFFUL) << 3) | CAN_Id_Extended,
+                                    ((frames[bank].Mask & 0x1FFFFFFFUL) << 3) | CAN_Id_Extended,
+                                    ENABLE);
+        }
+        else
+        {
+            Can_ConfigureFilterBank(bank,
+                                    (frames[bank].Id & 0x7FFUL) << 21,
+                                    ((frames[bank].Mask & 0x7FFUL) << 21) | CAN_Id_Extended,
+                                    ENABLE);
+        }
+    }
+}
+
+/**
+ * @brief  Checks a received frame against the configured wake-up frames.
+ * @retval TRUE if ID, length, payload pattern and (if configured) a PN cluster bit match.
+ */
+static boolean Can_PnIsWakeupFrame(Can_IdType Id, uint8 Length, const uint8 *Data)
+{
+    const Can_PnWakeupFrameType *frames = Can_ConfigPtr->Can_PartialNetworkConfig.Frames;
+
+    for (uint8 i = 0; i < Can_ConfigPtr->Can_PartialNetworkConfig.NumFrames; i++)
+    {
+        uint8 clusterConfigured = 0;
+        uint8 clusterRequested = 0;
+        boolean patternOk = TRUE;
+
+        if (((Id & frames[i].Mask) != (frames[i].Id & frames[i].Mask)) || (Length < frames[i].MinLength))
+        {
+            continue;
+        }
+
+        for (uint8 b = 0; b < 8; b++)
+        {
+            uint8 data = (b < Length) ? Data[b] : 0;
+
+            if ((data & frames[i].DataMask[b]) != frames[i].DataPattern[b])
+            {
+                patternOk = FALSE;
+                break;
+            }
+            clusterConfigured |= frames[i].PnClusterMask[b];
+            clusterRequested |= (uint8)(data & frames[i].PnClusterMask[b]);
+        }
+
+        if (patternOk && ((clusterConfigured == 0) || (clusterRequested != 0)))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief  Derives the error state from the ESR error flags.
+ * @param  Esr: Value of the CAN error status register.
+ * @retval Can_ErrorStateType: Bus-off, error passive or error active
+ *         (the error warning level is still error active).
+ */
+static Can_ErrorStateType Can_DecodeErrorState(uint32 Esr)
+{
+    if (Esr & CAN_ESR_BOFF)
+    {
+        return CAN_ERRORSTATE_BUSOFF;
+    }
+    else if (Esr & CAN_ESR_EPVF)
+    {
+        return CAN_ERRORSTATE_PASSIVE;
+    }
+
+    return CAN_ERRORSTATE_ACTIVE;
+}
+
+/**
+ * @brief  Returns the direction of an error counter between two samples.
+ */
+static Can_ErrorTrendType Can_GetErrorTrend(uint8 Previous, uint8 Current)
+{
+    if (Current > Previous)
+    {
+        return CAN_ERRORTREND_RISING;
+    }
+    else if (Current < Previous)
+    {
+        return CAN_ERRORTREND_FALLING;
+    }
+
+    return CAN_ERRORTREND_STABLE;
+}
+
+/**
+ * @brief  Compares the new error state with the last reported one and notifies
+ *         the upper layer only if it changed.
+ * @param  Controller: The CAN controller index.
+ * @param  Esr: Value of the CAN error status register.
+ */
+static void Can_UpdateErrorState(uint8 Controller, uint32 Esr)
+{
+    Can_ErrorStateType newState = Can_DecodeErrorState(Esr);
+
+    if (newState == Can_ErrorState[Controller])
+    {
+        return; /**< No transition, nothing to report */
+    }
+
+    Can_ErrorState[Controller] = newState;
+
+    if ((Can_ConfigPtr != NULL) && (Can_ConfigPtr->Can_NotificationConfig.ErrorStateNotification != NULL))
+    {
+        Can_ConfigPtr->Can_NotificationConfig.ErrorStateNotification(Controller, newState, Can_ErrorStatistics[Controller].LastError);
+    }
+}
+
 /**
  * @brief Initializes the CAN driver with the specified configuration.
  *
@@ -58,6 +453,34 @@ void Can_Init(const Can_ConfigType* Config)
         return; // Handle error
     }
 
+    /* Pretended networking needs one filter bank per wake-up frame */
+    if (Config->Can_PartialNetworkConfig.NumFrames > CAN_PN_MAX_WAKEUP_FRAMES)
+    {
+        return;
+    }
+
+    /* Keep the configuration for the notifications and reset the error bookkeeping */
+    Can_ConfigPtr = Config;
+    for (uint8 controller = 0; controller < CAN_MAX_CONTROLLERS; controller++)
+    {
+        Can_ErrorState[controller] = CAN_ERRORSTATE_ACTIVE;
+        Can_ErrorStatistics[controller] = (Can_ErrorStatisticsType){0};
+        Can_BusLoad[controller] = 0;
+        Can_PnActive[controller] = FALSE;
+        Can_WakeupPending[controller] = FALSE;
+        Can_BusLoadLastBits[controller] = Can_TxBitCount[controller] + Can_RxBitCount[controller];
+    }
+
+    /* Start every rate limiter bucket full */
+    for (uint8 i = 0; (i < Config->Can_TxRateLimitConfig.NumClasses) && (i < CAN_TXRL_MAX_CLASSES); i++)
+    {
+        Can_TxTokens[i] = (uint32)Config->Can_TxRateLimitConfig.Classes[i].BurstFrames * CAN_TXRL_TOKEN;
+    }
+    Can_BusLoadElapsedMs = 0;
+    Can_BitRate[0] = Can_ComputeBitRate(Config->Can_HardwareConfig.CAN_Prescaler,
+                                        Config->Can_HardwareConfig.CAN_BS1,
+                                        Config->Can_HardwareConfig.CAN_BS2);
+
     /* Enable clocks for CAN and GPIO */
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_CAN1, ENABLE);
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
@@ -89,21 +512,24 @@ void Can_Init(const Can_ConfigType* Config)
     if (CAN_Init(CAN1, &CAN_InitStruct) == CAN_InitStatus_Failed) 
 	{
         /* Initialization failed: Handle the error */
+        Can_ControllerState[0] = CAN_CS_UNINIT;
         return;
     }
 
+    /* CAN_Init leaves initialization mode, the controller is on the bus */
+    Can_ControllerState[0] = CAN_CS_STARTED;
+
     /* Configure CAN filters (default configuration) */
-    CAN_FilterInitTypeDef CAN_FilterInitStruct;
-    CAN_FilterInitStruct.CAN_FilterNumber = 0;
-    CAN_FilterInitStruct.CAN_FilterMode = CAN_FilterMode_IdMask;
-    CAN_FilterInitStruct.CAN_FilterScale = CAN_FilterScale_32bit;
-    CAN_FilterInitStruct.CAN_FilterIdHigh = 0x0000;
-    CAN_FilterInitStruct.CAN_FilterIdLow = 0x0000;
-    CAN_FilterInitStruct.CAN_FilterMaskIdHigh = 0x0000;
-    CAN_FilterInitStruct.CAN_FilterMaskIdLow = 0x0000;
-    CAN_FilterInitStruct.CAN_FilterFIFOAssignment = CAN_Filter_FIFO0;
-    CAN_FilterInitStruct.CAN_FilterActivation = ENABLE;
-    CAN_FilterInit(&CAN_FilterInitStruct);
+    Can_ConfigureDefaultFilter();
+
+    /* Mark LEC as "set by software" so the first protocol error is seen as a change */
+    CAN1->ESR = CAN_ESR_LEC;
+
+    /* Route error/status change, FIFO 0 and transmit interrupts to the NVIC;
+       sources are enabled through Can_EnableControllerInterrupts */
+    NVIC_EnableIRQ(CAN1_SCE_IRQn);
+    NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+    NVIC_EnableIRQ(CAN1_TX_IRQn);
 }
 
 /**
@@ -118,6 +544,13 @@ void Can_DeInit(void)
     /* Reset all registers of CAN1 to their default state */
     CAN_DeInit(CAN1);
 
+    /* Stop routing driver interrupts and detach the upper layer */
+    NVIC_DisableIRQ(CAN1_SCE_IRQn);
+    NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+    NVIC_DisableIRQ(CAN1_TX_IRQn);
+    Can_ConfigPtr = NULL;
+    Can_ControllerState[0] = CAN_CS_UNINIT;
+
     /* Disable all CAN-related interrupts if enabled */
     CAN_ITConfig(CAN1, CAN_IT_FMP0 | CAN_IT_TME | CAN_IT_ERR, DISABLE); 
 
@@ -206,6 +639,14 @@ Std_ReturnType Can_SetBaudrate(uint8 Controller, uint16 BaudRateConfigID)
         return E_NOT_OK;  /**< Return error if initialization fails */
     }
 
+    /* Keep the bus load reference in line with the new timing */
+    if (Controller < CAN_MAX_CONTROLLERS)
+    {
+        Can_BitRate[Controller] = Can_ComputeBitRate(CAN_InitStructure.CAN_Prescaler,
+                                                     CAN_InitStructure.CAN_BS1,
+                                                     CAN_InitStructure.CAN_BS2);
+    }
+
     /* Enable the CAN controller after configuration */
     CANx->MCR &= ~CAN_MCR_INRQ;  /**< Clear the initialization request to exit init mode */
     
@@ -240,10 +681,38 @@ Std_ReturnType Can_SetControllerMode(uint8 Controller, Can_ControllerStateType T
         return E_NOT_OK; /* Invalid controller, return error */
     }
 
+    /* Pretended networking: stay on the bus with only the wake-up filters
+       instead of entering bxCAN sleep/stop, where any activity wakes us up */
+    if ((Controller < CAN_MAX_CONTROLLERS) && (Can_ConfigPtr != NULL) &&
+        (Can_ConfigPtr->Can_PartialNetworkConfig.NumFrames != 0))
+    {
+        if ((Transition == CAN_CS_SLEEP) || (Transition == CAN_CS_STOPPED))
+        {
+            /* A sleeping node does not transmit: drop the frames still pending
+               (TSR holds rc_w1 flags, so only the ABRQ bits are written) */
+            CANx->TSR = CAN_TSR_ABRQ0 | CAN_TSR_ABRQ1 | CAN_TSR_ABRQ2;
+
+            Can_WakeupPending[Controller] = FALSE;
+            Can_ConfigurePnFilters();
+            Can_PnActive[Controller] = TRUE;
+            Can_ControllerState[Controller] = Transition; /**< Reported state, hardware keeps listening */
+            return E_OK;
+        }
+        else if (Can_PnActive[Controller])
+        {
+            /* Leaving pretended sleep: restore the accept-all filter */
+            Can_PnActive[Controller] = FALSE;
+            Can_ConfigureDefaultFilter();
+        }
+    }
+
     /* Switch based on the requested controller mode transition */
     switch (Transition)
     {
         case CAN_CS_STARTED: /**< Normal mode */
+            /* Leave Sleep mode if the controller was put to sleep */
+            CANx->MCR &= ~CAN_MCR_SLEEP; /**< Clear SLEEP bit */
+
             /* Enter Initialization Mode */
             CANx->MCR |= CAN_MCR_INRQ; /**< Request Initialization mode */
             
@@ -266,17 +735,11 @@ Std_ReturnType Can_SetControllerMode(uint8 Controller, Can_ControllerStateType T
             break;
 
         case CAN_CS_STOPPED: /**< Stop mode */
-            /* Enter Initialization Mode first */
-            CANx->MCR |= CAN_MCR_INRQ; /**< Request Initialization mode */
-            
-            /* Wait until CAN is in Initialization Mode */
-            while ((CANx->MSR & CAN_MSR_INAK) == 0); /**< Wait for INAK flag */
-            
-            /* Request Stop Mode */
-            CANx->MCR |= CAN_MCR_SLEEP; /**< Set the SLEEP bit to stop CAN operation */
+            /* Stopped = Initialization Mode: off the bus, configuration kept */
+            CANx->MCR = (CANx->MCR & ~CAN_MCR_SLEEP) | CAN_MCR_INRQ; /**< Request Initialization mode */
             
-            /* Wait for CAN to enter Stop Mode */
-            while ((CANx->MSR & CAN_MSR_SLAK) == 0); /**< Wait for SLAK flag */
+            /* Wait until CAN is in Initialization Mode and awake */
+            while ((CANx->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK)) != CAN_MSR_INAK); /**< Wait for INAK, SLAK cleared */
             break;
 
         case CAN_CS_UNINIT: /**< Uninitialized state */
@@ -298,6 +761,12 @@ Std_ReturnType Can_SetControllerMode(uint8 Controller, Can_ControllerStateType T
             break;
     }
 
+    /* The hardware reached the requested mode: update the cached state */
+    if ((status == E_OK) && (Controller < CAN_MAX_CONTROLLERS))
+    {
+        Can_ControllerState[Controller] = Transition;
+    }
+
     return status; /**< Return the operation status (E_OK or E_NOT_OK) */
 }
 
@@ -465,6 +934,25 @@ Std_ReturnType Can_CheckWakeup(uint8 Controller)
         return E_NOT_OK; /* Invalid controller, return error */
     }
 
+    /* In pretended sleep the controller never leaves normal mode, only a
+       validated wake-up frame counts */
+    if ((Controller < CAN_MAX_CONTROLLERS) && Can_PnActive[Controller])
+    {
+        if (Can_WakeupPending[Controller])
+        {
+            Can_WakeupPending[Controller] = FALSE;
+            status = E_OK; /**< Wake-up frame received */
+        }
+        return status;
+    }
+
+    /* Wake-up detected by the WKU interrupt */
+    if ((Controller < CAN_MAX_CONTROLLERS) && Can_WakeupPending[Controller])
+    {
+        Can_WakeupPending[Controller] = FALSE;
+        return E_OK;
+    }
+
     /* Check if the CAN controller is awake (SLAK bit in MSR should be cleared) */
     if ((CANx->MSR & CAN_MSR_SLAK) == 0) /**< SLAK = 0 means CAN is awake */
     {
@@ -507,74 +995,36 @@ Std_ReturnType Can_GetControllerErrorState(uint8 ControllerId, Can_ErrorStateTyp
         return E_NOT_OK; /**< Invalid controller ID, return error */
     }
 
-    /* Check the error flags in the CAN controller status register */
-    if (CANx->ESR & CAN_ESR_BOFF)
-    {
-        *ErrorStatePtr = CAN_ERRORSTATE_BUSOFF; /**< Bus-off error state */
-    }
-    else if (CANx->ESR & CAN_ESR_EPVF)
-    {
-        *ErrorStatePtr = CAN_ERRORSTATE_PASSIVE; /**< Error passive state */
-    }
-    else if (CANx->ESR & CAN_ESR_EWGF)
-    {
-        *ErrorStatePtr = CAN_ERRORSTATE_ACTIVE; /**< Error warning state */
-    }
-    else
-    {
-        return E_NOT_OK; /**< Invalid, return error */
-    }
+    /* Check the error flags in the CAN controller status register; a controller
+       without BOFF/EPVF (with or without the warning flag) is error active */
+    *ErrorStatePtr = Can_DecodeErrorState(CANx->ESR);
 
     return E_OK; /**< Return success */
 }
 
 /**
  * @brief  Get the current mode of the specified CAN controller.
- * @param  Controller: The CAN controller ID (0 for CAN1, 1 for CAN2).
+ * @param  Controller: The CAN controller ID (0 for CAN1).
  * @param  ControllerModePtr: Pointer to store the current mode of the controller.
  * @retval E_OK if successful, E_NOT_OK if there is an error or invalid controller.
  */
 Std_ReturnType Can_GetControllerMode(uint8 Controller, Can_ControllerStateType *ControllerModePtr)
 {
-    CAN_TypeDef *CANx = NULL; /**< Declare pointer for CAN controller */
-
     /* Check if the ControllerModePtr is valid */
     if (ControllerModePtr == NULL)
     {
         return E_NOT_OK; /**< Invalid pointer, return error */
     }
 
-    /* Select the appropriate CAN controller based on the Controller parameter */
-    if (Controller == 0)
-    {
-        CANx = CAN1; /**< CAN1 selected */
-    }
-    else if (Controller == 1)
-    {
-        CANx = CAN2; /**< CAN2 selected */
-    }
-    else
+    /* Only controllers with driver bookkeeping are supported */
+    if (Controller >= CAN_MAX_CONTROLLERS)
     {
         return E_NOT_OK; /**< Invalid controller ID, return error */
     }
 
-    /* Check the current mode of the selected CAN controller */
-    if (CANx->MCR & CAN_MCR_INRQ) /**< Initialization request flag */
-    {
-        *ControllerModePtr = CAN_CS_UNINIT; /**< Controller is uninitialized */
-    }
-    else if (CANx->MSR & CAN_MSR_SLAK) /**< Sleep acknowledge flag */
-    {
-        *ControllerModePtr = CAN_CS_SLEEP; /**< Controller is in sleep mode */
-    }
-    else if (CANx->MSR & CAN_MSR_TXM) /**< Transmit mode flag */
-    {
-        *ControllerModePtr = CAN_CS_STARTED; /**< Controller is operational */
-    }
-    else
-    {
-        *ControllerModePtr = CAN_CS_STOPPED; /**< Controller is stopped */
-    }
+    /* The cached state is maintained by the mode transitions and the SLK/WKU
+       interrupts, no register polling needed */
+    *ControllerModePtr = Can_ControllerState[Controller];
 
     return E_OK; /**< Return success */
 }
@@ -644,3 +1094,352 @@ Std_ReturnType Can_GetControllerTxErrorCounter(uint8 ControllerId, uint8 *TxErro
 
     return E_OK; /**< Return success */
 }
+
+/**
+ * @brief  Requests transmission of an L-PDU through the CAN1 transmit mailboxes.
+ * @param  Hth: Hardware transmit handle (0 for the CAN1 mailboxes).
+ * @param  PduInfo: L-PDU to transmit.
+ * @retval E_OK if a mailbox was filled, CAN_BUSY if no mailbox or no rate limiter
+ *         token is available, E_NOT_OK if a parameter is invalid.
+ */
+Std_ReturnType Can_Write(Can_HwHandleType Hth, const Can_PduType *PduInfo)
+{
+    CanTxMsg txMsg;
+    uint8 mailbox;
+    Std_ReturnType status = E_OK;
+
+    /* Validate input parameters */
+    if ((Can_ConfigPtr == NULL) || (Hth >= CAN_MAX_HTH) || (PduInfo == NULL))
+    {
+        return E_NOT_OK;
+    }
+    if ((PduInfo->length > 8) || ((PduInfo->sdu == NULL) && (PduInfo->length != 0)))
+    {
+        return E_NOT_OK; /**< Classic CAN payload only */
+    }
+    if (Can_ControllerState[0] != CAN_CS_STARTED)
+    {
+        return E_NOT_OK; /**< Only a started controller transmits (also not in pretended sleep) */
+    }
+
+    /* Build the SPL message from the L-PDU */
+    if (PduInfo->id & CAN_ID_EXTENDED_FLAG)
+    {
+        txMsg.IDE = CAN_Id_Extended;
+        txMsg.ExtId = PduInfo->id & 0x1FFFFFFFUL;
+        txMsg.StdId = 0;
+    }
+    else
+    {
+        txMsg.IDE = CAN_Id_Standard;
+        txMsg.StdId = PduInfo->id & 0x7FFUL;
+        txMsg.ExtId = 0;
+    }
+    txMsg.RTR = CAN_RTR_Data;
+    txMsg.DLC = PduInfo->length;
+    for (uint8 i = 0; i < PduInfo->length; i++)
+    {
+        txMsg.Data[i] = PduInfo->sdu[i];
+    }
+
+    uint8 txClass = Can_FindTxRateLimitClass(PduInfo->id);
+
+    /* Token check, mailbox request and token consumption are one atomic step */
+    uint32 primask = Mcal_EnterCritical();
+
+    if ((txClass < CAN_TXRL_MAX_CLASSES) && (Can_TxTokens[txClass] < CAN_TXRL_TOKEN))
+    {
+        status = CAN_BUSY; /**< Class is over its budget, caller retries later */
+    }
+    else if ((mailbox = CAN_Transmit(CAN1, &txMsg)) == CAN_TxStatus_NoMailBox)
+    {
+        status = CAN_BUSY; /**< All three mailboxes pending */
+    }
+    else
+    {
+        Can_TxPduHandle[mailbox] = PduInfo->swPduHandle;
+        if (txClass < CAN_TXRL_MAX_CLASSES)
+        {
+            Can_TxTokens[txClass] -= CAN_TXRL_TOKEN;
+        }
+        Can_TxBitCount[0] += Can_FrameBits(PduInfo->id, PduInfo->length);
+    }
+
+    Mcal_ExitCritical(primask);
+
+    return status;
+}
+
+/**
+ * @brief  Refills the rate limiter buckets and closes bus load windows.
+ */
+void Can_MainFunction_Write(void)
+{
+    if (Can_ConfigPtr == NULL)
+    {
+        return; /**< Driver not initialized */
+    }
+
+    /* Close the bus load window: bits seen / bits the bus could carry */
+    Can_BusLoadElapsedMs += CAN_MAIN_FUNCTION_WRITE_PERIOD_MS;
+    if (Can_BusLoadElapsedMs >= CAN_BUSLOAD_WINDOW_MS)
+    {
+        uint32 bits = Can_TxBitCount[0] + Can_RxBitCount[0];
+        uint32 capacity = (Can_BitRate[0] / 1000U) * Can_BusLoadElapsedMs;
+        uint32 load = (capacity != 0) ? (((bits - Can_BusLoadLastBits[0]) * 100U) / capacity) : 0;
+
+        Can_BusLoad[0] = (uint8)((load > 100U) ? 100U : load);
+        Can_BusLoadLastBits[0] = bits;
+        Can_BusLoadElapsedMs = 0;
+    }
+
+    /* Refill each bucket by rate * period milli-frames, scaled in adaptive mode */
+    for (uint8 i = 0; (i < Can_ConfigPtr->Can_TxRateLimitConfig.NumClasses) && (i < CAN_TXRL_MAX_CLASSES); i++)
+    {
+        const Can_TxRateLimitClassType *txClass = &Can_ConfigPtr->Can_TxRateLimitConfig.Classes[i];
+        uint32 refill = (uint32)txClass->SustainedRate * CAN_MAIN_FUNCTION_WRITE_PERIOD_MS;
+        uint32 limit = (uint32)txClass->BurstFrames * CAN_TXRL_TOKEN;
+
+        refill = (refill * Can_GetAdaptiveRatePercent(txClass, Can_BusLoad[0])) / 100U;
+
+        uint32 primask = Mcal_EnterCritical();
+        Can_TxTokens[i] = ((limit - Can_TxTokens[i]) > refill) ? (Can_TxTokens[i] + refill) : limit;
+        Mcal_ExitCritical(primask);
+    }
+}
+
+/**
+ * @brief  Get the bus load of the specified CAN controller.
+ * @param  ControllerId: The CAN controller ID (0 for CAN1).
+ * @param  BusLoadPtr: Pointer to store the bus load in percent.
+ * @retval E_OK if successful, E_NOT_OK if there is an error or invalid controller.
+ */
+Std_ReturnType Can_GetBusLoad(uint8 ControllerId, uint8 *BusLoadPtr)
+{
+    /* Check if the BusLoadPtr is valid */
+    if (BusLoadPtr == NULL)
+    {
+        return E_NOT_OK; /**< Invalid pointer, return error */
+    }
+
+    /* Only controllers with driver bookkeeping are supported */
+    if (ControllerId >= CAN_MAX_CONTROLLERS)
+    {
+        return E_NOT_OK; /**< Invalid controller ID, return error */
+    }
+
+    *BusLoadPtr = Can_BusLoad[ControllerId];
+
+    return E_OK; /**< Return success */
+}
+
+/**
+ * @brief  Get a copy of the error statistics of the specified CAN controller.
+ * @param  ControllerId: The CAN controller ID (0 for CAN1).
+ * @param  StatisticsPtr: Pointer to store the error statistics.
+ * @retval E_OK if successful, E_NOT_OK if there is an error or invalid controller.
+ */
+Std_ReturnType Can_GetErrorStatistics(uint8 ControllerId, Can_ErrorStatisticsType *StatisticsPtr)
+{
+    /* Check if the StatisticsPtr is valid */
+    if (StatisticsPtr == NULL)
+    {
+        return E_NOT_OK; /**< Invalid pointer, return error */
+    }
+
+    /* Only controllers with driver bookkeeping are supported */
+    if (ControllerId >= CAN_MAX_CONTROLLERS)
+    {
+        return E_NOT_OK; /**< Invalid controller ID, return error */
+    }
+
+    /* Copy with the error interrupt masked so the snapshot is consistent */
+    NVIC_DisableIRQ(CAN1_SCE_IRQn);
+    *StatisticsPtr = Can_ErrorStatistics[ControllerId];
+    NVIC_EnableIRQ(CAN1_SCE_IRQn);
+
+    return E_OK; /**< Return success */
+}
+
+/**
+ * @brief  Detects error state recoveries that do not raise an interrupt.
+ * @details bxCAN only interrupts when EWGF/EPVF/BOFF get set. Falling back to
+ *          error active (or leaving bus-off with ABOM) is silent, so the cached
+ *          state is compared against ESR here and the upper layer is notified
+ *          of the transition.
+ */
+void Can_MainFunction_BusOff(void)
+{
+    if (Can_ConfigPtr == NULL)
+    {
+        return; /**< Driver not initialized */
+    }
+
+    NVIC_DisableIRQ(CAN1_SCE_IRQn);
+    Can_UpdateErrorState(0, CAN1->ESR);
+    NVIC_EnableIRQ(CAN1_SCE_IRQn);
+}
+
+/**
+ * @brief  Error handling for one controller, called from the SCE interrupt.
+ * @param  Controller: The CAN controller index.
+ * @param  CANx: Register block of the controller.
+ */
+static void Can_ErrorIsr(uint8 Controller, CAN_TypeDef *CANx)
+{
+    Can_ErrorStatisticsType *stats = &Can_ErrorStatistics[Controller];
+    uint32 esr = CANx->ESR;
+    uint8 tec = (uint8)((esr & CAN_ESR_TEC) >> 16);
+    uint8 rec = (uint8)((esr & CAN_ESR_REC) >> 24);
+    Can_ErrorType error = Can_LecToErrorType[(esr & CAN_ESR_LEC) >> 4];
+
+    /* Count the protocol error; LEC = 0/7 means no new error since the last read */
+    if (error != 0)
+    {
+        stats->ErrorCount[error]++;
+        stats->LastError = error;
+
+        /* Re-arm LEC with the software code so the next error is a visible change */
+        CANx->ESR = CAN_ESR_LEC;
+    }
+
+    /* Track counter trends and peaks */
+    stats->TecTrend = Can_GetErrorTrend(stats->Tec, tec);
+    stats->RecTrend = Can_GetErrorTrend(stats->Rec, rec);
+    stats->Tec = tec;
+    stats->Rec = rec;
+    if (tec > stats->TecPeak)
+    {
+        stats->TecPeak = tec;
+    }
+    if (rec > stats->RecPeak)
+    {
+        stats->RecPeak = rec;
+    }
+
+    /* Notify the upper layer on active -> passive -> bus-off transitions only */
+    Can_UpdateErrorState(Controller, esr);
+
+    /* Acknowledge the error interrupt (ERRI is cleared by writing 1) */
+    CANx->MSR = CAN_MSR_ERRI;
+}
+
+/**
+ * @brief  CAN1 status change / error interrupt handler.
+ * @details Handles the error interrupt and keeps the cached controller state
+ *          in line with sleep acknowledge and wake-up events.
+ */
+void CAN1_SCE_IRQHandler(void)
+{
+    uint32 msr = CAN1->MSR;
+
+    if (msr & CAN_MSR_ERRI)
+    {
+        Can_ErrorIsr(0, CAN1);
+    }
+
+    /* Sleep acknowledged by the hardware */
+    if (msr & CAN_MSR_SLAKI)
+    {
+        CAN1->MSR = CAN_MSR_SLAKI; /**< rc_w1 */
+        if (msr & CAN_MSR_SLAK)
+        {
+            Can_ControllerState[0] = CAN_CS_SLEEP;
+        }
+    }
+
+    /* Bus activity while in Sleep mode */
+    if (msr & CAN_MSR_WKUI)
+    {
+        CAN1->MSR = CAN_MSR_WKUI; /**< rc_w1 */
+
+        /* With automatic wake-up (AWUM) the hardware already left Sleep mode */
+        if ((CAN1->MSR & CAN_MSR_SLAK) == 0)
+        {
+            Can_ControllerState[0] = CAN_CS_STARTED;
+        }
+
+        Can_WakeupPending[0] = TRUE;
+        if ((Can_ConfigPtr != NULL) && (Can_ConfigPtr->Can_NotificationConfig.WakeupNotification != NULL))
+        {
+            Can_ConfigPtr->Can_NotificationConfig.WakeupNotification(0);
+        }
+    }
+}
+
+/**
+ * @brief  CAN1 FIFO 0 receive interrupt handler.
+ */
+void USB_LP_CAN1_RX0_IRQHandler(void)
+{
+    CanRxMsg rxMsg;
+
+    /* Drain every pending frame; CAN_Receive releases the FIFO output mailbox */
+    while (CAN_MessagePending(CAN1, CAN_FIFO0) != 0)
+    {
+        CAN_Receive(CAN1, CAN_FIFO0, &rxMsg);
+
+        Can_IdType id = (rxMsg.IDE == CAN_Id_Extended) ? (rxMsg.ExtId | CAN_ID_EXTENDED_FLAG) : rxMsg.StdId;
+        Can_RxBitCount[0] += Can_FrameBits(id, rxMsg.DLC);
+
+        if (Can_ConfigPtr == NULL)
+        {
+            continue; /**< Driver de-initialized, drop the frame */
+        }
+
+        /* Pretended sleep: only wake-up frames pass the filters; nothing is
+           forwarded, a matching payload only raises the wake-up */
+        if (Can_PnActive[0])
+        {
+            if (!Can_WakeupPending[0] && Can_PnIsWakeupFrame(id, rxMsg.DLC, rxMsg.Data))
+            {
+                Can_WakeupPending[0] = TRUE;
+                if (Can_ConfigPtr->Can_NotificationConfig.WakeupNotification != NULL)
+                {
+                    Can_ConfigPtr->Can_NotificationConfig.WakeupNotification(0);
+                }
+            }
+            continue;
+        }
+
+        if (Can_ConfigPtr->Can_NotificationConfig.RxIndication != NULL)
+        {
+            Can_HwType mailbox = {.CanId = id, .Hoh = 0, .ControllerId = 0};
+            Can_PduType pdu = {.swPduHandle = 0, .length = rxMsg.DLC, .id = id, .sdu = rxMsg.Data};
+
+            Can_ConfigPtr->Can_NotificationConfig.RxIndication(&mailbox, &pdu);
+        }
+    }
+
+    /* Acknowledge FIFO full and overrun, which share this interrupt line */
+    CAN1->RF0R = CAN_RF0R_FULL0 | CAN_RF0R_FOVR0;
+}
+
+/**
+ * @brief  CAN1 transmit interrupt handler.
+ */
+void CAN1_TX_IRQHandler(void)
+{
+    static const uint32 requestCompleted[3] = {CAN_TSR_RQCP0, CAN_TSR_RQCP1, CAN_TSR_RQCP2};
+    static const uint32 mailboxEmpty[3] = {CAN_TSR_TME0, CAN_TSR_TME1, CAN_TSR_TME2};
+    uint32 tsr = CAN1->TSR;
+
+    for (uint8 mailbox = 0; mailbox < 3; mailbox++)
+    {
+        if ((tsr & requestCompleted[mailbox]) == 0)
+        {
+            continue;
+        }
+
+        /* Acknowledge the request (clears RQCP, TXOK, ALST and TERR of the mailbox) */
+        CAN1->TSR = requestCompleted[mailbox];
+
+        /* A completed request with the mailbox empty again was sent or aborted;
+           only confirm frames which left successfully (TXOKx = RQCPx << 1) */
+        if ((tsr & (requestCompleted[mailbox] << 1)) && (tsr & mailboxEmpty[mailbox]) &&
+            (Can_ConfigPtr != NULL) && (Can_ConfigPtr->Can_NotificationConfig.TxConfirmation != NULL))
+        {
+            Can_ConfigPtr->Can_NotificationConfig.TxConfirmation(Can_TxPduHandle[mailbox]);
+        }
+    }
+}
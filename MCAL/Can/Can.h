@@ -30,17 +30,165 @@ extern "C"{
 #define CAN_VERSION_INFO_API        STD_OFF /**< Disable version info API */
 #define CAN_MAX_CONTROLLERS         1       /**< Number of CAN controllers supported */
 
+/**
+ * @def CAN_ERROR_TYPE_COUNT
+ * @brief Size of the per-error-type counter array.
+ *
+ * One entry per Can_ErrorType value (0x01 - 0x0B); index 0 is unused so the
+ * enum value can be used directly as the array index.
+ */
+#define CAN_ERROR_TYPE_COUNT        0x0C
+
+/* TX rate limiter and bus load measurement */
+#define CAN_APB1_CLOCK_HZ           36000000UL /**< CAN kernel clock (APB1), used to derive the bit rate */
+#define CAN_MAX_HTH                 1       /**< One transmit object (3 pooled mailboxes) per controller */
+#define CAN_TXRL_MAX_CLASSES        4       /**< Maximum number of rate-limited TX classes */
+#define CAN_MAIN_FUNCTION_WRITE_PERIOD_MS 1 /**< Call period of Can_MainFunction_Write in ms */
+#define CAN_BUSLOAD_WINDOW_MS       100     /**< Bus load measurement window in ms */
+
+/* Pretended networking */
+#define CAN_PN_MAX_WAKEUP_FRAMES    4       /**< Filter banks reserved for wake-up frames while asleep */
+
 /*==============================================================================
  *                          TYPE DEFINITIONS                                   *
  ==============================================================================*/
- 
+
+/**
+ * @typedef Can_ErrorStateNotificationType
+ * @brief Upper-layer callback for controller error state changes.
+ *
+ * Called from the error interrupt (or Can_MainFunction_BusOff for recoveries)
+ * only when the error state actually changes, e.g. active -> passive -> bus-off,
+ * so a disturbed bus does not cause one callback per error frame.
+ *
+ * @param Controller Controller whose error state changed.
+ * @param ErrorState New error state of the controller.
+ * @param LastError  Last protocol error decoded from ESR.LEC (0 if none).
+ */
+typedef void (*Can_ErrorStateNotificationType)(uint8 Controller, Can_ErrorStateType ErrorState, Can_ErrorType LastError);
+
+/**
+ * @typedef Can_RxIndicationType
+ * @brief Upper-layer callback for a received L-PDU.
+ *
+ * Called from the FIFO 0 receive interrupt. The SDU buffer is only valid for
+ * the duration of the call.
+ *
+ * @param Mailbox Hardware object the frame was received on (CAN ID, HRH, controller).
+ * @param PduInfo Received L-PDU (length, id and payload).
+ */
+typedef void (*Can_RxIndicationType)(const Can_HwType *Mailbox, const Can_PduType *PduInfo);
+
+/**
+ * @typedef Can_TxConfirmationType
+ * @brief Upper-layer callback for a completed transmission.
+ *
+ * Called from the transmit mailbox empty interrupt, once per frame accepted
+ * by Can_Write, so the upper layer can immediately refill the mailbox.
+ *
+ * @param TxPduId swPduHandle of the transmitted L-PDU.
+ */
+typedef void (*Can_TxConfirmationType)(PduIdType TxPduId);
+
+/**
+ * @typedef Can_WakeupNotificationType
+ * @brief Upper-layer callback for a validated wake-up event.
+ *
+ * With pretended networking this is only called for a received frame that
+ * matches one of the configured wake-up frames.
+ *
+ * @param Controller Controller that detected the wake-up.
+ */
+typedef void (*Can_WakeupNotificationType)(uint8 Controller);
+
+/**
+ * @struct Can_PnWakeupFrameType
+ * @brief Wake-up frame watched while the controller pretends to sleep.
+ *
+ * The ID is matched in a hardware filter bank, so other frames never reach the
+ * CPU. The payload is then checked in the receive interrupt:
+ * - every byte must satisfy `(data & DataMask) == DataPattern`, and
+ * - if any `PnClusterMask` bit is configured, at least one of those partial
+ *   network cluster bits must be set in the payload (AUTOSAR PN request bits).
+ */
+typedef struct
+{
+    Can_IdType Id;            /**< CAN ID of the wake-up frame */
+    Can_IdType Mask;          /**< ID bits compared by the filter bank */
+    uint8 MinLength;          /**< Minimum DLC of a valid wake-up frame */
+    uint8 DataPattern[8];     /**< Expected value of the masked payload bits */
+    uint8 DataMask[8];        /**< Payload bits compared against DataPattern */
+    uint8 PnClusterMask[8];   /**< Partial network cluster bits relevant to this ECU */
+} Can_PnWakeupFrameType;
+
+/**
+ * @struct Can_TxRateLimitClassType
+ * @brief Token bucket configuration for one class of transmitted CAN IDs.
+ *
+ * A frame belongs to the first class where `(id & Mask) == (Id & Mask)`.
+ * Frames matching no class are never limited, which keeps headroom for the
+ * critical cyclic IDs. Each class owns a bucket of `BurstFrames` tokens that
+ * is refilled at `SustainedRate` frames per second by Can_MainFunction_Write;
+ * a frame consumes one token and Can_Write returns CAN_BUSY on an empty bucket.
+ *
+ * Adaptive mode (`AdaptiveHighLoad` != 0): the refill rate is scaled down
+ * linearly from 100 % at `AdaptiveLowLoad` bus load to `MinRatePercent` at
+ * `AdaptiveHighLoad` bus load and above.
+ */
+typedef struct
+{
+    Can_IdType Id;          /**< CAN ID pattern of the class */
+    Can_IdType Mask;        /**< Bits of the ID compared against the pattern */
+    uint16 BurstFrames;     /**< Bucket depth: frames allowed back-to-back */
+    uint16 SustainedRate;   /**< Refill rate in frames per second */
+    uint8 AdaptiveLowLoad;  /**< Bus load (%) up to which the full rate applies */
+    uint8 AdaptiveHighLoad; /**< Bus load (%) from which MinRatePercent applies, 0 = not adaptive */
+    uint8 MinRatePercent;   /**< Remaining refill rate (%) under high bus load */
+} Can_TxRateLimitClassType;
+
+/**
+ * @enum Can_ErrorTrendType
+ * @brief Direction of an error counter since the previous error interrupt.
+ */
+typedef enum
+{
+    CAN_ERRORTREND_STABLE,  /**< Counter unchanged. */
+    CAN_ERRORTREND_RISING,  /**< Counter increased, the bus is getting worse. */
+    CAN_ERRORTREND_FALLING  /**< Counter decreased, the bus is recovering. */
+} Can_ErrorTrendType;
+
+/**
+ * @struct Can_ErrorStatisticsType
+ * @brief Error bookkeeping maintained by the CAN error interrupt.
+ *
+ * - `ErrorCount`: Number of occurrences per Can_ErrorType, indexed by the enum value.
+ * - `LastError`: Last protocol error decoded from ESR.LEC.
+ * - `Tec`/`Rec`: Error counters sampled at the last error interrupt.
+ * - `TecPeak`/`RecPeak`: Highest counter values seen since Can_Init.
+ * - `TecTrend`/`RecTrend`: Direction of the counters between the last two samples.
+ */
+typedef struct
+{
+    uint16 ErrorCount[CAN_ERROR_TYPE_COUNT]; /**< Occurrences per error type */
+    Can_ErrorType LastError;                 /**< Last decoded protocol error */
+    uint8 Tec;                               /**< Transmit error counter at last sample */
+    uint8 Rec;                               /**< Receive error counter at last sample */
+    uint8 TecPeak;                           /**< Highest transmit error counter seen */
+    uint8 RecPeak;                           /**< Highest receive error counter seen */
+    Can_ErrorTrendType TecTrend;             /**< Transmit error counter trend */
+    Can_ErrorTrendType RecTrend;             /**< Receive error counter trend */
+} Can_ErrorStatisticsType;
+
 /**
  * @struct Can_ConfigType
  * @brief Configuration structure for CAN driver with nested structures.
  * 
- * This structure contains two sub-structures:
+ * This structure contains five sub-structures:
  * - `Can_HardwareConfig`: Configurations for the CAN hardware (e.g., timing, mode).
  * - `Can_GPIOConfig`: Configurations for the GPIO pins used by CAN.
+ * - `Can_NotificationConfig`: Upper-layer callbacks invoked by the driver.
+ * - `Can_TxRateLimitConfig`: Token bucket rate limiting of transmitted IDs.
+ * - `Can_PartialNetworkConfig`: Wake-up frames watched in pretended sleep.
  */
 typedef struct 
 {
@@ -81,6 +229,48 @@ typedef struct
         GPIOSpeed_TypeDef GPIO_Speed; /**< GPIO speed */
     } Can_GPIOConfig;
 
+    /**
+     * @struct Can_NotificationConfig
+     * @brief Sub-structure for upper-layer notifications.
+     * 
+     * Callbacks may be NULL if the upper layer is not interested.
+     */
+    struct 
+	{
+        Can_ErrorStateNotificationType ErrorStateNotification; /**< Error state change callback */
+        Can_RxIndicationType RxIndication;                     /**< Frame reception callback */
+        Can_TxConfirmationType TxConfirmation;                 /**< Transmission complete callback */
+        Can_WakeupNotificationType WakeupNotification;         /**< Validated wake-up callback */
+    } Can_NotificationConfig;
+
+    /**
+     * @struct Can_TxRateLimitConfig
+     * @brief Sub-structure for the TX token bucket rate limiter.
+     * 
+     * Set `NumClasses` to 0 to disable rate limiting.
+     */
+    struct 
+	{
+        const Can_TxRateLimitClassType *Classes; /**< Rate-limited classes, first match wins */
+        uint8 NumClasses;                        /**< Number of entries (max CAN_TXRL_MAX_CLASSES) */
+    } Can_TxRateLimitConfig;
+
+    /**
+     * @struct Can_PartialNetworkConfig
+     * @brief Sub-structure for pretended networking.
+     * 
+     * When `NumFrames` is not 0, CAN_CS_SLEEP and CAN_CS_STOPPED keep the
+     * controller listening with only the wake-up frames in the filter banks
+     * instead of putting bxCAN to sleep, where any bus activity wakes it up.
+     * Frames still pending in the transmit mailboxes are aborted on entry.
+     * Can_Init rejects a configuration with more than CAN_PN_MAX_WAKEUP_FRAMES.
+     */
+    struct 
+	{
+        const Can_PnWakeupFrameType *Frames; /**< Wake-up frames */
+        uint8 NumFrames;                     /**< Number of entries (max CAN_PN_MAX_WAKEUP_FRAMES) */
+    } Can_PartialNetworkConfig;
+
 } Can_ConfigType;
 
 /**
@@ -143,6 +333,7 @@ void Can_EnableControllerInterrupts(uint8 Controller);
  * @brief  Checks if the specified CAN controller has been woken up from Sleep mode.
  * @param  Controller: The CAN controller to check wake-up status (0 for CAN1, 1 for CAN2).
  * @retval Std_ReturnType: E_OK if the CAN controller has woken up from Sleep mode, E_NOT_OK if the controller is still in Sleep mode.
+ *         With pretended networking, E_OK only once a matching wake-up frame was received.
  */
 Std_ReturnType Can_CheckWakeup(uint8 Controller);
 
@@ -186,6 +377,76 @@ Std_ReturnType Can_GetControllerRxErrorCounter(uint8 ControllerId, uint8 *RxErro
  */
 Std_ReturnType Can_GetControllerTxErrorCounter(uint8 ControllerId, uint8 *TxErrorCounterPtr);
 
+/**
+ * @brief  Requests transmission of an L-PDU.
+ * @param  Hth: Hardware transmit handle (0 for the CAN1 mailboxes).
+ * @param  PduInfo: L-PDU to transmit (id, length 0-8, payload).
+ * @retval Std_ReturnType: 
+ *         - E_OK if the frame was placed in a transmit mailbox.
+ *         - CAN_BUSY if no mailbox is free or the rate limit class of the ID
+ *           has no token left; the caller retries later.
+ *         - E_NOT_OK if a parameter is invalid.
+ */
+Std_ReturnType Can_Write(Can_HwHandleType Hth, const Can_PduType *PduInfo);
+
+/**
+ * @brief  Refills the TX rate limiter buckets and updates the bus load.
+ * @details Must be called every CAN_MAIN_FUNCTION_WRITE_PERIOD_MS.
+ * @retval None
+ */
+void Can_MainFunction_Write(void);
+
+/**
+ * @brief  Retrieves the bus load measured over the last window.
+ * @param  ControllerId: The CAN controller ID (0 for CAN1).
+ * @param  BusLoadPtr: Pointer to store the bus load in percent (0-100).
+ * @retval Std_ReturnType: E_OK if successful, E_NOT_OK if a parameter is invalid.
+ */
+Std_ReturnType Can_GetBusLoad(uint8 ControllerId, uint8 *BusLoadPtr);
+
+/**
+ * @brief  Retrieves the error statistics collected by the error interrupt.
+ * @param  ControllerId: The CAN controller ID (0 for CAN1).
+ * @param  StatisticsPtr: Pointer to store a copy of the error statistics.
+ * @retval Std_ReturnType: 
+ *         - E_OK if the statistics were copied.
+ *         - E_NOT_OK if the controller ID or pointer is invalid.
+ */
+Std_ReturnType Can_GetErrorStatistics(uint8 ControllerId, Can_ErrorStatisticsType *StatisticsPtr);
+
+/**
+ * @brief  Polls for error state recoveries which raise no interrupt on bxCAN.
+ * @details Error passive -> active and bus-off -> active (automatic bus-off
+ *          management) clear ESR flags silently. This function must be called
+ *          cyclically so the upper layer is still notified of these transitions.
+ * @retval None
+ */
+void Can_MainFunction_BusOff(void);
+
+/**
+ * @brief  CAN1 status change / error interrupt handler.
+ * @details Decodes ESR.LEC into Can_ErrorType, updates the error statistics and
+ *          notifies the upper layer when the error state changes.
+ * @retval None
+ */
+void CAN1_SCE_IRQHandler(void);
+
+/**
+ * @brief  CAN1 transmit interrupt handler.
+ * @details Acknowledges completed mailboxes and confirms their L-PDUs to the
+ *          upper layer.
+ * @retval None
+ */
+void CAN1_TX_IRQHandler(void);
+
+/**
+ * @brief  CAN1 FIFO 0 receive interrupt handler (shared with USB low priority).
+ * @details Reads pending frames, accounts them in the bus load and forwards
+ *          them to the upper layer.
+ * @retval None
+ */
+void USB_LP_CAN1_RX0_IRQHandler(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,11 @@
  * @brief AUTOSAR LIN Driver Source File
  * @details This file contains the function definitions for
  *          the LIN driver according to the AUTOSAR standard.
+ *          All hardware accesses go through the USART/DMA/EXTI/TIM instances
+ *          of Lin_HwChannel, the NVIC functions and LIN_CYCLE_COUNTER(),
+ *          so the same source also runs on a host against the register
+ *          models of Tools/LinSim, which calls the USARTx/DMA/EXTI/TIM4 IRQ
+ *          handlers (functional tests and timing benchmark).
  * @version 1.0
  * @date 2024-11-01
  * @author Tong Xuan Hoang
@@ -10,179 +15,1973 @@
 
 #include "Lin.h"
 #include "Lin_Cfg.h"
+#include "Mcal_Critical.h"
 
 /**********************************************************
- * @brief Initialize the LIN module.
+ * @brief Free-running CPU cycle counter used as the LIN time base.
+ * @details Defaults to the DWT cycle counter, which Tools/LinSim also models
+ *          on the host; a port without DWT can define it to another counter
+ *          running at SystemCoreClock.
+ **********************************************************/
+#ifndef LIN_CYCLE_COUNTER
+#define LIN_CYCLE_COUNTER() (DWT->CYCCNT)
+#endif
+
+/**********************************************************
+ * @brief Frame phase timestamps (LIN_TIMING_SUPPORT).
+ * @details Expand to nothing when the instrumentation is compiled out.
+ **********************************************************/
+#if (LIN_TIMING_SUPPORT == 1)
+#define LIN_TIMING_START(runtime) Lin_TimingStart(runtime)
+#define LIN_TIMESTAMP(runtime, phase) ((runtime)->Timing.phase = LIN_CYCLE_COUNTER())
+#define LIN_TIMING_END(runtime) Lin_TimingEnd(runtime)
+#else
+#define LIN_TIMING_START(runtime) ((void)0)
+#define LIN_TIMESTAMP(runtime, phase) ((void)0)
+#define LIN_TIMING_END(runtime) ((void)0)
+#endif
+
+/**********************************************************
+ * @brief LIN frame constants.
+ **********************************************************/
+#define LIN_SYNC_BYTE 0x55U          /**< @brief Value of the sync field. */
+#define LIN_MAX_DATA_LENGTH 8U       /**< @brief Maximum number of data bytes in a frame. */
+#define LIN_FRAME_BUFFER_SIZE (2U + LIN_MAX_DATA_LENGTH + 1U) /**< @brief Sync, PID, data and checksum. */
+#define LIN_RESPONSE_BUFFER_SIZE (LIN_MAX_DATA_LENGTH + 1U)      /**< @brief Data and checksum. */
+#define LIN_FRAME_ID_MASK 0x3FU      /**< @brief Frame identifier bits of the PID. */
+#define LIN_DIAG_ID_MASTER_REQ 0x3CU /**< @brief Master request frame, always classic checksum. */
+#define LIN_DIAG_ID_SLAVE_RESP 0x3DU /**< @brief Slave response frame, always classic checksum. */
+
+/**********************************************************
+ * @brief DMA channel settings (8-bit transfers, memory increment).
+ **********************************************************/
+#define LIN_DMA_CCR_TX (DMA_CCR1_MINC | DMA_CCR1_DIR) /**< @brief Memory to USART DR. */
+#define LIN_DMA_CCR_RX (DMA_CCR1_MINC | DMA_CCR1_TCIE) /**< @brief USART DR to memory, interrupt when complete. */
+#define LIN_DMA_CCR_ECHO (DMA_CCR1_MINC)               /**< @brief USART DR to memory, checked at TC. */
+#define LIN_DMA_IFCR_CGIF(n) (0x1UL << (((n) - 1U) * 4U)) /**< @brief Clears all flags of DMA1 channel n. */
+
+/**********************************************************
+ * @brief Sync field measurement (slave mode).
+ * @details 0x55 has falling edges at the start of bits 0, 2, 4, 6 and 8
+ *          (start bit first), so the 1st and 5th edges are 8 bit times apart.
+ **********************************************************/
+#define LIN_SYNC_FALLING_EDGES 5U   /**< @brief Falling edges timed in the sync field. */
+#define LIN_SYNC_MEASURED_BITS 8U   /**< @brief Bit times between the first and the last edge. */
+#define LIN_SYNC_TOLERANCE_DIV 7U   /**< @brief Accepted deviation from the nominal bit time: 1/7 (about 14 %). */
+
+/**********************************************************
+ * @brief Maximum response time in tenths of nominal bit times per byte.
+ * @details T_Response_Maximum = 1.4 * T_Response_Nominal = 1.4 * 10 * (Dl + 1) bit times.
+ **********************************************************/
+#define LIN_RESPONSE_TENTH_BITS_PER_BYTE 140U
+
+/**********************************************************
+ * @brief Maximum header time in tenths of nominal bit times.
+ * @details T_Header_Maximum = 1.4 * T_Header_Nominal = 1.4 * 34 bit times.
+ **********************************************************/
+#define LIN_HEADER_MAX_TENTH_BITS 476U
+
+/**********************************************************
+ * @brief Shortest delay armed on the driver timer, so the compare cannot be missed.
+ **********************************************************/
+#define LIN_BATCH_MIN_DELAY_US 2U
+
+/**********************************************************
+ * @brief Bus fault handling (master channels).
+ * @details After LIN_BUS_STUCK_FRAMES header errors in a row (break not seen
+ *          back, header echo wrong, or header past its deadline) the bus is
+ *          considered stuck and the channel degraded: no frame is sent and
+ *          Lin_GetStatus reports LIN_NOT_OK. Every LIN_RECOVERY_DELAY_US the
+ *          USART is reset and, once the Rx pin is recessive again, frames are
+ *          allowed. After LIN_RECOVERY_ATTEMPTS degradations without a good
+ *          frame in between, the channel stays degraded until Lin_Init.
+ **********************************************************/
+#define LIN_BUS_STUCK_FRAMES 3U      /**< @brief Consecutive header errors meaning a stuck bus. */
+#define LIN_RECOVERY_DELAY_US 50000U /**< @brief Time between recovery attempts (at most 65535). */
+#define LIN_RECOVERY_ATTEMPTS 5U     /**< @brief Degradations tolerated before giving up. */
+
+/**********************************************************
+ * @brief Sleep and wake-up.
+ * @details The wake-up pulses of all channels are timed by one free-running
+ *          1 MHz timer, one compare channel per LIN channel; the timer is
+ *          reserved for the LIN driver and only runs while a pulse is sent,
+ *          a frame is bounded by its deadline, a frame batch (Lin_SendFrames)
+ *          is in progress or a stuck bus is being retried.
+ **********************************************************/
+#define LIN_GO_TO_SLEEP_FIRST_BYTE 0x00U         /**< @brief Data byte 1 of the go-to-sleep command (0x3C). */
+#define LIN_GO_TO_SLEEP_PADDING 0xFFU            /**< @brief Data bytes 2...8 of the go-to-sleep command. */
+#define LIN_WAKEUP_PULSE_US 1000U                /**< @brief Dominant wake-up pulse sent by Lin_Wakeup (250 us...5 ms). */
+#define LIN_WAKEUP_DETECT_US 150U                /**< @brief Shortest dominant pulse accepted as a wake-up. */
+#define LIN_WAKEUP_TIMER TIM4                    /**< @brief Timer of the wake-up pulses. */
+#define LIN_WAKEUP_TIMER_IRQn TIM4_IRQn          /**< @brief Interrupt of the wake-up timer. */
+#define LIN_WAKEUP_TIMER_CLOCK RCC_APB1Periph_TIM4 /**< @brief RCC APB1 clock bit of the wake-up timer. */
+#define LIN_WAKEUP_TIMER_HZ 1000000U             /**< @brief Counting frequency of the wake-up timer. */
+
+/**********************************************************
+ * @brief Protected identifier of each frame identifier.
+ * @details PID = ID | P0 << 6 | P1 << 7 with P0 = ID0 ^ ID1 ^ ID2 ^ ID4
+ *          and P1 = !(ID1 ^ ID3 ^ ID4 ^ ID5).
+ **********************************************************/
+static const uint8 Lin_PidTable[64] = {
+    0x80, 0xC1, 0x42, 0x03, 0xC4, 0x85, 0x06, 0x47,
+    0x08, 0x49, 0xCA, 0x8B, 0x4C, 0x0D, 0x8E, 0xCF,
+    0x50, 0x11, 0x92, 0xD3, 0x14, 0x55, 0xD6, 0x97,
+    0xD8, 0x99, 0x1A, 0x5B, 0x9C, 0xDD, 0x5E, 0x1F,
+    0x20, 0x61, 0xE2, 0xA3, 0x64, 0x25, 0xA6, 0xE7,
+    0xA8, 0xE9, 0x6A, 0x2B, 0xEC, 0xAD, 0x2E, 0x6F,
+    0xF0, 0xB1, 0x32, 0x73, 0xB4, 0xF5, 0x76, 0x37,
+    0x78, 0x39, 0xBA, 0xFB, 0x3C, 0x7D, 0xFE, 0xBF
+};
+
+/**********************************************************
+ * @struct Lin_HwChannelType
+ * @brief Hardware resources of a LIN channel.
+ **********************************************************/
+typedef struct
+{
+    USART_TypeDef *Usart;       /**< @brief USART running the channel. */
+    IRQn_Type IRQn;             /**< @brief Interrupt of the USART. */
+    uint32 ApbClock;            /**< @brief RCC clock bit of the USART. */
+    boolean OnApb2;             /**< @brief TRUE if the USART clock is on APB2, FALSE for APB1. */
+    GPIO_TypeDef *Port;         /**< @brief GPIO port of the Tx and Rx pins. */
+    uint32 PortClock;           /**< @brief RCC APB2 clock bit of the GPIO port. */
+    uint16 TxPin;               /**< @brief Tx pin. */
+    uint16 RxPin;               /**< @brief Rx pin. */
+    DMA_Channel_TypeDef *TxDma; /**< @brief DMA1 channel serving USART TX requests. */
+    DMA_Channel_TypeDef *RxDma; /**< @brief DMA1 channel serving USART RX requests. */
+    uint8 RxDmaNumber;          /**< @brief Number of the RX DMA1 channel (for the flag bits). */
+    IRQn_Type RxDmaIRQn;        /**< @brief Interrupt of the RX DMA channel. */
+    uint32 ExtiLine;            /**< @brief EXTI line of the Rx pin (sync field timing). */
+    uint8 ExtiPortSource;       /**< @brief AFIO port source of the Rx pin. */
+    uint8 ExtiPinSource;        /**< @brief AFIO pin source of the Rx pin. */
+    IRQn_Type ExtiIRQn;         /**< @brief Interrupt of the EXTI line. */
+    __IO uint16_t *WakeupCcr;   /**< @brief Compare register of the wake-up timer ending the pulse. */
+    uint16 WakeupCc;            /**< @brief CCxIE/CCxIF bit of that compare channel. */
+} Lin_HwChannelType;
+
+/**********************************************************
+ * @brief Hardware of each LIN channel, indexed by channel number.
+ * @details Default (non-remapped) pins of USART1, USART2 and USART3, their fixed DMA1
+ *          channels and compare channels 1...3 of the wake-up timer.
+ **********************************************************/
+static const Lin_HwChannelType Lin_HwChannel[MAX_LIN_CHANNELS] = {
+    {USART1, USART1_IRQn, RCC_APB2Periph_USART1, TRUE, GPIOA, RCC_APB2Periph_GPIOA, GPIO_Pin_9, GPIO_Pin_10,
+     DMA1_Channel4, DMA1_Channel5, 5, DMA1_Channel5_IRQn,
+     0x1UL << 10, GPIO_PortSourceGPIOA, GPIO_PinSource10, EXTI15_10_IRQn,
+     &LIN_WAKEUP_TIMER->CCR1, TIM_DIER_CC1IE},
+    {USART2, USART2_IRQn, RCC_APB1Periph_USART2, FALSE, GPIOA, RCC_APB2Periph_GPIOA, GPIO_Pin_2, GPIO_Pin_3,
+     DMA1_Channel7, DMA1_Channel6, 6, DMA1_Channel6_IRQn,
+     0x1UL << 3, GPIO_PortSourceGPIOA, GPIO_PinSource3, EXTI3_IRQn,
+     &LIN_WAKEUP_TIMER->CCR2, TIM_DIER_CC2IE},
+    {USART3, USART3_IRQn, RCC_APB1Periph_USART3, FALSE, GPIOB, RCC_APB2Periph_GPIOB, GPIO_Pin_10, GPIO_Pin_11,
+     DMA1_Channel2, DMA1_Channel3, 3, DMA1_Channel3_IRQn,
+     0x1UL << 11, GPIO_PortSourceGPIOB, GPIO_PinSource11, EXTI15_10_IRQn,
+     &LIN_WAKEUP_TIMER->CCR3, TIM_DIER_CC3IE},
+};
+
+/**********************************************************
+ * @enum Lin_FrameStateType
+ * @brief Steps of the interrupt driven frame state machine.
+ **********************************************************/
+typedef enum
+{
+    LIN_FRAME_IDLE,       /**< @brief No frame in progress. */
+    LIN_FRAME_BREAK,      /**< @brief Break requested, waiting for LBD. */
+    LIN_FRAME_SLAVE_SYNC, /**< @brief Slave: break received, timing the sync field. */
+    LIN_FRAME_SLAVE_PID,  /**< @brief Slave: baud rate adapted, waiting for the PID. */
+    LIN_FRAME_SLAVE_TX_WAIT, /**< @brief Slave: response ready, waiting for the end of the PID stop bit. */
+    LIN_FRAME_HEADER,     /**< @brief Sync and PID being shifted out (TXE driven). */
+    LIN_FRAME_TX_RESPONSE, /**< @brief Data and checksum being shifted out (TXE driven). */
+    LIN_FRAME_RX_RESPONSE  /**< @brief Waiting for the slave response (RXNE driven). */
+} Lin_FrameStateType;
+
+/**********************************************************
+ * @struct Lin_ChannelRuntimeType
+ * @brief Per-channel state shared between Lin_SendFrame, the ISR and Lin_GetStatus.
+ **********************************************************/
+typedef struct
+{
+    volatile Lin_StatusType FrameStatus;      /**< @brief Status reported by Lin_GetStatus. */
+    volatile Lin_FrameStateType FrameState;   /**< @brief Current step of the frame. */
+    boolean UseDma;                           /**< @brief Responses are moved by DMA instead of per-byte interrupts. */
+    boolean IsSlave;                          /**< @brief Channel runs as a slave node. */
+    boolean IsMonitor;                        /**< @brief Channel runs as a bus monitor. */
+    boolean MonitorActive;                    /**< @brief Monitor: a break was seen, Monitor is being filled. */
+    uint8 MonitorIndex;                       /**< @brief Monitor: bytes received since the break. */
+    boolean MonitorIdle;                      /**< @brief Monitor: bus idle since the last response byte. */
+    Lin_MonitorRecordType Monitor;            /**< @brief Monitor: frame being recorded. */
+    const Lin_PduType *SlaveResponseTable;    /**< @brief Slave: response of each frame ID. */
+    uint8 SyncEdges;                          /**< @brief Slave: falling edges seen in the sync field. */
+    uint32 SyncStart;                         /**< @brief Slave: cycle count of the first sync edge. */
+    uint32 NominalBitCycles;                  /**< @brief Configured bit time in CPU cycles. */
+    uint32 CoreToPclk;                        /**< @brief SystemCoreClock / USART clock. */
+    Lin_FrameResponseType Drc;                /**< @brief Response type of the current frame. */
+    Lin_FrameCsModelType Cs;                  /**< @brief Checksum model of the current frame. */
+    uint8 Pid;                                /**< @brief Protected identifier of the current frame. */
+    uint8 TxBuffer[LIN_FRAME_BUFFER_SIZE];    /**< @brief Bytes to transmit after the break. */
+    uint8 HeaderLength;                       /**< @brief Number of header bytes (sync + PID). */
+    uint8 TxLength;                           /**< @brief Number of bytes in TxBuffer. */
+    volatile uint8 TxIndex;                   /**< @brief Next byte to write into DR. */
+    uint8 EchoBuffer[LIN_FRAME_BUFFER_SIZE];  /**< @brief DMA mode: bytes read back while TxBuffer is sent. */
+    volatile uint8 EchoIndex;                 /**< @brief Next TxBuffer byte expected back from the bus. */
+    uint8 RxBuffer[LIN_RESPONSE_BUFFER_SIZE]; /**< @brief Received data and checksum (frames without signal buffer). */
+    Lin_SignalBufferType *const *SignalBufferTable; /**< @brief Signal buffer of each frame ID, may be NULL. */
+    Lin_SignalBufferType *RxSignal;           /**< @brief Signal buffer of the current response, NULL if none. */
+    uint8 *RxData;                            /**< @brief Where the current response is received. */
+    uint8 RxLength;                           /**< @brief Expected response length (Dl + 1). */
+    volatile uint8 RxIndex;                   /**< @brief Number of response bytes received. */
+    uint32 BitTimeCycles;                     /**< @brief One nominal bit time in CPU cycles. */
+    uint32 ResponseStart;                     /**< @brief Cycle count at the end of the header. */
+    uint32 ResponseTimeout;                   /**< @brief Maximum response time in CPU cycles. */
+    volatile Lin_ErrorCountersType Errors;    /**< @brief Error counters, see Lin_CountError. */
+#if (LIN_TIMING_SUPPORT == 1)
+    Lin_TimingRecordType Timing;              /**< @brief Timestamps of the current frame. */
+#endif
+    volatile boolean SleepPending;            /**< @brief The go-to-sleep command is being sent. */
+    volatile boolean WakeupPulse;             /**< @brief Lin_Wakeup: the dominant pulse is being sent. */
+    volatile boolean WakeupDetected;          /**< @brief Sleep: a wake-up pulse was seen on the bus. */
+    boolean WakeupEdge;                       /**< @brief Sleep: bus dominant since the last falling edge. */
+    boolean WakeupLong;                       /**< @brief Sleep: still dominant LIN_WAKEUP_DETECT_US after that edge. */
+    const Lin_PduType *volatile Batch;        /**< @brief Frames of the running batch, NULL if none. */
+    uint8 BatchCount;                         /**< @brief Number of frames of the batch. */
+    uint8 BatchIndex;                         /**< @brief Batch frame in progress or sent next. */
+    uint8 BatchOk;                            /**< @brief Batch frames completed successfully. */
+    uint16 BatchGapUs;                        /**< @brief Inter-frame space of the batch, in microseconds. */
+    Lin_BatchNotificationType BatchNotification; /**< @brief Called when the batch ends, may be NULL. */
+    uint8 HeaderFailures;                     /**< @brief Consecutive frames ended by a header error. */
+    uint8 RecoveryAttempts;                   /**< @brief Degradations since the last good frame. */
+    volatile boolean Degraded;                /**< @brief Bus stuck: frames refused until recovered. */
+} Lin_ChannelRuntimeType;
+
+/**********************************************************
+ * @brief Runtime state of each LIN channel.
+ **********************************************************/
+static Lin_ChannelRuntimeType Lin_ChannelRuntime[MAX_LIN_CHANNELS];
+
+/**********************************************************
+ * @brief Sleep/operational state of each LIN channel.
+ **********************************************************/
+static volatile Lin_StatusType LinChannelState[MAX_LIN_CHANNELS] = {
+    LIN_CH_SLEEP, // Initialize the initial state for each channel
+    LIN_CH_SLEEP,
+    LIN_CH_SLEEP
+};
+
+/**********************************************************
+ * @brief Frames recorded by the bus monitor, not read yet (ring buffer).
+ **********************************************************/
+static Lin_MonitorRecordType Lin_MonitorRing[LIN_MONITOR_RECORDS];
+static volatile uint8 Lin_MonitorHead; /**< @brief Records written, modulo 256. */
+static volatile uint8 Lin_MonitorTail; /**< @brief Records read, modulo 256. */
+static boolean Lin_MonitorLost;        /**< @brief A record was dropped since the last one stored. */
+
+#if (LIN_TIMING_SUPPORT == 1)
+/**********************************************************
+ * @brief Frame timing records not read yet (ring buffer).
+ **********************************************************/
+static Lin_TimingRecordType Lin_TimingRing[LIN_TIMING_RECORDS];
+static volatile uint8 Lin_TimingHead; /**< @brief Records written, modulo 256. */
+static volatile uint8 Lin_TimingTail; /**< @brief Records read, modulo 256. */
+
+/**********************************************************
+ * @brief Timing statistics, indexed by channel and frame ID.
+ **********************************************************/
+static Lin_TimingStatsType Lin_TimingStats[MAX_LIN_CHANNELS][LIN_FRAME_ID_MASK + 1U];
+
+/**********************************************************
+ * @brief Start the timing record of a new frame.
+ * @param runtime Runtime state of the channel.
+ **********************************************************/
+static void Lin_TimingStart(Lin_ChannelRuntimeType *runtime)
+{
+    runtime->Timing.BreakStart = LIN_CYCLE_COUNTER();
+    runtime->Timing.HeaderEnd = 0;
+    runtime->Timing.FirstByte = 0;
+}
+
+/**********************************************************
+ * @brief Raise a maximum duration with the time between two timestamps.
+ * @param max Maximum in microseconds, saturating at 0xFFFF.
+ * @param from First timestamp, 0 if not recorded.
+ * @param to Second timestamp, 0 if not recorded.
+ **********************************************************/
+static void Lin_TimingMax(uint16 *max, uint32 from, uint32 to)
+{
+    if ((from == 0U) || (to == 0U))
+    {
+        return;
+    }
+
+    uint32 us = (uint32)(to - from) / (SystemCoreClock / 1000000U);
+    if (us > 0xFFFFU)
+    {
+        us = 0xFFFFU;
+    }
+    if (us > *max)
+    {
+        *max = (uint16)us;
+    }
+}
+
+/**********************************************************
+ * @brief Close the timing record of a frame: statistics and ring buffer.
+ * @param runtime Runtime state of the channel; FrameStatus is final.
+ * @details A full ring buffer drops the new record.
+ **********************************************************/
+static void Lin_TimingEnd(Lin_ChannelRuntimeType *runtime)
+{
+    Lin_TimingRecordType *record = &runtime->Timing;
+    uint8 channel = (uint8)(runtime - Lin_ChannelRuntime);
+    Lin_TimingStatsType *stats = &Lin_TimingStats[channel][runtime->Pid & LIN_FRAME_ID_MASK];
+
+    record->End = LIN_CYCLE_COUNTER();
+    record->Channel = channel;
+    record->Pid = runtime->Pid;
+    record->Status = runtime->FrameStatus;
+
+    if (stats->Frames < 0xFFFFU)
+    {
+        stats->Frames++;
+    }
+    Lin_TimingMax(&stats->MaxHeaderUs, record->BreakStart, record->HeaderEnd);
+    Lin_TimingMax(&stats->MaxResponseUs, record->HeaderEnd, record->End);
+    Lin_TimingMax(&stats->MaxFrameUs, record->BreakStart, record->End);
+
+    // Response time in tenths of the nominal 10 * (Dl + 1) bit times
+    if ((record->Status == LIN_RX_OK) && (record->HeaderEnd != 0U))
+    {
+        uint32 tenths = (uint32)(record->End - record->HeaderEnd) / (runtime->BitTimeCycles * runtime->RxLength);
+        uint8 bin = (tenths <= 9U) ? 0U : ((tenths >= 14U) ? 5U : (uint8)(tenths - 9U));
+        if (stats->ResponseHistogram[bin] < 0xFFFFU)
+        {
+            stats->ResponseHistogram[bin]++;
+        }
+    }
+
+    // The channels may preempt each other
+    uint32 primask = Mcal_EnterCritical();
+    if ((uint8)(Lin_TimingHead - Lin_TimingTail) < LIN_TIMING_RECORDS)
+    {
+        Lin_TimingRing[Lin_TimingHead % LIN_TIMING_RECORDS] = *record;
+        Lin_TimingHead++;
+    }
+    Mcal_ExitCritical(primask);
+}
+#endif
+
+/**********************************************************
+ * @brief Start a DMA transfer between the USART data register and a buffer.
+ * @param dma DMA channel to use.
+ * @param ccr Direction and interrupt settings of the channel.
+ * @param usart USART whose DR is the peripheral side.
+ * @param buffer Memory side of the transfer.
+ * @param length Number of bytes to transfer.
+ **********************************************************/
+static void Lin_DmaStart(DMA_Channel_TypeDef *dma, uint32 ccr, USART_TypeDef *usart, uint8 *buffer, uint8 length)
+{
+    dma->CCR = 0; // The channel must be disabled to be reprogrammed
+    dma->CPAR = (uint32)&usart->DR;
+    dma->CMAR = (uint32)buffer;
+    dma->CNDTR = length;
+    dma->CCR = ccr | DMA_CCR1_EN;
+}
+
+/**********************************************************
+ * @brief Stop the DMA transfers of a channel and return the USART to interrupt mode.
+ * @param Channel The LIN channel.
+ **********************************************************/
+static void Lin_DmaStop(uint8 Channel)
+{
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    hw->Usart->CR3 &= (uint16)~(USART_CR3_DMAT | USART_CR3_DMAR | USART_CR3_EIE);
+    hw->TxDma->CCR = 0;
+    hw->RxDma->CCR = 0;
+    DMA1->IFCR = LIN_DMA_IFCR_CGIF(hw->RxDmaNumber);
+}
+
+/**********************************************************
+ * @brief Number of response bytes received so far.
+ * @param Channel The LIN channel.
+ * @return Bytes counted by the RXNE interrupt, or transferred by the RX DMA channel.
+ **********************************************************/
+static uint8 Lin_RxCount(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+
+    if (runtime->UseDma)
+    {
+        return (uint8)(runtime->RxLength - Lin_HwChannel[Channel].RxDma->CNDTR);
+    }
+    return runtime->RxIndex;
+}
+
+/**********************************************************
+ * @brief Enable or gate the clock of the USART of a channel.
+ * @param hw Hardware of the channel.
+ * @param state ENABLE or DISABLE; the registers keep their contents while gated.
+ **********************************************************/
+static void Lin_UsartClockCmd(const Lin_HwChannelType *hw, FunctionalState state)
+{
+    if (hw->OnApb2)
+    {
+        RCC_APB2PeriphClockCmd(hw->ApbClock, state);
+    }
+    else
+    {
+        RCC_APB1PeriphClockCmd(hw->ApbClock, state);
+    }
+}
+
+/**********************************************************
+ * @brief Set the mode of the Tx pin of a channel.
+ * @param hw Hardware of the channel.
+ * @param mode GPIO_Mode_AF_PP (driven by the USART) or GPIO_Mode_Out_PP (wake-up pulse).
+ **********************************************************/
+static void Lin_TxPinMode(const Lin_HwChannelType *hw, GPIOMode_TypeDef mode)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    GPIO_InitStructure.GPIO_Pin = hw->TxPin;
+    GPIO_InitStructure.GPIO_Mode = mode;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(hw->Port, &GPIO_InitStructure);
+}
+
+/**********************************************************
+ * @brief Start the 1 MHz timer of the wake-up pulses and frame batches.
+ * @details Does nothing if it already runs; call it with the timer interrupt masked.
+ **********************************************************/
+static void Lin_TimerStart(void)
+{
+    if ((LIN_WAKEUP_TIMER->CR1 & TIM_CR1_CEN) != 0U)
+    {
+        return;
+    }
+
+    RCC_ClocksTypeDef clocks;
+    RCC_GetClocksFreq(&clocks);
+    // APB1 timers run at twice PCLK1 when APB1 is divided
+    uint32 timerClock = (clocks.HCLK_Frequency == clocks.PCLK1_Frequency) ? clocks.PCLK1_Frequency
+                                                                           : 2U * clocks.PCLK1_Frequency;
+    RCC_APB1PeriphClockCmd(LIN_WAKEUP_TIMER_CLOCK, ENABLE);
+    LIN_WAKEUP_TIMER->PSC = (uint16)(timerClock / LIN_WAKEUP_TIMER_HZ - 1U);
+    LIN_WAKEUP_TIMER->ARR = 0xFFFF;
+    LIN_WAKEUP_TIMER->EGR = TIM_EGR_UG; // Load the prescaler
+    LIN_WAKEUP_TIMER->SR = 0;
+    LIN_WAKEUP_TIMER->CR1 = TIM_CR1_CEN;
+}
+
+/**********************************************************
+ * @brief Arm the timer compare of a channel; TIM4_IRQHandler runs when it expires.
+ * @param Channel The LIN channel.
+ * @param Us Delay from now, in microseconds (LIN_BATCH_MIN_DELAY_US...0xFFFF).
+ **********************************************************/
+static void Lin_TimerArm(uint8 Channel, uint32 Us)
+{
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    if (Us < LIN_BATCH_MIN_DELAY_US)
+    {
+        Us = LIN_BATCH_MIN_DELAY_US;
+    }
+    else if (Us > 0xFFFFU)
+    {
+        Us = 0xFFFFU;
+    }
+
+    NVIC_DisableIRQ(LIN_WAKEUP_TIMER_IRQn);
+    Lin_TimerStart();
+    *hw->WakeupCcr = (uint16)(LIN_WAKEUP_TIMER->CNT + Us);
+    LIN_WAKEUP_TIMER->SR = (uint16)~hw->WakeupCc;
+    LIN_WAKEUP_TIMER->DIER |= hw->WakeupCc;
+    NVIC_EnableIRQ(LIN_WAKEUP_TIMER_IRQn);
+}
+
+/**********************************************************
+ * @brief Disarm the timer compare of a channel; the timer stops once no compare is armed.
+ * @param Channel The LIN channel.
+ **********************************************************/
+static void Lin_TimerDisarm(uint8 Channel)
+{
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    NVIC_DisableIRQ(LIN_WAKEUP_TIMER_IRQn);
+    LIN_WAKEUP_TIMER->DIER &= (uint16)~hw->WakeupCc;
+    if ((LIN_WAKEUP_TIMER->DIER & (TIM_DIER_CC1IE | TIM_DIER_CC2IE | TIM_DIER_CC3IE)) == 0U)
+    {
+        LIN_WAKEUP_TIMER->CR1 = 0;
+    }
+    NVIC_EnableIRQ(LIN_WAKEUP_TIMER_IRQn);
+}
+
+/**********************************************************
+ * @brief End the frame batch of a channel and notify the application.
+ * @param Channel The LIN channel.
+ **********************************************************/
+static void Lin_BatchEnd(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    Lin_BatchNotificationType notification = runtime->BatchNotification;
+
+    Lin_TimerDisarm(Channel);
+    runtime->Batch = NULL;
+    if (notification != NULL)
+    {
+        notification(Channel, runtime->BatchOk);
+    }
+}
+
+/**********************************************************
+ * @brief Put a channel to sleep: stop the frame, gate the USART clock and arm the wake-up detection.
+ * @param Channel The LIN channel.
+ * @details With wake-up support, the Rx pin is watched by its EXTI line on
+ *          both edges: the falling edge also wakes the MCU from a low-power
+ *          mode and starts the measurement of the dominant pulse, the rising
+ *          edge ends it (Lin_WakeupEdgeIsr).
+ **********************************************************/
+static void Lin_EnterSleep(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    hw->Usart->CR1 &= (uint16)~(USART_CR1_TXEIE | USART_CR1_TCIE | USART_CR1_RXNEIE);
+    hw->Usart->CR2 &= (uint16)~USART_CR2_LBDIE;
+    if (runtime->UseDma)
+    {
+        Lin_DmaStop(Channel);
+    }
+    runtime->SleepPending = FALSE;
+    runtime->FrameState = LIN_FRAME_IDLE;
+    if (runtime->Batch != NULL)
+    {
+        Lin_BatchEnd(Channel); // Remaining frames are dropped
+    }
+    Lin_TimerDisarm(Channel);
+    runtime->Degraded = FALSE;
+    runtime->HeaderFailures = 0;
+    runtime->FrameStatus = LIN_CH_SLEEP;
+    LinChannelState[Channel] = LIN_CH_SLEEP;
+    Lin_UsartClockCmd(hw, DISABLE);
+
+    if (LinChannelConfig[Channel].LinChannelWakeupSupport == ENABLE)
+    {
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+        GPIO_EXTILineConfig(hw->ExtiPortSource, hw->ExtiPinSource);
+        runtime->WakeupEdge = FALSE;
+        runtime->WakeupLong = FALSE;
+        EXTI->FTSR |= hw->ExtiLine;
+        EXTI->RTSR |= hw->ExtiLine;
+        EXTI->PR = hw->ExtiLine;
+        EXTI->IMR |= hw->ExtiLine;
+        NVIC_EnableIRQ(hw->ExtiIRQn);
+    }
+}
+
+/**********************************************************
+ * @brief Leave sleep: disarm the wake-up detection and resume the USART.
+ * @param Channel The LIN channel.
+ **********************************************************/
+static void Lin_LeaveSleep(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    EXTI->IMR &= ~hw->ExtiLine;
+    EXTI->RTSR &= ~hw->ExtiLine;
+    EXTI->PR = hw->ExtiLine;
+
+    Lin_UsartClockCmd(hw, ENABLE);
+    (void)hw->Usart->SR; // Drop whatever was flagged before the clock was gated
+    (void)hw->Usart->DR;
+    hw->Usart->SR = (uint16)~USART_SR_LBD;
+    if (runtime->IsSlave || runtime->IsMonitor)
+    {
+        hw->Usart->CR2 |= USART_CR2_LBDIE;
+        hw->Usart->CR1 |= USART_CR1_RXNEIE;
+    }
+    if (runtime->IsMonitor)
+    {
+        runtime->MonitorActive = FALSE;
+        hw->Usart->CR1 |= USART_CR1_IDLEIE;
+    }
+
+    runtime->WakeupDetected = FALSE;
+    runtime->FrameState = LIN_FRAME_IDLE;
+    runtime->FrameStatus = LIN_OPERATIONAL;
+    LinChannelState[Channel] = LIN_OPERATIONAL;
+}
+
+/**********************************************************
+ * @brief Look up the precomputed BRR value of a baud rate.
+ * @param Channel The LIN channel.
+ * @param BaudRate Baud rate in bit/s.
+ * @return The USART_BRR value, 0 if the baud rate is not in Lin_BaudrateTable.
+ **********************************************************/
+static uint16 Lin_LookupBrr(uint8 Channel, uint32 BaudRate)
+{
+    for (uint8 i = 0; i < LIN_NUM_BAUDRATES; i++)
+    {
+        if (Lin_BaudrateTable[Channel][i].BaudRate == BaudRate)
+        {
+            return Lin_BaudrateTable[Channel][i].Brr;
+        }
+    }
+
+    return 0;
+}
+
+/**********************************************************
+ * @brief Initialize a LIN channel.
  * @param Config Pointer to the LIN configuration structure.
+ * @details The USART, pins and interrupt come from Lin_HwChannel[Config->Lin_Channel].
+ *          Call it once per channel; every channel runs its own state machine.
  **********************************************************/
 void Lin_Init(const Lin_ConfigType *Config)
 {
     // Check if the configuration is valid
-    if (Config == NULL)
+    if ((Config == NULL) || (Config->Lin_Channel >= MAX_LIN_CHANNELS))
+    {
+        return; // Return if the configuration is invalid
+    }
+
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Config->Lin_Channel];
+
+    // Enable clock for GPIO port and USART used for LIN
+    RCC_APB2PeriphClockCmd(hw->PortClock, ENABLE);
+    Lin_UsartClockCmd(hw, ENABLE);
+
+    // Configure Tx and Rx pins of the USART used for LIN; a monitor leaves the bus alone
+    Lin_TxPinMode(hw, (Config->Lin_Mode == LIN_MODE_MONITOR) ? GPIO_Mode_IN_FLOATING : GPIO_Mode_AF_PP);
+
+    GPIO_InitTypeDef GPIO_InitStructure;
+    GPIO_InitStructure.GPIO_Pin = hw->RxPin; // Rx pin
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+    GPIO_Init(hw->Port, &GPIO_InitStructure);
+
+    // BRR precomputed for the configured baud rate; other rates are computed from the bus clock
+    uint16 brr = Lin_LookupBrr(Config->Lin_Channel, Config->Lin_BaudRate);
+    if (brr == 0U)
+    {
+        RCC_ClocksTypeDef clocks;
+        RCC_GetClocksFreq(&clocks);
+        uint32 pclk = hw->OnApb2 ? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency;
+        brr = (uint16)((pclk + Config->Lin_BaudRate / 2U) / Config->Lin_BaudRate);
+    }
+
+    // Configure USART for LIN communication: 8 data bits, 1 stop bit, no parity, no flow control
+    hw->Usart->CR1 = 0;
+    hw->Usart->CR2 &= (uint16)~USART_CR2_STOP;
+    hw->Usart->CR3 = 0;
+    hw->Usart->BRR = brr;
+    hw->Usart->CR1 = (Config->Lin_Mode == LIN_MODE_MONITOR) ? (USART_CR1_UE | USART_CR1_RE)
+                                                             : (USART_CR1_UE | USART_CR1_TE | USART_CR1_RE);
+
+    // Enable LIN mode with 11-bit break detection (LBD is raised by our own break too)
+    USART_LINBreakDetectLengthConfig(hw->Usart, USART_LINBreakDetectLength_11b);
+    USART_LINCmd(hw->Usart, ENABLE);
+
+    // No frame in progress
+    Lin_ChannelRuntime[Config->Lin_Channel].FrameState = LIN_FRAME_IDLE;
+    Lin_ChannelRuntime[Config->Lin_Channel].FrameStatus = LIN_OPERATIONAL;
+    Lin_ChannelRuntime[Config->Lin_Channel].SleepPending = FALSE;
+    Lin_ChannelRuntime[Config->Lin_Channel].Batch = NULL;
+    Lin_ChannelRuntime[Config->Lin_Channel].Degraded = FALSE;
+    Lin_ChannelRuntime[Config->Lin_Channel].HeaderFailures = 0;
+    Lin_ChannelRuntime[Config->Lin_Channel].RecoveryAttempts = 0;
+    Lin_ChannelRuntime[Config->Lin_Channel].WakeupDetected = FALSE;
+    LinChannelState[Config->Lin_Channel] = LIN_OPERATIONAL;
+    Lin_ChannelRuntime[Config->Lin_Channel].BitTimeCycles = SystemCoreClock / Config->Lin_BaudRate;
+    Lin_ChannelRuntime[Config->Lin_Channel].NominalBitCycles = SystemCoreClock / Config->Lin_BaudRate;
+    Lin_ChannelRuntime[Config->Lin_Channel].UseDma =
+        ((Config->Lin_DmaSupport == ENABLE) && (Config->Lin_Mode != LIN_MODE_MONITOR)) ? TRUE : FALSE;
+    Lin_ChannelRuntime[Config->Lin_Channel].IsSlave = (Config->Lin_Mode == LIN_MODE_SLAVE) ? TRUE : FALSE;
+    Lin_ChannelRuntime[Config->Lin_Channel].IsMonitor = (Config->Lin_Mode == LIN_MODE_MONITOR) ? TRUE : FALSE;
+    Lin_ChannelRuntime[Config->Lin_Channel].MonitorActive = FALSE;
+    Lin_ChannelRuntime[Config->Lin_Channel].SlaveResponseTable = Config->Lin_SlaveResponseTable;
+    Lin_ChannelRuntime[Config->Lin_Channel].SignalBufferTable = Config->Lin_SignalBufferTable;
+    Lin_ChannelRuntime[Config->Lin_Channel].RxData = Lin_ChannelRuntime[Config->Lin_Channel].RxBuffer;
+    for (uint8 i = 0; i < LIN_ERROR_TYPES; i++)
+    {
+        Lin_ChannelRuntime[Config->Lin_Channel].Errors.Count[i] = 0;
+    }
+
+    // Slave: listen for breaks permanently and time the sync field on the Rx pin
+    if (Config->Lin_Mode == LIN_MODE_SLAVE)
+    {
+        RCC_ClocksTypeDef clocks;
+        RCC_GetClocksFreq(&clocks);
+        Lin_ChannelRuntime[Config->Lin_Channel].CoreToPclk =
+            SystemCoreClock / (hw->OnApb2 ? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency);
+
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+        GPIO_EXTILineConfig(hw->ExtiPortSource, hw->ExtiPinSource);
+        EXTI->IMR &= ~hw->ExtiLine; // Unmasked only while the sync field is timed
+        EXTI->FTSR |= hw->ExtiLine;
+        EXTI->PR = hw->ExtiLine;
+        NVIC_EnableIRQ(hw->ExtiIRQn);
+
+        hw->Usart->SR = (uint16)~USART_SR_LBD;
+        hw->Usart->CR2 |= USART_CR2_LBDIE;
+        hw->Usart->CR1 |= USART_CR1_RXNEIE;
+    }
+
+    // Monitor: every break, byte and bus idle interrupts
+    if (Config->Lin_Mode == LIN_MODE_MONITOR)
+    {
+        hw->Usart->SR = (uint16)~USART_SR_LBD;
+        hw->Usart->CR2 |= USART_CR2_LBDIE;
+        hw->Usart->CR1 |= USART_CR1_RXNEIE | USART_CR1_IDLEIE;
+    }
+
+    // Responses by DMA: the RX channel interrupts once per response
+    if ((Config->Lin_DmaSupport == ENABLE) && (Config->Lin_Mode != LIN_MODE_MONITOR))
+    {
+        RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+        NVIC_EnableIRQ(hw->RxDmaIRQn);
+    }
+
+    // Start the cycle counter used to time the slave response
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Enable interrupt; frames are driven by the LBD/TXE/TC/RXNE interrupts
+    NVIC_EnableIRQ(hw->IRQn);
+}
+
+/**********************************************************
+ * @brief Check for wake-up event on the LIN channel.
+ * @param Channel The LIN channel to check.
+ * @return `E_OK` if a wake-up event is detected, `E_NOT_OK` if not detected.
+ * @details Reports (once) a dominant pulse of at least LIN_WAKEUP_DETECT_US seen on the
+ *          bus while the channel sleeps. The channel stays asleep; call
+ *          Lin_WakeupInternal to resume it.
+ **********************************************************/
+Std_ReturnType Lin_CheckWakeup(uint8 Channel)
+{
+    // Check if the Channel is within a valid range
+    if (Channel >= MAX_LIN_CHANNELS)
+    {
+        return E_NOT_OK; // Return if the Channel is invalid
+    }
+
+    // Set by the EXTI interrupt of the Rx pin while the channel sleeps
+    if (Lin_ChannelRuntime[Channel].WakeupDetected)
+    {
+        Lin_ChannelRuntime[Channel].WakeupDetected = FALSE;
+        return E_OK; // Wake-up event detected
+    }
+
+    return E_NOT_OK; // No wake-up event detected
+}
+
+/**********************************************************
+ * @brief Retrieve the version information of the LIN driver.
+ * @param versioninfo Pointer to the structure where version information will be stored.
+ **********************************************************/
+void Lin_GetVersionInfo(Std_VersionInfoType *versioninfo)
+{
+    if (versioninfo != NULL)
+    {
+        versioninfo->vendorID = LIN_VENDOR_ID;
+        versioninfo->moduleID = LIN_MODULE_ID;
+        versioninfo->sw_major_version = LIN_SW_MAJOR_VERSION;
+        versioninfo->sw_minor_version = LIN_SW_MINOR_VERSION;
+        versioninfo->sw_patch_version = LIN_SW_PATCH_VERSION;
+    }
+}
+
+/**********************************************************
+ * @brief Calculate the checksum value for a LIN frame.
+ * @param Pid Protected identifier of the frame.
+ * @param Cs Checksum model of the frame.
+ * @param data Pointer to the data array for which the checksum will be calculated.
+ * @param length The length of the data array.
+ * @return The calculated checksum value.
+ * @details The enhanced model also covers the PID; diagnostic frames (0x3C/0x3D)
+ *          always use the classic model. At most 9 bytes are summed, so the sum
+ *          fits in 16 bits and the carries are folded back once at the end
+ *          instead of after every byte.
+ **********************************************************/
+static uint8 LIN_CalculateChecksum(uint8 Pid, Lin_FrameCsModelType Cs, const uint8 *data, uint8 length)
+{
+    uint16 checksum = 0;
+    uint8 id = Pid & LIN_FRAME_ID_MASK;
+
+    // The enhanced checksum starts with the PID
+    if ((Cs == LIN_ENHANCED_CS) && (id != LIN_DIAG_ID_MASTER_REQ) && (id != LIN_DIAG_ID_SLAVE_RESP))
+    {
+        checksum = Pid;
+    }
+
+    // Add all the data bytes
+    for (uint8 i = 0; i < length; i++)
+    {
+        checksum += data[i];
+    }
+
+    // Fold the carries back: the first fold leaves at most 0x1FE, the second one fits in a byte
+    checksum = (checksum & 0xFF) + (checksum >> 8);
+    checksum = (checksum & 0xFF) + (checksum >> 8);
+
+    // Return the checksum's complement value
+    return (uint8)(~checksum);
+}
+
+/**********************************************************
+ * @brief Start a LIN frame (Lin_SendFrame without the batch check).
+ * @param Channel The LIN channel to send the frame.
+ * @param PduInfoPtr Pointer to the PDU containing the information to send.
+ * @return `E_OK` if the frame was started, `E_NOT_OK` if failed.
+ **********************************************************/
+static Std_ReturnType Lin_StartFrame(uint8 Channel, const Lin_PduType *PduInfoPtr)
+{
+    // Check the validity of the input parameters
+    if ((PduInfoPtr == NULL) || (Channel >= MAX_LIN_CHANNELS) || (PduInfoPtr->Dl > LIN_MAX_DATA_LENGTH))
+    {
+        return E_NOT_OK;
+    }
+    if ((PduInfoPtr->Drc == LIN_FRAMERESPONSE_TX) && (PduInfoPtr->SduPtr == NULL))
+    {
+        return E_NOT_OK;
+    }
+
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    USART_TypeDef *usart = Lin_HwChannel[Channel].Usart;
+
+    // Only a master sends headers, and only while the channel is awake and the bus usable
+    if (runtime->IsSlave || runtime->IsMonitor || runtime->Degraded || runtime->SleepPending ||
+        (LinChannelState[Channel] == LIN_CH_SLEEP))
+    {
+        return E_NOT_OK;
+    }
+
+    // The USART, DMA and timer interrupts of the aborted frame must not act on the new one
+    uint32 primask = Mcal_EnterCritical();
+
+    // Abort a frame still in progress: its deadline first, then the frame interrupts and transfers
+    Lin_TimerDisarm(Channel);
+    usart->CR1 &= (uint16)~(USART_CR1_TXEIE | USART_CR1_TCIE);
+    if (runtime->UseDma)
+    {
+        Lin_DmaStop(Channel);
+    }
+    runtime->FrameState = LIN_FRAME_IDLE;
+
+    // Header: sync byte and protected identifier
+    runtime->TxBuffer[0] = LIN_SYNC_BYTE;
+    runtime->Pid = Lin_PidTable[PduInfoPtr->Pid & LIN_FRAME_ID_MASK];
+    runtime->TxBuffer[1] = runtime->Pid;
+    runtime->HeaderLength = 2;
+    runtime->TxLength = 2;
+    runtime->Drc = PduInfoPtr->Drc;
+    runtime->Cs = PduInfoPtr->Cs;
+
+    // Response: data and checksum when this node is the publisher
+    if (PduInfoPtr->Drc == LIN_FRAMERESPONSE_TX)
+    {
+        for (uint8 i = 0; i < PduInfoPtr->Dl; i++)
+        {
+            runtime->TxBuffer[runtime->TxLength++] = PduInfoPtr->SduPtr[i];
+        }
+        runtime->TxBuffer[runtime->TxLength++] = LIN_CalculateChecksum(runtime->Pid, runtime->Cs, PduInfoPtr->SduPtr, PduInfoPtr->Dl);
+    }
+
+    runtime->TxIndex = 0;
+    runtime->EchoIndex = 0;
+    runtime->RxLength = PduInfoPtr->Dl + 1U;
+    runtime->RxIndex = 0;
+    runtime->ResponseTimeout = runtime->BitTimeCycles * LIN_RESPONSE_TENTH_BITS_PER_BYTE * runtime->RxLength / 10U;
+    runtime->FrameStatus = LIN_TX_BUSY;
+    runtime->FrameState = LIN_FRAME_BREAK;
+
+    // Deadline: maximum header time plus, with a response, the maximum response time
+    uint32 tenthBits = LIN_HEADER_MAX_TENTH_BITS;
+    if (PduInfoPtr->Drc != LIN_FRAMERESPONSE_IGNORE)
+    {
+        tenthBits += LIN_RESPONSE_TENTH_BITS_PER_BYTE * runtime->RxLength;
+    }
+    Lin_TimerArm(Channel, tenthBits * runtime->NominalBitCycles / (10U * (SystemCoreClock / 1000000U)) + 1U);
+
+    // Request the break; the LBD interrupt continues with the sync byte
+    LIN_TIMING_START(runtime);
+    (void)usart->SR;                              // Drop line errors left by an aborted frame
+    (void)usart->DR;
+    usart->SR = (uint16)~USART_SR_LBD;            // LBD is cleared by writing 0
+    usart->CR2 |= USART_CR2_LBDIE;
+    usart->CR1 |= USART_CR1_RXNEIE;
+    USART_SendBreak(usart);
+    Mcal_ExitCritical(primask);
+
+    return E_OK; // Frame started
+}
+
+/**********************************************************
+ * @brief Start the current frame of the batch.
+ * @param Channel The LIN channel.
+ **********************************************************/
+static void Lin_BatchSend(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+
+    if (Lin_StartFrame(Channel, &runtime->Batch[runtime->BatchIndex]) != E_OK)
+    {
+        Lin_BatchEnd(Channel);
+    }
+}
+
+/**********************************************************
+ * @brief Send a LIN frame.
+ * @param Channel The LIN channel to send the frame.
+ * @param PduInfoPtr Pointer to the PDU containing the information to send.
+ * @return `E_OK` if the frame was started, `E_NOT_OK` if failed.
+ * @details Only prepares the frame and requests the break; the header and the
+ *          response are then handled by the USART interrupt, so the call
+ *          returns immediately. The driver timer bounds the frame by its
+ *          maximum frame time, so a stuck bus cannot keep it busy. Lin_GetStatus reports LIN_TX_BUSY until the
+ *          header is sent, then LIN_RX_BUSY while a LIN_FRAMERESPONSE_RX
+ *          response is being received. A frame still in progress is aborted;
+ *          the call is rejected while a batch (Lin_SendFrames) runs.
+ **********************************************************/
+Std_ReturnType Lin_SendFrame(uint8 Channel, const Lin_PduType *PduInfoPtr)
+{
+    // Frames cannot be mixed into a running batch
+    if ((Channel >= MAX_LIN_CHANNELS) || (Lin_ChannelRuntime[Channel].Batch != NULL))
+    {
+        return E_NOT_OK;
+    }
+
+    return Lin_StartFrame(Channel, PduInfoPtr);
+}
+
+/**********************************************************
+ * @brief Count an error of a LIN channel.
+ * @param runtime Runtime state of the channel.
+ * @param error Kind of error; the counter saturates at 0xFFFF.
+ * @details Called from the USART, DMA and timer interrupts, and from task
+ *          context when Lin_GetStatus ends a response past its timeout; the
+ *          update is done with interrupts masked so none of them is lost.
+ **********************************************************/
+static void Lin_CountError(Lin_ChannelRuntimeType *runtime, Lin_SlaveErrorType error)
+{
+    uint32 primask = Mcal_EnterCritical();
+
+    if (runtime->Errors.Count[error] < 0xFFFFU)
+    {
+        runtime->Errors.Count[error]++;
+    }
+    runtime->Errors.LastError = error;
+    Mcal_ExitCritical(primask);
+}
+
+/**********************************************************
+ * @brief Classify a byte of TxBuffer that was not read back correctly.
+ * @param runtime Runtime state of the channel.
+ * @param index Position of the byte in TxBuffer.
+ * @param sr USART status seen with the echo (FE: stop bit read as dominant).
+ * @return LIN_ERR_HEADER for sync/PID, otherwise a stop bit or data bit error of the response.
+ **********************************************************/
+static Lin_SlaveErrorType Lin_EchoError(const Lin_ChannelRuntimeType *runtime, uint8 index, uint16 sr)
+{
+    if (index < runtime->HeaderLength)
+    {
+        return LIN_ERR_HEADER;
+    }
+    return (sr & USART_SR_FE) ? LIN_ERR_RESP_STOPBIT : LIN_ERR_RESP_DATABIT;
+}
+
+/**********************************************************
+ * @brief Bus stuck: refuse frames and schedule a recovery attempt.
+ * @param Channel The LIN channel.
+ * @details Once LIN_RECOVERY_ATTEMPTS attempts are used up, no attempt is
+ *          scheduled any more and the channel stays degraded until Lin_Init.
+ **********************************************************/
+static void Lin_EnterDegraded(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+
+    runtime->Degraded = TRUE;
+    runtime->HeaderFailures = 0;
+    if (runtime->Batch != NULL)
+    {
+        Lin_BatchEnd(Channel); // Remaining frames are dropped
+    }
+
+    if (runtime->RecoveryAttempts < LIN_RECOVERY_ATTEMPTS)
+    {
+        runtime->RecoveryAttempts++;
+        Lin_TimerArm(Channel, LIN_RECOVERY_DELAY_US);
+    }
+    else
+    {
+        Lin_TimerDisarm(Channel);
+    }
+}
+
+/**********************************************************
+ * @brief Recovery attempt of a degraded channel, executed from the timer interrupt.
+ * @param Channel The LIN channel.
+ * @details Resets the USART (pending FE/NE/ORE are cleared by reading SR then
+ *          DR) and leaves the degraded state if the bus is recessive again.
+ **********************************************************/
+static void Lin_Recover(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    hw->Usart->CR1 &= (uint16)~USART_CR1_UE;
+    (void)hw->Usart->SR;
+    (void)hw->Usart->DR;
+    hw->Usart->SR = (uint16)~USART_SR_LBD;
+    hw->Usart->CR1 |= USART_CR1_UE;
+
+    if ((hw->Port->IDR & hw->RxPin) != 0U)
+    {
+        runtime->Degraded = FALSE;
+        runtime->FrameStatus = LIN_OPERATIONAL;
+    }
+    else
+    {
+        Lin_EnterDegraded(Channel); // Still dominant: next attempt, if any left
+    }
+}
+
+/**********************************************************
+ * @brief End of a frame: record its timing, supervise the bus and continue a running batch.
+ * @param runtime Runtime state of the channel; FrameStatus is final.
+ * @details Master: LIN_BUS_STUCK_FRAMES header errors in a row degrade the
+ *          channel. Batch: a received response without signal buffer is
+ *          copied to the SduPtr of its PDU, then the next frame is started by
+ *          the timer after the inter-frame space. Otherwise the deadline of
+ *          the frame is disarmed.
+ **********************************************************/
+static void Lin_FrameDone(Lin_ChannelRuntimeType *runtime)
+{
+    uint8 channel = (uint8)(runtime - Lin_ChannelRuntime);
+
+    LIN_TIMING_END(runtime);
+
+    // Only a master sends headers
+    if (!runtime->IsSlave)
+    {
+        if (runtime->FrameStatus != LIN_TX_HEADER_ERROR)
+        {
+            runtime->HeaderFailures = 0;
+            if ((runtime->FrameStatus == LIN_TX_OK) || (runtime->FrameStatus == LIN_RX_OK))
+            {
+                runtime->RecoveryAttempts = 0;
+            }
+        }
+        else if (++runtime->HeaderFailures >= LIN_BUS_STUCK_FRAMES)
+        {
+            Lin_EnterDegraded(channel);
+            return;
+        }
+    }
+
+    if (runtime->Batch == NULL)
+    {
+        Lin_TimerDisarm(channel);
+        return;
+    }
+
+    const Lin_PduType *pdu = &runtime->Batch[runtime->BatchIndex];
+
+    if ((runtime->FrameStatus == LIN_TX_OK) || (runtime->FrameStatus == LIN_RX_OK))
+    {
+        if ((runtime->FrameStatus == LIN_RX_OK) && (runtime->RxSignal == NULL) && (pdu->SduPtr != NULL))
+        {
+            for (uint8 i = 0; i < pdu->Dl; i++)
+            {
+                pdu->SduPtr[i] = runtime->RxBuffer[i];
+            }
+        }
+        runtime->BatchOk++;
+    }
+
+    if (++runtime->BatchIndex >= runtime->BatchCount)
+    {
+        Lin_BatchEnd(channel);
+    }
+    else
+    {
+        Lin_TimerArm(channel, runtime->BatchGapUs);
+    }
+}
+
+/**********************************************************
+ * @brief Abort the transmission of a frame after a readback error.
+ * @param Channel The LIN channel.
+ * @param error Kind of error; LIN_ERR_HEADER gives LIN_TX_HEADER_ERROR, any other LIN_TX_ERROR.
+ * @details The byte already in the shift register still completes; nothing
+ *          more is written to DR.
+ **********************************************************/
+static void Lin_AbortTx(uint8 Channel, Lin_SlaveErrorType error)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    USART_TypeDef *usart = Lin_HwChannel[Channel].Usart;
+
+    usart->CR1 &= (uint16)~(USART_CR1_TXEIE | USART_CR1_TCIE);
+    if (runtime->UseDma)
+    {
+        Lin_DmaStop(Channel);
+        usart->CR1 |= USART_CR1_RXNEIE;
+    }
+    runtime->FrameState = LIN_FRAME_IDLE;
+    runtime->FrameStatus = (error == LIN_ERR_HEADER) ? LIN_TX_HEADER_ERROR : LIN_TX_ERROR;
+    Lin_CountError(runtime, error);
+    Lin_FrameDone(runtime);
+
+    // A failed go-to-sleep command still puts the channel to sleep
+    if (runtime->SleepPending)
+    {
+        Lin_EnterSleep(Channel);
+    }
+}
+
+/**********************************************************
+ * @brief Position of the first byte of TxBuffer not read back correctly, at TC.
+ * @param Channel The LIN channel.
+ * @return TxLength if every byte was echoed unchanged.
+ * @details Per-byte interrupts compare the echoes as they arrive, so only a
+ *          missing echo is left to find. In DMA mode the echoes from EchoIndex
+ *          on were collected in EchoBuffer and are compared here.
+ **********************************************************/
+static uint8 Lin_CheckEcho(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    if (!runtime->UseDma || !(hw->Usart->CR3 & USART_CR3_DMAR))
+    {
+        return runtime->EchoIndex;
+    }
+
+    uint8 received = (uint8)(runtime->TxLength - hw->RxDma->CNDTR);
+    for (uint8 i = runtime->EchoIndex; i < received; i++)
+    {
+        if (runtime->EchoBuffer[i] != runtime->TxBuffer[i])
+        {
+            return i;
+        }
+    }
+    return received;
+}
+
+/**********************************************************
+ * @brief Complete the reception of a slave response.
+ * @param runtime Runtime state of the channel; RxData holds RxLength bytes.
+ * @details A valid response received into a signal buffer becomes its front half.
+ **********************************************************/
+static void Lin_CompleteResponse(Lin_ChannelRuntimeType *runtime)
+{
+    uint8 dl = runtime->RxLength - 1U;
+
+    runtime->FrameState = LIN_FRAME_IDLE;
+    if (runtime->RxData[dl] == LIN_CalculateChecksum(runtime->Pid, runtime->Cs, runtime->RxData, dl))
+    {
+        if (runtime->RxSignal != NULL)
+        {
+            runtime->RxSignal->Front ^= 1U;
+            runtime->RxSignal->Updated = TRUE;
+        }
+        runtime->FrameStatus = LIN_RX_OK;
+    }
+    else
+    {
+        runtime->FrameStatus = LIN_RX_ERROR;
+        Lin_CountError(runtime, LIN_ERR_RESP_CHKSUM);
+    }
+    Lin_FrameDone(runtime);
+}
+
+/**********************************************************
+ * @brief Start the reception of a response of RxLength bytes, right after the header.
+ * @param Channel The LIN channel.
+ * @details The bytes go straight into the back half of the frame's signal
+ *          buffer, or into RxBuffer if the frame has none.
+ **********************************************************/
+static void Lin_StartRxResponse(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    USART_TypeDef *usart = Lin_HwChannel[Channel].Usart;
+
+    runtime->RxSignal = (runtime->SignalBufferTable != NULL)
+                            ? runtime->SignalBufferTable[runtime->Pid & LIN_FRAME_ID_MASK]
+                            : NULL;
+    runtime->RxData = (runtime->RxSignal != NULL) ? runtime->RxSignal->Data[runtime->RxSignal->Front ^ 1U]
+                                                  : runtime->RxBuffer;
+    runtime->ResponseStart = LIN_CYCLE_COUNTER();
+    runtime->FrameState = LIN_FRAME_RX_RESPONSE;
+    runtime->FrameStatus = LIN_RX_BUSY;
+    if (runtime->UseDma)
+    {
+        usart->CR1 &= (uint16)~USART_CR1_RXNEIE;
+        Lin_DmaStart(Lin_HwChannel[Channel].RxDma, LIN_DMA_CCR_RX, usart, runtime->RxData, runtime->RxLength);
+        usart->CR3 |= USART_CR3_DMAR | USART_CR3_EIE;
+    }
+}
+
+/**********************************************************
+ * @brief Slave: answer a received PID from the response table.
+ * @param Channel The LIN channel.
+ * @param pid Received protected identifier.
+ * @details The table is indexed by frame ID, so the lookup is O(1). A
+ *          published response starts from the timer once the stop bit of the
+ *          PID is over (half a bit after RXNE), well within the response space.
+ **********************************************************/
+static void Lin_SlaveHandlePid(uint8 Channel, uint8 pid)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    uint8 id = pid & LIN_FRAME_ID_MASK;
+
+    runtime->FrameState = LIN_FRAME_IDLE;
+    LIN_TIMESTAMP(runtime, HeaderEnd);
+
+    // Parity error or no table: header ignored
+    if ((Lin_PidTable[id] != pid) || (runtime->SlaveResponseTable == NULL))
+    {
+        return;
+    }
+
+    const Lin_PduType *entry = &runtime->SlaveResponseTable[id];
+    if ((entry->Dl == 0) || (entry->Dl > LIN_MAX_DATA_LENGTH) || (entry->Drc == LIN_FRAMERESPONSE_IGNORE) ||
+        ((entry->Drc == LIN_FRAMERESPONSE_TX) && (entry->SduPtr == NULL)))
+    {
+        return; // Frame not handled by this node
+    }
+
+    runtime->Pid = pid;
+    runtime->Cs = entry->Cs;
+    runtime->Drc = entry->Drc;
+
+    if (entry->Drc == LIN_FRAMERESPONSE_TX)
+    {
+        // Publisher: data and checksum, fed by TXE (or the TX DMA) like a master response
+        for (uint8 i = 0; i < entry->Dl; i++)
+        {
+            runtime->TxBuffer[i] = entry->SduPtr[i];
+        }
+        runtime->TxBuffer[entry->Dl] = LIN_CalculateChecksum(pid, entry->Cs, entry->SduPtr, entry->Dl);
+        runtime->HeaderLength = 0;
+        runtime->TxLength = entry->Dl + 1U;
+        runtime->TxIndex = 0;
+        runtime->EchoIndex = 0;
+        runtime->FrameStatus = LIN_TX_BUSY;
+
+        // RXNE comes in the middle of the stop bit: a start bit now would corrupt it for the master
+        runtime->FrameState = LIN_FRAME_SLAVE_TX_WAIT;
+        Lin_TimerArm(Channel, runtime->BitTimeCycles / (2U * (SystemCoreClock / 1000000U)) + 1U);
+    }
+    else
+    {
+        // Subscriber: collect the response of another node
+        runtime->RxLength = entry->Dl + 1U;
+        runtime->RxIndex = 0;
+        runtime->ResponseTimeout = runtime->BitTimeCycles * LIN_RESPONSE_TENTH_BITS_PER_BYTE * runtime->RxLength / 10U;
+        Lin_StartRxResponse(Channel);
+        Lin_TimerArm(Channel, runtime->ResponseTimeout / (SystemCoreClock / 1000000U) + 1U);
+    }
+}
+
+/**********************************************************
+ * @brief Slave: time the sync field, executed from the EXTI interrupt of the Rx pin.
+ * @param Channel The LIN channel served by the interrupt.
+ * @details At the 5th falling edge the bit time of the master is known. The
+ *          receiver is switched off while BRR is rewritten, then re-enabled
+ *          before the start bit of the PID (the end of the sync byte is lost,
+ *          which is harmless).
+ **********************************************************/
+static void Lin_SyncEdgeIsr(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+    uint32 now = LIN_CYCLE_COUNTER();
+
+    EXTI->PR = hw->ExtiLine;
+    if (runtime->FrameState != LIN_FRAME_SLAVE_SYNC)
+    {
+        EXTI->IMR &= ~hw->ExtiLine;
+        return;
+    }
+
+    if (++runtime->SyncEdges == 1U)
+    {
+        runtime->SyncStart = now;
+        return;
+    }
+    if (runtime->SyncEdges < LIN_SYNC_FALLING_EDGES)
+    {
+        return;
+    }
+
+    EXTI->IMR &= ~hw->ExtiLine;
+
+    uint32 cycles = now - runtime->SyncStart;
+    uint32 bitCycles = cycles / LIN_SYNC_MEASURED_BITS;
+    uint32 nominal = runtime->NominalBitCycles;
+
+    // Not a sync field of a master running near the configured baud rate
+    if ((bitCycles > nominal + nominal / LIN_SYNC_TOLERANCE_DIV) ||
+        (bitCycles < nominal - nominal / LIN_SYNC_TOLERANCE_DIV))
+    {
+        runtime->FrameState = LIN_FRAME_IDLE;
+        return;
+    }
+
+    // BRR = f_PCLK / baud = bit time in USART clock cycles
+    uint32 div = LIN_SYNC_MEASURED_BITS * runtime->CoreToPclk;
+    hw->Usart->CR1 &= (uint16)~USART_CR1_RE;
+    hw->Usart->BRR = (uint16)((cycles + div / 2U) / div);
+    (void)hw->Usart->SR;
+    (void)hw->Usart->DR;
+    hw->Usart->CR1 |= USART_CR1_RE;
+
+    runtime->BitTimeCycles = bitCycles;
+    runtime->FrameState = LIN_FRAME_SLAVE_PID;
+}
+
+/**********************************************************
+ * @brief Sleep: measure a dominant pulse on the bus, executed from the EXTI interrupt of the Rx pin.
+ * @param Channel The LIN channel served by the interrupt.
+ * @details The falling edge arms the driver timer for LIN_WAKEUP_DETECT_US
+ *          (Lin_WakeupTimeout); the rising edge accepts the pulse if the
+ *          timer expired meanwhile. Shorter pulses (spikes) are ignored; an
+ *          accepted wake-up disarms the detection and is reported by
+ *          Lin_CheckWakeup. The timer prescaler is taken from the RCC when
+ *          the timer starts, so the measurement does not depend on
+ *          SystemCoreClock, e.g., right after a wake-up from STOP on HSI.
+ **********************************************************/
+static void Lin_WakeupEdgeIsr(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    EXTI->PR = hw->ExtiLine;
+
+    // Falling edge: the bus turned dominant
+    if ((hw->Port->IDR & hw->RxPin) == 0U)
+    {
+        runtime->WakeupEdge = TRUE;
+        runtime->WakeupLong = FALSE;
+        Lin_TimerArm(Channel, LIN_WAKEUP_DETECT_US);
+        return;
+    }
+
+    // Rising edge: end of the pulse
+    if (runtime->WakeupEdge && runtime->WakeupLong)
+    {
+        EXTI->IMR &= ~hw->ExtiLine;
+        EXTI->RTSR &= ~hw->ExtiLine;
+        runtime->WakeupDetected = TRUE;
+    }
+    else
+    {
+        Lin_TimerDisarm(Channel); // Spike: stop the measurement
+    }
+    runtime->WakeupEdge = FALSE;
+}
+
+/**********************************************************
+ * @brief Sleep: LIN_WAKEUP_DETECT_US elapsed since the falling edge, executed from the timer interrupt.
+ * @param Channel The LIN channel.
+ **********************************************************/
+static void Lin_WakeupTimeout(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    if (runtime->WakeupEdge && ((hw->Port->IDR & hw->RxPin) == 0U))
+    {
+        runtime->WakeupLong = TRUE; // Accepted on the rising edge
+    }
+}
+
+/**********************************************************
+ * @brief Edge on the Rx pin: wake-up detection while asleep, sync field timing otherwise.
+ * @param Channel The LIN channel served by the interrupt.
+ **********************************************************/
+static void Lin_RxEdgeIsr(uint8 Channel)
+{
+    if (LinChannelState[Channel] == LIN_CH_SLEEP)
+    {
+        Lin_WakeupEdgeIsr(Channel);
+    }
+    else
+    {
+        Lin_SyncEdgeIsr(Channel);
+    }
+}
+
+/**********************************************************
+ * @brief Validate the frame recorded by the monitor and store it in the ring buffer.
+ * @param Channel The LIN channel.
+ **********************************************************/
+static void Lin_MonitorClose(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    Lin_MonitorRecordType *record = &runtime->Monitor;
+
+    runtime->MonitorActive = FALSE;
+    record->Count = (runtime->MonitorIndex > 2U) ? (uint8)(runtime->MonitorIndex - 2U) : 0U;
+    if ((runtime->MonitorIndex < 2U) || (Lin_PidTable[record->Pid & LIN_FRAME_ID_MASK] != record->Pid))
+    {
+        record->Flags &= (uint8)~LIN_MONITOR_HEADER_OK;
+    }
+
+    // Both checksum models are tried: the monitor does not know the frames
+    if ((record->Flags & LIN_MONITOR_HEADER_OK) && (record->Count >= 2U))
+    {
+        uint8 dl = record->Count - 1U;
+        if (LIN_CalculateChecksum(record->Pid, LIN_CLASSIC_CS, record->Bytes, dl) == record->Bytes[dl])
+        {
+            record->Flags |= LIN_MONITOR_CLASSIC_OK;
+        }
+        if (LIN_CalculateChecksum(record->Pid, LIN_ENHANCED_CS, record->Bytes, dl) == record->Bytes[dl])
+        {
+            record->Flags |= LIN_MONITOR_ENHANCED_OK;
+        }
+    }
+
+    // The channels may preempt each other
+    uint32 primask = Mcal_EnterCritical();
+    if ((uint8)(Lin_MonitorHead - Lin_MonitorTail) < LIN_MONITOR_RECORDS)
+    {
+        if (Lin_MonitorLost)
+        {
+            record->Flags |= LIN_MONITOR_LOST;
+            Lin_MonitorLost = FALSE;
+        }
+        Lin_MonitorRing[Lin_MonitorHead % LIN_MONITOR_RECORDS] = *record;
+        Lin_MonitorHead++;
+    }
+    else
+    {
+        Lin_MonitorLost = TRUE;
+    }
+    Mcal_ExitCritical(primask);
+}
+
+/**********************************************************
+ * @brief Bus monitor, executed from the USART interrupt instead of Lin_Isr.
+ * @param Channel The LIN channel served by the interrupt.
+ * @details
+ *  - LBD:  stores the previous frame and starts a new record.
+ *  - RXNE: appends the byte: sync, PID, then data and checksum. A 0x00 with
+ *          framing error is the break character and is not recorded.
+ *  - IDLE: the frame stays open even if its last byte is a valid checksum:
+ *          without the data length the monitor cannot tell the end of the
+ *          response from an inter-byte space. A response byte received
+ *          after it sets LIN_MONITOR_IDLE.
+ **********************************************************/
+static void Lin_MonitorIsr(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    USART_TypeDef *usart = Lin_HwChannel[Channel].Usart;
+    uint16 sr = usart->SR;
+
+    if (sr & USART_SR_LBD)
+    {
+        usart->SR = (uint16)~USART_SR_LBD;
+        if (runtime->MonitorActive)
+        {
+            Lin_MonitorClose(Channel);
+        }
+        runtime->Monitor.Timestamp = LIN_CYCLE_COUNTER();
+        runtime->Monitor.Channel = Channel;
+        runtime->Monitor.Pid = 0;
+        runtime->Monitor.Flags = 0;
+        runtime->MonitorIndex = 0;
+        runtime->MonitorIdle = FALSE;
+        runtime->MonitorActive = TRUE;
+    }
+
+    if (sr & (USART_SR_RXNE | USART_SR_ORE))
+    {
+        uint8 data = (uint8)usart->DR; // Reading DR also clears FE/NE/ORE/IDLE
+        boolean error = (sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE)) ? TRUE : FALSE;
+
+        if (!runtime->MonitorActive || ((data == 0x00U) && (sr & USART_SR_FE)))
+        {
+            return; // Before the first break, or the break character itself
+        }
+
+        if (error)
+        {
+            runtime->Monitor.Flags |= LIN_MONITOR_LINE_ERROR;
+        }
+        if (runtime->MonitorIdle)
+        {
+            runtime->Monitor.Flags |= LIN_MONITOR_IDLE;
+            runtime->MonitorIdle = FALSE;
+        }
+        if (runtime->MonitorIndex == 0U)
+        {
+            if ((data == LIN_SYNC_BYTE) && !error)
+            {
+                runtime->Monitor.Flags |= LIN_MONITOR_HEADER_OK;
+            }
+        }
+        else if (runtime->MonitorIndex == 1U)
+        {
+            runtime->Monitor.Pid = data;
+        }
+        else
+        {
+            runtime->Monitor.Bytes[runtime->MonitorIndex - 2U] = data;
+        }
+
+        // Longest frame complete: nothing else can belong to it
+        if (++runtime->MonitorIndex == (2U + LIN_SIGNAL_BUFFER_SIZE))
+        {
+            Lin_MonitorClose(Channel);
+        }
+        return;
+    }
+
+    if (sr & USART_SR_IDLE)
+    {
+        (void)usart->DR; // Clears IDLE
+        if (runtime->MonitorActive && (runtime->MonitorIndex >= 3U))
+        {
+            runtime->MonitorIdle = TRUE; // Only an inter-byte space if another byte follows
+        }
+    }
+}
+
+/**********************************************************
+ * @brief Frame state machine, executed from the USART interrupt.
+ * @param Channel The LIN channel served by the interrupt.
+ * @details
+ *  - LBD:  our break was seen on the bus, start the header with the sync byte.
+ *  - TXE:  feed the next header/response byte so the bytes go out back-to-back.
+ *  - TC:   last byte left the shift register; the frame is complete, or the
+ *          reception of the slave response starts.
+ *  - RXNE: compare each byte echoed by the transceiver with the byte sent
+ *          (a mismatch or framing error aborts the frame with
+ *          LIN_TX_HEADER_ERROR/LIN_TX_ERROR), or collect the slave response
+ *          and verify its checksum.
+ * In DMA mode the response bytes bypass TXE/RXNE: TX DMA is started once the
+ * header is queued, RX DMA collects the echoes and TC compares them and ends
+ * the frame; for a received response RX DMA is started at the end
+ * of the header and completes in Lin_DmaRxIsr. A framing, noise or overrun
+ * error during an RX DMA transfer raises the error interrupt (EIE).
+ * In slave mode LBD starts the timing of the sync field (Lin_SyncEdgeIsr) and
+ * the RXNE of the PID selects the response (Lin_SlaveHandlePid); the
+ * response itself uses the same TXE/TC/RXNE steps as a master response.
+ * The response timeout is checked by Lin_GetStatus.
+ * In monitor mode Lin_MonitorIsr runs instead.
+ **********************************************************/
+static void Lin_Isr(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    USART_TypeDef *usart = Lin_HwChannel[Channel].Usart;
+
+    if (runtime->IsMonitor)
+    {
+        Lin_MonitorIsr(Channel);
+        return;
+    }
+
+    uint16 sr = usart->SR;
+
+    // Break detected: send the sync byte and let TXE feed the rest
+    if (sr & USART_SR_LBD)
+    {
+        usart->SR = (uint16)~USART_SR_LBD;
+        if (runtime->IsSlave)
+        {
+            // A break always starts a new frame: drop the current one and time the sync field
+            usart->CR1 &= (uint16)~(USART_CR1_TXEIE | USART_CR1_TCIE);
+            if (runtime->UseDma)
+            {
+                Lin_DmaStop(Channel);
+                usart->CR1 |= USART_CR1_RXNEIE;
+            }
+            runtime->FrameState = LIN_FRAME_SLAVE_SYNC;
+            runtime->SyncEdges = 0;
+            LIN_TIMING_START(runtime);
+            EXTI->PR = Lin_HwChannel[Channel].ExtiLine;
+            EXTI->IMR |= Lin_HwChannel[Channel].ExtiLine;
+        }
+        else if (runtime->FrameState == LIN_FRAME_BREAK)
+        {
+            // Drop the break character (0x00 with FE) so it is not taken for the sync echo
+            (void)usart->DR;
+            sr &= (uint16)~(USART_SR_RXNE | USART_SR_FE | USART_SR_NE | USART_SR_ORE);
+            runtime->FrameState = LIN_FRAME_HEADER;
+            usart->DR = runtime->TxBuffer[runtime->TxIndex++];
+            sr &= (uint16)~USART_SR_TXE; // TDR just filled: the TXE read above is stale
+            usart->CR1 |= USART_CR1_TXEIE;
+        }
+    }
+
+    // Line error while the RX DMA collects the response
+    if ((runtime->FrameState == LIN_FRAME_RX_RESPONSE) && runtime->UseDma &&
+        (sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE)))
+    {
+        Lin_DmaStop(Channel);
+        (void)usart->DR; // Clears FE/NE/ORE
+        runtime->FrameState = LIN_FRAME_IDLE;
+        runtime->FrameStatus = LIN_RX_ERROR;
+        Lin_CountError(runtime, (sr & USART_SR_FE) ? LIN_ERR_RESP_STOPBIT : LIN_ERR_RESP_DATABIT);
+        Lin_FrameDone(runtime);
+    }
+
+    // Line error while the RX DMA collects the echo of the response
+    if ((runtime->FrameState == LIN_FRAME_TX_RESPONSE) && runtime->UseDma &&
+        (sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE)))
+    {
+        // The faulty byte has already been moved by the DMA
+        uint8 index = (uint8)(runtime->TxLength - Lin_HwChannel[Channel].RxDma->CNDTR);
+        (void)usart->DR; // Clears FE/NE/ORE
+        Lin_AbortTx(Channel, Lin_EchoError(runtime, (index > 0U) ? (uint8)(index - 1U) : 0U, sr));
+    }
+
+    // Received byte: slave response, or echo of our own bytes (and the break character)
+    if ((usart->CR1 & USART_CR1_RXNEIE) && (sr & (USART_SR_RXNE | USART_SR_ORE)))
+    {
+        uint8 data = (uint8)usart->DR; // Reading DR also clears FE/NE/ORE
+
+        if (runtime->FrameState == LIN_FRAME_SLAVE_PID)
+        {
+            if (sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE))
+            {
+                runtime->FrameState = LIN_FRAME_IDLE; // Header error, wait for the next break
+                Lin_CountError(runtime, LIN_ERR_HEADER);
+            }
+            else
+            {
+                Lin_SlaveHandlePid(Channel, data);
+            }
+        }
+        else if (runtime->FrameState == LIN_FRAME_RX_RESPONSE)
+        {
+            if (sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE))
+            {
+                runtime->FrameState = LIN_FRAME_IDLE;
+                runtime->FrameStatus = LIN_RX_ERROR; // Corrupted response byte
+                Lin_CountError(runtime, (sr & USART_SR_FE) ? LIN_ERR_RESP_STOPBIT : LIN_ERR_RESP_DATABIT);
+                Lin_FrameDone(runtime);
+            }
+            else
+            {
+                if (runtime->RxIndex == 0U)
+                {
+                    LIN_TIMESTAMP(runtime, FirstByte);
+                }
+                runtime->RxData[runtime->RxIndex++] = data;
+                if (runtime->RxIndex == runtime->RxLength)
+                {
+                    Lin_CompleteResponse(runtime);
+                }
+            }
+        }
+        else if (((runtime->FrameState == LIN_FRAME_HEADER) || (runtime->FrameState == LIN_FRAME_TX_RESPONSE)) &&
+                 (runtime->EchoIndex < runtime->TxLength))
+        {
+            // Readback: every byte we send must come back unchanged, or another node drove the bus
+            uint8 index = runtime->EchoIndex++;
+            if ((sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE)) || (data != runtime->TxBuffer[index]))
+            {
+                Lin_AbortTx(Channel, Lin_EchoError(runtime, index, sr));
+            }
+            else if ((index + 1U) == runtime->HeaderLength)
+            {
+                LIN_TIMESTAMP(runtime, HeaderEnd);
+            }
+            else if (index == runtime->HeaderLength)
+            {
+                LIN_TIMESTAMP(runtime, FirstByte);
+            }
+        }
+    }
+
+    // Transmit data register empty: next byte or wait for the last one to finish
+    if ((usart->CR1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE))
+    {
+        if ((runtime->TxIndex == runtime->HeaderLength) && (runtime->TxLength > runtime->HeaderLength) && runtime->UseDma)
+        {
+            // PID queued: hand the response to the TX DMA; the RX DMA collects the echoes still due for TC
+            runtime->FrameState = LIN_FRAME_TX_RESPONSE;
+            LIN_TIMESTAMP(runtime, HeaderEnd); // PID queued: about one byte early
+            usart->CR1 &= (uint16)~(USART_CR1_TXEIE | USART_CR1_RXNEIE);
+            Lin_DmaStart(Lin_HwChannel[Channel].RxDma, LIN_DMA_CCR_ECHO, usart,
+                         &runtime->EchoBuffer[runtime->EchoIndex], runtime->TxLength - runtime->EchoIndex);
+            Lin_DmaStart(Lin_HwChannel[Channel].TxDma, LIN_DMA_CCR_TX, usart,
+                         &runtime->TxBuffer[runtime->HeaderLength], runtime->TxLength - runtime->HeaderLength);
+            usart->CR3 |= USART_CR3_DMAT | USART_CR3_DMAR | USART_CR3_EIE;
+            usart->SR = (uint16)~USART_SR_TC; // TC must only fire after the last DMA byte
+            sr &= (uint16)~USART_SR_TC;       // A slave response starts with TC still set from the idle line
+            usart->CR1 |= USART_CR1_TCIE;
+        }
+        else if (runtime->TxIndex < runtime->TxLength)
+        {
+            if (runtime->TxIndex == runtime->HeaderLength)
+            {
+                runtime->FrameState = LIN_FRAME_TX_RESPONSE;
+            }
+            usart->DR = runtime->TxBuffer[runtime->TxIndex++];
+        }
+        else
+        {
+            usart->CR1 = (uint16)((usart->CR1 & ~USART_CR1_TXEIE) | USART_CR1_TCIE);
+        }
+    }
+
+    // Transmission complete: header (and our response) are on the bus
+    if ((usart->CR1 & USART_CR1_TCIE) && (sr & USART_SR_TC))
     {
-        return; // Return if the configuration is invalid
+        usart->CR1 &= (uint16)~USART_CR1_TCIE;
+
+        // The echo of the last byte arrives half a bit before TC: a missing one means a stuck bus
+        uint8 failed = Lin_CheckEcho(Channel);
+        if (failed < runtime->TxLength)
+        {
+            Lin_AbortTx(Channel, Lin_EchoError(runtime, failed, 0));
+        }
+        else if (runtime->Drc == LIN_FRAMERESPONSE_RX)
+        {
+            // The PID echo has been drained above; what follows is the response
+            Lin_StartRxResponse(Channel);
+        }
+        else
+        {
+            if (runtime->UseDma)
+            {
+                Lin_DmaStop(Channel);
+                usart->CR1 |= USART_CR1_RXNEIE;
+            }
+            runtime->FrameState = LIN_FRAME_IDLE;
+            runtime->FrameStatus = LIN_TX_OK;
+            Lin_FrameDone(runtime);
+            if (runtime->SleepPending)
+            {
+                Lin_EnterSleep(Channel); // Go-to-sleep command sent
+            }
+        }
     }
+}
 
-    // Enable clock for GPIO ports and UART used for LIN
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_USART1, ENABLE);
+/**********************************************************
+ * @brief Completion of a response received by DMA, executed from the DMA interrupt.
+ * @param Channel The LIN channel served by the interrupt.
+ **********************************************************/
+static void Lin_DmaRxIsr(uint8 Channel)
+{
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
 
-    // Configure Tx (PA9) and Rx (PA10) pins for UART used for LIN
-    GPIO_InitTypeDef GPIO_InitStructure;
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_9; // Tx pin
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    GPIO_Init(GPIOA, &GPIO_InitStructure);
+    DMA1->IFCR = LIN_DMA_IFCR_CGIF(hw->RxDmaNumber);
+    if ((runtime->FrameState == LIN_FRAME_RX_RESPONSE) && (hw->RxDma->CNDTR == 0))
+    {
+        Lin_DmaStop(Channel);
+        hw->Usart->CR1 |= USART_CR1_RXNEIE;
+        Lin_CompleteResponse(runtime);
+    }
+}
 
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_10; // Rx pin
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
-    GPIO_Init(GPIOA, &GPIO_InitStructure);
+/**********************************************************
+ * @brief USART1 interrupt handler, serves LIN channel 0.
+ **********************************************************/
+void USART1_IRQHandler(void)
+{
+    Lin_Isr(0);
+}
 
-    // Configure USART for LIN communication
-    USART_InitTypeDef USART_InitStructure;
-    USART_InitStructure.USART_BaudRate = Config->Lin_BaudRate; // Baud rate from the configuration
-    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
-    USART_InitStructure.USART_StopBits = USART_StopBits_1;
-    USART_InitStructure.USART_Parity = USART_Parity_No;
-    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
-    USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
-    USART_Init(USART1, &USART_InitStructure);
+/**********************************************************
+ * @brief USART2 interrupt handler, serves LIN channel 1.
+ **********************************************************/
+void USART2_IRQHandler(void)
+{
+    Lin_Isr(1);
+}
 
-    // Enable USART
-    USART_Cmd(USART1, ENABLE);
+/**********************************************************
+ * @brief USART3 interrupt handler, serves LIN channel 2.
+ **********************************************************/
+void USART3_IRQHandler(void)
+{
+    Lin_Isr(2);
+}
 
-    // Enable LIN mode
-    USART_LINCmd(USART1, ENABLE);
+/**********************************************************
+ * @brief EXTI line 3 interrupt handler, Rx pin PA3 of LIN channel 1.
+ **********************************************************/
+void EXTI3_IRQHandler(void)
+{
+    Lin_RxEdgeIsr(1);
+}
 
-    // Enable interrupt if required
-    if (Config->Lin_IRQn != 0)
+/**********************************************************
+ * @brief EXTI lines 10..15 interrupt handler, Rx pins PA10 (LIN channel 0) and PB11 (LIN channel 2).
+ **********************************************************/
+void EXTI15_10_IRQHandler(void)
+{
+    if (EXTI->PR & Lin_HwChannel[0].ExtiLine)
+    {
+        Lin_RxEdgeIsr(0);
+    }
+    if (EXTI->PR & Lin_HwChannel[2].ExtiLine)
     {
-        NVIC_EnableIRQ(Config->Lin_IRQn); // Enable interrupt for LIN
+        Lin_RxEdgeIsr(2);
     }
 }
 
 /**********************************************************
- * @brief Check for wake-up event on the LIN channel.
- * @param Channel The LIN channel to check.
- * @return `E_OK` if a wake-up event is detected, `E_NOT_OK` if not detected.
- * @details This function checks the status of the LIN channel to determine if a wake-up event has occurred.
+ * @brief DMA1 channel 5 interrupt handler, USART1 RX (LIN channel 0).
  **********************************************************/
-Std_ReturnType Lin_CheckWakeup(uint8 Channel)
+void DMA1_Channel5_IRQHandler(void)
 {
-    // Check if the Channel is within a valid range
-    if (Channel >= MAX_LIN_CHANNELS)
-    {
-        return E_NOT_OK; // Return if the Channel is invalid
-    }
+    Lin_DmaRxIsr(0);
+}
 
-    // Read the status from the hardware register or LIN module to check for a wake-up event
-    if (USART1->SR & USART_SR_WU)
-    { // Assume USART_SR_WU is the wake-up flag in the USART status register
-        // Clear the wake-up flag after checking
-        USART1->SR &= ~USART_SR_WU;
-        return E_OK; // Wake-up event detected
-    }
+/**********************************************************
+ * @brief DMA1 channel 6 interrupt handler, USART2 RX (LIN channel 1).
+ **********************************************************/
+void DMA1_Channel6_IRQHandler(void)
+{
+    Lin_DmaRxIsr(1);
+}
 
-    return E_NOT_OK; // No wake-up event detected
+/**********************************************************
+ * @brief DMA1 channel 3 interrupt handler, USART3 RX (LIN channel 2).
+ **********************************************************/
+void DMA1_Channel3_IRQHandler(void)
+{
+    Lin_DmaRxIsr(2);
 }
 
 /**********************************************************
- * @brief Retrieve the version information of the LIN driver.
- * @param versioninfo Pointer to the structure where version information will be stored.
+ * @brief End a response that did not arrive in time.
+ * @param Channel The LIN channel; its interrupts must be masked.
  **********************************************************/
-void Lin_GetVersionInfo(Std_VersionInfoType *versioninfo)
+static void Lin_ResponseTimeout(uint8 Channel)
 {
-    if (versioninfo != NULL)
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+
+    if (runtime->UseDma)
     {
-        versioninfo->vendorID = LIN_VENDOR_ID;
-        versioninfo->moduleID = LIN_MODULE_ID;
-        versioninfo->sw_major_version = LIN_SW_MAJOR_VERSION;
-        versioninfo->sw_minor_version = LIN_SW_MINOR_VERSION;
-        versioninfo->sw_patch_version = LIN_SW_PATCH_VERSION;
+        Lin_DmaStop(Channel);
+        Lin_HwChannel[Channel].Usart->CR1 |= USART_CR1_RXNEIE;
+    }
+    runtime->FrameState = LIN_FRAME_IDLE;
+    if (Lin_RxCount(Channel) == 0)
+    {
+        runtime->FrameStatus = LIN_RX_NO_RESPONSE;
+        Lin_CountError(runtime, LIN_ERR_NO_RESP);
     }
+    else
+    {
+        runtime->FrameStatus = LIN_RX_ERROR;
+        Lin_CountError(runtime, LIN_ERR_INC_RESP);
+    }
+    Lin_FrameDone(runtime);
 }
 
 /**********************************************************
- * @brief Calculate the checksum value for a LIN frame.
- * @param data Pointer to the data array for which the checksum will be calculated.
- * @param length The length of the data array.
- * @return The calculated checksum value.
- * @details This function calculates the checksum according to the LIN protocol for frames.
+ * @brief Driver timer expired: recovery attempt, end of the frame past its deadline,
+ *        start of a slave response, or next frame of a batch.
+ * @param Channel The LIN channel; its interrupts must be masked.
  **********************************************************/
-static uint8 LIN_CalculateChecksum(const uint8 *data, uint8 length)
+static void Lin_FrameTimer(uint8 Channel)
 {
-    uint16 checksum = 0;
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
 
-    // Add all the data bytes
-    for (uint8 i = 0; i < length; i++)
+    if (runtime->Degraded)
     {
-        checksum += data[i];
+        Lin_Recover(Channel);
+        return;
+    }
 
-        // If there is a carry bit, add it to the checksum
-        if (checksum > 0xFF)
+    switch (runtime->FrameState)
+    {
+    case LIN_FRAME_IDLE:
+        if (runtime->Batch != NULL)
         {
-            checksum = (checksum & 0xFF) + 1;
+            Lin_BatchSend(Channel); // Inter-frame space elapsed
         }
+        break;
+    case LIN_FRAME_SLAVE_SYNC:
+    case LIN_FRAME_SLAVE_PID:
+        break; // Slave header: the next break restarts it
+    case LIN_FRAME_SLAVE_TX_WAIT:
+        runtime->FrameState = LIN_FRAME_HEADER; // Stop bit of the PID over: TXE feeds the response
+        Lin_HwChannel[Channel].Usart->CR1 |= USART_CR1_TXEIE;
+        break;
+    case LIN_FRAME_RX_RESPONSE:
+        Lin_ResponseTimeout(Channel);
+        break;
+    case LIN_FRAME_TX_RESPONSE:
+        Lin_AbortTx(Channel, LIN_ERR_RESP_DATABIT);
+        break;
+    default:
+        Lin_AbortTx(Channel, LIN_ERR_HEADER); // No break detected or header not sent
+        break;
     }
-
-    // Return the checksum's complement value
-    return (uint8)(~checksum);
 }
 
 /**********************************************************
- * @brief Send a LIN frame.
- * @param Channel The LIN channel to send the frame.
- * @param PduInfoPtr Pointer to the PDU containing the information to send.
- * @return `E_OK` if successful, `E_NOT_OK` if failed.
+ * @brief Driver timer interrupt handler: wake-up pulses, frame deadlines, batches and bus recovery.
+ * @details The compare channel of a LIN channel fires LIN_WAKEUP_PULSE_US
+ *          after Lin_Wakeup; the Tx pin is handed back to the USART and the
+ *          channel becomes operational. While the channel sleeps, it times
+ *          the dominant pulse of a remote wake-up. Otherwise it ends a frame past its
+ *          deadline, starts a slave response after the PID, paces the frames
+ *          of a batch (Lin_SendFrames) or retries a stuck bus (Lin_FrameTimer).
+ *          The timer stops once no compare is armed.
  **********************************************************/
-Std_ReturnType Lin_SendFrame(uint8 Channel, const Lin_PduType *PduInfoPtr)
+void TIM4_IRQHandler(void)
 {
-    // Check the validity of the input parameters
-    if (PduInfoPtr == NULL)
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
     {
-        return E_NOT_OK;
-    }
-
-    // Start sending the LIN frame by transmitting the Break field
-    USART_SendBreak(USART1); // Send the Break field via UART
+        const Lin_HwChannelType *hw = &Lin_HwChannel[ch];
 
-    // Wait for the Break field transmission to complete
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-        ;
-
-    // Send the Sync Field
-    USART_SendData(USART1, 0x55); // Sync byte with fixed value 0x55
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-        ;
-
-    // Calculate and send the ID field
-    uint8 id_with_parity = PduInfoPtr->Pid | LIN_CalculateParity(PduInfoPtr->Pid);
-    USART_SendData(USART1, id_with_parity);
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-        ;
+        if ((LIN_WAKEUP_TIMER->DIER & hw->WakeupCc) && (LIN_WAKEUP_TIMER->SR & hw->WakeupCc))
+        {
+            LIN_WAKEUP_TIMER->DIER &= (uint16)~hw->WakeupCc;
+            LIN_WAKEUP_TIMER->SR = (uint16)~hw->WakeupCc;
+            if (Lin_ChannelRuntime[ch].WakeupPulse)
+            {
+                Lin_LeaveSleep(ch);
+                Lin_TxPinMode(hw, GPIO_Mode_AF_PP); // Recessive again, now driven by the USART
+                Lin_ChannelRuntime[ch].WakeupPulse = FALSE;
+            }
+            else if (LinChannelState[ch] == LIN_CH_SLEEP)
+            {
+                Lin_WakeupTimeout(ch);
+            }
+            else
+            {
+                NVIC_DisableIRQ(hw->IRQn);
+                NVIC_DisableIRQ(hw->RxDmaIRQn);
+                Lin_FrameTimer(ch);
+                NVIC_EnableIRQ(hw->IRQn);
+                if (Lin_ChannelRuntime[ch].UseDma)
+                {
+                    NVIC_EnableIRQ(hw->RxDmaIRQn);
+                }
+            }
+        }
+    }
 
-    // Send the Data Field
-    for (uint8 i = 0; i < PduInfoPtr->Dl; i++)
+    if ((LIN_WAKEUP_TIMER->DIER & (TIM_DIER_CC1IE | TIM_DIER_CC2IE | TIM_DIER_CC3IE)) == 0U)
     {
-        USART_SendData(USART1, PduInfoPtr->SduPtr[i]);
-        while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-            ;
+        LIN_WAKEUP_TIMER->CR1 = 0;
     }
-
-    // Calculate and send the Checksum field
-    uint8 checksum = LIN_CalculateChecksum(PduInfoPtr->SduPtr, PduInfoPtr->Dl);
-    USART_SendData(USART1, checksum);
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-        ;
-
-    return E_OK; // Return `E_OK` if the transmission completes successfully
 }
 
 /**********************************************************
  * @brief Put the LIN channel into sleep mode.
  * @param Channel The LIN channel to put into sleep mode.
  * @return `E_OK` if the sleep command is accepted, `E_NOT_OK` if an error occurs.
- * @details This function sends the "go-to-sleep" command on the specified LIN channel
- *          and puts the channel into sleep mode to save power.
+ * @details Starts the go-to-sleep command (master request 0x3C with data
+ *          0x00 0xFF ... 0xFF, classic checksum) like any other frame and
+ *          returns immediately. Once it has been sent, or has failed, the
+ *          channel enters sleep: the USART clock is gated and, with wake-up
+ *          support, the Rx pin is watched for a wake-up pulse. Lin_GetStatus
+ *          reports LIN_TX_BUSY meanwhile, then LIN_CH_SLEEP.
+ *          Master channels only; a slave uses Lin_GoToSleepInternal.
  **********************************************************/
 Std_ReturnType Lin_GoToSleep(uint8 Channel)
 {
@@ -192,32 +1991,40 @@ Std_ReturnType Lin_GoToSleep(uint8 Channel)
         return E_NOT_OK; // Invalid Channel
     }
 
-    // Send the "go-to-sleep" signal by transmitting the Break field and sending the sleep ID frame
-    USART_SendBreak(USART1); // Transmit Break field to signal sleep
-
-    // Wait for the transmission to complete
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-        ;
-
-    USART_SendData(USART1, LIN_GO_TO_SLEEP); // Transmit frame with sleep ID
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    if (runtime->SleepPending || (LinChannelState[Channel] == LIN_CH_SLEEP))
+    {
+        return E_OK; // Already asleep or on the way
+    }
 
-    // Wait for the transmission to complete
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-        ;
+    uint8 data[LIN_MAX_DATA_LENGTH];
+    data[0] = LIN_GO_TO_SLEEP_FIRST_BYTE;
+    for (uint8 i = 1; i < LIN_MAX_DATA_LENGTH; i++)
+    {
+        data[i] = LIN_GO_TO_SLEEP_PADDING;
+    }
+    Lin_PduType pdu = {LIN_DIAG_ID_MASTER_REQ, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_TX, LIN_MAX_DATA_LENGTH, data};
 
-    // Set the LIN channel state to sleep mode
-    LinChannelState[Channel] = LIN_CH_SLEEP;
+    // The frame cannot progress before SleepPending is set
+    Std_ReturnType result;
+    NVIC_DisableIRQ(Lin_HwChannel[Channel].IRQn);
+    result = Lin_SendFrame(Channel, &pdu);
+    if (result == E_OK)
+    {
+        runtime->SleepPending = TRUE;
+    }
+    NVIC_EnableIRQ(Lin_HwChannel[Channel].IRQn);
 
-    return E_OK; // Sleep command executed successfully
+    return result;
 }
 
 /**********************************************************
  * @brief Put the LIN channel into sleep mode and activate wake-up detection.
  * @param Channel The LIN channel to process.
  * @return `E_OK` if the command is accepted, `E_NOT_OK` if an error occurs.
- * @details This function sends the "go-to-sleep" command on the specified LIN channel and
- *          puts the channel into sleep mode to save power. While in sleep mode,
- *          the system will activate monitoring to detect wake-up signals.
+ * @details Enters sleep at once without sending the go-to-sleep command
+ *          (e.g., after it was received from the master, or on bus idle).
+ *          A frame in progress is aborted.
  **********************************************************/
 Std_ReturnType Lin_GoToSleepInternal(uint8 Channel)
 {
@@ -227,30 +2034,32 @@ Std_ReturnType Lin_GoToSleepInternal(uint8 Channel)
         return E_NOT_OK; // Return error if channel is invalid
     }
 
-    // Send the "go-to-sleep" signal by transmitting the Break field and sending the sleep ID
-    USART_SendBreak(USART1); // Transmit Break field to signal sleep mode
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
 
-    // Wait for the transmission to complete
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-        ;
-
-    // Update the LIN channel state to sleep mode
-    LinChannelState[Channel] = LIN_CH_SLEEP;
-
-    // Activate wake-up detection if necessary
-    if (LinChannelConfig[Channel].LinChannelWakeupSupport == ENABLE)
+    NVIC_DisableIRQ(hw->IRQn);
+    NVIC_DisableIRQ(hw->RxDmaIRQn);
+    if (LinChannelState[Channel] != LIN_CH_SLEEP)
+    {
+        Lin_EnterSleep(Channel);
+    }
+    NVIC_EnableIRQ(hw->IRQn);
+    if (Lin_ChannelRuntime[Channel].UseDma)
     {
-        // Enable wake-up detection mode, which could be through interrupts or bus monitoring
+        NVIC_EnableIRQ(hw->RxDmaIRQn);
     }
 
     return E_OK; // Return `E_OK` if the process is successful
 }
 
 /**********************************************************
- * @brief Send a wake-up pulse and set the channel state to LIN_CH_OPERATIONAL.
+ * @brief Send a wake-up pulse and set the channel state to LIN_OPERATIONAL.
  * @param Channel The LIN channel to send the wake-up pulse.
- * @return `E_OK` if successful, `E_NOT_OK` if failed.
- * @details Sends a wake-up signal to wake up LIN nodes from sleep mode.
+ * @return `E_OK` if the pulse was started, `E_NOT_OK` if failed.
+ * @details Drives the Tx pin dominant for LIN_WAKEUP_PULSE_US and returns
+ *          immediately; the wake-up timer interrupt releases the bus and
+ *          resumes the channel, after which Lin_GetStatus reports
+ *          LIN_OPERATIONAL instead of LIN_CH_SLEEP. The wake-up detection
+ *          is disarmed first so the pulse is not taken for a remote wake-up.
  **********************************************************/
 Std_ReturnType Lin_Wakeup(uint8 Channel)
 {
@@ -260,31 +2069,62 @@ Std_ReturnType Lin_Wakeup(uint8 Channel)
         return E_NOT_OK; // Return error if Channel is invalid
     }
 
-    // Check the channel state; it must be LIN_CH_SLEEP to continue
-    if (LinChannelState[Channel] != LIN_CH_SLEEP)
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    const Lin_HwChannelType *hw = &Lin_HwChannel[Channel];
+
+    // Check the channel state; it must be LIN_CH_SLEEP to continue (a monitor never drives the bus)
+    if ((LinChannelState[Channel] != LIN_CH_SLEEP) || runtime->WakeupPulse || runtime->IsMonitor)
     {
         return E_NOT_OK; // Return error if the channel is not in sleep state
     }
 
-    // Send a wake-up signal by transmitting a dominant bit
-    USART_SendData(USART1, 0x80); // Transmit byte with dominant bit 0b10000000
-
-    // Wait for the transmission to complete
-    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET)
-        ;
+    EXTI->IMR &= ~hw->ExtiLine;
+    EXTI->RTSR &= ~hw->ExtiLine;
+    runtime->WakeupEdge = FALSE; // The pulse timer replaces a measurement in progress
+    runtime->WakeupPulse = TRUE;
 
-    // Update the channel state to LIN_CH_OPERATIONAL
-    LinChannelState[Channel] = LIN_CH_OPERATIONAL;
+    // Dominant pulse on the Tx pin, released by the compare interrupt
+    hw->Port->BRR = hw->TxPin;
+    Lin_TxPinMode(hw, GPIO_Mode_Out_PP);
+    Lin_TimerArm(Channel, LIN_WAKEUP_PULSE_US);
 
     return E_OK; // Return `E_OK` if successful
 }
 
+/**********************************************************
+ * @brief Resume a sleeping channel without sending a wake-up pulse.
+ * @param Channel The LIN channel.
+ * @return `E_OK` if the channel is operational, `E_NOT_OK` if it was not asleep.
+ * @details Used after Lin_CheckWakeup reported a wake-up by another node.
+ **********************************************************/
+Std_ReturnType Lin_WakeupInternal(uint8 Channel)
+{
+    if ((Channel >= MAX_LIN_CHANNELS) || (LinChannelState[Channel] != LIN_CH_SLEEP) ||
+        Lin_ChannelRuntime[Channel].WakeupPulse)
+    {
+        return E_NOT_OK;
+    }
+
+    NVIC_DisableIRQ(Lin_HwChannel[Channel].ExtiIRQn);
+    Lin_ChannelRuntime[Channel].WakeupEdge = FALSE;
+    Lin_TimerDisarm(Channel); // Pulse measurement still running
+    Lin_LeaveSleep(Channel);
+    NVIC_EnableIRQ(Lin_HwChannel[Channel].ExtiIRQn);
+
+    return E_OK;
+}
+
 /**********************************************************
  * @brief Get the current status of the LIN channel.
  * @param Channel The LIN channel to check.
  * @param Lin_SduPtr A pointer to a pointer that will contain the current SDU.
  * @return The current status of the LIN channel.
  * @details This function checks the status of the LIN channel and returns its current operational state.
+ *          While a response is being received, it also enforces the response timeout:
+ *          no byte at all gives LIN_RX_NO_RESPONSE, an incomplete response LIN_RX_ERROR.
+ *          On LIN_RX_OK, Lin_SduPtr points to the received data: the front half of
+ *          the frame's signal buffer, or the driver's RxBuffer. LIN_NOT_OK is
+ *          returned while the channel is degraded by a stuck bus.
  **********************************************************/
 Lin_StatusType Lin_GetStatus(uint8 Channel, const uint8 **Lin_SduPtr)
 {
@@ -300,13 +2140,46 @@ Lin_StatusType Lin_GetStatus(uint8 Channel, const uint8 **Lin_SduPtr)
         return LIN_NOT_OK; // Return error if Channel is invalid
     }
 
-    // Retrieve the current status from hardware or a status variable
-    Lin_StatusType currentStatus = LinChannelState[Channel];
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+
+    // Stuck bus: no frame until a recovery attempt succeeds
+    if (runtime->Degraded)
+    {
+        *Lin_SduPtr = NULL;
+        return LIN_NOT_OK;
+    }
+
+    // The frames of a batch are reported by its notification
+    if (runtime->Batch != NULL)
+    {
+        *Lin_SduPtr = NULL;
+        return LIN_TX_BUSY;
+    }
+
+    // Response timeout; the channel interrupts are masked so they cannot complete the frame meanwhile
+    if (runtime->FrameState == LIN_FRAME_RX_RESPONSE)
+    {
+        NVIC_DisableIRQ(Lin_HwChannel[Channel].IRQn);
+        NVIC_DisableIRQ(Lin_HwChannel[Channel].RxDmaIRQn);
+        if ((runtime->FrameState == LIN_FRAME_RX_RESPONSE) &&
+            ((uint32)(LIN_CYCLE_COUNTER() - runtime->ResponseStart) > runtime->ResponseTimeout))
+        {
+            Lin_ResponseTimeout(Channel);
+        }
+        NVIC_EnableIRQ(Lin_HwChannel[Channel].IRQn);
+        if (runtime->UseDma)
+        {
+            NVIC_EnableIRQ(Lin_HwChannel[Channel].RxDmaIRQn);
+        }
+    }
+
+    // Retrieve the frame status maintained by the interrupt state machine
+    Lin_StatusType currentStatus = runtime->FrameStatus;
 
-    // If the status is LIN_RX_OK or LIN_TX_OK, update Lin_SduPtr
-    if (currentStatus == LIN_RX_OK || currentStatus == LIN_TX_OK)
+    // If the status is LIN_RX_OK, return the received data (in place)
+    if (currentStatus == LIN_RX_OK)
     {
-        *Lin_SduPtr = LinChannelData[Channel]; // LinChannelData is the data region containing the SDU
+        *Lin_SduPtr = (runtime->RxSignal != NULL) ? runtime->RxSignal->Data[runtime->RxSignal->Front] : runtime->RxBuffer;
     }
     else
     {
@@ -315,3 +2188,246 @@ Lin_StatusType Lin_GetStatus(uint8 Channel, const uint8 **Lin_SduPtr)
 
     return currentStatus; // Return the current status of the LIN channel
 }
+
+/**********************************************************
+ * @brief Get the error counters of a LIN channel.
+ * @param Channel The LIN channel.
+ * @param Counters Receives a copy of the counters.
+ * @return `E_OK` if copied, `E_NOT_OK` if a parameter is invalid.
+ * @details Each counter is a single 16-bit read, so the copy does not mask
+ *          interrupts; the updates themselves are atomic (Lin_CountError).
+ **********************************************************/
+Std_ReturnType Lin_GetErrorCounters(uint8 Channel, Lin_ErrorCountersType *Counters)
+{
+    if ((Counters == NULL) || (Channel >= MAX_LIN_CHANNELS))
+    {
+        return E_NOT_OK;
+    }
+
+    for (uint8 i = 0; i < LIN_ERROR_TYPES; i++)
+    {
+        Counters->Count[i] = Lin_ChannelRuntime[Channel].Errors.Count[i];
+    }
+    Counters->LastError = Lin_ChannelRuntime[Channel].Errors.LastError;
+
+    return E_OK;
+}
+
+/**********************************************************
+ * @brief Store a response into the signal buffer of a frame.
+ * @param Channel The LIN channel.
+ * @param FrameId Frame identifier (0...63).
+ * @param Data Response data.
+ * @param Length Number of bytes (1...8).
+ * @return `E_OK` if stored, `E_NOT_OK` if the frame has no signal buffer or a parameter is invalid.
+ * @details Fills the back half and swaps the halves, like a response received
+ *          by the interrupt.
+ **********************************************************/
+Std_ReturnType Lin_SignalBufferWrite(uint8 Channel, uint8 FrameId, const uint8 *Data, uint8 Length)
+{
+    if ((Channel >= MAX_LIN_CHANNELS) || (FrameId > LIN_FRAME_ID_MASK) || (Data == NULL) ||
+        (Length == 0U) || (Length > LIN_MAX_DATA_LENGTH) || (Lin_ChannelRuntime[Channel].SignalBufferTable == NULL))
+    {
+        return E_NOT_OK;
+    }
+
+    Lin_SignalBufferType *buffer = Lin_ChannelRuntime[Channel].SignalBufferTable[FrameId];
+    if (buffer == NULL)
+    {
+        return E_NOT_OK;
+    }
+
+    uint8 *back = buffer->Data[buffer->Front ^ 1U];
+    for (uint8 i = 0; i < Length; i++)
+    {
+        back[i] = Data[i];
+    }
+    buffer->Front ^= 1U;
+    buffer->Updated = TRUE;
+
+    return E_OK;
+}
+
+/**********************************************************
+ * @brief Switch the baud rate of a LIN channel.
+ * @param Channel The LIN channel.
+ * @param BaudRate New baud rate, one of the rates in Lin_BaudrateTable.
+ * @return `E_OK` if switched, `E_NOT_OK` if the rate is not configured or the channel is not idle.
+ * @details Writes the precomputed BRR value with the USART briefly disabled;
+ *          the GPIO and LIN settings are kept. A slave synchronizes to the
+ *          new rate from the next sync field.
+ **********************************************************/
+Std_ReturnType Lin_SetBaudrate(uint8 Channel, uint32 BaudRate)
+{
+    // Check the validity of the Channel
+    if (Channel >= MAX_LIN_CHANNELS)
+    {
+        return E_NOT_OK; // Invalid Channel
+    }
+
+    uint16 brr = Lin_LookupBrr(Channel, BaudRate);
+    if (brr == 0U)
+    {
+        return E_NOT_OK; // Baud rate without precomputed BRR
+    }
+
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    USART_TypeDef *usart = Lin_HwChannel[Channel].Usart;
+    uint32 bitCycles = SystemCoreClock / BaudRate;
+    Std_ReturnType result = E_NOT_OK;
+
+    // A slave may start a frame on the next break
+    NVIC_DisableIRQ(Lin_HwChannel[Channel].IRQn);
+    if ((runtime->FrameState == LIN_FRAME_IDLE) && !runtime->SleepPending &&
+        (LinChannelState[Channel] != LIN_CH_SLEEP))
+    {
+        usart->CR1 &= (uint16)~USART_CR1_UE;
+        usart->BRR = brr;
+        usart->CR1 |= USART_CR1_UE;
+        runtime->NominalBitCycles = bitCycles;
+        runtime->BitTimeCycles = bitCycles;
+        result = E_OK;
+    }
+    NVIC_EnableIRQ(Lin_HwChannel[Channel].IRQn);
+
+    return result;
+}
+
+/**********************************************************
+ * @brief Send a burst of LIN frames back-to-back.
+ * @param Channel The LIN channel.
+ * @param Frames The frames, sent in order; the array must stay valid until the notification.
+ * @param NumFrames Number of frames (1...255).
+ * @param InterFrameUs Inter-frame space between the end of a frame and the next break, in microseconds.
+ * @param Notification Called once, from an interrupt, when the batch ends; may be NULL.
+ * @return `E_OK` if the batch was started, `E_NOT_OK` if a parameter is invalid or a batch runs.
+ * @details The frames are chained by the interrupts without polling: the end
+ *          of a frame arms the driver timer for the inter-frame space, and its
+ *          compare interrupt sends the next break. Each frame is also bounded
+ *          by its maximum frame time, so a missing response cannot stall the
+ *          batch. A failed frame does not stop the batch. Responses of RX
+ *          frames without signal buffer are copied to the SduPtr of their PDU.
+ *          Lin_GetStatus reports LIN_TX_BUSY until the batch ends; going to
+ *          sleep drops the frames not sent yet.
+ **********************************************************/
+Std_ReturnType Lin_SendFrames(uint8 Channel, const Lin_PduType *Frames, uint8 NumFrames, uint16 InterFrameUs,
+                              Lin_BatchNotificationType Notification)
+{
+    // Check the validity of the input parameters
+    if ((Frames == NULL) || (NumFrames == 0U) || (Channel >= MAX_LIN_CHANNELS))
+    {
+        return E_NOT_OK;
+    }
+    for (uint8 i = 0; i < NumFrames; i++)
+    {
+        if ((Frames[i].Dl > LIN_MAX_DATA_LENGTH) ||
+            ((Frames[i].Drc == LIN_FRAMERESPONSE_TX) && (Frames[i].SduPtr == NULL)))
+        {
+            return E_NOT_OK;
+        }
+    }
+
+    Lin_ChannelRuntimeType *runtime = &Lin_ChannelRuntime[Channel];
+    if (runtime->IsSlave || runtime->IsMonitor || runtime->Degraded || runtime->SleepPending ||
+        (LinChannelState[Channel] == LIN_CH_SLEEP))
+    {
+        return E_NOT_OK;
+    }
+
+    Std_ReturnType result = E_NOT_OK;
+    NVIC_DisableIRQ(Lin_HwChannel[Channel].IRQn);
+    if (runtime->Batch == NULL)
+    {
+        runtime->BatchCount = NumFrames;
+        runtime->BatchIndex = 0;
+        runtime->BatchOk = 0;
+        runtime->BatchGapUs = InterFrameUs;
+        runtime->BatchNotification = Notification;
+        runtime->Batch = Frames;
+        Lin_BatchSend(Channel);
+        result = E_OK;
+    }
+    NVIC_EnableIRQ(Lin_HwChannel[Channel].IRQn);
+
+    return result;
+}
+
+/**********************************************************
+ * @brief Take the oldest frame recorded by the bus monitor.
+ * @param Record Receives the record.
+ * @return `E_OK` if a record was taken, `E_NOT_OK` if none is pending.
+ **********************************************************/
+Std_ReturnType Lin_MonitorRead(Lin_MonitorRecordType *Record)
+{
+    if ((Record == NULL) || (Lin_MonitorHead == Lin_MonitorTail))
+    {
+        return E_NOT_OK;
+    }
+
+    // Only the interrupts write: the oldest record stays put until Tail moves
+    *Record = Lin_MonitorRing[Lin_MonitorTail % LIN_MONITOR_RECORDS];
+    Lin_MonitorTail++;
+
+    return E_OK;
+}
+
+#if (LIN_TIMING_SUPPORT == 1)
+/**********************************************************
+ * @brief Take the oldest frame timing record.
+ * @param Record Receives the record.
+ * @return `E_OK` if a record was taken, `E_NOT_OK` if none is pending.
+ **********************************************************/
+Std_ReturnType Lin_GetTimingRecord(Lin_TimingRecordType *Record)
+{
+    if ((Record == NULL) || (Lin_TimingHead == Lin_TimingTail))
+    {
+        return E_NOT_OK;
+    }
+
+    // Only the interrupts write: the oldest record stays put until Tail moves
+    *Record = Lin_TimingRing[Lin_TimingTail % LIN_TIMING_RECORDS];
+    Lin_TimingTail++;
+
+    return E_OK;
+}
+
+/**********************************************************
+ * @brief Get the timing statistics of a frame ID.
+ * @param Channel The LIN channel.
+ * @param FrameId Frame identifier (0...63).
+ * @param Stats Receives a copy of the statistics.
+ * @return `E_OK` if copied, `E_NOT_OK` if a parameter is invalid.
+ **********************************************************/
+Std_ReturnType Lin_GetTimingStats(uint8 Channel, uint8 FrameId, Lin_TimingStatsType *Stats)
+{
+    if ((Stats == NULL) || (Channel >= MAX_LIN_CHANNELS) || (FrameId > LIN_FRAME_ID_MASK))
+    {
+        return E_NOT_OK;
+    }
+
+    uint32 primask = Mcal_EnterCritical();
+    *Stats = Lin_TimingStats[Channel][FrameId];
+    Mcal_ExitCritical(primask);
+
+    return E_OK;
+}
+
+/**********************************************************
+ * @brief Share of a schedule slot used by the longest frame of an ID.
+ * @param Channel The LIN channel.
+ * @param FrameId Frame identifier (0...63).
+ * @param SlotUs Length of the slot, in microseconds.
+ * @return Utilization in percent, saturating at 255; 0 if unknown.
+ **********************************************************/
+uint8 Lin_GetSlotUtilization(uint8 Channel, uint8 FrameId, uint32 SlotUs)
+{
+    if ((Channel >= MAX_LIN_CHANNELS) || (FrameId > LIN_FRAME_ID_MASK) || (SlotUs == 0U))
+    {
+        return 0;
+    }
+
+    uint32 percent = (uint32)Lin_TimingStats[Channel][FrameId].MaxFrameUs * 100U / SlotUs;
+
+    return (percent > 0xFFU) ? 0xFFU : (uint8)percent;
+}
+#endif
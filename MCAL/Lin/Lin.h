@@ -17,121 +17,185 @@
 #include "Lin_Types.h"        /**< @brief LIN-specific data types */
 
 /**********************************************************
- * @typedef Lin_ConfigType
- * @brief Configuration structure for the LIN driver.
- * @details This structure contains the necessary information to configure
- *          the LIN driver and settings for SFR that affect the LIN channels.
+ * @brief Pre-compile time parameter settings.
+ **********************************************************/
+#ifndef LIN_TIMING_SUPPORT
+#define LIN_TIMING_SUPPORT 0 /**< @brief 1: timestamp the frame phases (adds about 4 KB of RAM). */
+#endif
+#define LIN_TIMING_RECORDS 16U       /**< @brief Frame records kept until read (power of two). */
+#define LIN_TIMING_HISTOGRAM_BINS 6U /**< @brief Response time classes, see Lin_TimingStatsType. */
+#ifndef LIN_MONITOR_RECORDS
+#define LIN_MONITOR_RECORDS 32U      /**< @brief Frames kept by the bus monitor until read (power of two, up to 128). */
+#endif
+
+/**********************************************************
+ * @typedef Lin_PduType
+ * @brief Structure providing information about a PDU.
+ * @details Provides the PID, checksum model, data length, and SDU pointer.
  **********************************************************/
 typedef struct
 {
-    uint32_t Lin_BaudRate;             /**< @brief Baud rate for the LIN channel. */
-    GPIO_TypeDef *Lin_Port;            /**< @brief GPIO port for the LIN channel, e.g., GPIOA. */
-    uint16_t Lin_TxPin;                /**< @brief Tx pin for the LIN channel, e.g., GPIO_PIN_9. */
-    uint16_t Lin_RxPin;                /**< @brief Rx pin for the LIN channel, e.g., GPIO_PIN_10. */
-    uint8_t Lin_Channel;               /**< @brief LIN channel number. */
-    FunctionalState Lin_WakeupSupport; /**< @brief Wake-up mode support (TRUE/FALSE). */
-    IRQn_Type Lin_IRQn;                /**< @brief Interrupt number for the LIN channel. */
-    uint32_t Lin_Prescaler;            /**< @brief Prescaler value for adjusting baud rate. */
-    uint32_t Lin_Mode;                 /**< @brief Operating mode of LIN (0: master, 1: slave). */
-    uint8_t Lin_TimeoutDuration;       /**< @brief Timeout duration to detect errors. */
-} Lin_ConfigType;
+    Lin_FramePidType Pid;      /**< @brief PID of the LIN frame */
+    Lin_FrameCsModelType Cs;   /**< @brief Checksum model */
+    Lin_FrameResponseType Drc; /**< @brief Response type */
+    Lin_FrameDlType Dl;        /**< @brief Data length */
+    uint8 *SduPtr;             /**< @brief Pointer to the SDU data */
+} Lin_PduType;
 
 /**********************************************************
- * @typedef Lin_FramePidType
- * @brief Type representing a valid protection ID.
- * @details Represents valid protection IDs used by Lin_SendFrame().
+ * @brief Size of each half of a signal buffer: data and checksum.
  **********************************************************/
-typedef uint8 Lin_FramePidType; /**< @brief Range: 0...0xFE */
+#define LIN_SIGNAL_BUFFER_SIZE 9U
 
 /**********************************************************
- * @typedef Lin_FrameCsModelType
- * @brief Enum specifying the checksum model.
- * @details Specifies the checksum model used for a LIN frame.
+ * @typedef Lin_SignalBufferType
+ * @brief Double-buffered response of one received frame.
+ * @details The USART/DMA interrupt receives into Data[Front ^ 1] and makes it
+ *          the front half once the checksum is correct, so the application
+ *          reads the signals in place from Data[Front] while the next
+ *          response comes in. Read Front once per access: the half it names
+ *          is only written again after another complete response.
  **********************************************************/
-typedef enum
+typedef struct
 {
-    LIN_ENHANCED_CS, /**< @brief Enhanced checksum model */
-    LIN_CLASSIC_CS   /**< @brief Classic checksum model */
-} Lin_FrameCsModelType;
+    uint8 Data[2][LIN_SIGNAL_BUFFER_SIZE]; /**< @brief The two halves. */
+    volatile uint8 Front;                  /**< @brief Half holding the latest valid response (0 or 1). */
+    volatile boolean Updated;              /**< @brief Set by each valid response, cleared by the application. */
+} Lin_SignalBufferType;
+
+/**********************************************************
+ * @brief Number of Lin_SlaveErrorType values.
+ **********************************************************/
+#define LIN_ERROR_TYPES ((uint8)LIN_ERR_INC_RESP + 1U)
 
 /**********************************************************
- * @typedef Lin_FrameResponseType
- * @brief Enum specifying the response type of a LIN frame.
- * @details Specifies whether the frame processor needs to transmit a response part or not.
+ * @typedef Lin_ErrorCountersType
+ * @brief Error counters of a LIN channel.
+ * @details Header and response errors seen by the frame state machine: TX
+ *          readback mismatches (LIN_ERR_HEADER, LIN_ERR_RESP_DATABIT),
+ *          framing errors (LIN_ERR_RESP_STOPBIT), checksum errors and
+ *          response timeouts.
  **********************************************************/
-typedef enum
+typedef struct
 {
-    LIN_FRAMERESPONSE_TX,    /**< @brief Response generated by this node */
-    LIN_FRAMERESPONSE_RX,    /**< @brief Response generated by another node and relevant to this node */
-    LIN_FRAMERESPONSE_IGNORE /**< @brief Response generated by another node and not relevant to this node */
-} Lin_FrameResponseType;
+    uint16 Count[LIN_ERROR_TYPES]; /**< @brief Errors of each Lin_SlaveErrorType, saturating at 0xFFFF. */
+    Lin_SlaveErrorType LastError;  /**< @brief Most recent error (meaningless while all counts are 0). */
+} Lin_ErrorCountersType;
 
+#if (LIN_TIMING_SUPPORT == 1)
 /**********************************************************
- * @typedef Lin_FrameDlType
- * @brief Type specifying the data length.
- * @details Specifies the number of data bytes (SDU) to be copied.
+ * @typedef Lin_TimingRecordType
+ * @brief Timestamps of one frame, in CPU cycles (DWT CYCCNT).
+ * @details A phase that was not observed is 0: the first response byte is
+ *          not seen when the response is moved by DMA, and a slave records
+ *          the end of the break (LBD) instead of its start.
  **********************************************************/
-typedef uint8 Lin_FrameDlType; /**< @brief Range: 1...8 */
+typedef struct
+{
+    uint32 BreakStart;     /**< @brief Break requested (master) or detected (slave). */
+    uint32 HeaderEnd;      /**< @brief PID on the bus: echo read back, or received by a slave. */
+    uint32 FirstByte;      /**< @brief First response byte received or read back. */
+    uint32 End;            /**< @brief Checksum received or sent, or frame ended by an error. */
+    uint8 Channel;         /**< @brief LIN channel. */
+    uint8 Pid;             /**< @brief Protected identifier. */
+    Lin_StatusType Status; /**< @brief Final status of the frame. */
+} Lin_TimingRecordType;
 
 /**********************************************************
- * @typedef Lin_PduType
- * @brief Structure providing information about a PDU.
- * @details Provides the PID, checksum model, data length, and SDU pointer.
+ * @typedef Lin_TimingStatsType
+ * @brief Timing statistics of one frame ID of a channel.
+ * @details ResponseHistogram classifies the response time of valid received
+ *          responses against the nominal response time 10 * (Dl + 1) bits:
+ *          bin 0 below 1.0, bins 1...4 from 1.0 to 1.4 by steps of 0.1 and
+ *          bin 5 at or above 1.4 (longer than the LIN maximum).
  **********************************************************/
 typedef struct
 {
-    Lin_FramePidType Pid;      /**< @brief PID of the LIN frame */
-    Lin_FrameCsModelType Cs;   /**< @brief Checksum model */
-    Lin_FrameResponseType Drc; /**< @brief Response type */
-    Lin_FrameDlType Dl;        /**< @brief Data length */
-    uint8 *SduPtr;             /**< @brief Pointer to the SDU data */
-} Lin_PduType;
+    uint16 Frames;                                       /**< @brief Frames recorded, saturating. */
+    uint16 MaxHeaderUs;                                  /**< @brief Longest break start to header end. */
+    uint16 MaxResponseUs;                                /**< @brief Longest header end to frame end. */
+    uint16 MaxFrameUs;                                   /**< @brief Longest break start to frame end. */
+    uint16 ResponseHistogram[LIN_TIMING_HISTOGRAM_BINS]; /**< @brief Response times, saturating. */
+} Lin_TimingStatsType;
+#endif
 
 /**********************************************************
- * @typedef Lin_StatusType
- * @brief Enum representing the status of a LIN channel or frame.
- * @details The operational status returned by the Lin_GetStatus() service.
+ * @brief Operating modes of a LIN channel (Lin_ConfigType.Lin_Mode).
  **********************************************************/
-typedef enum
+#define LIN_MODE_MASTER 0U  /**< @brief Master node: sends headers with Lin_SendFrame. */
+#define LIN_MODE_SLAVE 1U   /**< @brief Slave node: answers headers from its response table. */
+#define LIN_MODE_MONITOR 2U /**< @brief Bus monitor: records every frame, never transmits. */
+
+/**********************************************************
+ * @brief Flags of a monitor record (Lin_MonitorRecordType.Flags).
+ **********************************************************/
+#define LIN_MONITOR_HEADER_OK 0x01U   /**< @brief Sync byte 0x55 and PID parity correct. */
+#define LIN_MONITOR_CLASSIC_OK 0x02U  /**< @brief Last byte is the classic checksum of the others. */
+#define LIN_MONITOR_ENHANCED_OK 0x04U /**< @brief Last byte is the enhanced checksum of the others. */
+#define LIN_MONITOR_LINE_ERROR 0x08U  /**< @brief Framing, noise or overrun error in a byte of the frame. */
+#define LIN_MONITOR_LOST 0x10U        /**< @brief Frames were dropped before this one (buffer full). */
+#define LIN_MONITOR_IDLE 0x20U        /**< @brief Bus idle between two response bytes (a character or more). */
+
+/**********************************************************
+ * @typedef Lin_MonitorRecordType
+ * @brief One frame seen on the bus in monitor mode.
+ * @details The record spans from a break to the next break, or ends earlier
+ *          when 9 bytes follow the PID. Bus idle does not end it: the
+ *          response may resume after a long inter-byte space (then
+ *          LIN_MONITOR_IDLE is set), so the last frame before a pause is
+ *          stored at the next break. A header without response has Count 0.
+ *          Tools/LinMonitor/lindecode.py decodes an array of records
+ *          (20 bytes each, little-endian) to text.
+ **********************************************************/
+typedef struct
 {
-    LIN_NOT_OK,          /**< @brief Error occurred during operation */
-    LIN_TX_OK,           /**< @brief Transmission successful */
-    LIN_RX_OK,           /**< @brief Correct response received */
-    LIN_TX_BUSY,         /**< @brief Transmitting */
-    LIN_TX_HEADER_ERROR, /**< @brief Error during header transmission */
-    LIN_TX_ERROR,        /**< @brief Error during response transmission */
-    LIN_RX_BUSY,         /**< @brief Receiving data */
-    LIN_RX_ERROR,        /**< @brief Error during data reception */
-    LIN_RX_NO_RESPONSE,  /**< @brief No response received */
-    LIN_OPERATIONAL,     /**< @brief Normal operational state */
-    LIN_CH_SLEEP         /**< @brief Sleep state of the channel */
-} Lin_StatusType;
-
-/**********************************************************
- * @typedef Lin_SlaveErrorType
- * @brief Enum representing errors that occur during the LIN node response.
- * @details Includes errors such as header error, checksum error, no response, etc.
- **********************************************************/
-typedef enum
+    uint32 Timestamp; /**< @brief Cycle count (DWT) at the break detection. */
+    uint8 Channel;    /**< @brief LIN channel of the frame. */
+    uint8 Pid;        /**< @brief Protected identifier as received. */
+    uint8 Count;      /**< @brief Bytes received after the PID: data and checksum. */
+    uint8 Flags;      /**< @brief LIN_MONITOR_* flags. */
+    uint8 Bytes[LIN_SIGNAL_BUFFER_SIZE]; /**< @brief Data bytes followed by the checksum. */
+} Lin_MonitorRecordType;
+
+/**********************************************************
+ * @typedef Lin_BatchNotificationType
+ * @brief Called once when a frame batch (Lin_SendFrames) ends.
+ * @details Called from an interrupt. NumOk is the number of frames completed
+ *          successfully; it equals the number of frames if none failed.
+ **********************************************************/
+typedef void (*Lin_BatchNotificationType)(uint8 Channel, uint8 NumOk);
+
+/**********************************************************
+ * @typedef Lin_ConfigType
+ * @brief Configuration structure for the LIN driver.
+ * @details This structure contains the necessary information to configure
+ *          the LIN driver and settings for SFR that affect the LIN channels.
+ **********************************************************/
+typedef struct
 {
-    LIN_ERR_HEADER,       /**< @brief Header error */
-    LIN_ERR_RESP_STOPBIT, /**< @brief Framing error in response */
-    LIN_ERR_RESP_CHKSUM,  /**< @brief Checksum error */
-    LIN_ERR_RESP_DATABIT, /**< @brief Data bit monitoring error in response */
-    LIN_ERR_NO_RESP,      /**< @brief No response */
-    LIN_ERR_INC_RESP      /**< @brief Incomplete response */
-} Lin_SlaveErrorType;
+    uint32_t Lin_BaudRate;             /**< @brief Baud rate for the LIN channel. */
+    uint8_t Lin_Channel;               /**< @brief LIN channel number: 0 = USART1, 1 = USART2, 2 = USART3. */
+    FunctionalState Lin_WakeupSupport; /**< @brief Wake-up mode support (TRUE/FALSE). */
+    FunctionalState Lin_DmaSupport;    /**< @brief Move responses by DMA instead of per-byte interrupts. */
+    uint32_t Lin_Prescaler;            /**< @brief Prescaler value for adjusting baud rate. */
+    uint32_t Lin_Mode;                 /**< @brief Operating mode of LIN (0: master, 1: slave, 2: monitor). */
+    const Lin_PduType *Lin_SlaveResponseTable; /**< @brief Slave mode: 64 entries indexed by frame ID;
+                                                    entries with Dl 0, or TX entries with SduPtr NULL, are ignored. */
+    uint8_t Lin_TimeoutDuration;       /**< @brief Timeout duration to detect errors. */
+    Lin_SignalBufferType *const *Lin_SignalBufferTable; /**< @brief 64 entries indexed by frame ID, may be NULL;
+                                                             responses of frames without buffer go to the driver's RxBuffer. */
+} Lin_ConfigType;
 
 /**********************************************************
- * @brief Initialize the LIN module.
- * @param Config Pointer to the LIN configuration structure.
+ * @brief Initialize a LIN channel.
+ * @param Config Pointer to the LIN configuration structure; call once per channel.
  **********************************************************/
 void Lin_Init(const Lin_ConfigType *Config);
 
 /**********************************************************
  * @brief Check the wake-up event for a LIN channel.
  * @param Channel The LIN channel to check.
- * @return `E_OK` if the check is successful, `E_NOT_OK` if it fails.
+ * @return `E_OK` if a wake-up pulse was detected while the channel sleeps, `E_NOT_OK` otherwise.
  **********************************************************/
 Std_ReturnType Lin_CheckWakeup(uint8 Channel);
 
@@ -146,13 +210,16 @@ void Lin_GetVersionInfo(Std_VersionInfoType *versioninfo);
  * @param Channel The LIN channel from which the frame will be sent.
  * @param PduInfoPtr Pointer to the PDU containing the information to send.
  * @return `E_OK` if successful, `E_NOT_OK` if failed.
+ * @details Refused while the channel is degraded after repeated header errors
+ *          (stuck bus); Lin_GetStatus then reports LIN_NOT_OK.
  **********************************************************/
 Std_ReturnType Lin_SendFrame(uint8 Channel, const Lin_PduType *PduInfoPtr);
 
 /**********************************************************
- * @brief Put the LIN channel into sleep mode.
- * @param Channel The LIN channel to put into sleep mode.
+ * @brief Send the go-to-sleep command, then put the LIN channel into sleep mode.
+ * @param Channel The LIN channel to put into sleep mode (master only).
  * @return `E_OK` if successful, `E_NOT_OK` if failed.
+ * @details Returns at once; Lin_GetStatus reports LIN_CH_SLEEP once the command is sent.
  **********************************************************/
 Std_ReturnType Lin_GoToSleep(uint8 Channel);
 
@@ -164,12 +231,20 @@ Std_ReturnType Lin_GoToSleep(uint8 Channel);
 Std_ReturnType Lin_GoToSleepInternal(uint8 Channel);
 
 /**********************************************************
- * @brief Generate a wake-up pulse and set the channel status to LIN_CH_OPERATIONAL.
+ * @brief Generate a wake-up pulse and set the channel status to LIN_OPERATIONAL.
  * @param Channel The LIN channel to generate the wake-up pulse for.
  * @return `E_OK` if successful, `E_NOT_OK` if failed.
+ * @details Returns at once; the channel is operational when the pulse has ended (TIM4 interrupt).
  **********************************************************/
 Std_ReturnType Lin_Wakeup(uint8 Channel);
 
+/**********************************************************
+ * @brief Set a sleeping channel to LIN_OPERATIONAL without sending a wake-up pulse.
+ * @param Channel The LIN channel.
+ * @return `E_OK` if successful, `E_NOT_OK` if the channel was not asleep.
+ **********************************************************/
+Std_ReturnType Lin_WakeupInternal(uint8 Channel);
+
 /**********************************************************
  * @brief Get the current status of the LIN channel.
  * @param Channel The LIN channel to check.
@@ -178,4 +253,116 @@ Std_ReturnType Lin_Wakeup(uint8 Channel);
  **********************************************************/
 Lin_StatusType Lin_GetStatus(uint8 Channel, const uint8 **Lin_SduPtr);
 
+/**********************************************************
+ * @brief Get the error counters of a LIN channel.
+ * @param Channel The LIN channel.
+ * @param Counters Receives a copy of the counters.
+ * @return `E_OK` if copied, `E_NOT_OK` if a parameter is invalid.
+ * @details Does not mask interrupts: each counter is copied with a single
+ *          16-bit read, so a frame completing meanwhile only shows up in
+ *          the next call. The counters are incremented by the interrupts and
+ *          by Lin_GetStatus (response timeout), each time with interrupts
+ *          masked. The counters are reset by Lin_Init.
+ **********************************************************/
+Std_ReturnType Lin_GetErrorCounters(uint8 Channel, Lin_ErrorCountersType *Counters);
+
+/**********************************************************
+ * @brief Store a response into the signal buffer of a frame.
+ * @param Channel The LIN channel.
+ * @param FrameId Frame identifier (0...63).
+ * @param Data Response data.
+ * @param Length Number of bytes (1...8).
+ * @return `E_OK` if stored, `E_NOT_OK` if the frame has no signal buffer or a parameter is invalid.
+ * @details Used for responses received under another identifier (event-triggered
+ *          frames). Call it only while no header of FrameId is in progress.
+ **********************************************************/
+Std_ReturnType Lin_SignalBufferWrite(uint8 Channel, uint8 FrameId, const uint8 *Data, uint8 Length);
+
+/**********************************************************
+ * @brief Switch the baud rate of a LIN channel.
+ * @param Channel The LIN channel.
+ * @param BaudRate New baud rate, one of the rates in Lin_BaudrateTable.
+ * @return `E_OK` if switched, `E_NOT_OK` if the rate is not configured or the channel is not idle.
+ * @details Only rewrites USART_BRR (precomputed in Lin_Cfg.c), so a transceiver
+ *          can be moved between 9600 and 19200 bit/s clusters between frames.
+ **********************************************************/
+Std_ReturnType Lin_SetBaudrate(uint8 Channel, uint32 BaudRate);
+
+/**********************************************************
+ * @brief Send a burst of LIN frames back-to-back.
+ * @param Channel The LIN channel.
+ * @param Frames The frames, sent in order; the array must stay valid until the notification.
+ * @param NumFrames Number of frames (1...255).
+ * @param InterFrameUs Inter-frame space between the end of a frame and the next break, in microseconds.
+ * @param Notification Called once when the batch ends; may be NULL.
+ * @return `E_OK` if the batch was started, `E_NOT_OK` if a parameter is invalid or a batch runs.
+ * @details The frames are chained by the interrupts, so no status polling is
+ *          needed between them. Lin_SendFrame is rejected while a batch runs.
+ **********************************************************/
+Std_ReturnType Lin_SendFrames(uint8 Channel, const Lin_PduType *Frames, uint8 NumFrames, uint16 InterFrameUs,
+                              Lin_BatchNotificationType Notification);
+
+/**********************************************************
+ * @brief Take the oldest frame recorded by the bus monitor.
+ * @param Record Receives the record.
+ * @return `E_OK` if a record was taken, `E_NOT_OK` if none is pending.
+ * @details Records of all monitor channels share one buffer of
+ *          LIN_MONITOR_RECORDS entries; read them faster than the bus
+ *          produces frames, or LIN_MONITOR_LOST marks the gap.
+ **********************************************************/
+Std_ReturnType Lin_MonitorRead(Lin_MonitorRecordType *Record);
+
+#if (LIN_TIMING_SUPPORT == 1)
+/**********************************************************
+ * @brief Take the oldest frame timing record.
+ * @param Record Receives the record.
+ * @return `E_OK` if a record was taken, `E_NOT_OK` if none is pending.
+ **********************************************************/
+Std_ReturnType Lin_GetTimingRecord(Lin_TimingRecordType *Record);
+
+/**********************************************************
+ * @brief Get the timing statistics of a frame ID.
+ * @param Channel The LIN channel.
+ * @param FrameId Frame identifier (0...63).
+ * @param Stats Receives a copy of the statistics.
+ * @return `E_OK` if copied, `E_NOT_OK` if a parameter is invalid.
+ **********************************************************/
+Std_ReturnType Lin_GetTimingStats(uint8 Channel, uint8 FrameId, Lin_TimingStatsType *Stats);
+
+/**********************************************************
+ * @brief Share of a schedule slot used by the longest frame of an ID.
+ * @param Channel The LIN channel.
+ * @param FrameId Frame identifier (0...63).
+ * @param SlotUs Length of the slot, in microseconds.
+ * @return Utilization in percent (MaxFrameUs / SlotUs), saturating at 255; 0 if unknown.
+ **********************************************************/
+uint8 Lin_GetSlotUtilization(uint8 Channel, uint8 FrameId, uint32 SlotUs);
+#endif
+
+/**********************************************************
+ * @brief USART interrupt handlers driving the frame state machine of LIN channels 0, 1 and 2.
+ **********************************************************/
+void USART1_IRQHandler(void);
+void USART2_IRQHandler(void);
+void USART3_IRQHandler(void);
+
+/**********************************************************
+ * @brief EXTI interrupt handlers on the Rx pins: sync field timing (slave) and wake-up detection (sleep).
+ * @details EXTI3 serves PA3 (channel 1), EXTI15_10 serves PA10 (channel 0) and PB11 (channel 2).
+ **********************************************************/
+void EXTI3_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+
+/**********************************************************
+ * @brief DMA1 interrupt handlers completing the DMA responses of LIN channels 0, 1 and 2.
+ **********************************************************/
+void DMA1_Channel5_IRQHandler(void);
+void DMA1_Channel6_IRQHandler(void);
+void DMA1_Channel3_IRQHandler(void);
+
+/**********************************************************
+ * @brief TIM4 interrupt handler ending the wake-up pulses (TIM4 is reserved for the LIN driver).
+ **********************************************************/
+void TIM4_IRQHandler(void);
+
 #endif /* LIN_H */
@@ -0,0 +1,392 @@
+/**********************************************************
+ * @file LinTp.c
+ * @brief LIN Transport Protocol Source File
+ * @details This file contains the segmentation of diagnostic
+ *          requests, the reassembly of slave responses and the
+ *          request queue of each LIN channel. Segments are
+ *          exchanged through the MasterReq/SlaveResp slots of the
+ *          schedule tables (see Lin_Sched.c).
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "LinTp.h"
+#include "Lin_Cfg.h"
+#include "Mcal_Critical.h"
+
+/**********************************************************
+ * @brief Payload bytes per segment.
+ **********************************************************/
+#define LINTP_SF_DATA 6U /**< @brief Single frame: NAD, PCI, 6 data bytes. */
+#define LINTP_FF_DATA 5U /**< @brief First frame: NAD, PCI, LEN, 5 data bytes. */
+#define LINTP_CF_DATA 6U /**< @brief Consecutive frame: NAD, PCI, 6 data bytes. */
+
+/**********************************************************
+ * @brief Negative response "request received, response pending".
+ **********************************************************/
+#define LINTP_SID_NEGATIVE_RESPONSE 0x7FU
+#define LINTP_NRC_RESPONSE_PENDING 0x78U
+
+/**********************************************************
+ * @struct LinTp_RequestType
+ * @brief Queued diagnostic request.
+ **********************************************************/
+typedef struct
+{
+    uint8 Nad;                             /**< @brief Target node address. */
+    uint8 ResponseNad;                     /**< @brief Node address expected in the response. */
+    LinTp_ResponseNotificationType Notification; /**< @brief Result callback, NULL for the configured one. */
+    uint16 Length;                         /**< @brief Number of bytes in Data. */
+    uint8 Data[LINTP_MAX_MESSAGE_LENGTH];  /**< @brief Request, starting with the SID. */
+} LinTp_RequestType;
+
+/**********************************************************
+ * @struct LinTp_ChannelType
+ * @brief Transport state of one LIN channel.
+ **********************************************************/
+typedef struct
+{
+    LinTp_RequestType Queue[LINTP_REQUEST_QUEUE_SIZE]; /**< @brief Request ring buffer. */
+    volatile uint8 Head;                   /**< @brief Request being processed. */
+    volatile uint8 Count;                  /**< @brief Number of queued requests. */
+    uint16 TxOffset;                       /**< @brief Request bytes already segmented. */
+    uint8 TxSn;                            /**< @brief Next consecutive frame sequence number. */
+    boolean TxComplete;                    /**< @brief All segments sent, waiting for the response. */
+    uint8 RxBuffer[LINTP_MAX_MESSAGE_LENGTH]; /**< @brief Reassembled response. */
+    uint16 RxLength;                       /**< @brief Announced response length. */
+    uint16 RxOffset;                       /**< @brief Response bytes received. */
+    uint8 RxSn;                            /**< @brief Expected consecutive frame sequence number. */
+    uint8 EmptySlots;                      /**< @brief SlaveResp slots without valid response. */
+} LinTp_ChannelType;
+
+/**********************************************************
+ * @brief Configuration of the transport layer.
+ **********************************************************/
+static const LinTp_ConfigType *LinTp_Config = NULL;
+
+/**********************************************************
+ * @brief Transport state of each LIN channel.
+ **********************************************************/
+static LinTp_ChannelType LinTp_Channel[MAX_LIN_CHANNELS];
+
+/**********************************************************
+ * @brief Finish the current request, notify the result and start the next one.
+ * @param Channel The LIN channel.
+ * @param Status Result of the request.
+ **********************************************************/
+static void LinTp_Finish(uint8 Channel, LinTp_StatusType Status)
+{
+    LinTp_ChannelType *tp = &LinTp_Channel[Channel];
+    const LinTp_RequestType *req = &tp->Queue[tp->Head];
+    LinTp_ResponseNotificationType notification = req->Notification;
+
+    if ((notification == NULL) && (LinTp_Config != NULL))
+    {
+        notification = LinTp_Config->ResponseNotification;
+    }
+    if (notification != NULL)
+    {
+        notification(Channel, req->Nad, Status, tp->RxBuffer, (Status == LINTP_OK) ? tp->RxOffset : 0U);
+    }
+
+    uint32 primask = Mcal_EnterCritical();
+    tp->Head = (uint8)((tp->Head + 1U) % LINTP_REQUEST_QUEUE_SIZE);
+    tp->Count--;
+    Mcal_ExitCritical(primask);
+
+    tp->TxOffset = 0;
+    tp->TxComplete = FALSE;
+}
+
+/**********************************************************
+ * @brief Initialize the transport layer; pending requests are dropped.
+ * @param Config Pointer to the configuration.
+ **********************************************************/
+void LinTp_Init(const LinTp_ConfigType *Config)
+{
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
+    {
+        while (LinTp_Channel[ch].Count > 0)
+        {
+            LinTp_Finish(ch, LINTP_E_ABORTED);
+        }
+        LinTp_Channel[ch].Head = 0;
+        LinTp_Channel[ch].TxOffset = 0;
+        LinTp_Channel[ch].TxComplete = FALSE;
+    }
+
+    LinTp_Config = Config;
+}
+
+/**********************************************************
+ * @brief Queue a diagnostic request.
+ * @param Channel The LIN channel.
+ * @param Nad Node address of the target slave.
+ * @param Data Request, starting with the SID.
+ * @param Length Number of bytes (1...LINTP_MAX_MESSAGE_LENGTH).
+ * @return `E_OK` if queued, `E_NOT_OK` if the queue is full or a parameter is invalid.
+ **********************************************************/
+Std_ReturnType LinTp_Transmit(uint8 Channel, uint8 Nad, const uint8 *Data, uint16 Length)
+{
+    return LinTp_TransmitRequest(Channel, Nad, Nad, Data, Length, NULL);
+}
+
+/**********************************************************
+ * @brief Queue a diagnostic request with its own response NAD and notification.
+ * @param Channel The LIN channel.
+ * @param Nad Node address of the target slave.
+ * @param ResponseNad Node address expected in the response.
+ * @param Data Request, starting with the SID.
+ * @param Length Number of bytes (1...LINTP_MAX_MESSAGE_LENGTH).
+ * @param Notification Result callback of this request, or NULL for the configured one.
+ * @return `E_OK` if queued, `E_NOT_OK` if the queue is full or a parameter is invalid.
+ **********************************************************/
+Std_ReturnType LinTp_TransmitRequest(uint8 Channel, uint8 Nad, uint8 ResponseNad, const uint8 *Data, uint16 Length,
+                                     LinTp_ResponseNotificationType Notification)
+{
+    if ((Channel >= MAX_LIN_CHANNELS) || (Data == NULL) || (Length == 0) ||
+        (Length > LINTP_MAX_MESSAGE_LENGTH) || (Nad == 0x00U))
+    {
+        return E_NOT_OK; // NAD 0 is reserved for the go-to-sleep command
+    }
+
+    LinTp_ChannelType *tp = &LinTp_Channel[Channel];
+    Std_ReturnType ret = E_NOT_OK;
+
+    // The slot is only visible to the schedule once Count includes it
+    uint32 primask = Mcal_EnterCritical();
+    if (tp->Count < LINTP_REQUEST_QUEUE_SIZE)
+    {
+        LinTp_RequestType *req = &tp->Queue[(tp->Head + tp->Count) % LINTP_REQUEST_QUEUE_SIZE];
+        req->Nad = Nad;
+        req->ResponseNad = ResponseNad;
+        req->Notification = Notification;
+        req->Length = Length;
+        for (uint16 i = 0; i < Length; i++)
+        {
+            req->Data[i] = Data[i];
+        }
+        tp->Count++;
+        ret = E_OK;
+    }
+    Mcal_ExitCritical(primask);
+
+    return ret;
+}
+
+/**********************************************************
+ * @brief Number of request bytes carried by the next segment.
+ * @param tp Transport state of the channel.
+ * @param req The current request.
+ * @return Payload bytes of the single, first or consecutive frame.
+ **********************************************************/
+static uint8 LinTp_SegmentLength(const LinTp_ChannelType *tp, const LinTp_RequestType *req)
+{
+    if ((tp->TxOffset == 0) && (req->Length <= LINTP_SF_DATA))
+    {
+        return (uint8)req->Length;
+    }
+    if (tp->TxOffset == 0)
+    {
+        return LINTP_FF_DATA;
+    }
+
+    uint16 remaining = (uint16)(req->Length - tp->TxOffset);
+    return (remaining < LINTP_CF_DATA) ? (uint8)remaining : LINTP_CF_DATA;
+}
+
+/**********************************************************
+ * @brief Schedule hook: next master request frame of a channel.
+ * @param Channel The LIN channel.
+ * @param Frame Buffer of LINTP_FRAME_LENGTH bytes, filled when TRUE is returned.
+ * @return TRUE if a segment is due and the MasterReq header must be sent.
+ * @details The segment stays current until LinTp_MasterRequestSent, so a
+ *          header that could not be sent is retried in the next slot.
+ **********************************************************/
+boolean LinTp_GetMasterRequest(uint8 Channel, uint8 *Frame)
+{
+    if ((Channel >= MAX_LIN_CHANNELS) || (Frame == NULL))
+    {
+        return FALSE;
+    }
+
+    const LinTp_ChannelType *tp = &LinTp_Channel[Channel];
+    if ((tp->Count == 0) || tp->TxComplete)
+    {
+        return FALSE; // Nothing to send, or waiting for the response
+    }
+
+    const LinTp_RequestType *req = &tp->Queue[tp->Head];
+    uint8 chunk = LinTp_SegmentLength(tp, req);
+    uint8 pos = 2;
+
+    for (uint8 i = 0; i < LINTP_FRAME_LENGTH; i++)
+    {
+        Frame[i] = LINTP_PADDING;
+    }
+    Frame[0] = req->Nad;
+
+    if ((tp->TxOffset == 0) && (req->Length <= LINTP_SF_DATA))
+    {
+        Frame[1] = (uint8)(LINTP_PCI_SF | req->Length);
+    }
+    else if (tp->TxOffset == 0)
+    {
+        Frame[1] = (uint8)(LINTP_PCI_FF | (req->Length >> 8));
+        Frame[2] = (uint8)req->Length;
+        pos = 3;
+    }
+    else
+    {
+        Frame[1] = (uint8)(LINTP_PCI_CF | (tp->TxSn & 0x0FU));
+    }
+
+    for (uint8 i = 0; i < chunk; i++)
+    {
+        Frame[pos + i] = req->Data[tp->TxOffset + i];
+    }
+
+    return TRUE;
+}
+
+/**********************************************************
+ * @brief Schedule hook: the frame of LinTp_GetMasterRequest was started.
+ * @param Channel The LIN channel.
+ **********************************************************/
+void LinTp_MasterRequestSent(uint8 Channel)
+{
+    if (Channel >= MAX_LIN_CHANNELS)
+    {
+        return;
+    }
+
+    LinTp_ChannelType *tp = &LinTp_Channel[Channel];
+    if ((tp->Count == 0) || tp->TxComplete)
+    {
+        return;
+    }
+
+    const LinTp_RequestType *req = &tp->Queue[tp->Head];
+    uint8 chunk = LinTp_SegmentLength(tp, req);
+
+    if (tp->TxOffset == 0)
+    {
+        tp->TxSn = 1; // First consecutive frame, if any
+    }
+    else
+    {
+        tp->TxSn++;
+    }
+    tp->TxOffset += chunk;
+
+    // Last segment: wait for the response, or move on for functional requests
+    if (tp->TxOffset == req->Length)
+    {
+        tp->RxOffset = 0;
+        tp->RxLength = 0;
+        tp->EmptySlots = 0;
+        tp->TxComplete = TRUE;
+        if (req->Nad == LINTP_NAD_FUNCTIONAL)
+        {
+            LinTp_Finish(Channel, LINTP_OK);
+        }
+    }
+}
+
+/**********************************************************
+ * @brief Schedule hook: tells whether a SlaveResp header is needed.
+ * @param Channel The LIN channel.
+ * @return TRUE if a response to the current request is awaited.
+ **********************************************************/
+boolean LinTp_IsResponsePending(uint8 Channel)
+{
+    if (Channel >= MAX_LIN_CHANNELS)
+    {
+        return FALSE;
+    }
+
+    return ((LinTp_Channel[Channel].Count > 0) && LinTp_Channel[Channel].TxComplete) ? TRUE : FALSE;
+}
+
+/**********************************************************
+ * @brief Schedule hook: result of a SlaveResp slot.
+ * @param Channel The LIN channel.
+ * @param Frame The LINTP_FRAME_LENGTH received bytes, or NULL if the slot gave no valid response.
+ * @details Responses from another NAD than the expected one count as empty
+ *          slots, except for requests sent to LINTP_NAD_BROADCAST.
+ **********************************************************/
+void LinTp_SlaveResponseIndication(uint8 Channel, const uint8 *Frame)
+{
+    if (!LinTp_IsResponsePending(Channel))
+    {
+        return;
+    }
+
+    LinTp_ChannelType *tp = &LinTp_Channel[Channel];
+    const LinTp_RequestType *req = &tp->Queue[tp->Head];
+
+    // No response or response of another node
+    if ((Frame == NULL) || ((Frame[0] != req->ResponseNad) && (req->Nad != LINTP_NAD_BROADCAST)))
+    {
+        if ((LinTp_Config != NULL) && (++tp->EmptySlots >= LinTp_Config->MaxEmptyResponses))
+        {
+            LinTp_Finish(Channel, LINTP_E_TIMEOUT);
+        }
+        return;
+    }
+
+    uint8 pci = Frame[1];
+    uint8 pos = 2;
+    uint8 chunk;
+    tp->EmptySlots = 0;
+
+    if ((tp->RxOffset == 0) && ((pci & LINTP_PCI_TYPE_MASK) == LINTP_PCI_SF))
+    {
+        tp->RxLength = pci & 0x0FU;
+        if ((tp->RxLength == 0) || (tp->RxLength > LINTP_SF_DATA))
+        {
+            LinTp_Finish(Channel, LINTP_E_SEQUENCE);
+            return;
+        }
+        if ((tp->RxLength == 3U) && (Frame[2] == LINTP_SID_NEGATIVE_RESPONSE) &&
+            (Frame[4] == LINTP_NRC_RESPONSE_PENDING))
+        {
+            return; // The slave needs more time, keep polling
+        }
+        chunk = (uint8)tp->RxLength;
+    }
+    else if ((tp->RxOffset == 0) && ((pci & LINTP_PCI_TYPE_MASK) == LINTP_PCI_FF))
+    {
+        tp->RxLength = (uint16)(((uint16)(pci & 0x0FU) << 8) | Frame[2]);
+        if ((tp->RxLength <= LINTP_SF_DATA) || (tp->RxLength > LINTP_MAX_MESSAGE_LENGTH))
+        {
+            LinTp_Finish(Channel, LINTP_E_SEQUENCE);
+            return;
+        }
+        pos = 3;
+        chunk = LINTP_FF_DATA;
+        tp->RxSn = 1;
+    }
+    else if ((tp->RxOffset != 0) && (pci == (LINTP_PCI_CF | (tp->RxSn & 0x0FU))))
+    {
+        uint16 remaining = (uint16)(tp->RxLength - tp->RxOffset);
+        chunk = (remaining < LINTP_CF_DATA) ? (uint8)remaining : LINTP_CF_DATA;
+        tp->RxSn++;
+    }
+    else
+    {
+        LinTp_Finish(Channel, LINTP_E_SEQUENCE);
+        return;
+    }
+
+    for (uint8 i = 0; i < chunk; i++)
+    {
+        tp->RxBuffer[tp->RxOffset++] = Frame[pos + i];
+    }
+
+    if (tp->RxOffset == tp->RxLength)
+    {
+        LinTp_Finish(Channel, LINTP_OK);
+    }
+}
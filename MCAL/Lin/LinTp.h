@@ -0,0 +1,135 @@
+/**********************************************************
+ * @file LinTp.h
+ * @brief LIN Transport Protocol Header File
+ * @details This file contains the definitions for the LIN diagnostic
+ *          transport layer: segmentation of master requests (0x3C)
+ *          into single, first and consecutive frames, reassembly of
+ *          slave responses (0x3D) with NAD routing, and the hooks
+ *          used by the schedule executor to fill diagnostic slots.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef LINTP_H
+#define LINTP_H
+
+#include "Std_Types.h" /**< @brief Standard AUTOSAR data types */
+
+/**********************************************************
+ * @brief Pre-compile time parameter settings.
+ **********************************************************/
+#define LINTP_MAX_MESSAGE_LENGTH 64U /**< @brief Largest request or response (SID included). */
+#define LINTP_REQUEST_QUEUE_SIZE 4U  /**< @brief Requests queued per channel. */
+
+/**********************************************************
+ * @brief Diagnostic frame layout.
+ **********************************************************/
+#define LINTP_ID_MASTER_REQ 0x3CU   /**< @brief Frame ID of the master request. */
+#define LINTP_ID_SLAVE_RESP 0x3DU   /**< @brief Frame ID of the slave response. */
+#define LINTP_FRAME_LENGTH 8U       /**< @brief Diagnostic frames always carry 8 bytes. */
+#define LINTP_PADDING 0xFFU         /**< @brief Value of unused bytes. */
+#define LINTP_NAD_FUNCTIONAL 0x7EU  /**< @brief Functional NAD: no response expected. */
+#define LINTP_NAD_BROADCAST 0x7FU   /**< @brief Broadcast NAD: any responding NAD is accepted. */
+#define LINTP_PCI_SF 0x00U          /**< @brief Single frame: PCI = 0x0L. */
+#define LINTP_PCI_FF 0x10U          /**< @brief First frame: PCI = 0x1H, LEN = low byte. */
+#define LINTP_PCI_CF 0x20U          /**< @brief Consecutive frame: PCI = 0x2N (sequence number). */
+#define LINTP_PCI_TYPE_MASK 0xF0U   /**< @brief Frame type bits of the PCI. */
+
+/**********************************************************
+ * @enum LinTp_StatusType
+ * @brief Result of a transported message.
+ **********************************************************/
+typedef enum
+{
+    LINTP_OK,          /**< @brief Response received completely. */
+    LINTP_E_SEQUENCE,  /**< @brief Unexpected PCI or sequence number in the response. */
+    LINTP_E_TIMEOUT,   /**< @brief No valid response within the configured number of slots. */
+    LINTP_E_ABORTED    /**< @brief Request dropped by LinTp_Init. */
+} LinTp_StatusType;
+
+/**********************************************************
+ * @typedef LinTp_ResponseNotificationType
+ * @brief Called when a request is finished (response received or failed).
+ * @details Called from Lin_ScheduleTick; Data is valid during the call only.
+ **********************************************************/
+typedef void (*LinTp_ResponseNotificationType)(uint8 Channel, uint8 Nad, LinTp_StatusType Status,
+                                               const uint8 *Data, uint16 Length);
+
+/**********************************************************
+ * @typedef LinTp_ConfigType
+ * @brief Configuration of the LIN transport layer.
+ **********************************************************/
+typedef struct
+{
+    LinTp_ResponseNotificationType ResponseNotification; /**< @brief Result callback, may be NULL. */
+    uint8 MaxEmptyResponses; /**< @brief SlaveResp slots without valid response before LINTP_E_TIMEOUT. */
+} LinTp_ConfigType;
+
+/**********************************************************
+ * @brief Initialize the transport layer; pending requests are dropped.
+ * @param Config Pointer to the configuration.
+ **********************************************************/
+void LinTp_Init(const LinTp_ConfigType *Config);
+
+/**********************************************************
+ * @brief Queue a diagnostic request.
+ * @param Channel The LIN channel.
+ * @param Nad Node address of the target slave.
+ * @param Data Request, starting with the SID.
+ * @param Length Number of bytes (1...LINTP_MAX_MESSAGE_LENGTH).
+ * @return `E_OK` if queued, `E_NOT_OK` if the queue is full or a parameter is invalid.
+ * @details Queued requests are sent in order, one segment per MasterReq slot.
+ *          A request to LINTP_NAD_FUNCTIONAL completes when sent; the next
+ *          one starts in the following MasterReq slot. Otherwise the next
+ *          request starts as soon as the response has been received.
+ **********************************************************/
+Std_ReturnType LinTp_Transmit(uint8 Channel, uint8 Nad, const uint8 *Data, uint16 Length);
+
+/**********************************************************
+ * @brief Queue a diagnostic request with its own response NAD and notification.
+ * @param Channel The LIN channel.
+ * @param Nad Node address of the target slave.
+ * @param ResponseNad Node address expected in the response (e.g., the new NAD of ConditionalChangeNAD).
+ * @param Data Request, starting with the SID.
+ * @param Length Number of bytes (1...LINTP_MAX_MESSAGE_LENGTH).
+ * @param Notification Result callback of this request, or NULL for the configured one.
+ * @return `E_OK` if queued, `E_NOT_OK` if the queue is full or a parameter is invalid.
+ * @details Same as LinTp_Transmit otherwise; the notification may queue the next request.
+ **********************************************************/
+Std_ReturnType LinTp_TransmitRequest(uint8 Channel, uint8 Nad, uint8 ResponseNad, const uint8 *Data, uint16 Length,
+                                     LinTp_ResponseNotificationType Notification);
+
+/**********************************************************
+ * @brief Schedule hook: next master request frame of a channel.
+ * @param Channel The LIN channel.
+ * @param Frame Buffer of LINTP_FRAME_LENGTH bytes, filled when TRUE is returned.
+ * @return TRUE if a segment is due and the MasterReq header must be sent.
+ * @details Does not consume the segment: the same frame is returned until
+ *          LinTp_MasterRequestSent confirms it.
+ **********************************************************/
+boolean LinTp_GetMasterRequest(uint8 Channel, uint8 *Frame);
+
+/**********************************************************
+ * @brief Schedule hook: the frame of LinTp_GetMasterRequest was started.
+ * @param Channel The LIN channel.
+ * @details Moves on to the next segment; after the last one the response is
+ *          awaited, or a functional request is finished.
+ **********************************************************/
+void LinTp_MasterRequestSent(uint8 Channel);
+
+/**********************************************************
+ * @brief Schedule hook: tells whether a SlaveResp header is needed.
+ * @param Channel The LIN channel.
+ * @return TRUE if a response to the current request is awaited.
+ **********************************************************/
+boolean LinTp_IsResponsePending(uint8 Channel);
+
+/**********************************************************
+ * @brief Schedule hook: result of a SlaveResp slot.
+ * @param Channel The LIN channel.
+ * @param Frame The LINTP_FRAME_LENGTH received bytes, or NULL if the slot gave no valid response.
+ **********************************************************/
+void LinTp_SlaveResponseIndication(uint8 Channel, const uint8 *Frame);
+
+#endif /* LINTP_H */
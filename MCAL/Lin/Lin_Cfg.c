@@ -0,0 +1,43 @@
+/**********************************************************
+ * @file Lin_Cfg.c
+ * @brief LIN Driver Configuration Source File
+ * @details This file is the single definition site of the LIN channel
+ *          configuration. All tables are const and placed in flash;
+ *          cluster tables (frames, schedules, signals) are generated
+ *          from the LDF by Tools/LinCfgGen/ldf2c.py.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Lin_Cfg.h"
+
+/**********************************************************
+ * @brief Array storing configurations for LIN channels.
+ **********************************************************/
+const LinChannelConfigType LinChannelConfig[MAX_LIN_CHANNELS] = {
+    {
+        .Lin_BaudRate = 19200,             /**< @brief Baud rate for the LIN channel. */
+        .LinChannelWakeupSupport = ENABLE, /**< @brief Wake-up support. */
+        .Lin_ChannelID = 0                 /**< @brief ID of the LIN channel (USART1). */
+    },
+    {
+        .Lin_BaudRate = 19200,             /**< @brief Baud rate for the LIN channel. */
+        .LinChannelWakeupSupport = ENABLE, /**< @brief Wake-up support. */
+        .Lin_ChannelID = 1                 /**< @brief ID of the LIN channel (USART2). */
+    },
+    {
+        .Lin_BaudRate = 19200,             /**< @brief Baud rate for the LIN channel. */
+        .LinChannelWakeupSupport = ENABLE, /**< @brief Wake-up support. */
+        .Lin_ChannelID = 2                 /**< @brief ID of the LIN channel (USART3). */
+    }
+};
+
+/**********************************************************
+ * @brief Baud rates of the LIN channels with their BRR values.
+ **********************************************************/
+const Lin_BaudrateType Lin_BaudrateTable[MAX_LIN_CHANNELS][LIN_NUM_BAUDRATES] = {
+    {{9600, LIN_BRR(LIN_PCLK2_HZ, 9600U)}, {19200, LIN_BRR(LIN_PCLK2_HZ, 19200U)}}, /**< @brief USART1 (APB2). */
+    {{9600, LIN_BRR(LIN_PCLK1_HZ, 9600U)}, {19200, LIN_BRR(LIN_PCLK1_HZ, 19200U)}}, /**< @brief USART2 (APB1). */
+    {{9600, LIN_BRR(LIN_PCLK1_HZ, 9600U)}, {19200, LIN_BRR(LIN_PCLK1_HZ, 19200U)}}  /**< @brief USART3 (APB1). */
+};
@@ -2,8 +2,9 @@
  * @file Lin_Cfg.h
  * @brief The sole header file for the LIN driver.
  * @details This file contains declarations of structures, constants, and arrays required
- *          to configure and manage the state of LIN channels, along with
- *          version information and vendor/module IDs.
+ *          to configure the LIN channels, along with version information and
+ *          vendor/module IDs. The configuration itself is defined once, as const
+ *          data, in Lin_Cfg.c.
  * @version 1.0
  * @date 2024-11-01
  * @author Tong Xuan Hoang
@@ -12,22 +13,16 @@
 #ifndef LIN_CFG_H
 #define LIN_CFG_H
 
-#include "stm32f1xx.h" // Include hardware library if using STM32
-#include "Lin_Types.h" // Include necessary data type definitions
-
-/**********************************************************
- * @brief Defines the states of the LIN channel.
- **********************************************************/
-#define LIN_CH_SLEEP 0         /**< @brief Sleep state of the LIN channel. */
-#define LIN_CH_OPERATIONAL 1   /**< @brief Operational state of the LIN channel. */
-#define LIN_CH_SLEEP_PENDING 2 /**< @brief Pending state for transitioning to sleep. */
+#include "stm32f10x.h"  // Include hardware library
+#include "Std_Types.h"  // Standard AUTOSAR data types
+#include "Lin_Types.h"  // Include necessary data type definitions
 
 /**********************************************************
  * @brief Defines the maximum number of LIN channels.
  * @details This value should be configured based on the actual system
  *          and the microcontroller's capabilities.
  **********************************************************/
-#define MAX_LIN_CHANNELS 2 // This value can be adjusted depending on the number of LIN channels supported by the system
+#define MAX_LIN_CHANNELS 3 // USART1, USART2 and USART3
 
 /**********************************************************
  * @brief Defines the Vendor ID.
@@ -47,15 +42,40 @@
 #define LIN_SW_PATCH_VERSION 0 /**< @brief Patch version of the software. */
 
 /**********************************************************
- * @enum Lin_StatusType
- * @brief Different states of the LIN channel.
+ * @brief Peripheral clocks of the USARTs used for LIN.
+ * @details Must match the RCC setup of the application (72 MHz SYSCLK:
+ *          APB2 = 72 MHz for USART1, APB1 = 36 MHz for USART2/USART3).
+ **********************************************************/
+#define LIN_PCLK1_HZ 36000000U /**< @brief APB1 clock (USART2, USART3). */
+#define LIN_PCLK2_HZ 72000000U /**< @brief APB2 clock (USART1). */
+
+/**********************************************************
+ * @brief USART_BRR value for a baud rate, rounded to the nearest.
+ * @details BRR = f_PCLK / baud (mantissa and 4-bit fraction of f_PCLK / (16 * baud)).
+ *          Constant arguments give a constant evaluated at compile time.
  **********************************************************/
-typedef enum
+#define LIN_BRR(PclkHz, Baud) ((uint16)(((PclkHz) + (Baud) / 2U) / (Baud)))
+
+/**********************************************************
+ * @brief Number of baud rates supported per channel (Lin_BaudrateTable).
+ **********************************************************/
+#define LIN_NUM_BAUDRATES 2U
+
+/**********************************************************
+ * @struct Lin_BaudrateType
+ * @brief A supported baud rate and its precomputed USART_BRR value.
+ **********************************************************/
+typedef struct
 {
-    LIN_CH_SLEEP,        /**< @brief Sleep state of the LIN channel. */
-    LIN_CH_OPERATIONAL,  /**< @brief Operational state of the LIN channel. */
-    LIN_CH_SLEEP_PENDING /**< @brief Pending state to transition to sleep. */
-} Lin_StatusType;
+    uint32 BaudRate; /**< @brief Baud rate in bit/s. */
+    uint16 Brr;      /**< @brief USART_BRR value for the clock of the channel's USART. */
+} Lin_BaudrateType;
+
+/**********************************************************
+ * @brief Baud rates each LIN channel can switch to without divisions.
+ * @details Used by Lin_Init and Lin_SetBaudrate. Defined in Lin_Cfg.c (flash).
+ **********************************************************/
+extern const Lin_BaudrateType Lin_BaudrateTable[MAX_LIN_CHANNELS][LIN_NUM_BAUDRATES];
 
 /**********************************************************
  * @struct LinChannelConfigType
@@ -65,36 +85,14 @@ typedef struct
 {
     uint32 Lin_BaudRate;                     /**< @brief Data transmission speed of the LIN channel. */
     FunctionalState LinChannelWakeupSupport; /**< @brief Support for wake-up detection (ENABLE/DISABLE). */
-    uint8 Lin_ChannelID;                     /**< @brief ID of the LIN channel. */
-    GPIO_TypeDef *Lin_Port;                  /**< @brief GPIO port of the LIN channel. */
-    uint16 Lin_TxPin;                        /**< @brief Tx pin of the LIN channel. */
-    uint16 Lin_RxPin;                        /**< @brief Rx pin of the LIN channel. */
+    uint8 Lin_ChannelID;                     /**< @brief ID of the LIN channel (0 = USART1, 1 = USART2, 2 = USART3). */
 } LinChannelConfigType;
 
-/**********************************************************
- * @brief Array storing the states of LIN channels.
- * @details Each element in the array represents the state of a specific LIN channel.
- **********************************************************/
-Lin_StatusType LinChannelState[MAX_LIN_CHANNELS] = {
-    LIN_CH_SLEEP, // Initialize the initial state for each channel
-    LIN_CH_SLEEP  // Initialize for the second channel, if required
-};
-
 /**********************************************************
  * @brief Array storing configurations for LIN channels.
  * @details Each element in the array contains configuration information for a specific LIN channel,
- *          including baud rate, wake-up support status, and associated GPIO pins.
+ *          including baud rate and wake-up support status. Defined in Lin_Cfg.c (flash).
  **********************************************************/
-LinChannelConfigType LinChannelConfig[MAX_LIN_CHANNELS] = {
-    {
-        .Lin_BaudRate = 19200,             /**< @brief Baud rate for the LIN channel. */
-        .LinChannelWakeupSupport = ENABLE, /**< @brief Wake-up support. */
-        .Lin_ChannelID = 0,                /**< @brief ID of the LIN channel. */
-        .Lin_Port = GPIOA,                 /**< @brief GPIO port used. */
-        .Lin_TxPin = GPIO_Pin_9,           /**< @brief Tx pin of the channel. */
-        .Lin_RxPin = GPIO_Pin_10           /**< @brief Rx pin of the channel. */
-    },
-    // Add configurations for additional channels if needed
-};
+extern const LinChannelConfigType LinChannelConfig[MAX_LIN_CHANNELS];
 
 #endif /* LIN_CFG_H */
@@ -0,0 +1,220 @@
+/**********************************************************
+ * @file Lin_NodeCfg.c
+ * @brief LIN Node Configuration Service Source File
+ * @details This file contains the runner of the node configuration
+ *          scripts: each step is queued in LinTp, its response is
+ *          checked in the LinTp notification (schedule tick context)
+ *          and the next step is queued from there, so the start-up
+ *          configuration of the cluster never blocks the application.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Lin_NodeCfg.h"
+#include "Lin_Cfg.h"
+
+/**********************************************************
+ * @struct Lin_NodeCfgRuntimeType
+ * @brief Execution state of the configuration script of one channel.
+ **********************************************************/
+typedef struct
+{
+    const Lin_NodeCfgStepType *volatile Script; /**< @brief Running script, NULL if none. */
+    uint8 NumSteps;                             /**< @brief Number of steps of the script. */
+    uint8 Step;                                 /**< @brief Step in progress. */
+    uint8 Retries;                              /**< @brief Repetitions of the step in progress. */
+    Lin_NodeCfgNotificationType Notification;   /**< @brief Called when the script ends. */
+} Lin_NodeCfgRuntimeType;
+
+/**********************************************************
+ * @brief Configuration script state of each LIN channel.
+ **********************************************************/
+static Lin_NodeCfgRuntimeType Lin_NodeCfgRuntime[MAX_LIN_CHANNELS];
+
+static void Lin_NodeCfgResponse(uint8 Channel, uint8 Nad, LinTp_StatusType Status, const uint8 *Data, uint16 Length);
+
+/**********************************************************
+ * @brief Queue the step in progress of a channel in LinTp.
+ * @param Channel The LIN channel.
+ * @return `E_OK` if queued, `E_NOT_OK` if the LinTp queue is full.
+ **********************************************************/
+static Std_ReturnType Lin_NodeCfgSend(uint8 Channel)
+{
+    const Lin_NodeCfgRuntimeType *cfg = &Lin_NodeCfgRuntime[Channel];
+    const Lin_NodeCfgStepType *step = &cfg->Script[cfg->Step];
+    uint8 request[1U + LIN_NODECFG_DATA_LENGTH];
+
+    request[0] = step->Sid;
+    for (uint8 i = 0; i < LIN_NODECFG_DATA_LENGTH; i++)
+    {
+        request[1U + i] = step->Data[i];
+    }
+
+    // SaveConfiguration has no data; LinTp pads the single frame with 0xFF
+    return LinTp_TransmitRequest(Channel, step->Nad, step->ResponseNad, request,
+                                 (step->Sid == LIN_NODECFG_SID_SAVE_CONFIGURATION) ? 1U : sizeof(request),
+                                 Lin_NodeCfgResponse);
+}
+
+/**********************************************************
+ * @brief End the script of a channel and report the result.
+ * @param Channel The LIN channel.
+ * @param Result Result of the script.
+ **********************************************************/
+static void Lin_NodeCfgEnd(uint8 Channel, Lin_NodeCfgResultType Result)
+{
+    Lin_NodeCfgRuntimeType *cfg = &Lin_NodeCfgRuntime[Channel];
+    Lin_NodeCfgNotificationType notification = cfg->Notification;
+    uint8 step = (Result == LIN_NODECFG_OK) ? cfg->NumSteps : cfg->Step;
+
+    cfg->Script = NULL; // A new script may be started from the notification
+    if (notification != NULL)
+    {
+        notification(Channel, Result, step);
+    }
+}
+
+/**********************************************************
+ * @brief LinTp notification of the configuration requests.
+ * @param Channel The LIN channel.
+ * @param Nad NAD the request was sent to.
+ * @param Status Result of the transport.
+ * @param Data Response, starting with the response SID.
+ * @param Length Number of bytes in Data.
+ * @details Checks the response of the step in progress and queues the
+ *          next step, or repeats the step if no valid response came. A
+ *          notification for another NAD than the one of the step is ignored.
+ **********************************************************/
+static void Lin_NodeCfgResponse(uint8 Channel, uint8 Nad, LinTp_StatusType Status, const uint8 *Data, uint16 Length)
+{
+    Lin_NodeCfgRuntimeType *cfg = &Lin_NodeCfgRuntime[Channel];
+    const Lin_NodeCfgStepType *step = cfg->Script;
+    Lin_NodeCfgResultType result;
+
+    if (step == NULL)
+    {
+        return;
+    }
+    step = &step[cfg->Step];
+
+    // Late notification of a request to another node, e.g., of a previous script
+    if (Nad != step->Nad)
+    {
+        return;
+    }
+
+    if (Status == LINTP_E_ABORTED)
+    {
+        Lin_NodeCfgEnd(Channel, LIN_NODECFG_E_ABORTED);
+        return;
+    }
+
+    if (Status != LINTP_OK)
+    {
+        result = LIN_NODECFG_E_NO_RESPONSE;
+    }
+    else if (step->Nad == LINTP_NAD_FUNCTIONAL)
+    {
+        result = LIN_NODECFG_OK; // Functional requests are not answered
+    }
+    else if ((Length >= 1U) && (Data[0] == (uint8)(step->Sid + LIN_NODECFG_RSID_OFFSET)))
+    {
+        result = LIN_NODECFG_OK;
+        if (step->ResponseData != NULL)
+        {
+            for (uint16 i = 1; (i < Length) && (i <= LIN_NODECFG_DATA_LENGTH); i++)
+            {
+                step->ResponseData[i - 1U] = Data[i];
+            }
+        }
+    }
+    else
+    {
+        result = LIN_NODECFG_E_NEGATIVE; // LIN_NODECFG_SID_NEGATIVE_RESPONSE or another service
+    }
+
+    if (result == LIN_NODECFG_E_NO_RESPONSE)
+    {
+        if (cfg->Retries >= LIN_NODECFG_RETRIES)
+        {
+            Lin_NodeCfgEnd(Channel, result);
+        }
+        else
+        {
+            cfg->Retries++;
+            if (Lin_NodeCfgSend(Channel) != E_OK)
+            {
+                Lin_NodeCfgEnd(Channel, LIN_NODECFG_E_ABORTED);
+            }
+        }
+    }
+    else if (result != LIN_NODECFG_OK)
+    {
+        Lin_NodeCfgEnd(Channel, result);
+    }
+    else if ((cfg->Step + 1U) >= cfg->NumSteps)
+    {
+        Lin_NodeCfgEnd(Channel, LIN_NODECFG_OK);
+    }
+    else
+    {
+        cfg->Step++;
+        cfg->Retries = 0;
+        if (Lin_NodeCfgSend(Channel) != E_OK)
+        {
+            Lin_NodeCfgEnd(Channel, LIN_NODECFG_E_ABORTED);
+        }
+    }
+}
+
+/**********************************************************
+ * @brief Start a configuration script on a LIN channel.
+ * @param Channel The LIN channel.
+ * @param Script Steps executed in order.
+ * @param NumSteps Number of steps.
+ * @param Notification Called when the script ends, or NULL.
+ * @return `E_OK` if started, `E_NOT_OK` otherwise.
+ * @details The next step is queued while LinTp still holds the finished one,
+ *          so the application must leave one LinTp queue entry free.
+ **********************************************************/
+Std_ReturnType Lin_NodeCfgStart(uint8 Channel, const Lin_NodeCfgStepType *Script, uint8 NumSteps,
+                                Lin_NodeCfgNotificationType Notification)
+{
+    if ((Channel >= MAX_LIN_CHANNELS) || (Script == NULL) || (NumSteps == 0) ||
+        (Lin_NodeCfgRuntime[Channel].Script != NULL))
+    {
+        return E_NOT_OK;
+    }
+
+    Lin_NodeCfgRuntimeType *cfg = &Lin_NodeCfgRuntime[Channel];
+
+    cfg->NumSteps = NumSteps;
+    cfg->Step = 0;
+    cfg->Retries = 0;
+    cfg->Notification = Notification;
+    cfg->Script = Script; // Set before queueing: the response may come from the next slot
+
+    if (Lin_NodeCfgSend(Channel) != E_OK)
+    {
+        cfg->Script = NULL;
+        return E_NOT_OK;
+    }
+
+    return E_OK;
+}
+
+/**********************************************************
+ * @brief Check whether a configuration script runs on a LIN channel.
+ * @param Channel The LIN channel.
+ * @return `TRUE` while a script runs.
+ **********************************************************/
+boolean Lin_NodeCfgIsBusy(uint8 Channel)
+{
+    if (Channel >= MAX_LIN_CHANNELS)
+    {
+        return FALSE;
+    }
+
+    return (Lin_NodeCfgRuntime[Channel].Script != NULL) ? TRUE : FALSE;
+}
@@ -0,0 +1,128 @@
+/**********************************************************
+ * @file Lin_NodeCfg.h
+ * @brief LIN Node Configuration Service Header File
+ * @details This file contains the definitions for the master-side
+ *          node configuration and identification services of LIN 2.x
+ *          (AssignNAD, AssignFrameIdRange, ReadByIdentifier,
+ *          ConditionalChangeNAD, SaveConfiguration). A configuration
+ *          script is a const array of requests, typically generated
+ *          from the LDF, sent one after the other by LinTp in the
+ *          diagnostic slots of the running schedule table.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef LIN_NODECFG_H
+#define LIN_NODECFG_H
+
+#include "Std_Types.h" /**< @brief Standard AUTOSAR data types */
+#include "LinTp.h"     /**< @brief Transport layer carrying the requests */
+
+/**********************************************************
+ * @brief Pre-compile time parameter settings.
+ **********************************************************/
+#ifndef LIN_NODECFG_RETRIES
+#define LIN_NODECFG_RETRIES 2U /**< @brief Repetitions of a step left without valid response. */
+#endif
+
+/**********************************************************
+ * @brief Service identifiers of the node configuration requests.
+ * @details A positive response carries SID + LIN_NODECFG_RSID_OFFSET,
+ *          a negative response LIN_NODECFG_SID_NEGATIVE_RESPONSE.
+ **********************************************************/
+#define LIN_NODECFG_SID_ASSIGN_NAD 0xB0U             /**< @brief Assign a NAD to the node matching supplier/function ID. */
+#define LIN_NODECFG_SID_READ_BY_ID 0xB2U             /**< @brief Read an identifier (e.g., 0: product ID). */
+#define LIN_NODECFG_SID_CONDITIONAL_CHANGE_NAD 0xB3U /**< @brief Change the NAD if a byte of an identifier matches. */
+#define LIN_NODECFG_SID_SAVE_CONFIGURATION 0xB6U     /**< @brief Store the configuration in the slave's memory. */
+#define LIN_NODECFG_SID_ASSIGN_FRAME_ID_RANGE 0xB7U  /**< @brief Assign the PIDs of up to four frames. */
+#define LIN_NODECFG_RSID_OFFSET 0x40U                /**< @brief Positive response SID offset. */
+#define LIN_NODECFG_SID_NEGATIVE_RESPONSE 0x7FU      /**< @brief Response SID of a rejected request. */
+#define LIN_NODECFG_DATA_LENGTH 5U                   /**< @brief Data bytes after the SID (D1...D5). */
+#define LIN_NODECFG_PID_UNCHANGED 0xFFU              /**< @brief AssignFrameIdRange: keep the current PID. */
+#define LIN_NODECFG_PID_UNASSIGNED 0x00U             /**< @brief AssignFrameIdRange: disable the frame. */
+
+/**********************************************************
+ * @enum Lin_NodeCfgResultType
+ * @brief Result of a configuration script.
+ **********************************************************/
+typedef enum
+{
+    LIN_NODECFG_OK,            /**< @brief All steps answered positively. */
+    LIN_NODECFG_E_NEGATIVE,    /**< @brief A step was answered with a negative or unexpected response. */
+    LIN_NODECFG_E_NO_RESPONSE, /**< @brief A step got no valid response, retries included. */
+    LIN_NODECFG_E_ABORTED      /**< @brief The request could not be queued or was dropped by LinTp_Init. */
+} Lin_NodeCfgResultType;
+
+/**********************************************************
+ * @typedef Lin_NodeCfgStepType
+ * @brief One request of a configuration script.
+ * @details Use the LIN_NODECFG_* initializer macros below.
+ **********************************************************/
+typedef struct
+{
+    uint8 Nad;                             /**< @brief NAD the request is sent to. */
+    uint8 ResponseNad;                     /**< @brief NAD expected in the response. */
+    uint8 Sid;                             /**< @brief Service identifier. */
+    uint8 Data[LIN_NODECFG_DATA_LENGTH];   /**< @brief Request bytes D1...D5. */
+    uint8 *ResponseData;                   /**< @brief ReadByIdentifier: receives D1...D5 of the response, or NULL. */
+} Lin_NodeCfgStepType;
+
+/**********************************************************
+ * @brief Initializers of Lin_NodeCfgStepType.
+ * @details Supplier and function IDs are 16-bit, sent LSB first;
+ *          0x7FFF/0xFFFF are the wildcards.
+ **********************************************************/
+#define LIN_NODECFG_ASSIGN_NAD(Nad, SupplierId, FunctionId, NewNad)                                     \
+    {(Nad), (Nad), LIN_NODECFG_SID_ASSIGN_NAD,                                                        \
+     {(uint8)(SupplierId), (uint8)((SupplierId) >> 8), (uint8)(FunctionId), (uint8)((FunctionId) >> 8), \
+      (NewNad)},                                                                                        \
+     NULL}
+#define LIN_NODECFG_READ_BY_ID(Nad, Identifier, SupplierId, FunctionId, Buffer)                         \
+    {(Nad), (Nad), LIN_NODECFG_SID_READ_BY_ID,                                                        \
+     {(Identifier), (uint8)(SupplierId), (uint8)((SupplierId) >> 8), (uint8)(FunctionId),               \
+      (uint8)((FunctionId) >> 8)},                                                                      \
+     (Buffer)}
+#define LIN_NODECFG_CONDITIONAL_CHANGE_NAD(Nad, Identifier, Byte, Mask, Invert, NewNad)                 \
+    {(Nad), (NewNad), LIN_NODECFG_SID_CONDITIONAL_CHANGE_NAD,                                         \
+     {(Identifier), (Byte), (Mask), (Invert), (NewNad)}, NULL}
+#define LIN_NODECFG_SAVE_CONFIGURATION(Nad)                                                             \
+    {(Nad), (Nad), LIN_NODECFG_SID_SAVE_CONFIGURATION, {0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU}, NULL}
+#define LIN_NODECFG_ASSIGN_FRAME_ID_RANGE(Nad, StartIndex, Pid0, Pid1, Pid2, Pid3)                      \
+    {(Nad), (Nad), LIN_NODECFG_SID_ASSIGN_FRAME_ID_RANGE, {(StartIndex), (Pid0), (Pid1), (Pid2), (Pid3)}, NULL}
+
+/**********************************************************
+ * @typedef Lin_NodeCfgNotificationType
+ * @brief Called when a configuration script is finished.
+ * @details Step is the index of the failed step (NumSteps on success).
+ *          Called from Lin_ScheduleTick, except for LIN_NODECFG_E_ABORTED
+ *          reported by LinTp_Init.
+ **********************************************************/
+typedef void (*Lin_NodeCfgNotificationType)(uint8 Channel, Lin_NodeCfgResultType Result, uint8 Step);
+
+/**********************************************************
+ * @brief Start a configuration script on a LIN channel.
+ * @param Channel The LIN channel.
+ * @param Script Steps executed in order; must stay valid until the script ends.
+ * @param NumSteps Number of steps.
+ * @param Notification Called when the script ends, or NULL.
+ * @return `E_OK` if started, `E_NOT_OK` if a script runs, a parameter is
+ *         invalid or the LinTp queue is full.
+ * @details Non-blocking: each step is queued in LinTp when the previous one is
+ *          answered, and goes out in the MasterReq/SlaveResp slots of the
+ *          running schedule table (e.g., the generated diagnostic table).
+ *          Steps to LINTP_NAD_FUNCTIONAL succeed once sent. The script stops
+ *          at the first step still failing after LIN_NODECFG_RETRIES
+ *          repetitions; a negative response is not repeated.
+ **********************************************************/
+Std_ReturnType Lin_NodeCfgStart(uint8 Channel, const Lin_NodeCfgStepType *Script, uint8 NumSteps,
+                                Lin_NodeCfgNotificationType Notification);
+
+/**********************************************************
+ * @brief Check whether a configuration script runs on a LIN channel.
+ * @param Channel The LIN channel.
+ * @return `TRUE` while a script runs.
+ **********************************************************/
+boolean Lin_NodeCfgIsBusy(uint8 Channel);
+
+#endif /* LIN_NODECFG_H */
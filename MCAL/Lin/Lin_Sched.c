@@ -0,0 +1,350 @@
+/**********************************************************
+ * @file Lin_Sched.c
+ * @brief LIN Master Schedule Table Source File
+ * @details This file contains the schedule table executor:
+ *          slot advancement, table switching at slot boundaries
+ *          and slot overrun detection. MasterReq/SlaveResp slots
+ *          carry the segments of the LIN transport layer (LinTp).
+ *          Event-triggered slots switch to their collision resolution
+ *          table on a collision; sporadic slots send updated frames only.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Lin_Sched.h"
+#include "Lin_Cfg.h"
+#include "LinTp.h"
+
+/**********************************************************
+ * @brief Frame ID bits of a PID.
+ **********************************************************/
+#define LIN_SCHED_FRAME_ID_MASK 0x3FU
+
+/**********************************************************
+ * @struct Lin_ScheduleRuntimeType
+ * @brief Execution state of the schedule of one channel.
+ **********************************************************/
+typedef struct
+{
+    uint8 Table;                           /**< @brief Running table, LIN_SCHED_NULL_TABLE if none. */
+    volatile uint8 RequestedTable;         /**< @brief Table to switch to at the next slot boundary. */
+    volatile boolean SwitchPending;        /**< @brief A table switch was requested. */
+    uint8 Slot;                            /**< @brief Next slot to execute. */
+    const Lin_ScheduleEntryType *Current;  /**< @brief Slot in progress, NULL if none. */
+    volatile uint16 OverrunCount;          /**< @brief Slots whose frame had not completed in time. */
+    boolean Resolving;                     /**< @brief A collision resolution table runs. */
+    uint8 ReturnTable;                     /**< @brief Table resumed once the collision is resolved. */
+    uint8 ReturnSlot;                      /**< @brief Slot resumed once the collision is resolved. */
+    volatile uint16 CollisionCount;        /**< @brief Event-triggered slots with a corrupted response. */
+} Lin_ScheduleRuntimeType;
+
+/**********************************************************
+ * @brief Schedule configuration, one entry per channel.
+ **********************************************************/
+static const Lin_ScheduleConfigType *Lin_ScheduleConfig = NULL;
+
+/**********************************************************
+ * @brief Schedule execution state of each channel.
+ **********************************************************/
+static Lin_ScheduleRuntimeType Lin_ScheduleRuntime[MAX_LIN_CHANNELS];
+
+/**********************************************************
+ * @brief Update flags of the sporadic frames, indexed by channel and frame ID.
+ * @details One byte per flag, so setting and clearing never race.
+ **********************************************************/
+static volatile boolean Lin_ScheduleUpdateFlag[MAX_LIN_CHANNELS][LIN_SCHED_FRAME_ID_MASK + 1U];
+
+/**********************************************************
+ * @brief Initialize the schedule executor.
+ * @param Config Array of MAX_LIN_CHANNELS schedule configurations, one per channel.
+ * @details All channels start with no table running.
+ **********************************************************/
+void Lin_ScheduleInit(const Lin_ScheduleConfigType *Config)
+{
+    Lin_ScheduleConfig = Config;
+
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
+    {
+        Lin_ScheduleRuntime[ch].Table = LIN_SCHED_NULL_TABLE;
+        Lin_ScheduleRuntime[ch].RequestedTable = LIN_SCHED_NULL_TABLE;
+        Lin_ScheduleRuntime[ch].SwitchPending = FALSE;
+        Lin_ScheduleRuntime[ch].Slot = 0;
+        Lin_ScheduleRuntime[ch].Current = NULL;
+        Lin_ScheduleRuntime[ch].OverrunCount = 0;
+        Lin_ScheduleRuntime[ch].Resolving = FALSE;
+        Lin_ScheduleRuntime[ch].CollisionCount = 0;
+        for (uint8 id = 0; id <= LIN_SCHED_FRAME_ID_MASK; id++)
+        {
+            Lin_ScheduleUpdateFlag[ch][id] = FALSE;
+        }
+    }
+}
+
+/**********************************************************
+ * @brief Request a schedule table on a LIN channel.
+ * @param Channel The LIN channel.
+ * @param Table Index of the table, or LIN_SCHED_NULL_TABLE to stop.
+ * @return `E_OK` if accepted, `E_NOT_OK` if the channel or table is invalid.
+ **********************************************************/
+Std_ReturnType Lin_ScheduleRequest(uint8 Channel, uint8 Table)
+{
+    if ((Lin_ScheduleConfig == NULL) || (Channel >= MAX_LIN_CHANNELS))
+    {
+        return E_NOT_OK;
+    }
+    if ((Table != LIN_SCHED_NULL_TABLE) && (Table >= Lin_ScheduleConfig[Channel].NumTables))
+    {
+        return E_NOT_OK;
+    }
+
+    // Picked up by Lin_ScheduleTick at the next slot boundary
+    Lin_ScheduleRuntime[Channel].RequestedTable = Table;
+    Lin_ScheduleRuntime[Channel].SwitchPending = TRUE;
+
+    return E_OK;
+}
+
+/**********************************************************
+ * @brief Result of an event-triggered slot.
+ * @param Channel The LIN channel.
+ * @param entry The event-triggered slot.
+ * @param status Status of the frame at the end of the slot.
+ * @param sdu Received data if status is LIN_RX_OK.
+ * @details A valid response goes to the associated frame named by its first
+ *          byte (its SduPtr, or its signal buffer if SduPtr is NULL). A corrupted one means several slaves answered: the
+ *          collision resolution table runs once from its first slot, then
+ *          the interrupted table resumes where it left off.
+ **********************************************************/
+static void Lin_ScheduleEventResult(uint8 Channel, const Lin_ScheduleEntryType *entry,
+                                    Lin_StatusType status, const uint8 *sdu)
+{
+    Lin_ScheduleRuntimeType *runtime = &Lin_ScheduleRuntime[Channel];
+
+    if (status == LIN_RX_OK)
+    {
+        for (uint8 i = 0; i < entry->NumAssociated; i++)
+        {
+            const Lin_PduType *frame = &entry->Associated[i];
+            if (((frame->Pid ^ sdu[0]) & LIN_SCHED_FRAME_ID_MASK) == 0U)
+            {
+                if (frame->SduPtr != NULL)
+                {
+                    for (uint8 b = 0; b < frame->Dl; b++)
+                    {
+                        frame->SduPtr[b] = sdu[b];
+                    }
+                }
+                else
+                {
+                    // Received frames of a generated configuration live in driver signal buffers
+                    (void)Lin_SignalBufferWrite(Channel, frame->Pid & LIN_SCHED_FRAME_ID_MASK, sdu, frame->Dl);
+                }
+                break;
+            }
+        }
+    }
+    else if (status == LIN_RX_ERROR)
+    {
+        runtime->CollisionCount++;
+        if ((entry->CollisionTable < Lin_ScheduleConfig[Channel].NumTables) && !runtime->Resolving &&
+            !runtime->SwitchPending)
+        {
+            runtime->ReturnTable = runtime->Table;
+            runtime->ReturnSlot = runtime->Slot; // Already the slot after the event-triggered one
+            runtime->Table = entry->CollisionTable;
+            runtime->Slot = 0;
+            runtime->Resolving = TRUE;
+        }
+    }
+}
+
+/**********************************************************
+ * @brief Execute the slot boundary of a LIN channel.
+ * @param Channel The LIN channel.
+ * @return Length of the slot just started, in timer ticks; 0 if no table runs.
+ * @details
+ *  1. Completes the previous slot: copies a received response into the
+ *     frame's SduPtr (SlaveResp: hands it to LinTp; event-triggered: to the
+ *     associated frame, or starts the collision resolution), or counts an
+ *     overrun if the frame is still busy.
+ *  2. Applies a pending table switch.
+ *  3. Starts the header of the next slot and advances the slot index.
+ *     A MasterReq slot is only used when LinTp has a segment to send (it
+ *     is consumed once Lin_SendFrame accepted it), a SlaveResp slot only
+ *     when LinTp waits for a response and a sporadic slot only when one of
+ *     its frames was updated.
+ **********************************************************/
+uint16 Lin_ScheduleTick(uint8 Channel)
+{
+    if ((Lin_ScheduleConfig == NULL) || (Channel >= MAX_LIN_CHANNELS))
+    {
+        return 0;
+    }
+
+    Lin_ScheduleRuntimeType *runtime = &Lin_ScheduleRuntime[Channel];
+
+    // Result of the previous slot
+    if (runtime->Current != NULL)
+    {
+        const uint8 *sdu;
+        Lin_StatusType status = Lin_GetStatus(Channel, &sdu);
+
+        if ((status == LIN_TX_BUSY) || (status == LIN_RX_BUSY))
+        {
+            runtime->OverrunCount++; // Slot too short for the frame; it is aborted by the next one
+        }
+
+        if (runtime->Current->Type == LIN_SCHED_EVENT_TRIGGERED)
+        {
+            Lin_ScheduleEventResult(Channel, runtime->Current, status, sdu);
+        }
+        else if (runtime->Current->Type == LIN_SCHED_SPORADIC)
+        {
+            // Published by the master: nothing to collect
+        }
+        else if ((runtime->Current->Frame.Pid & LIN_SCHED_FRAME_ID_MASK) == LINTP_ID_SLAVE_RESP)
+        {
+            LinTp_SlaveResponseIndication(Channel, (status == LIN_RX_OK) ? sdu : NULL);
+        }
+        else if ((status == LIN_RX_OK) && (runtime->Current->Frame.SduPtr != NULL))
+        {
+            for (uint8 i = 0; i < runtime->Current->Frame.Dl; i++)
+            {
+                runtime->Current->Frame.SduPtr[i] = sdu[i];
+            }
+        }
+        runtime->Current = NULL;
+    }
+
+    // Table switch at the slot boundary
+    if (runtime->SwitchPending)
+    {
+        runtime->SwitchPending = FALSE;
+        runtime->Table = runtime->RequestedTable;
+        runtime->Slot = 0;
+        runtime->Resolving = FALSE; // A requested table also ends a collision resolution
+    }
+
+    if (runtime->Table == LIN_SCHED_NULL_TABLE)
+    {
+        return 0; // Nothing scheduled
+    }
+
+    const Lin_ScheduleTableType *table = &Lin_ScheduleConfig[Channel].Tables[runtime->Table];
+    if (table->NumEntries == 0)
+    {
+        return 0;
+    }
+
+    // Start the slot; diagnostic and sporadic slots stay silent unless they have something to send
+    const Lin_ScheduleEntryType *entry = &table->Entries[runtime->Slot];
+    uint8 id = entry->Frame.Pid & LIN_SCHED_FRAME_ID_MASK;
+    Lin_PduType pdu = entry->Frame;
+    uint8 diagFrame[LINTP_FRAME_LENGTH];
+    boolean send = TRUE;
+    boolean masterReq = FALSE;
+
+    if (entry->Type == LIN_SCHED_SPORADIC)
+    {
+        send = FALSE;
+        for (uint8 i = 0; i < entry->NumAssociated; i++)
+        {
+            uint8 frameId = entry->Associated[i].Pid & LIN_SCHED_FRAME_ID_MASK;
+            if (Lin_ScheduleUpdateFlag[Channel][frameId])
+            {
+                // Cleared before the data is copied, so a newer update is sent next time
+                Lin_ScheduleUpdateFlag[Channel][frameId] = FALSE;
+                pdu = entry->Associated[i];
+                send = TRUE;
+                break;
+            }
+        }
+    }
+    else if (id == LINTP_ID_MASTER_REQ)
+    {
+        send = LinTp_GetMasterRequest(Channel, diagFrame);
+        masterReq = TRUE;
+        pdu.SduPtr = diagFrame; // Copied into the driver buffer by Lin_SendFrame
+        pdu.Dl = LINTP_FRAME_LENGTH;
+    }
+    else if (id == LINTP_ID_SLAVE_RESP)
+    {
+        send = LinTp_IsResponsePending(Channel);
+    }
+
+    if (send && (Lin_SendFrame(Channel, &pdu) == E_OK))
+    {
+        runtime->Current = entry;
+        if (masterReq)
+        {
+            LinTp_MasterRequestSent(Channel); // A segment whose header was refused is sent again next slot
+        }
+    }
+
+    runtime->Slot = (uint8)((runtime->Slot + 1U) % table->NumEntries);
+
+    // Collision resolution table done: back to the interrupted table
+    if (runtime->Resolving && (runtime->Slot == 0U))
+    {
+        runtime->Resolving = FALSE;
+        runtime->Table = runtime->ReturnTable;
+        runtime->Slot = runtime->ReturnSlot;
+    }
+
+    return entry->Delay;
+}
+
+/**********************************************************
+ * @brief Mark the data of a frame as updated (sporadic slots).
+ * @param Channel The LIN channel.
+ * @param FrameId Frame identifier (0...63) of the updated frame.
+ * @return `E_OK` if accepted, `E_NOT_OK` if a parameter is invalid.
+ **********************************************************/
+Std_ReturnType Lin_ScheduleSetUpdateFlag(uint8 Channel, uint8 FrameId)
+{
+    if ((Channel >= MAX_LIN_CHANNELS) || (FrameId > LIN_SCHED_FRAME_ID_MASK))
+    {
+        return E_NOT_OK;
+    }
+
+    Lin_ScheduleUpdateFlag[Channel][FrameId] = TRUE;
+
+    return E_OK;
+}
+
+/**********************************************************
+ * @brief Return and clear the number of event-triggered collisions of a LIN channel.
+ * @param Channel The LIN channel.
+ * @return Number of event-triggered slots whose response was corrupted.
+ **********************************************************/
+uint16 Lin_ScheduleGetAndClearCollisionCount(uint8 Channel)
+{
+    if (Channel >= MAX_LIN_CHANNELS)
+    {
+        return 0;
+    }
+
+    uint16 count = Lin_ScheduleRuntime[Channel].CollisionCount;
+    Lin_ScheduleRuntime[Channel].CollisionCount = 0;
+
+    return count;
+}
+
+/**********************************************************
+ * @brief Return and clear the number of slot overruns of a LIN channel.
+ * @param Channel The LIN channel.
+ * @return Number of slots whose frame was still in progress at the next boundary.
+ **********************************************************/
+uint16 Lin_ScheduleGetAndClearOverrunCount(uint8 Channel)
+{
+    if (Channel >= MAX_LIN_CHANNELS)
+    {
+        return 0;
+    }
+
+    uint16 count = Lin_ScheduleRuntime[Channel].OverrunCount;
+    Lin_ScheduleRuntime[Channel].OverrunCount = 0;
+
+    return count;
+}
@@ -0,0 +1,125 @@
+/**********************************************************
+ * @file Lin_Sched.h
+ * @brief LIN Master Schedule Table Header File
+ * @details This file contains the definitions for the schedule
+ *          table executor running on top of the LIN driver.
+ *          Schedule tables are const arrays of (frame, slot delay)
+ *          entries, typically generated from the LDF; slots can also
+ *          be event-triggered or sporadic.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef LIN_SCHED_H
+#define LIN_SCHED_H
+
+#include "Std_Types.h" /**< @brief Standard AUTOSAR data types */
+#include "Lin.h"       /**< @brief LIN driver used to transmit the headers */
+
+/**********************************************************
+ * @brief Table index requesting that no schedule table runs.
+ **********************************************************/
+#define LIN_SCHED_NULL_TABLE 0xFFU
+
+/**********************************************************
+ * @brief Kinds of schedule slots (Lin_ScheduleEntryType.Type).
+ **********************************************************/
+#define LIN_SCHED_UNCONDITIONAL 0U   /**< @brief Frame sent in every slot (default). */
+#define LIN_SCHED_EVENT_TRIGGERED 1U /**< @brief Header answered only by slaves with updated data. */
+#define LIN_SCHED_SPORADIC 2U        /**< @brief Master frame sent only when its update flag is set. */
+
+/**********************************************************
+ * @typedef Lin_ScheduleEntryType
+ * @brief One slot of a schedule table.
+ * @details Entries initialized with Frame and Delay only are unconditional.
+ *          - Event-triggered: Frame is the event-triggered header (Drc RX);
+ *            the first data byte of a response is the PID of the associated
+ *            frame whose SduPtr receives the data. A corrupted response is a
+ *            collision: CollisionTable then runs once, and the interrupted
+ *            table resumes after the event-triggered slot.
+ *          - Sporadic: Frame is unused; the first associated frame (highest
+ *            priority first) whose update flag is set is sent, and the slot
+ *            stays silent if none is.
+ **********************************************************/
+typedef struct
+{
+    Lin_PduType Frame;             /**< @brief Frame sent at the start of the slot; SduPtr receives RX responses. */
+    uint16 Delay;                  /**< @brief Slot length in ticks of the application timer (e.g., ms). */
+    uint8 Type;                    /**< @brief LIN_SCHED_UNCONDITIONAL, LIN_SCHED_EVENT_TRIGGERED or LIN_SCHED_SPORADIC. */
+    uint8 CollisionTable;          /**< @brief Event-triggered: table resolving collisions, or LIN_SCHED_NULL_TABLE. */
+    const Lin_PduType *Associated; /**< @brief Event-triggered/sporadic: the associated unconditional frames. */
+    uint8 NumAssociated;           /**< @brief Number of associated frames. */
+} Lin_ScheduleEntryType;
+
+/**********************************************************
+ * @typedef Lin_ScheduleTableType
+ * @brief Schedule table: slots executed cyclically.
+ **********************************************************/
+typedef struct
+{
+    const Lin_ScheduleEntryType *Entries; /**< @brief Slots of the table. */
+    uint8 NumEntries;                     /**< @brief Number of slots. */
+} Lin_ScheduleTableType;
+
+/**********************************************************
+ * @typedef Lin_ScheduleConfigType
+ * @brief Schedule tables available on a LIN channel.
+ **********************************************************/
+typedef struct
+{
+    const Lin_ScheduleTableType *Tables; /**< @brief Schedule tables of the channel. */
+    uint8 NumTables;                     /**< @brief Number of schedule tables. */
+} Lin_ScheduleConfigType;
+
+/**********************************************************
+ * @brief Initialize the schedule executor.
+ * @param Config Array of MAX_LIN_CHANNELS schedule configurations, one per channel.
+ **********************************************************/
+void Lin_ScheduleInit(const Lin_ScheduleConfigType *Config);
+
+/**********************************************************
+ * @brief Request a schedule table on a LIN channel.
+ * @param Channel The LIN channel.
+ * @param Table Index of the table, or LIN_SCHED_NULL_TABLE to stop.
+ * @return `E_OK` if accepted, `E_NOT_OK` if the channel or table is invalid.
+ * @details The switch takes effect at the next slot boundary, starting with
+ *          the first slot of the new table.
+ **********************************************************/
+Std_ReturnType Lin_ScheduleRequest(uint8 Channel, uint8 Table);
+
+/**********************************************************
+ * @brief Execute the slot boundary of a LIN channel.
+ * @param Channel The LIN channel.
+ * @return Length of the slot just started, in timer ticks; 0 if no table runs.
+ * @details Call it from a one-shot timer and re-arm the timer with the returned
+ *          delay, so the handler runs once per slot and the header starts at
+ *          the exact slot boundary. A frame still busy at the boundary is
+ *          counted as a slot overrun.
+ **********************************************************/
+uint16 Lin_ScheduleTick(uint8 Channel);
+
+/**********************************************************
+ * @brief Mark the data of a frame as updated (sporadic slots).
+ * @param Channel The LIN channel.
+ * @param FrameId Frame identifier (0...63) of the updated frame.
+ * @return `E_OK` if accepted, `E_NOT_OK` if a parameter is invalid.
+ * @details The flag is cleared when a sporadic slot sends the frame.
+ **********************************************************/
+Std_ReturnType Lin_ScheduleSetUpdateFlag(uint8 Channel, uint8 FrameId);
+
+/**********************************************************
+ * @brief Return and clear the number of event-triggered collisions of a LIN channel.
+ * @param Channel The LIN channel.
+ * @return Number of event-triggered slots whose response was corrupted.
+ **********************************************************/
+uint16 Lin_ScheduleGetAndClearCollisionCount(uint8 Channel);
+
+/**********************************************************
+ * @brief Return and clear the number of slot overruns of a LIN channel.
+ * @param Channel The LIN channel.
+ * @return Number of slots whose frame was still in progress at the next boundary.
+ **********************************************************/
+uint16 Lin_ScheduleGetAndClearOverrunCount(uint8 Channel);
+
+#endif /* LIN_SCHED_H */
@@ -1,9 +1,13 @@
 /**********************************************************
- * @typedef FunctionalState
- * @brief Defines the enable or disable state.
+ * @file Lin_Types.h
+ * @brief LIN-specific data types.
+ * @details FunctionalState (ENABLE/DISABLE) used by the LIN configuration
+ *          is taken from the STM32F10x library instead of being redefined.
  **********************************************************/
-typedef enum
-{
-    DISABLE = 0, /**< Feature is disabled */
-    ENABLE = 1   /**< Feature is enabled */
-} FunctionalState;
+
+#ifndef LIN_TYPES_H
+#define LIN_TYPES_H
+
+#include "stm32f10x.h" /**< @brief Provides FunctionalState */
+
+#endif /* LIN_TYPES_H */
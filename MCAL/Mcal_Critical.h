@@ -0,0 +1,46 @@
+/**********************************************************
+ * @file Mcal_Critical.h
+ * @brief Critical sections shared by the MCAL modules.
+ * @details Masks every interrupt through PRIMASK and restores the
+ *          previous mask on exit, so the sections nest and can be
+ *          entered from task level as well as from a handler.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef MCAL_CRITICAL_H
+#define MCAL_CRITICAL_H
+
+#include "stm32f10x.h" /**< @brief CMSIS core: PRIMASK access */
+#include "Std_Types.h" /**< @brief Standard AUTOSAR data types */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************
+ * @brief Save PRIMASK and disable interrupts.
+ * @return The previous PRIMASK value.
+ **********************************************************/
+static inline uint32 Mcal_EnterCritical(void)
+{
+    uint32 primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+/**********************************************************
+ * @brief Restore the PRIMASK saved by Mcal_EnterCritical.
+ * @param Primask The saved value.
+ **********************************************************/
+static inline void Mcal_ExitCritical(uint32 Primask)
+{
+    __set_PRIMASK(Primask);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MCAL_CRITICAL_H */
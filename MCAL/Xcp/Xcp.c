@@ -0,0 +1,476 @@
+/**********************************************************
+ * @file Xcp.c
+ * @brief XCP-on-CAN Measurement Slave Source File
+ * @details This file contains the function definitions for
+ *          the lightweight XCP slave running on the CAN driver.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Xcp.h"
+#include "Mcal_Critical.h"
+
+/**
+ * @struct Xcp_DtoBufferType
+ * @brief Preallocated buffer holding one packet ready for Can_Write.
+ */
+typedef struct
+{
+    uint8 Length;              /**< Packet length including the PID */
+    uint8 Data[XCP_MAX_DTO];   /**< PID followed by the packet payload */
+} Xcp_DtoBufferType;
+
+/**
+ * @var Xcp_ConfigPtr
+ * @brief Configuration passed to Xcp_Init.
+ */
+static const Xcp_ConfigType *Xcp_ConfigPtr = NULL;
+
+/**
+ * @var Xcp_Connected
+ * @brief TRUE between CONNECT and DISCONNECT.
+ */
+static boolean Xcp_Connected = FALSE;
+
+/**
+ * @var Xcp_DaqRunning
+ * @brief Running state of each DAQ list.
+ */
+static volatile boolean Xcp_DaqRunning[XCP_MAX_DAQ_LISTS];
+
+/**
+ * @var Xcp_DaqSelected
+ * @brief DAQ lists selected for the next START_STOP_SYNCH.
+ */
+static boolean Xcp_DaqSelected[XCP_MAX_DAQ_LISTS];
+
+/**
+ * @var Xcp_FirstPid
+ * @brief Absolute ODT number of the first ODT of each DAQ list, resolved at init.
+ */
+static uint8 Xcp_FirstPid[XCP_MAX_DAQ_LISTS];
+
+/**
+ * @var Xcp_DtoQueue
+ * @brief Preallocated ODT buffers, used as a FIFO of packets awaiting a mailbox.
+ */
+static Xcp_DtoBufferType Xcp_DtoQueue[XCP_DTO_QUEUE_SIZE];
+static uint8 Xcp_DtoHead = 0;   /**< Next buffer to fill */
+static uint8 Xcp_DtoTail = 0;   /**< Next buffer to transmit */
+static uint8 Xcp_DtoCount = 0;  /**< Buffers waiting for transmission */
+
+/**
+ * @var Xcp_CrmBuffer
+ * @brief Pending command response, sent ahead of the DAQ packets.
+ */
+static Xcp_DtoBufferType Xcp_CrmBuffer;
+static boolean Xcp_CrmPending = FALSE;
+
+/**
+ * @var Xcp_OverloadCount
+ * @brief DAQ list samples dropped because the ODT buffers were full.
+ */
+static uint16 Xcp_OverloadCount = 0;
+
+/**
+ * @brief  Hands one packet to the CAN driver.
+ * @retval E_OK if a mailbox accepted the packet, CAN_BUSY/E_NOT_OK otherwise.
+ */
+static Std_ReturnType Xcp_WritePacket(Xcp_DtoBufferType *Packet)
+{
+    Can_PduType pdu;
+
+    pdu.swPduHandle = Xcp_ConfigPtr->TxPduId;
+    pdu.length = Packet->Length;
+    pdu.id = Xcp_ConfigPtr->DtoId;
+    pdu.sdu = Packet->Data;
+
+    return Can_Write(0, &pdu);
+}
+
+/**
+ * @brief  Fills every free transmit mailbox, command response first.
+ * @details Can_Write copies the payload into the mailbox, so a buffer is free
+ *          again as soon as it was accepted.
+ */
+static void Xcp_Transmit(void)
+{
+    uint32 primask = Mcal_EnterCritical();
+
+    if (Xcp_CrmPending)
+    {
+        if (Xcp_WritePacket(&Xcp_CrmBuffer) != E_OK)
+        {
+            Mcal_ExitCritical(primask);
+            return; /**< Retried on the next TX confirmation */
+        }
+        Xcp_CrmPending = FALSE;
+    }
+
+    while (Xcp_DtoCount != 0)
+    {
+        if (Xcp_WritePacket(&Xcp_DtoQueue[Xcp_DtoTail]) != E_OK)
+        {
+            break; /**< All mailboxes busy */
+        }
+        Xcp_DtoTail = (uint8)((Xcp_DtoTail + 1) % XCP_DTO_QUEUE_SIZE);
+        Xcp_DtoCount--;
+    }
+
+    Mcal_ExitCritical(primask);
+}
+
+/**
+ * @brief  Stops all DAQ lists and drops queued DAQ packets.
+ */
+static void Xcp_StopAllDaq(void)
+{
+    uint32 primask = Mcal_EnterCritical();
+
+    for (uint8 i = 0; i < XCP_MAX_DAQ_LISTS; i++)
+    {
+        Xcp_DaqRunning[i] = FALSE;
+        Xcp_DaqSelected[i] = FALSE;
+    }
+    Xcp_DtoHead = 0;
+    Xcp_DtoTail = 0;
+    Xcp_DtoCount = 0;
+
+    Mcal_ExitCritical(primask);
+}
+
+/**
+ * @brief  Reads a little endian (Intel) 16-bit value from a command.
+ */
+static uint16 Xcp_GetWord(const uint8 *Data)
+{
+    return (uint16)(Data[0] | ((uint16)Data[1] << 8));
+}
+
+/**
+ * @brief  Minimum length of a command packet, PID included.
+ * @details Unknown commands only need their PID; they are answered with
+ *          XCP_ERR_CMD_UNKNOWN.
+ */
+static uint8 Xcp_CommandLength(uint8 Command)
+{
+    switch (Command)
+    {
+        case XCP_CMD_CONNECT:               return 2; /**< Mode */
+        case XCP_CMD_SHORT_UPLOAD:          return 8; /**< Count, reserved, extension, address */
+        case XCP_CMD_START_STOP_DAQ_LIST:   return 4; /**< Mode, DAQ list number */
+        case XCP_CMD_START_STOP_SYNCH:      return 2; /**< Mode */
+        default:                            return 1;
+    }
+}
+
+/**
+ * @brief  Queues a command response and starts its transmission.
+ * @details A previous response may still wait for a mailbox while
+ *          Xcp_Transmit runs from the TX confirmation or Xcp_Event, so the
+ *          buffer and its pending flag are replaced with interrupts masked.
+ */
+static void Xcp_Respond(const Xcp_DtoBufferType *Response)
+{
+    uint32 primask = Mcal_EnterCritical();
+
+    Xcp_CrmBuffer = *Response;
+    Xcp_CrmPending = TRUE;
+    Mcal_ExitCritical(primask);
+
+    Xcp_Transmit();
+}
+
+/**
+ * @brief Initializes the XCP slave and resolves the ODT numbering.
+ *
+ * @param[in] Config Pointer to the XCP configuration.
+ */
+void Xcp_Init(const Xcp_ConfigType *Config)
+{
+    uint16 pid = 0;
+
+    /* Validate input parameter */
+    if ((Config == NULL) || (Config->NumDaqLists > XCP_MAX_DAQ_LISTS))
+    {
+        return;
+    }
+
+    Xcp_ConfigPtr = Config;
+    Xcp_Connected = FALSE;
+    uint32 primask = Mcal_EnterCritical();
+    Xcp_CrmPending = FALSE;
+    Xcp_OverloadCount = 0;
+    Mcal_ExitCritical(primask);
+    Xcp_StopAllDaq();
+
+    /* Absolute ODT numbers: the lists are numbered consecutively, PIDs
+       0xFC-0xFF are reserved for EV/SERV/ERR/RES packets */
+    for (uint8 i = 0; i < Config->NumDaqLists; i++)
+    {
+        Xcp_FirstPid[i] = (uint8)pid;
+        pid += Config->DaqLists[i].NumOdts;
+        if (pid > 0xFC)
+        {
+            Xcp_ConfigPtr = NULL; /**< Too many ODTs for absolute numbering */
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Samples all running DAQ lists attached to an event channel.
+ *
+ * @param[in] EventChannel Event channel number.
+ *
+ * @details All ODTs of a list are sampled in one critical section so the
+ *          master sees a consistent snapshot; if the ODT buffers cannot hold
+ *          the whole list the sample is dropped and counted as overload.
+ */
+void Xcp_Event(uint8 EventChannel)
+{
+    if ((Xcp_ConfigPtr == NULL) || !Xcp_Connected)
+    {
+        return;
+    }
+
+    for (uint8 i = 0; i < Xcp_ConfigPtr->NumDaqLists; i++)
+    {
+        const Xcp_DaqListType *daq = &Xcp_ConfigPtr->DaqLists[i];
+
+        if (!Xcp_DaqRunning[i] || (daq->EventChannel != EventChannel))
+        {
+            continue;
+        }
+
+        uint32 primask = Mcal_EnterCritical();
+
+        if ((XCP_DTO_QUEUE_SIZE - Xcp_DtoCount) < daq->NumOdts)
+        {
+            Xcp_OverloadCount++;
+            Mcal_ExitCritical(primask);
+            continue;
+        }
+
+        for (uint8 odt = 0; odt < daq->NumOdts; odt++)
+        {
+            Xcp_DtoBufferType *buffer = &Xcp_DtoQueue[Xcp_DtoHead];
+            uint8 pos = 1;
+
+            buffer->Data[0] = (uint8)(Xcp_FirstPid[i] + odt);
+            for (uint8 e = 0; e < daq->Odts[odt].NumEntries; e++)
+            {
+                const Xcp_OdtEntryType *entry = &daq->Odts[odt].Entries[e];
+
+                for (uint8 b = 0; (b < entry->Size) && (pos < XCP_MAX_DTO); b++)
+                {
+                    buffer->Data[pos++] = entry->Address[b];
+                }
+            }
+            buffer->Length = pos;
+
+            Xcp_DtoHead = (uint8)((Xcp_DtoHead + 1) % XCP_DTO_QUEUE_SIZE);
+            Xcp_DtoCount++;
+        }
+
+        Mcal_ExitCritical(primask);
+    }
+
+    /* Push the sampled ODTs into every free mailbox */
+    Xcp_Transmit();
+}
+
+/**
+ * @brief Processes an XCP command received on the CRO ID.
+ *
+ * @param[in] PduInfo Received L-PDU.
+ */
+void Xcp_RxIndication(const Can_PduType *PduInfo)
+{
+    Xcp_DtoBufferType response;
+    uint8 *res = response.Data;
+    const uint8 *cmd;
+
+    if ((Xcp_ConfigPtr == NULL) || (PduInfo == NULL) || (PduInfo->id != Xcp_ConfigPtr->CroId) || (PduInfo->length == 0))
+    {
+        return; /**< Not an XCP command */
+    }
+
+    cmd = PduInfo->sdu;
+
+    /* Only CONNECT is accepted while disconnected */
+    if (!Xcp_Connected && (cmd[0] != XCP_CMD_CONNECT))
+    {
+        return;
+    }
+
+    res[0] = XCP_PID_RES;
+    response.Length = 1;
+
+    if (PduInfo->length < Xcp_CommandLength(cmd[0]))
+    {
+        res[0] = XCP_PID_ERR;
+        res[1] = XCP_ERR_CMD_SYNTAX;
+        response.Length = 2;
+        Xcp_Respond(&response);
+        return;
+    }
+
+    switch (cmd[0])
+    {
+        case XCP_CMD_CONNECT:
+            Xcp_Connected = TRUE;
+            res[1] = 0x04;                  /**< RESOURCE: DAQ available */
+            res[2] = 0x00;                  /**< COMM_MODE_BASIC: Intel, byte granularity */
+            res[3] = XCP_MAX_CTO;
+            res[4] = (uint8)(XCP_MAX_DTO & 0xFF);
+            res[5] = (uint8)(XCP_MAX_DTO >> 8);
+            res[6] = 0x01;                  /**< Protocol layer version */
+            res[7] = 0x01;                  /**< Transport layer version */
+            response.Length = 8;
+            break;
+
+        case XCP_CMD_DISCONNECT:
+            Xcp_StopAllDaq();
+            Xcp_Connected = FALSE;
+            break;
+
+        case XCP_CMD_GET_STATUS:
+        {
+            uint8 running = 0;
+            for (uint8 i = 0; i < Xcp_ConfigPtr->NumDaqLists; i++)
+            {
+                running |= Xcp_DaqRunning[i];
+            }
+            res[1] = running ? 0x40 : 0x00; /**< SESSION_STATUS: DAQ_RUNNING */
+            res[2] = 0x00;                  /**< No resource protection */
+            res[3] = 0x00;
+            res[4] = 0x00;                  /**< Session configuration ID */
+            res[5] = 0x00;
+            response.Length = 6;
+            break;
+        }
+
+        case XCP_CMD_SHORT_UPLOAD:
+        {
+            uint8 count = cmd[1];
+
+            if ((count == 0) || (count > (XCP_MAX_CTO - 1)))
+            {
+                res[0] = XCP_PID_ERR;
+                res[1] = XCP_ERR_OUT_OF_RANGE;
+                response.Length = 2;
+                break;
+            }
+
+            const volatile uint8 *address = (const volatile uint8 *)(uint32)
+                (cmd[4] | ((uint32)cmd[5] << 8) | ((uint32)cmd[6] << 16) | ((uint32)cmd[7] << 24));
+            for (uint8 b = 0; b < count; b++)
+            {
+                res[1 + b] = address[b];
+            }
+            response.Length = (uint8)(1 + count);
+            break;
+        }
+
+        case XCP_CMD_START_STOP_DAQ_LIST:
+        {
+            uint16 daqList = Xcp_GetWord(&cmd[2]);
+
+            if (daqList >= Xcp_ConfigPtr->NumDaqLists)
+            {
+                res[0] = XCP_PID_ERR;
+                res[1] = XCP_ERR_OUT_OF_RANGE;
+                response.Length = 2;
+                break;
+            }
+
+            switch (cmd[1])
+            {
+                case 0: Xcp_DaqRunning[daqList] = FALSE; break;  /**< Stop */
+                case 1: Xcp_DaqRunning[daqList] = TRUE; break;   /**< Start */
+                case 2: Xcp_DaqSelected[daqList] = TRUE; break;  /**< Select */
+                default:
+                    res[0] = XCP_PID_ERR;
+                    res[1] = XCP_ERR_MODE_NOT_VALID;
+                    response.Length = 2;
+                    break;
+            }
+            if (res[0] == XCP_PID_RES)
+            {
+                res[1] = Xcp_FirstPid[daqList];
+                response.Length = 2;
+            }
+            break;
+        }
+
+        case XCP_CMD_START_STOP_SYNCH:
+            if (cmd[1] > 2)
+            {
+                res[0] = XCP_PID_ERR;
+                res[1] = XCP_ERR_MODE_NOT_VALID;
+                response.Length = 2;
+                break;
+            }
+            for (uint8 i = 0; i < Xcp_ConfigPtr->NumDaqLists; i++)
+            {
+                if (cmd[1] == 0)
+                {
+                    Xcp_DaqRunning[i] = FALSE;                  /**< Stop all */
+                }
+                else if (Xcp_DaqSelected[i])
+                {
+                    Xcp_DaqRunning[i] = (cmd[1] == 1);         /**< Start/stop selected */
+                }
+                Xcp_DaqSelected[i] = FALSE;
+            }
+            break;
+
+        case XCP_CMD_GET_DAQ_PROCESSOR_INFO:
+            res[1] = 0x00;                  /**< DAQ_PROPERTIES: static DAQ lists */
+            res[2] = Xcp_ConfigPtr->NumDaqLists;
+            res[3] = 0x00;
+            res[4] = Xcp_ConfigPtr->NumEventChannels;
+            res[5] = 0x00;
+            res[6] = Xcp_ConfigPtr->NumDaqLists; /**< MIN_DAQ: all lists are predefined */
+            res[7] = 0x00;                  /**< DAQ_KEY_BYTE: absolute ODT number */
+            response.Length = 8;
+            break;
+
+        default:
+            res[0] = XCP_PID_ERR;
+            res[1] = XCP_ERR_CMD_UNKNOWN;
+            response.Length = 2;
+            break;
+    }
+
+    Xcp_Respond(&response);
+}
+
+/**
+ * @brief Continues transmission once a mailbox became free.
+ */
+void Xcp_TxConfirmation(void)
+{
+    if (Xcp_ConfigPtr != NULL)
+    {
+        Xcp_Transmit();
+    }
+}
+
+/**
+ * @brief Returns and clears the DAQ overload counter.
+ *
+ * @return Number of dropped DAQ list samples since the last call.
+ */
+uint16 Xcp_GetAndClearOverloadCount(void)
+{
+    uint32 primask = Mcal_EnterCritical();
+    uint16 count = Xcp_OverloadCount;
+
+    Xcp_OverloadCount = 0;
+    Mcal_ExitCritical(primask);
+
+    return count;
+}
@@ -0,0 +1,156 @@
+/**********************************************************
+ * @file Xcp.h
+ * @brief XCP-on-CAN Measurement Slave Header File
+ * @details This file contains the definitions for a lightweight
+ *          XCP slave running on top of the CAN driver. It supports
+ *          static DAQ lists with pre-resolved addresses, event
+ *          triggered sampling into preallocated ODT buffers and
+ *          back-to-back transmission of the sampled ODTs.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef XCP_H
+#define XCP_H
+
+#include "Std_Types.h"      /**< Type definitions for standard types used across AUTOSAR modules */
+#include "Can.h"            /**< CAN driver used as transport layer */
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*==============================================================================
+ *                              MACROS                                         *
+ ==============================================================================*/
+
+/* Pre-compile time parameter settings */
+#define XCP_MAX_DAQ_LISTS           8       /**< Maximum number of DAQ lists */
+#define XCP_DTO_QUEUE_SIZE          16      /**< Preallocated ODT buffers (one CAN frame each) */
+#define XCP_MAX_DTO                 8       /**< Maximum DTO size = classic CAN payload */
+#define XCP_MAX_CTO                 8       /**< Maximum CTO size = classic CAN payload */
+#define XCP_MAX_ODT_DATA            (XCP_MAX_DTO - 1) /**< ODT payload after the PID byte */
+
+/* Command codes (master -> slave) */
+#define XCP_CMD_CONNECT                 0xFF
+#define XCP_CMD_DISCONNECT              0xFE
+#define XCP_CMD_GET_STATUS              0xFD
+#define XCP_CMD_SHORT_UPLOAD            0xF4
+#define XCP_CMD_START_STOP_DAQ_LIST     0xDE
+#define XCP_CMD_START_STOP_SYNCH        0xDD
+#define XCP_CMD_GET_DAQ_PROCESSOR_INFO  0xDA
+
+/* Packet identifiers (slave -> master) */
+#define XCP_PID_RES                 0xFF    /**< Positive response */
+#define XCP_PID_ERR                 0xFE    /**< Error packet */
+
+/* Error codes */
+#define XCP_ERR_CMD_UNKNOWN         0x20
+#define XCP_ERR_CMD_SYNTAX          0x21
+#define XCP_ERR_OUT_OF_RANGE        0x22
+#define XCP_ERR_MODE_NOT_VALID      0x27
+
+/*==============================================================================
+ *                          TYPE DEFINITIONS                                   *
+ ==============================================================================*/
+
+/**
+ * @struct Xcp_OdtEntryType
+ * @brief One measured variable, resolved to its address at build time.
+ */
+typedef struct
+{
+    const volatile uint8 *Address; /**< Address of the variable */
+    uint8 Size;                    /**< Number of bytes to sample */
+} Xcp_OdtEntryType;
+
+/**
+ * @struct Xcp_OdtType
+ * @brief Object Descriptor Table: variables packed into one DTO.
+ *
+ * The sum of the entry sizes must not exceed XCP_MAX_ODT_DATA.
+ */
+typedef struct
+{
+    const Xcp_OdtEntryType *Entries; /**< Entries sampled into this ODT */
+    uint8 NumEntries;                /**< Number of entries */
+} Xcp_OdtType;
+
+/**
+ * @struct Xcp_DaqListType
+ * @brief Static DAQ list: ODTs sampled together on one event channel.
+ */
+typedef struct
+{
+    const Xcp_OdtType *Odts; /**< ODTs of the list */
+    uint8 NumOdts;           /**< Number of ODTs */
+    uint8 EventChannel;      /**< Event channel triggering the sampling */
+} Xcp_DaqListType;
+
+/**
+ * @struct Xcp_ConfigType
+ * @brief Configuration of the XCP slave.
+ */
+typedef struct
+{
+    Can_IdType CroId;                  /**< CAN ID of commands from the master */
+    Can_IdType DtoId;                  /**< CAN ID of responses and DAQ packets */
+    PduIdType TxPduId;                 /**< swPduHandle used for Can_Write */
+    uint8 NumEventChannels;            /**< Number of event channels */
+    const Xcp_DaqListType *DaqLists;   /**< Static DAQ lists */
+    uint8 NumDaqLists;                 /**< Number of DAQ lists (max XCP_MAX_DAQ_LISTS) */
+} Xcp_ConfigType;
+
+/*==============================================================================
+ *                           FUNCTION PROTOTYPES                               *
+ ==============================================================================*/
+
+/**
+ * @brief  Initializes the XCP slave.
+ * @param  Config: Pointer to the XCP configuration.
+ * @retval None
+ */
+void Xcp_Init(const Xcp_ConfigType *Config);
+
+/**
+ * @brief  Samples all running DAQ lists of an event channel.
+ * @details Copies the ODT entries into preallocated ODT buffers and starts
+ *          transmitting them back-to-back. Call it where the measured
+ *          variables are consistent (e.g., at the end of a 10 ms task).
+ * @param  EventChannel: Event channel number.
+ * @retval None
+ */
+void Xcp_Event(uint8 EventChannel);
+
+/**
+ * @brief  Handles a frame received by the CAN driver.
+ * @details Frames with the configured CRO ID are processed as XCP commands,
+ *          others are ignored. Commands shorter than their fixed part
+ *          are answered with XCP_ERR_CMD_SYNTAX. Call it from the CAN
+ *          RxIndication.
+ * @param  PduInfo: Received L-PDU.
+ * @retval None
+ */
+void Xcp_RxIndication(const Can_PduType *PduInfo);
+
+/**
+ * @brief  Refills the CAN mailboxes after a completed transmission.
+ * @details Call it from the CAN TxConfirmation for the XCP TxPduId.
+ * @retval None
+ */
+void Xcp_TxConfirmation(void);
+
+/**
+ * @brief  Returns and clears the number of DAQ samples dropped since the last call.
+ * @details A sample is dropped as a whole when the ODT buffers cannot hold
+ *          all ODTs of a DAQ list.
+ * @retval Number of dropped DAQ list samples.
+ */
+uint16 Xcp_GetAndClearOverloadCount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XCP_H */
@@ -0,0 +1,530 @@
+#!/usr/bin/env python3
+"""LIN configuration generator: LDF -> C tables for the LIN driver.
+
+Reads a LIN Description File and emits, for one node of the cluster,
+Lin_<Cluster>_Cfg.h and Lin_<Cluster>_Cfg.c containing:
+
+  - the frame table (const Lin_PduType, protected IDs precomputed),
+  - the schedule tables (const Lin_ScheduleEntryType / Lin_ScheduleTableType),
+    including event-triggered and sporadic slots with their associated frames
+    (the associated frames of an event-triggered frame must share length and
+    checksum model and leave byte 0 free for the protected ID),
+  - for the master, the node configuration script (const Lin_NodeCfgStepType)
+    built from the Node_attributes: AssignNAD for slaves whose initial NAD
+    differs from the configured one, then AssignFrameIdRange for their
+    configurable frames, four at a time,
+  - for a slave node, the 64-entry response table indexed by frame ID,
+  - one frame buffer per published frame and one double-buffered
+    Lin_SignalBufferType per received frame, with the 64-entry signal
+    buffer table for Lin_ConfigType (the only RAM used),
+  - get/set codecs for every signal, reduced to shifts and masks; each
+    received frame gets an update flag accessor and a snapshot accessor
+    returning the front half of its buffer, from which its signal getters
+    decode in place.
+
+Every object is defined exactly once, in the generated .c file; the
+header only declares them. Nothing is built at startup.
+
+Usage:
+  ldf2c.py cluster.ldf [--node Master] [--cluster Body] [--tick-ms 1] [-o outdir]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+DIAG_FRAMES = {"MasterReq": 0x3C, "SlaveResp": 0x3D}
+
+
+def protected_id(frame_id):
+    """Frame ID with the two parity bits (same values as Lin_PidTable)."""
+    bit = lambda n: (frame_id >> n) & 1
+    p0 = bit(0) ^ bit(1) ^ bit(2) ^ bit(4)
+    p1 = 1 - (bit(1) ^ bit(3) ^ bit(4) ^ bit(5))
+    return frame_id | (p0 << 6) | (p1 << 7)
+
+
+# ------------------------------------------------------------------------------
+# Parsing
+# ------------------------------------------------------------------------------
+
+TOKEN_RE = re.compile(r'"[^"]*"|[A-Za-z_][A-Za-z0-9_]*|0[xX][0-9A-Fa-f]+|\d+(?:\.\d+)?|[{}();:,=]')
+
+
+def tokenize(text):
+    text = re.sub(r"/\*.*?\*/", " ", text, flags=re.S)
+    text = re.sub(r"//[^\n]*", " ", text)
+    return TOKEN_RE.findall(text)
+
+
+def to_int(token):
+    return int(token, 0)
+
+
+def find_block(tokens, name):
+    """Token list between the braces of a top-level 'name { ... }' section."""
+    depth = 0
+    for i, tok in enumerate(tokens):
+        if tok == "{":
+            depth += 1
+        elif tok == "}":
+            depth -= 1
+        elif depth == 1 and tok == name and i + 1 < len(tokens) and tokens[i + 1] == "{":
+            return matching_block(tokens, i + 1)[0]
+    return []
+
+
+def matching_block(tokens, start):
+    """Content of the brace block opening at tokens[start], and the index after it."""
+    depth = 0
+    for i in range(start, len(tokens)):
+        if tokens[i] == "{":
+            depth += 1
+        elif tokens[i] == "}":
+            depth -= 1
+            if depth == 0:
+                return tokens[start + 1:i], i + 1
+    raise ValueError("unbalanced braces")
+
+
+def split_statements(tokens):
+    """Split on ';' at brace depth 0; a statement may contain brace groups."""
+    out, cur, depth = [], [], 0
+    for tok in tokens:
+        if tok == "{":
+            depth += 1
+        elif tok == "}":
+            depth -= 1
+        if tok == ";" and depth == 0:
+            if cur:
+                out.append(cur)
+            cur = []
+        else:
+            cur.append(tok)
+    if cur:
+        out.append(cur)
+    return out
+
+
+def parse_ldf(text):
+    tokens = tokenize(text)
+    # The whole file is one block: LIN_description_file ; ... (no outer braces)
+    tokens = ["{"] + tokens + ["}"]
+    ldf = {"version": "2.1", "speed": 19200, "master": None, "slaves": [],
+           "signals": {}, "frames": {}, "schedules": [], "sporadic": {}, "event": {}, "attributes": {}}
+
+    for i, tok in enumerate(tokens):
+        if tok == "LIN_protocol_version" and tokens[i + 1] == "=":
+            ldf["version"] = tokens[i + 2].strip('"')
+        elif tok == "LIN_speed" and tokens[i + 1] == "=":
+            ldf["speed"] = int(round(float(tokens[i + 2]) * 1000))
+
+    for stmt in split_statements(find_block(tokens, "Nodes")):
+        if stmt[0] == "Master":
+            ldf["master"] = stmt[2]
+        elif stmt[0] == "Slaves":
+            ldf["slaves"] = [t for t in stmt[2:] if t != ","]
+
+    for stmt in split_statements(find_block(tokens, "Signals")):
+        name, size = stmt[0], to_int(stmt[2])
+        rest = stmt[4:]
+        if rest and rest[0] == "{":
+            _, end = matching_block(rest, 0)
+            rest = rest[end:]
+        else:
+            rest = rest[1:]
+        nodes = [t for t in rest if t != ","]
+        ldf["signals"][name] = {"size": size, "publisher": nodes[0], "subscribers": nodes[1:]}
+
+    body = find_block(tokens, "Frames")
+    i = 0
+    while i < len(body):
+        name = body[i]
+        frame_id, publisher, length = to_int(body[i + 2]), body[i + 4], to_int(body[i + 6])
+        content, i = matching_block(body, i + 7)
+        signals = [(stmt[0], to_int(stmt[2])) for stmt in split_statements(content)]
+        ldf["frames"][name] = {"id": frame_id, "publisher": publisher, "length": length, "signals": signals}
+
+    # name: frame, frame ... ; (highest priority first)
+    for stmt in split_statements(find_block(tokens, "Sporadic_frames")):
+        ldf["sporadic"][stmt[0]] = [t for t in stmt[2:] if t != ","]
+
+    # name: [collision_resolving_table,] frame_id, frame ... ; (the table is LIN 2.1 only)
+    for stmt in split_statements(find_block(tokens, "Event_triggered_frames")):
+        rest = [t for t in stmt[2:] if t != ","]
+        table = None
+        if not rest[0][0].isdigit():
+            table, rest = rest[0], rest[1:]
+        ldf["event"][stmt[0]] = {"id": to_int(rest[0]), "table": table, "frames": rest[1:]}
+
+    body = find_block(tokens, "Schedule_tables")
+    i = 0
+    while i < len(body):
+        name = body[i]
+        content, i = matching_block(body, i + 1)
+        entries = []
+        for stmt in split_statements(content):
+            if "delay" not in stmt:
+                continue
+            d = stmt.index("delay")
+            entries.append((stmt[0], float(stmt[d + 1])))
+        ldf["schedules"].append((name, entries))
+
+    # node { configured_NAD = x; initial_NAD = x; product_id = supplier, function[, variant];
+    #        configurable_frames { frame[ = message_id]; ... } ... }
+    body = find_block(tokens, "Node_attributes")
+    i = 0
+    while i < len(body):
+        name = body[i]
+        content, i = matching_block(body, i + 1)
+        attr = {"configured_nad": None, "initial_nad": None, "product_id": None, "frames": []}
+        for j in range(len(content) - 2):
+            if content[j + 1] != "=":
+                continue
+            if content[j] == "configured_NAD":
+                attr["configured_nad"] = to_int(content[j + 2])
+            elif content[j] == "initial_NAD":
+                attr["initial_nad"] = to_int(content[j + 2])
+            elif content[j] == "product_id":
+                attr["product_id"] = (to_int(content[j + 2]), to_int(content[j + 4]))
+        if "configurable_frames" in content:
+            k = content.index("configurable_frames")
+            frames, _ = matching_block(content, k + 1)
+            attr["frames"] = [stmt[0] for stmt in split_statements(frames)]
+        ldf["attributes"][name] = attr
+
+    return ldf
+
+
+# ------------------------------------------------------------------------------
+# Code generation
+# ------------------------------------------------------------------------------
+
+def response_type(ldf, frame, node):
+    if frame["publisher"] == node:
+        return "LIN_FRAMERESPONSE_TX"
+    if node == ldf["master"]:
+        return "LIN_FRAMERESPONSE_RX"  # The master sees every slave response
+    for sig, _ in frame["signals"]:
+        if node in ldf["signals"][sig]["subscribers"]:
+            return "LIN_FRAMERESPONSE_RX"
+    return "LIN_FRAMERESPONSE_IGNORE"
+
+
+def checksum_model(ldf, frame_id):
+    if frame_id in DIAG_FRAMES.values() or ldf["version"].startswith("1."):
+        return "LIN_CLASSIC_CS"
+    return "LIN_ENHANCED_CS"
+
+
+def check_event_triggered(ldf):
+    """Reasons why the event-triggered frames cannot be scheduled, if any.
+
+    The slot is received with one Dl and checksum model whichever slave
+    answers, and byte 0 of the response carries the protected ID of the
+    associated frame, so no signal may start there.
+    """
+    errors = []
+    for name, event in ldf["event"].items():
+        frames = [ldf["frames"][f] for f in event["frames"]]
+        if len({frame["length"] for frame in frames}) > 1:
+            errors.append("{}: associated frames differ in length".format(name))
+        if len({checksum_model(ldf, frame["id"]) for frame in frames}) > 1:
+            errors.append("{}: associated frames differ in checksum model".format(name))
+        for frame_name, frame in zip(event["frames"], frames):
+            for sig, offset in frame["signals"]:
+                if offset < 8:
+                    errors.append("{}: signal {} of {} overlaps the PID in byte 0".format(name, sig, frame_name))
+    return errors
+
+
+def codec(prefix, frame_buf, sig, offset, size, received):
+    """Inline get/set functions of one signal: one shift/mask per byte touched.
+
+    A received signal only gets a getter, decoding from the frame snapshot
+    passed by the caller, so all signals read from one snapshot come from the
+    same response.
+    """
+    if size > 32:
+        return []  # Byte arrays are accessed through the frame buffer directly
+    ctype = "uint8" if size <= 8 else ("uint16" if size <= 16 else "uint32")
+    get, put = [], []
+    bit, pos = offset, 0
+    while pos < size:
+        byte, shift = bit // 8, bit % 8
+        width = min(8 - shift, size - pos)
+        mask = (1 << width) - 1
+        get.append("((uint32)(({buf}[{b}] >> {s}) & 0x{m:02X}U) << {p})".format(
+            buf=frame_buf, b=byte, s=shift, m=mask, p=pos))
+        put.append("    {buf}[{b}] = (uint8)(({buf}[{b}] & 0x{k:02X}U) | (((value >> {p}) & 0x{m:02X}U) << {s}));".format(
+            buf=frame_buf, b=byte, k=(~(mask << shift)) & 0xFF, p=pos, m=mask, s=shift))
+        bit += width
+        pos += width
+    if received:
+        return [
+            "static inline {t} {pfx}_Get_{sig}(const uint8 *frame)".format(t=ctype, pfx=prefix, sig=sig),
+            "{",
+            "    return ({t})({expr});".format(t=ctype, expr=" | ".join(get).replace(frame_buf, "frame")),
+            "}",
+            "",
+        ]
+    return [
+        "static inline {t} {pfx}_Get_{sig}(void)".format(t=ctype, pfx=prefix, sig=sig),
+        "{",
+        "    return ({t})({expr});".format(t=ctype, expr=" | ".join(get)),
+        "}",
+        "",
+        "static inline void {pfx}_Set_{sig}({t} value)".format(t=ctype, pfx=prefix, sig=sig),
+        "{",
+    ] + put + ["}", ""]
+
+
+def update_flag(prefix, frame, buf):
+    """Test-and-clear of the update flag of a received frame."""
+    return [
+        "static inline boolean {}_IsUpdated_{}(void)".format(prefix, frame),
+        "{",
+        "    if (!{}.Updated)".format(buf),
+        "    {",
+        "        return FALSE;",
+        "    }",
+        "    {}.Updated = FALSE; /* Cleared before the signals are read */".format(buf),
+        "    return TRUE;",
+        "}",
+        "",
+    ]
+
+
+def snapshot(prefix, frame, buf):
+    """Front half of a received frame's signal buffer, for its signal getters."""
+    return [
+        "static inline const uint8 *{}_Snapshot_{}(void)".format(prefix, frame),
+        "{",
+        "    return {0}.Data[{0}.Front]; /* Front read once; this half is not written again before the second next response */".format(buf),
+        "}",
+        "",
+    ]
+
+
+def node_config_script(ldf):
+    """Master configuration steps: (initializer macro, comment) per step."""
+    steps = []
+    for slave in ldf["slaves"]:
+        attr = ldf["attributes"].get(slave)
+        if attr is None or attr["configured_nad"] is None:
+            continue
+        nad = attr["configured_nad"]
+        initial = attr["initial_nad"]
+        if initial is not None and initial != nad and attr["product_id"] is not None:
+            supplier, function = attr["product_id"]
+            steps.append(("LIN_NODECFG_ASSIGN_NAD(0x{:02X}U, 0x{:04X}U, 0x{:04X}U, 0x{:02X}U)".format(
+                initial, supplier, function, nad), "{}: NAD 0x{:02X} -> 0x{:02X}".format(slave, initial, nad)))
+        for start in range(0, len(attr["frames"]), 4):
+            chunk = attr["frames"][start:start + 4]
+            pids = []
+            for name in chunk:
+                frame_id = ldf["frames"][name]["id"] if name in ldf["frames"] else \
+                    ldf["event"][name]["id"] if name in ldf["event"] else None
+                pids.append("LIN_NODECFG_PID_UNCHANGED" if frame_id is None else "0x{:02X}U".format(protected_id(frame_id)))
+            pids += ["LIN_NODECFG_PID_UNCHANGED"] * (4 - len(pids))
+            steps.append(("LIN_NODECFG_ASSIGN_FRAME_ID_RANGE(0x{:02X}U, {}U, {})".format(nad, start, ", ".join(pids)),
+                          "{}: {}".format(slave, ", ".join(chunk))))
+    return steps
+
+
+def generate(ldf, node, cluster, tick_ms):
+    prefix = "Lin_" + cluster
+    guard = "LIN_" + cluster.upper() + "_CFG_H"
+    is_master = node == ldf["master"]
+    script = node_config_script(ldf) if is_master else []
+
+    # Frames relevant to the node, plus diagnostic frames used by the schedules
+    frames = []
+    for name, frame in ldf["frames"].items():
+        drc = response_type(ldf, frame, node)
+        if is_master or drc != "LIN_FRAMERESPONSE_IGNORE":
+            frames.append((name, frame["id"], frame["length"], drc, frame["signals"]))
+    used = {cmd for _, entries in ldf["schedules"] for cmd, _ in entries}
+    for name, frame_id in DIAG_FRAMES.items():
+        if is_master and name in used:
+            drc = "LIN_FRAMERESPONSE_TX" if name == "MasterReq" else "LIN_FRAMERESPONSE_RX"
+            frames.append((name, frame_id, 8, drc, []))
+    index = {name: i for i, (name, *_rest) in enumerate(frames)}
+    # Received frames with signals live in driver signal buffers, the others in plain buffers
+    buffered = {name for name, _, _, drc, signals in frames if drc == "LIN_FRAMERESPONSE_RX" and signals}
+
+    h, c = [], []
+    h += ["/**********************************************************",
+          " * @file {}_Cfg.h".format(prefix),
+          " * @brief LIN cluster {} configuration, node {}.".format(cluster, node),
+          " * @details Generated by Tools/LinCfgGen/ldf2c.py - do not edit.",
+          " **********************************************************/",
+          "",
+          "#ifndef " + guard,
+          "#define " + guard,
+          "",
+          '#include "Lin.h"',
+          '#include "Lin_Sched.h"'] + (['#include "Lin_NodeCfg.h"'] if script else []) + [
+          "",
+          "#define {}_BAUDRATE {}U".format(prefix.upper(), ldf["speed"]),
+          ""]
+    for name, i in index.items():
+        h.append("#define {}_FRAME_{} {}U".format(prefix.upper(), name.upper(), i))
+    h.append("")
+    for name, frame_id, *_rest in frames:
+        h.append("#define {}_ID_{} 0x{:02X}U".format(prefix.upper(), name.upper(), frame_id))
+    h.append("")
+
+    c += ["/**********************************************************",
+          " * @file {}_Cfg.c".format(prefix),
+          " * @brief LIN cluster {} configuration, node {}.".format(cluster, node),
+          " * @details Generated by Tools/LinCfgGen/ldf2c.py - do not edit.",
+          " **********************************************************/",
+          "",
+          '#include "{}_Cfg.h"'.format(prefix),
+          "",
+          "/* Frame buffers (RAM) */"]
+    for name, _, length, _, _ in frames:
+        if name in buffered:
+            h.append("extern Lin_SignalBufferType {}_Buffer_{};".format(prefix, name))
+            c.append("Lin_SignalBufferType {}_Buffer_{};".format(prefix, name))
+        else:
+            h.append("extern uint8 {}_Data_{}[{}];".format(prefix, name, length))
+            c.append("uint8 {}_Data_{}[{}];".format(prefix, name, length))
+    h += ["", "extern const Lin_PduType {}_Frames[{}];".format(prefix, len(frames))]
+
+    def sdu(name):
+        return "NULL" if name in buffered else "{}_Data_{}".format(prefix, name)
+
+    c += ["", "/* Frame table (flash) */",
+          "const Lin_PduType {}_Frames[{}] = {{".format(prefix, len(frames))]
+    for name, frame_id, length, drc, _ in frames:
+        c.append("    {{0x{:02X}, {}, {}, {}, {}}}, /* {} */".format(
+            protected_id(frame_id), checksum_model(ldf, frame_id), drc, length, sdu(name), name))
+    c += ["};", ""]
+
+    c += ["/* Signal buffer table for Lin_ConfigType, indexed by frame ID (flash) */",
+          "Lin_SignalBufferType *const {}_SignalBufferTable[64] = {{".format(prefix)]
+    for name, frame_id, *_rest in frames:
+        if name in buffered:
+            c.append("    [0x{:02X}] = &{}_Buffer_{},".format(frame_id, prefix, name))
+    c += ["};", ""]
+    h += ["extern Lin_SignalBufferType *const {}_SignalBufferTable[64];".format(prefix)]
+
+    if is_master:
+        h.append("")
+        tables = {table: t for t, (table, _) in enumerate(ldf["schedules"])}
+
+        def pdu(name):
+            frame_id, length, drc = frames[index[name]][1], frames[index[name]][2], frames[index[name]][3]
+            return "{{0x{:02X}, {}, {}, {}, {}}}".format(
+                protected_id(frame_id), checksum_model(ldf, frame_id), drc, length, sdu(name))
+
+        # Associated frames of the event-triggered and sporadic slots
+        special = [cmd for cmd in sorted(used) if cmd in ldf["sporadic"] or cmd in ldf["event"]]
+        if special:
+            c.append("/* Frames associated with event-triggered and sporadic slots (flash) */")
+        for cmd in special:
+            assoc = ldf["sporadic"][cmd] if cmd in ldf["sporadic"] else ldf["event"][cmd]["frames"]
+            c.append("static const Lin_PduType {}_Associated_{}[] = {{".format(prefix, cmd))
+            for name in assoc:
+                c.append("    {},".format(pdu(name)))
+            c += ["};", ""]
+
+        c.append("/* Schedule tables (flash) */")
+        for t, (table, entries) in enumerate(ldf["schedules"]):
+            h.append("#define {}_TABLE_{} {}U".format(prefix.upper(), table.upper(), t))
+            c.append("static const Lin_ScheduleEntryType {}_Schedule_{}[] = {{".format(prefix, table))
+            for cmd, delay in entries:
+                ticks = max(1, int(round(delay / tick_ms)))
+                if cmd in ldf["sporadic"]:
+                    c.append("    {{{{0x00, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 0, NULL}}, {}U, LIN_SCHED_SPORADIC, "
+                             "LIN_SCHED_NULL_TABLE, {}_Associated_{}, {}U}}, /* {} */".format(
+                                 ticks, prefix, cmd, len(ldf["sporadic"][cmd]), cmd))
+                    continue
+                if cmd in ldf["event"]:
+                    event = ldf["event"][cmd]
+                    resolve = event["table"]
+                    c.append("    {{{{0x{:02X}, {}, LIN_FRAMERESPONSE_RX, {}, NULL}}, {}U, LIN_SCHED_EVENT_TRIGGERED, "
+                             "{}, {}_Associated_{}, {}U}}, /* {} */".format(
+                                 protected_id(event["id"]), checksum_model(ldf, event["id"]),
+                                 ldf["frames"][event["frames"][0]]["length"], ticks,
+                                 "{}_TABLE_{}".format(prefix.upper(), resolve.upper()) if resolve in tables
+                                 else "LIN_SCHED_NULL_TABLE",
+                                 prefix, cmd, len(event["frames"]), cmd))
+                    continue
+                if cmd not in index:
+                    c.append("    /* {}: command not supported by the driver, skipped */".format(cmd))
+                    continue
+                c.append("    {{{}, {}U, LIN_SCHED_UNCONDITIONAL, LIN_SCHED_NULL_TABLE, NULL, 0U}},".format(pdu(cmd), ticks))
+            c += ["};", ""]
+        c.append("static const Lin_ScheduleTableType {}_ScheduleTables[] = {{".format(prefix))
+        for table, _ in ldf["schedules"]:
+            c.append("    {{{0}_Schedule_{1}, (uint8)(sizeof({0}_Schedule_{1}) / sizeof({0}_Schedule_{1}[0]))}},".format(prefix, table))
+        c += ["};", "",
+              "const Lin_ScheduleConfigType {0}_ScheduleConfig = {{{0}_ScheduleTables, {1}}};".format(
+                  prefix, len(ldf["schedules"])), ""]
+        h += ["", "extern const Lin_ScheduleConfigType {}_ScheduleConfig;".format(prefix)]
+
+        if script:
+            c += ["/* Node configuration script for Lin_NodeCfgStart, sent in the diagnostic slots (flash) */",
+                  "const Lin_NodeCfgStepType {}_NodeCfgScript[{}] = {{".format(prefix, len(script))]
+            for step, comment in script:
+                c.append("    {}, /* {} */".format(step, comment))
+            c += ["};", ""]
+            h += ["", "#define {}_NODECFG_STEPS {}U".format(prefix.upper(), len(script)),
+                  "extern const Lin_NodeCfgStepType {}_NodeCfgScript[{}];".format(prefix, len(script))]
+    else:
+        c += ["/* Slave response table, indexed by frame ID (flash) */",
+              "const Lin_PduType {}_SlaveResponseTable[64] = {{".format(prefix)]
+        for name, frame_id, length, drc, _ in frames:
+            c.append("    [0x{:02X}] = {{0x{:02X}, {}, {}, {}, {}}},".format(
+                frame_id, protected_id(frame_id), checksum_model(ldf, frame_id), drc, length, sdu(name)))
+        c += ["};", ""]
+        h += ["", "extern const Lin_PduType {}_SlaveResponseTable[64];".format(prefix)]
+
+    h += ["", "/* Signal codecs */", ""]
+    for name, _, _, _, signals in frames:
+        if name in buffered:
+            h += update_flag(prefix, name, "{}_Buffer_{}".format(prefix, name))
+            h += snapshot(prefix, name, "{}_Buffer_{}".format(prefix, name))
+        for sig, offset in signals:
+            buf = "{}_Buffer_{}".format(prefix, name) if name in buffered else "{}_Data_{}".format(prefix, name)
+            h += codec(prefix, buf, sig, offset, ldf["signals"][sig]["size"], name in buffered)
+    h += ["#endif /* {} */".format(guard), ""]
+
+    return "\n".join(h), "\n".join(c)
+
+
+def main(argv):
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("ldf", help="LIN description file")
+    ap.add_argument("--node", help="node to generate for (default: the master)")
+    ap.add_argument("--cluster", help="cluster name used in identifiers (default: LDF file name)")
+    ap.add_argument("--tick-ms", type=float, default=1.0, help="period of the schedule timer tick in ms")
+    ap.add_argument("-o", "--outdir", default=".", help="output directory")
+    args = ap.parse_args(argv)
+
+    with open(args.ldf) as f:
+        ldf = parse_ldf(f.read())
+
+    node = args.node or ldf["master"]
+    if node != ldf["master"] and node not in ldf["slaves"]:
+        sys.exit("unknown node: " + node)
+    errors = check_event_triggered(ldf)
+    if errors:
+        sys.exit("\n".join(errors))
+    cluster = args.cluster or re.sub(r"\W", "_", os.path.splitext(os.path.basename(args.ldf))[0])
+
+    header, source = generate(ldf, node, cluster, args.tick_ms)
+    os.makedirs(args.outdir, exist_ok=True)
+    base = os.path.join(args.outdir, "Lin_{}_Cfg".format(cluster))
+    with open(base + ".h", "w") as f:
+        f.write(header)
+    with open(base + ".c", "w") as f:
+        f.write(source)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""LIN monitor decoder: Lin_MonitorRecordType records -> text.
+
+Reads the records collected by the LIN driver in monitor mode
+(Lin_MonitorRead), stored back to back as they are laid out in the
+STM32 memory: 20 bytes each, little-endian,
+
+  uint32 Timestamp   DWT cycle count at the break detection
+  uint8  Channel
+  uint8  Pid         protected identifier as received
+  uint8  Count       bytes after the PID (data and checksum)
+  uint8  Flags       LIN_MONITOR_* flags
+  uint8  Bytes[9]    data bytes followed by the checksum
+  (3 padding bytes)
+
+and prints one line per frame: time since the first frame, channel,
+frame ID, data, checksum and what was wrong with the frame. The 32-bit
+cycle counter wraps; the time stays correct as long as consecutive
+records are less than half a wrap apart (about 30 s at 72 MHz).
+
+Usage:
+  lindecode.py records.bin [--clock 72000000]
+"""
+
+import argparse
+import struct
+import sys
+
+RECORD = struct.Struct("<IBBBB9s3x")
+
+HEADER_OK = 0x01
+CLASSIC_OK = 0x02
+ENHANCED_OK = 0x04
+LINE_ERROR = 0x08
+LOST = 0x10
+IDLE = 0x20
+
+
+def parity_ok(pid):
+    """Check the two parity bits of a protected identifier."""
+    bit = [(pid >> i) & 1 for i in range(8)]
+    p0 = bit[0] ^ bit[1] ^ bit[2] ^ bit[4]
+    p1 = 1 ^ bit[1] ^ bit[3] ^ bit[4] ^ bit[5]
+    return bit[6] == p0 and bit[7] == p1
+
+
+def describe(pid, count, flags, data):
+    """Text for one record, without the timestamp and channel."""
+    text = "ID 0x{:02X} (PID 0x{:02X})".format(pid & 0x3F, pid)
+    if count >= 2:
+        text += "  data {}  cs 0x{:02X}".format(" ".join("{:02X}".format(b) for b in data[:count - 1]),
+                                                 data[count - 1])
+    elif count == 1:
+        text += "  byte 0x{:02X}".format(data[0])
+
+    problems = []
+    if not flags & HEADER_OK:
+        problems.append("bad parity" if not parity_ok(pid) else "bad header")
+    elif count == 0:
+        problems.append("no response")
+    elif flags & (CLASSIC_OK | ENHANCED_OK):
+        text += "  " + ("enhanced" if flags & ENHANCED_OK else "classic")
+    else:
+        problems.append("bad checksum")
+    if flags & LINE_ERROR:
+        problems.append("line error")
+    if flags & IDLE:
+        problems.append("idle inside response")
+    if flags & LOST:
+        problems.append("frames lost before")
+    if problems:
+        text += "  [" + ", ".join(problems) + "]"
+    return text
+
+
+def decode(blob, clock):
+    """Yield one text line per record."""
+    first = None
+    previous = None
+    elapsed = 0
+    usable = len(blob) - len(blob) % RECORD.size
+    for offset in range(0, usable, RECORD.size):
+        timestamp, channel, pid, count, flags, data = RECORD.unpack_from(blob, offset)
+        if first is None:
+            first = previous = timestamp
+        # Signed difference: tolerates records stored slightly out of order by two channels
+        elapsed += (timestamp - previous + 0x80000000) % 0x100000000 - 0x80000000
+        previous = timestamp
+        yield "{:12.6f} ms  ch{}  {}".format(elapsed * 1000.0 / clock, channel,
+                                             describe(pid, min(count, 9), flags, data))
+
+
+def main(argv):
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("records", help="binary dump of Lin_MonitorRecordType records ('-' for stdin)")
+    ap.add_argument("--clock", type=float, default=72e6, help="core clock in Hz (DWT cycle counter)")
+    args = ap.parse_args(argv)
+
+    if args.records == "-":
+        blob = sys.stdin.buffer.read()
+    else:
+        with open(args.records, "rb") as f:
+            blob = f.read()
+    if len(blob) % RECORD.size:
+        sys.stderr.write("warning: {} trailing bytes ignored\n".format(len(blob) % RECORD.size))
+
+    for line in decode(blob, args.clock):
+        print(line)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
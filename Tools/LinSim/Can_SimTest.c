@@ -0,0 +1,516 @@
+/**********************************************************
+ * @file Can_SimTest.c
+ * @brief Functional tests of the CAN driver on the host simulator.
+ * @details Each test runs in its own process (the driver and the simulator
+ *          keep static state) and drives the unmodified driver through its
+ *          API against the bxCAN1 model: transmission and reception, every
+ *          Can_SetControllerMode transition, the status change interrupt
+ *          (sleep acknowledge, wake-up with and without AWUM, errors) and
+ *          pretended networking.
+ *          Usage: can_sim_test [name], without a name every test runs.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Sim.h"
+#include "Can.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**********************************************************
+ * @brief Test assertion: reports the failed condition with the simulated time.
+ **********************************************************/
+#define CHECK(cond)                                                              \
+    do                                                                           \
+    {                                                                            \
+        if (!(cond))                                                             \
+        {                                                                        \
+            Sim_Fail("%s:%d: %s", __FILE__, __LINE__, #cond);                    \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                               \
+    do                                                                           \
+    {                                                                            \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);          \
+        if (a_ != e_)                                                            \
+        {                                                                        \
+            Sim_Fail("%s:%d: %s is %lld, expected %lld", __FILE__, __LINE__,     \
+                     #actual, a_, e_);                                           \
+        }                                                                        \
+    } while (0)
+
+#define BIT_NS 7000U        /**< @brief Can_ConfigData: 36 MHz / 18 / 14 tq. */
+#define TIMEOUT_NS 20000000U
+#define TEST_ID_EXTENDED 0x80000000UL /**< @brief Extended ID flag of Can_IdType (private to Can.c). */
+
+/**********************************************************
+ * @brief Notifications recorded by the callbacks.
+ **********************************************************/
+static struct
+{
+    uint32 RxCount;
+    Can_HwType RxMailbox;
+    Can_IdType RxId;
+    uint8 RxLength;
+    uint8 RxData[8];
+    uint32 TxCount;
+    PduIdType TxPdu;
+    uint32 WakeupCount;
+    uint32 ErrorCount;
+    Can_ErrorStateType ErrorState;
+    Can_ErrorType LastError;
+} Test_Events;
+
+static void Test_RxIndication(const Can_HwType *Mailbox, const Can_PduType *PduInfo)
+{
+    Test_Events.RxCount++;
+    Test_Events.RxMailbox = *Mailbox;
+    Test_Events.RxId = PduInfo->id;
+    Test_Events.RxLength = PduInfo->length;
+    memcpy(Test_Events.RxData, PduInfo->sdu, PduInfo->length);
+}
+
+static void Test_TxConfirmation(PduIdType TxPduId)
+{
+    Test_Events.TxCount++;
+    Test_Events.TxPdu = TxPduId;
+}
+
+static void Test_WakeupNotification(uint8 Controller)
+{
+    CHECK_EQ(Controller, 0);
+    Test_Events.WakeupCount++;
+}
+
+static void Test_ErrorNotification(uint8 Controller, Can_ErrorStateType ErrorState, Can_ErrorType LastError)
+{
+    CHECK_EQ(Controller, 0);
+    Test_Events.ErrorCount++;
+    Test_Events.ErrorState = ErrorState;
+    Test_Events.LastError = LastError;
+}
+
+/**********************************************************
+ * @brief Can_ConfigData with the callbacks of the tests; kept static, the driver keeps the pointer.
+ **********************************************************/
+static Can_ConfigType Test_Config;
+
+static void Test_Init(FunctionalState Awum, const Can_PnWakeupFrameType *Frames, uint8 NumFrames)
+{
+    Test_Config = Can_ConfigData;
+    Test_Config.Can_HardwareConfig.CAN_AWUM = Awum;
+    Test_Config.Can_NotificationConfig.RxIndication = Test_RxIndication;
+    Test_Config.Can_NotificationConfig.TxConfirmation = Test_TxConfirmation;
+    Test_Config.Can_NotificationConfig.WakeupNotification = Test_WakeupNotification;
+    Test_Config.Can_NotificationConfig.ErrorStateNotification = Test_ErrorNotification;
+    Test_Config.Can_PartialNetworkConfig.Frames = Frames;
+    Test_Config.Can_PartialNetworkConfig.NumFrames = NumFrames;
+    memset(&Test_Events, 0, sizeof(Test_Events));
+
+    Can_Init(&Test_Config);
+    Can_EnableControllerInterrupts(0);
+}
+
+static boolean Test_CanIdle(void *Arg)
+{
+    (void)Arg;
+    return Sim_CanIdle();
+}
+
+static void Test_RunIdle(void)
+{
+    CHECK(Sim_RunUntil(Test_CanIdle, NULL, TIMEOUT_NS));
+    Sim_Run(10000U); // Interrupts of the last frame
+}
+
+static Can_ControllerStateType Test_Mode(void)
+{
+    Can_ControllerStateType mode = CAN_CS_UNINIT;
+    CHECK_EQ(Can_GetControllerMode(0, &mode), E_OK);
+    return mode;
+}
+
+static uint32 Test_IsrEntries(IRQn_Type IRQn)
+{
+    Sim_StatsType stats;
+    Sim_GetStats(&stats);
+    return stats.Entries[IRQn];
+}
+
+static Std_ReturnType Test_Write(Can_IdType Id, PduIdType Pdu, const uint8 *Data, uint8 Length)
+{
+    Can_PduType pdu = {.swPduHandle = Pdu, .length = Length, .id = Id, .sdu = (uint8 *)Data};
+    return Can_Write(0, &pdu);
+}
+
+static void Test_CheckTxFrame(uint32 Index, uint32 Id, boolean Extended, const uint8 *Data, uint8 Dlc)
+{
+    const Sim_CanFrameType *frame = Sim_CanTxFrame(Index);
+
+    CHECK(frame != NULL);
+    CHECK_EQ(frame->Id, Id);
+    CHECK_EQ(frame->Extended, Extended);
+    CHECK_EQ(frame->Dlc, Dlc);
+    CHECK(memcmp(frame->Data, Data, Dlc) == 0);
+    CHECK_EQ(frame->End - frame->Start, ((Extended ? 67U : 47U) + 8U * Dlc) * (uint64)BIT_NS);
+}
+
+/**********************************************************
+ * @brief Frames both ways: mailboxes in request order (TXFP), confirmation, filters, indication.
+ **********************************************************/
+static void Test_TxRx(void)
+{
+    static const uint8 data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+
+    Test_Init(ENABLE, NULL, 0);
+    CHECK_EQ(Test_Mode(), CAN_CS_STARTED);
+
+    CHECK_EQ(Test_Write(0x300, 1, data, 8), E_OK);
+    CHECK_EQ(Test_Write(0x18DAF110UL | TEST_ID_EXTENDED, 2, data, 3), E_OK);
+    CHECK_EQ(Test_Write(0x100, 3, data, 0), E_OK);
+    CHECK_EQ(Test_Write(0x101, 4, data, 1), CAN_BUSY); // Three mailboxes
+    Test_RunIdle();
+
+    CHECK_EQ(Sim_CanTxCount(), 3);
+    Test_CheckTxFrame(0, 0x300, FALSE, data, 8);
+    Test_CheckTxFrame(1, 0x18DAF110UL, TRUE, data, 3);
+    Test_CheckTxFrame(2, 0x100, FALSE, data, 0);
+    CHECK_EQ(Test_Events.TxCount, 3);
+    CHECK_EQ(Test_Events.TxPdu, 3);
+
+    Sim_CanSendFrame(0x321, FALSE, data, 5);
+    Sim_CanSendFrame(0x1ABCDE, TRUE, data + 4, 4);
+    Test_RunIdle();
+    CHECK_EQ(Test_Events.RxCount, 2);
+    CHECK_EQ(Test_Events.RxId, 0x1ABCDEUL | TEST_ID_EXTENDED);
+    CHECK_EQ(Test_Events.RxMailbox.CanId, 0x1ABCDEUL | TEST_ID_EXTENDED);
+    CHECK_EQ(Test_Events.RxMailbox.Hoh, 0);
+    CHECK_EQ(Test_Events.RxLength, 4);
+    CHECK(memcmp(Test_Events.RxData, data + 4, 4) == 0);
+    CHECK_EQ(CAN1->RF0R & CAN_RF0R_FMP0, 0);
+}
+
+/**********************************************************
+ * @brief STOPPED is initialization mode: off the bus until STARTED.
+ **********************************************************/
+static void Test_StopStart(void)
+{
+    static const uint8 data[2] = {0xA5, 0x5A};
+
+    Test_Init(ENABLE, NULL, 0);
+
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_STOPPED), E_OK);
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK), CAN_MSR_INAK);
+    CHECK_EQ(Test_Mode(), CAN_CS_STOPPED);
+    CHECK_EQ(Test_Write(0x123, 1, data, 2), E_NOT_OK);
+    Sim_CanSendFrame(0x200, FALSE, data, 2);
+    Test_RunIdle();
+    CHECK_EQ(Test_Events.RxCount, 0);
+    CHECK_EQ(Sim_CanTxCount(), 0);
+
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_STARTED), E_OK);
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK), 0);
+    CHECK_EQ(CAN1->MCR & (CAN_MCR_INRQ | CAN_MCR_SLEEP), 0);
+    CHECK_EQ(Test_Mode(), CAN_CS_STARTED);
+    CHECK_EQ(Test_Write(0x123, 1, data, 2), E_OK);
+    Sim_CanSendFrame(0x200, FALSE, data, 2);
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), 1);
+    CHECK_EQ(Test_Events.TxCount, 1);
+    CHECK_EQ(Test_Events.RxCount, 1);
+
+    // STOPPED from Sleep mode wakes the hardware into initialization mode
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_SLEEP), E_OK);
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_STOPPED), E_OK);
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK), CAN_MSR_INAK);
+}
+
+/**********************************************************
+ * @brief SLEEP: sleep acknowledge, SLAKI handled once, software wake-up.
+ **********************************************************/
+static void Test_Sleep(void)
+{
+    static const uint8 data[1] = {0x01};
+
+    Test_Init(ENABLE, NULL, 0);
+
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_SLEEP), E_OK);
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK | CAN_MSR_SLAKI), CAN_MSR_SLAK | CAN_MSR_SLAKI);
+    CHECK_EQ(Test_Mode(), CAN_CS_SLEEP);
+    Sim_Run(10000U);
+    CHECK_EQ(Test_IsrEntries(CAN1_SCE_IRQn), 1);
+    CHECK_EQ(CAN1->MSR & CAN_MSR_SLAKI, 0);
+    CHECK_EQ(Test_Mode(), CAN_CS_SLEEP);
+    CHECK_EQ(Test_Events.WakeupCount, 0);
+    CHECK_EQ(Can_CheckWakeup(0), E_NOT_OK);
+    CHECK_EQ(Test_Write(0x123, 1, data, 1), E_NOT_OK);
+
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_STARTED), E_OK);
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK | CAN_MSR_SLAKI), 0);
+    CHECK_EQ(Test_Mode(), CAN_CS_STARTED);
+    CHECK_EQ(Can_CheckWakeup(0), E_OK);
+    CHECK_EQ(Test_Events.WakeupCount, 0);
+
+    // Sleep entered behind the driver: the SLAKI handler updates the cached state
+    CAN1->MCR |= CAN_MCR_SLEEP;
+    CHECK_EQ(Test_Mode(), CAN_CS_STARTED);
+    Sim_Run(10000U);
+    CHECK_EQ(Test_IsrEntries(CAN1_SCE_IRQn), 2);
+    CHECK_EQ(Test_Mode(), CAN_CS_SLEEP);
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_STARTED), E_OK);
+
+    // Without SLKIE there is no SLAKI
+    CAN_ITConfig(CAN1, CAN_IT_SLK, DISABLE);
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_SLEEP), E_OK);
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_SLAK | CAN_MSR_SLAKI), CAN_MSR_SLAK);
+    Sim_Run(10000U);
+    CHECK_EQ(Test_IsrEntries(CAN1_SCE_IRQn), 2);
+}
+
+/**********************************************************
+ * @brief Bus activity in Sleep mode with AWUM: the hardware wakes up, the frame is lost.
+ **********************************************************/
+static void Test_WakeupAwum(void)
+{
+    static const uint8 data[2] = {0x12, 0x34};
+
+    Test_Init(ENABLE, NULL, 0);
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_SLEEP), E_OK);
+    Sim_Run(10000U);
+
+    Sim_CanSendFrame(0x321, FALSE, data, 2);
+    Test_RunIdle();
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_SLAK | CAN_MSR_WKUI | CAN_MSR_INAK), 0);
+    CHECK_EQ(CAN1->MCR & CAN_MCR_SLEEP, 0);
+    CHECK_EQ(Test_IsrEntries(CAN1_SCE_IRQn), 2); // SLAKI, then WKUI
+    CHECK_EQ(Test_Mode(), CAN_CS_STARTED);
+    CHECK_EQ(Test_Events.WakeupCount, 1);
+    CHECK_EQ(Test_Events.RxCount, 0);
+    CHECK_EQ(Can_CheckWakeup(0), E_OK);
+
+    Sim_CanSendFrame(0x321, FALSE, data, 2);
+    Test_RunIdle();
+    CHECK_EQ(Test_Events.RxCount, 1);
+    CHECK_EQ(Test_Events.WakeupCount, 1);
+}
+
+/**********************************************************
+ * @brief Bus activity in Sleep mode without AWUM: reported, the software wakes the controller.
+ **********************************************************/
+static void Test_WakeupNoAwum(void)
+{
+    static const uint8 data[2] = {0x12, 0x34};
+
+    Test_Init(DISABLE, NULL, 0);
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_SLEEP), E_OK);
+
+    Sim_CanSendFrame(0x321, FALSE, data, 2);
+    Test_RunIdle();
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_SLAK | CAN_MSR_WKUI), CAN_MSR_SLAK);
+    CHECK_EQ(Test_Mode(), CAN_CS_SLEEP);
+    CHECK_EQ(Test_Events.WakeupCount, 1);
+    CHECK_EQ(Test_Events.RxCount, 0);
+    CHECK_EQ(Can_CheckWakeup(0), E_OK);
+    CHECK_EQ(Can_CheckWakeup(0), E_NOT_OK); // Pending wake-up consumed, still asleep
+
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_STARTED), E_OK);
+    CHECK_EQ(Test_Mode(), CAN_CS_STARTED);
+    Sim_CanSendFrame(0x321, FALSE, data, 2);
+    Test_RunIdle();
+    CHECK_EQ(Test_Events.RxCount, 1);
+}
+
+/**********************************************************
+ * @brief UNINIT: master reset to the reset values, Can_Init starts again.
+ **********************************************************/
+static void Test_Uninit(void)
+{
+    static const uint8 data[1] = {0x5A};
+
+    Test_Init(ENABLE, NULL, 0);
+
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_UNINIT), E_OK);
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK), CAN_MSR_SLAK);
+    CHECK_EQ(CAN1->MCR, 0x00010002UL);
+    CHECK_EQ(CAN1->IER, 0);
+    CHECK_EQ(CAN1->BTR, 0x01230000UL);
+    CHECK_EQ(Test_Mode(), CAN_CS_UNINIT);
+    CHECK_EQ(Test_Write(0x123, 1, data, 1), E_NOT_OK);
+    Sim_Run(10000U);
+    CHECK_EQ(Test_IsrEntries(CAN1_SCE_IRQn), 0);
+
+    Test_Init(ENABLE, NULL, 0);
+    CHECK_EQ(Test_Mode(), CAN_CS_STARTED);
+    CHECK_EQ(Test_Write(0x123, 1, data, 1), E_OK);
+    Test_RunIdle();
+    CHECK_EQ(Test_Events.TxCount, 1);
+}
+
+/**********************************************************
+ * @brief Pretended networking: pending frames aborted, only a validated wake-up frame wakes.
+ **********************************************************/
+static void Test_PnSleep(void)
+{
+    static const Can_PnWakeupFrameType frames[1] = {
+        {.Id = 0x6A0, .Mask = 0x7FF, .MinLength = 2, .DataPattern = {0x01}, .DataMask = {0x01}, .PnClusterMask = {0, 0x04}},
+    };
+    static const uint8 data[2] = {0x01, 0x04};
+    static const uint8 noCluster[2] = {0x01, 0x02};
+
+    Test_Init(ENABLE, frames, 1);
+
+    CHECK_EQ(Test_Write(0x110, 1, data, 2), E_OK);
+    CHECK_EQ(Test_Write(0x111, 2, data, 2), E_OK);
+    CHECK_EQ(Test_Write(0x112, 3, data, 2), E_OK);
+    Sim_Run(10000U); // First frame on the bus
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_SLEEP), E_OK);
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), 1);
+    CHECK_EQ(Test_Events.TxCount, 1);
+    CHECK_EQ(Test_Events.TxPdu, 1);
+    CHECK_EQ(CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2), CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2);
+
+    // Reported asleep, the hardware keeps listening
+    CHECK_EQ(Test_Mode(), CAN_CS_SLEEP);
+    CHECK_EQ(CAN1->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK), 0);
+    CHECK_EQ(Test_Write(0x110, 1, data, 2), E_NOT_OK);
+    CHECK_EQ(Can_CheckWakeup(0), E_NOT_OK);
+
+    uint32 rxIsr = Test_IsrEntries(USB_LP_CAN1_RX0_IRQn);
+    Sim_CanSendFrame(0x6A1, FALSE, data, 2); // Filtered out by the bank
+    Test_RunIdle();
+    CHECK_EQ(Test_IsrEntries(USB_LP_CAN1_RX0_IRQn), rxIsr);
+    Sim_CanSendFrame(0x6A0, FALSE, noCluster, 2); // Passes the bank, not the payload check
+    Test_RunIdle();
+    CHECK_EQ(Test_IsrEntries(USB_LP_CAN1_RX0_IRQn), rxIsr + 1U);
+    CHECK_EQ(Test_Events.WakeupCount, 0);
+    Sim_CanSendFrame(0x6A0, FALSE, data, 2);
+    Test_RunIdle();
+    CHECK_EQ(Test_Events.WakeupCount, 1);
+    CHECK_EQ(Test_Events.RxCount, 0);
+    CHECK_EQ(Can_CheckWakeup(0), E_OK);
+    CHECK_EQ(Can_CheckWakeup(0), E_NOT_OK);
+
+    // STARTED restores the accept-all filter
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_STARTED), E_OK);
+    CHECK_EQ(Test_Mode(), CAN_CS_STARTED);
+    Sim_CanSendFrame(0x6A1, FALSE, data, 2);
+    Test_RunIdle();
+    CHECK_EQ(Test_Events.RxCount, 1);
+    CHECK_EQ(Test_Events.RxId, 0x6A1);
+
+    // STOPPED also pretends
+    CHECK_EQ(Can_SetControllerMode(0, CAN_CS_STOPPED), E_OK);
+    CHECK_EQ(Test_Mode(), CAN_CS_STOPPED);
+    CHECK_EQ(CAN1->MSR & CAN_MSR_INAK, 0);
+}
+
+/**********************************************************
+ * @brief Error interrupt: statistics, state notifications, silent recovery.
+ **********************************************************/
+static void Test_Errors(void)
+{
+    Can_ErrorStatisticsType stats;
+    Can_ErrorStateType state;
+
+    Test_Init(ENABLE, NULL, 0);
+
+    Sim_CanSetErrors(100, 0, 3); // Warning level, acknowledgment error
+    Sim_Run(10000U);
+    CHECK_EQ(Test_IsrEntries(CAN1_SCE_IRQn), 1);
+    CHECK_EQ(CAN1->MSR & CAN_MSR_ERRI, 0);
+    CHECK_EQ(CAN1->ESR & CAN_ESR_LEC, CAN_ESR_LEC); // Re-armed
+    CHECK_EQ(Test_Events.ErrorCount, 0);
+
+    Sim_CanSetErrors(130, 5, 3);
+    Sim_Run(10000U);
+    CHECK_EQ(Test_Events.ErrorCount, 1);
+    CHECK_EQ(Test_Events.ErrorState, CAN_ERRORSTATE_PASSIVE);
+    CHECK_EQ(Test_Events.LastError, CAN_ERROR_CHECK_ACK_FAILED);
+
+    Sim_CanSetErrors(256, 5, 5);
+    Sim_Run(10000U);
+    CHECK_EQ(Test_IsrEntries(CAN1_SCE_IRQn), 3);
+    CHECK_EQ(Test_Events.ErrorCount, 2);
+    CHECK_EQ(Test_Events.ErrorState, CAN_ERRORSTATE_BUSOFF);
+    CHECK_EQ(Test_Events.LastError, CAN_ERROR_BIT_MONITORING);
+    CHECK_EQ(Can_GetControllerErrorState(0, &state), E_OK);
+    CHECK_EQ(state, CAN_ERRORSTATE_BUSOFF);
+
+    CHECK_EQ(Can_GetErrorStatistics(0, &stats), E_OK);
+    CHECK_EQ(stats.ErrorCount[CAN_ERROR_CHECK_ACK_FAILED], 2);
+    CHECK_EQ(stats.ErrorCount[CAN_ERROR_BIT_MONITORING], 1);
+    CHECK_EQ(stats.Tec, 255);
+    CHECK_EQ(stats.TecPeak, 255);
+    CHECK_EQ(stats.TecTrend, CAN_ERRORTREND_RISING);
+    CHECK_EQ(stats.Rec, 5);
+
+    // Recovery raises no interrupt: seen by the main function
+    Sim_CanSetErrors(0, 0, 0);
+    Sim_Run(10000U);
+    CHECK_EQ(Test_IsrEntries(CAN1_SCE_IRQn), 3);
+    CHECK_EQ(Test_Events.ErrorCount, 2);
+    Can_MainFunction_BusOff();
+    CHECK_EQ(Test_Events.ErrorCount, 3);
+    CHECK_EQ(Test_Events.ErrorState, CAN_ERRORSTATE_ACTIVE);
+}
+
+static const struct
+{
+    const char *Name;
+    void (*Run)(void);
+} Test_List[] = {
+    {"tx_rx", Test_TxRx},
+    {"stop_start", Test_StopStart},
+    {"sleep", Test_Sleep},
+    {"wakeup_awum", Test_WakeupAwum},
+    {"wakeup_no_awum", Test_WakeupNoAwum},
+    {"uninit", Test_Uninit},
+    {"pn_sleep", Test_PnSleep},
+    {"errors", Test_Errors},
+};
+
+#define TEST_COUNT (sizeof(Test_List) / sizeof(Test_List[0]))
+
+int main(int argc, char **argv)
+{
+    unsigned failed = 0;
+    unsigned run = 0;
+
+    for (unsigned i = 0; i < TEST_COUNT; i++)
+    {
+        if ((argc > 1) && (strcmp(argv[1], Test_List[i].Name) != 0))
+        {
+            continue;
+        }
+
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            Sim_Init();
+            Test_List[i].Run();
+            _exit(0);
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        boolean ok = (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) ? TRUE : FALSE;
+        printf("%-28s %s\n", Test_List[i].Name, ok ? "ok" : "FAILED");
+        failed += ok ? 0U : 1U;
+        run++;
+    }
+
+    if (run == 0U)
+    {
+        fprintf(stderr, "no test named %s\n", argv[1]);
+        return 2;
+    }
+    printf("%u tests, %u failed\n", run, failed);
+    return (failed == 0U) ? 0 : 1;
+}
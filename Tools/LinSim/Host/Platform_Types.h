@@ -0,0 +1,49 @@
+/**********************************************************
+ * @file Platform_Types.h
+ * @brief AUTOSAR platform types of the host build.
+ * @details MCAL/Std_Types.h relies on the toolchain's platform types; the
+ *          simulator build includes this header first (-include) in every
+ *          translation unit.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef PLATFORM_TYPES_H
+#define PLATFORM_TYPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Std_Types.h defines NULL itself */
+#undef NULL
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+typedef int8_t sint8;
+typedef int16_t sint16;
+typedef int32_t sint32;
+typedef int64_t sint64;
+typedef uint8 boolean;
+
+#ifndef TRUE
+#define TRUE 1U
+#endif
+#ifndef FALSE
+#define FALSE 0U
+#endif
+
+typedef uint8 Std_ReturnType;
+
+typedef struct
+{
+    uint16 vendorID;
+    uint16 moduleID;
+    uint8 sw_major_version;
+    uint8 sw_minor_version;
+    uint8 sw_patch_version;
+} Std_VersionInfoType;
+
+#endif /* PLATFORM_TYPES_H */
@@ -0,0 +1,575 @@
+/**********************************************************
+ * @file stm32f10x.h
+ * @brief Host replacement of the STM32F10x device header and SPL subset.
+ * @details Declares the registers used by the LIN and CAN drivers with the
+ *          CMSIS layout and the real peripheral addresses. The simulator
+ *          (Sim_Core.c) maps these addresses on the host and traps every
+ *          access, so the driver runs unmodified against the register
+ *          models of Sim_Periph.c. The CMSIS core functions and the SPL
+ *          functions used by the driver are host functions of the
+ *          simulator.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef STM32F10X_H
+#define STM32F10X_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __IO volatile
+
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {ERROR = 0, SUCCESS = !ERROR} ErrorStatus;
+
+/**********************************************************
+ * @brief Interrupt numbers (STM32F10x medium density).
+ **********************************************************/
+typedef enum
+{
+    EXTI3_IRQn = 9,
+    DMA1_Channel1_IRQn = 11,
+    DMA1_Channel2_IRQn = 12,
+    DMA1_Channel3_IRQn = 13,
+    DMA1_Channel4_IRQn = 14,
+    DMA1_Channel5_IRQn = 15,
+    DMA1_Channel6_IRQn = 16,
+    DMA1_Channel7_IRQn = 17,
+    CAN1_TX_IRQn = 19,         /**< @brief USB_HP_CAN1_TX_IRQn, named as in the CAN driver. */
+    USB_LP_CAN1_RX0_IRQn = 20,
+    CAN1_SCE_IRQn = 22,
+    TIM2_IRQn = 28,
+    TIM3_IRQn = 29,
+    TIM4_IRQn = 30,
+    USART1_IRQn = 37,
+    USART2_IRQn = 38,
+    USART3_IRQn = 39,
+    EXTI15_10_IRQn = 40
+} IRQn_Type;
+
+/**********************************************************
+ * @brief Peripheral register blocks.
+ **********************************************************/
+typedef struct
+{
+    __IO uint32_t CRL, CRH, IDR, ODR, BSRR, BRR, LCKR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t EVCR, MAPR, EXTICR[4];
+} AFIO_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t IMR, EMR, RTSR, FTSR, SWIER, PR;
+} EXTI_TypeDef;
+
+typedef struct
+{
+    __IO uint16_t SR;
+    uint16_t RESERVED0;
+    __IO uint16_t DR;
+    uint16_t RESERVED1;
+    __IO uint16_t BRR;
+    uint16_t RESERVED2;
+    __IO uint16_t CR1;
+    uint16_t RESERVED3;
+    __IO uint16_t CR2;
+    uint16_t RESERVED4;
+    __IO uint16_t CR3;
+    uint16_t RESERVED5;
+    __IO uint16_t GTPR;
+    uint16_t RESERVED6;
+} USART_TypeDef;
+
+typedef struct
+{
+    __IO uint16_t CR1;
+    uint16_t RESERVED0;
+    __IO uint16_t CR2;
+    uint16_t RESERVED1;
+    __IO uint16_t SMCR;
+    uint16_t RESERVED2;
+    __IO uint16_t DIER;
+    uint16_t RESERVED3;
+    __IO uint16_t SR;
+    uint16_t RESERVED4;
+    __IO uint16_t EGR;
+    uint16_t RESERVED5;
+    __IO uint16_t CCMR1;
+    uint16_t RESERVED6;
+    __IO uint16_t CCMR2;
+    uint16_t RESERVED7;
+    __IO uint16_t CCER;
+    uint16_t RESERVED8;
+    __IO uint16_t CNT;
+    uint16_t RESERVED9;
+    __IO uint16_t PSC;
+    uint16_t RESERVED10;
+    __IO uint16_t ARR;
+    uint16_t RESERVED11;
+    __IO uint16_t RCR;
+    uint16_t RESERVED12;
+    __IO uint16_t CCR1;
+    uint16_t RESERVED13;
+    __IO uint16_t CCR2;
+    uint16_t RESERVED14;
+    __IO uint16_t CCR3;
+    uint16_t RESERVED15;
+    __IO uint16_t CCR4;
+    uint16_t RESERVED16;
+} TIM_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CCR, CNDTR, CPAR, CMAR;
+    uint32_t RESERVED;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t ISR, IFCR;
+} DMA_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t TIR, TDTR, TDLR, TDHR;
+} CAN_TxMailBox_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t RIR, RDTR, RDLR, RDHR;
+} CAN_FIFOMailBox_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t FR1, FR2;
+} CAN_FilterRegister_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t MCR, MSR, TSR, RF0R, RF1R, IER, ESR, BTR;
+    uint32_t RESERVED0[88];
+    CAN_TxMailBox_TypeDef sTxMailBox[3];
+    CAN_FIFOMailBox_TypeDef sFIFOMailBox[2];
+    uint32_t RESERVED1[12];
+    __IO uint32_t FMR, FM1R;
+    uint32_t RESERVED2;
+    __IO uint32_t FS1R;
+    uint32_t RESERVED3;
+    __IO uint32_t FFA1R;
+    uint32_t RESERVED4;
+    __IO uint32_t FA1R;
+    uint32_t RESERVED5[8];
+    CAN_FilterRegister_TypeDef sFilterRegister[14];
+} CAN_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR, CFGR, CIR, APB2RSTR, APB1RSTR, AHBENR, APB2ENR, APB1ENR, BDCR, CSR;
+} RCC_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CTRL, CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR;
+} CoreDebug_Type;
+
+/**********************************************************
+ * @brief Peripheral addresses.
+ **********************************************************/
+#define TIM2_BASE 0x40000000UL
+#define TIM3_BASE 0x40000400UL
+#define TIM4_BASE 0x40000800UL
+#define USART2_BASE 0x40004400UL
+#define USART3_BASE 0x40004800UL
+#define CAN1_BASE 0x40006400UL
+#define CAN2_BASE 0x40006800UL /**< @brief Connectivity line only: declared for the driver, not modelled. */
+#define AFIO_BASE 0x40010000UL
+#define EXTI_BASE 0x40010400UL
+#define GPIOA_BASE 0x40010800UL
+#define GPIOB_BASE 0x40010C00UL
+#define USART1_BASE 0x40013800UL
+#define DMA1_BASE 0x40020000UL
+#define DMA1_Channel1_BASE 0x40020008UL
+#define RCC_BASE 0x40021000UL
+#define DWT_BASE 0xE0001000UL
+#define CoreDebug_BASE 0xE000EDF0UL
+
+#define TIM2 ((TIM_TypeDef *)TIM2_BASE)
+#define TIM3 ((TIM_TypeDef *)TIM3_BASE)
+#define TIM4 ((TIM_TypeDef *)TIM4_BASE)
+#define USART1 ((USART_TypeDef *)USART1_BASE)
+#define USART2 ((USART_TypeDef *)USART2_BASE)
+#define USART3 ((USART_TypeDef *)USART3_BASE)
+#define CAN1 ((CAN_TypeDef *)CAN1_BASE)
+#define CAN2 ((CAN_TypeDef *)CAN2_BASE)
+#define AFIO ((AFIO_TypeDef *)AFIO_BASE)
+#define EXTI ((EXTI_TypeDef *)EXTI_BASE)
+#define GPIOA ((GPIO_TypeDef *)GPIOA_BASE)
+#define GPIOB ((GPIO_TypeDef *)GPIOB_BASE)
+#define DMA1 ((DMA_TypeDef *)DMA1_BASE)
+#define DMA1_Channel1 ((DMA_Channel_TypeDef *)(DMA1_Channel1_BASE + 0x00UL))
+#define DMA1_Channel2 ((DMA_Channel_TypeDef *)(DMA1_Channel1_BASE + 0x14UL))
+#define DMA1_Channel3 ((DMA_Channel_TypeDef *)(DMA1_Channel1_BASE + 0x28UL))
+#define DMA1_Channel4 ((DMA_Channel_TypeDef *)(DMA1_Channel1_BASE + 0x3CUL))
+#define DMA1_Channel5 ((DMA_Channel_TypeDef *)(DMA1_Channel1_BASE + 0x50UL))
+#define DMA1_Channel6 ((DMA_Channel_TypeDef *)(DMA1_Channel1_BASE + 0x64UL))
+#define DMA1_Channel7 ((DMA_Channel_TypeDef *)(DMA1_Channel1_BASE + 0x78UL))
+#define RCC ((RCC_TypeDef *)RCC_BASE)
+#define DWT ((DWT_Type *)DWT_BASE)
+#define CoreDebug ((CoreDebug_Type *)CoreDebug_BASE)
+
+/**********************************************************
+ * @brief Register bits.
+ **********************************************************/
+#define USART_SR_PE 0x0001U
+#define USART_SR_FE 0x0002U
+#define USART_SR_NE 0x0004U
+#define USART_SR_ORE 0x0008U
+#define USART_SR_IDLE 0x0010U
+#define USART_SR_RXNE 0x0020U
+#define USART_SR_TC 0x0040U
+#define USART_SR_TXE 0x0080U
+#define USART_SR_LBD 0x0100U
+#define USART_SR_CTS 0x0200U
+
+#define USART_CR1_SBK 0x0001U
+#define USART_CR1_RWU 0x0002U
+#define USART_CR1_RE 0x0004U
+#define USART_CR1_TE 0x0008U
+#define USART_CR1_IDLEIE 0x0010U
+#define USART_CR1_RXNEIE 0x0020U
+#define USART_CR1_TCIE 0x0040U
+#define USART_CR1_TXEIE 0x0080U
+#define USART_CR1_PEIE 0x0100U
+#define USART_CR1_PS 0x0200U
+#define USART_CR1_PCE 0x0400U
+#define USART_CR1_WAKE 0x0800U
+#define USART_CR1_M 0x1000U
+#define USART_CR1_UE 0x2000U
+
+#define USART_CR2_LBDL 0x0020U
+#define USART_CR2_LBDIE 0x0040U
+#define USART_CR2_STOP 0x3000U
+#define USART_CR2_LINEN 0x4000U
+
+#define USART_CR3_EIE 0x0001U
+#define USART_CR3_DMAR 0x0040U
+#define USART_CR3_DMAT 0x0080U
+
+#define DMA_CCR1_EN 0x0001U
+#define DMA_CCR1_TCIE 0x0002U
+#define DMA_CCR1_HTIE 0x0004U
+#define DMA_CCR1_TEIE 0x0008U
+#define DMA_CCR1_DIR 0x0010U
+#define DMA_CCR1_CIRC 0x0020U
+#define DMA_CCR1_PINC 0x0040U
+#define DMA_CCR1_MINC 0x0080U
+
+#define TIM_CR1_CEN 0x0001U
+#define TIM_DIER_UIE 0x0001U
+#define TIM_DIER_CC1IE 0x0002U
+#define TIM_DIER_CC2IE 0x0004U
+#define TIM_DIER_CC3IE 0x0008U
+#define TIM_DIER_CC4IE 0x0010U
+#define TIM_SR_UIF 0x0001U
+#define TIM_SR_CC1IF 0x0002U
+#define TIM_SR_CC2IF 0x0004U
+#define TIM_SR_CC3IF 0x0008U
+#define TIM_SR_CC4IF 0x0010U
+#define TIM_EGR_UG 0x0001U
+
+#define CAN_MCR_INRQ 0x00000001UL
+#define CAN_MCR_SLEEP 0x00000002UL
+#define CAN_MCR_TXFP 0x00000004UL
+#define CAN_MCR_RFLM 0x00000008UL
+#define CAN_MCR_NART 0x00000010UL
+#define CAN_MCR_AWUM 0x00000020UL
+#define CAN_MCR_ABOM 0x00000040UL
+#define CAN_MCR_TTCM 0x00000080UL
+#define CAN_MCR_RESET 0x00008000UL
+
+#define CAN_MSR_INAK 0x00000001UL
+#define CAN_MSR_SLAK 0x00000002UL
+#define CAN_MSR_ERRI 0x00000004UL
+#define CAN_MSR_WKUI 0x00000008UL
+#define CAN_MSR_SLAKI 0x00000010UL
+#define CAN_MSR_TXM 0x00000100UL
+#define CAN_MSR_RXM 0x00000200UL
+
+#define CAN_TSR_RQCP0 0x00000001UL
+#define CAN_TSR_TXOK0 0x00000002UL
+#define CAN_TSR_ALST0 0x00000004UL
+#define CAN_TSR_TERR0 0x00000008UL
+#define CAN_TSR_ABRQ0 0x00000080UL
+#define CAN_TSR_RQCP1 0x00000100UL
+#define CAN_TSR_TXOK1 0x00000200UL
+#define CAN_TSR_ALST1 0x00000400UL
+#define CAN_TSR_TERR1 0x00000800UL
+#define CAN_TSR_ABRQ1 0x00008000UL
+#define CAN_TSR_RQCP2 0x00010000UL
+#define CAN_TSR_TXOK2 0x00020000UL
+#define CAN_TSR_ALST2 0x00040000UL
+#define CAN_TSR_TERR2 0x00080000UL
+#define CAN_TSR_ABRQ2 0x00800000UL
+#define CAN_TSR_CODE 0x03000000UL
+#define CAN_TSR_TME0 0x04000000UL
+#define CAN_TSR_TME1 0x08000000UL
+#define CAN_TSR_TME2 0x10000000UL
+
+#define CAN_RF0R_FMP0 0x00000003UL
+#define CAN_RF0R_FULL0 0x00000008UL
+#define CAN_RF0R_FOVR0 0x00000010UL
+#define CAN_RF0R_RFOM0 0x00000020UL
+
+#define CAN_IER_TMEIE 0x00000001UL
+#define CAN_IER_FMPIE0 0x00000002UL
+#define CAN_IER_FFIE0 0x00000004UL
+#define CAN_IER_FOVIE0 0x00000008UL
+#define CAN_IER_EWGIE 0x00000100UL
+#define CAN_IER_EPVIE 0x00000200UL
+#define CAN_IER_BOFIE 0x00000400UL
+#define CAN_IER_LECIE 0x00000800UL
+#define CAN_IER_ERRIE 0x00008000UL
+#define CAN_IER_WKUIE 0x00010000UL
+#define CAN_IER_SLKIE 0x00020000UL
+
+#define CAN_ESR_EWGF 0x00000001UL
+#define CAN_ESR_EPVF 0x00000002UL
+#define CAN_ESR_BOFF 0x00000004UL
+#define CAN_ESR_LEC 0x00000070UL
+#define CAN_ESR_TEC 0x00FF0000UL
+#define CAN_ESR_REC 0xFF000000UL
+
+#define CAN_TI0R_TXRQ 0x00000001UL
+#define CAN_TI0R_RTR 0x00000002UL
+#define CAN_TI0R_IDE 0x00000004UL
+
+#define CAN_FMR_FINIT 0x00000001UL
+
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+
+/**********************************************************
+ * @brief SPL: GPIO.
+ **********************************************************/
+typedef enum
+{
+    GPIO_Speed_10MHz = 1,
+    GPIO_Speed_2MHz,
+    GPIO_Speed_50MHz
+} GPIOSpeed_TypeDef;
+
+typedef enum
+{
+    GPIO_Mode_AIN = 0x0,
+    GPIO_Mode_IN_FLOATING = 0x04,
+    GPIO_Mode_IPD = 0x28,
+    GPIO_Mode_IPU = 0x48,
+    GPIO_Mode_Out_OD = 0x14,
+    GPIO_Mode_Out_PP = 0x10,
+    GPIO_Mode_AF_OD = 0x1C,
+    GPIO_Mode_AF_PP = 0x18
+} GPIOMode_TypeDef;
+
+typedef struct
+{
+    uint16_t GPIO_Pin;
+    GPIOSpeed_TypeDef GPIO_Speed;
+    GPIOMode_TypeDef GPIO_Mode;
+} GPIO_InitTypeDef;
+
+#define GPIO_Pin_0 ((uint16_t)0x0001)
+#define GPIO_Pin_1 ((uint16_t)0x0002)
+#define GPIO_Pin_2 ((uint16_t)0x0004)
+#define GPIO_Pin_3 ((uint16_t)0x0008)
+#define GPIO_Pin_9 ((uint16_t)0x0200)
+#define GPIO_Pin_10 ((uint16_t)0x0400)
+#define GPIO_Pin_11 ((uint16_t)0x0800)
+#define GPIO_Pin_12 ((uint16_t)0x1000)
+
+#define GPIO_PortSourceGPIOA ((uint8_t)0x00)
+#define GPIO_PortSourceGPIOB ((uint8_t)0x01)
+#define GPIO_PinSource3 ((uint8_t)0x03)
+#define GPIO_PinSource10 ((uint8_t)0x0A)
+#define GPIO_PinSource11 ((uint8_t)0x0B)
+
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct);
+void GPIO_EXTILineConfig(uint8_t GPIO_PortSource, uint8_t GPIO_PinSource);
+
+/**********************************************************
+ * @brief SPL: RCC.
+ **********************************************************/
+typedef struct
+{
+    uint32_t SYSCLK_Frequency;
+    uint32_t HCLK_Frequency;
+    uint32_t PCLK1_Frequency;
+    uint32_t PCLK2_Frequency;
+    uint32_t ADCCLK_Frequency;
+} RCC_ClocksTypeDef;
+
+#define RCC_AHBPeriph_DMA1 ((uint32_t)0x00000001)
+#define RCC_APB2Periph_AFIO ((uint32_t)0x00000001)
+#define RCC_APB2Periph_GPIOA ((uint32_t)0x00000004)
+#define RCC_APB2Periph_GPIOB ((uint32_t)0x00000008)
+#define RCC_APB2Periph_USART1 ((uint32_t)0x00004000)
+#define RCC_APB1Periph_TIM2 ((uint32_t)0x00000001)
+#define RCC_APB1Periph_TIM3 ((uint32_t)0x00000002)
+#define RCC_APB1Periph_TIM4 ((uint32_t)0x00000004)
+#define RCC_APB1Periph_USART2 ((uint32_t)0x00020000)
+#define RCC_APB1Periph_USART3 ((uint32_t)0x00040000)
+#define RCC_APB1Periph_CAN1 ((uint32_t)0x02000000)
+
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState);
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState);
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState);
+void RCC_GetClocksFreq(RCC_ClocksTypeDef *RCC_Clocks);
+
+/**********************************************************
+ * @brief SPL: USART (LIN subset).
+ **********************************************************/
+#define USART_LINBreakDetectLength_10b ((uint16_t)0x0000)
+#define USART_LINBreakDetectLength_11b ((uint16_t)0x0020)
+
+void USART_SendBreak(USART_TypeDef *USARTx);
+void USART_LINCmd(USART_TypeDef *USARTx, FunctionalState NewState);
+void USART_LINBreakDetectLengthConfig(USART_TypeDef *USARTx, uint16_t USART_LINBreakDetectLength);
+
+/**********************************************************
+ * @brief SPL: CAN.
+ **********************************************************/
+typedef struct
+{
+    uint16_t CAN_Prescaler;
+    uint8_t CAN_Mode;
+    uint8_t CAN_SJW;
+    uint8_t CAN_BS1;
+    uint8_t CAN_BS2;
+    FunctionalState CAN_TTCM;
+    FunctionalState CAN_ABOM;
+    FunctionalState CAN_AWUM;
+    FunctionalState CAN_NART;
+    FunctionalState CAN_RFLM;
+    FunctionalState CAN_TXFP;
+} CAN_InitTypeDef;
+
+typedef struct
+{
+    uint16_t CAN_FilterIdHigh;
+    uint16_t CAN_FilterIdLow;
+    uint16_t CAN_FilterMaskIdHigh;
+    uint16_t CAN_FilterMaskIdLow;
+    uint16_t CAN_FilterFIFOAssignment;
+    uint8_t CAN_FilterNumber;
+    uint8_t CAN_FilterMode;
+    uint8_t CAN_FilterScale;
+    FunctionalState CAN_FilterActivation;
+} CAN_FilterInitTypeDef;
+
+typedef struct
+{
+    uint32_t StdId;
+    uint32_t ExtId;
+    uint8_t IDE;
+    uint8_t RTR;
+    uint8_t DLC;
+    uint8_t Data[8];
+} CanTxMsg;
+
+typedef struct
+{
+    uint32_t StdId;
+    uint32_t ExtId;
+    uint8_t IDE;
+    uint8_t RTR;
+    uint8_t DLC;
+    uint8_t Data[8];
+    uint8_t FMI;
+} CanRxMsg;
+
+#define CAN_InitStatus_Failed ((uint8_t)0x00)
+#define CAN_InitStatus_Success ((uint8_t)0x01)
+
+#define CAN_Mode_Normal ((uint8_t)0x00)
+#define CAN_SJW_1tq ((uint8_t)0x00)
+#define CAN_BS1_4tq ((uint8_t)0x03)
+#define CAN_BS1_6tq ((uint8_t)0x05)
+#define CAN_BS1_14tq ((uint8_t)0x0D)
+#define CAN_BS2_3tq ((uint8_t)0x02)
+#define CAN_BS2_6tq ((uint8_t)0x05)
+#define CAN_BS2_7tq ((uint8_t)0x06)
+
+#define CAN_Id_Standard ((uint32_t)0x00000000)
+#define CAN_Id_Extended ((uint32_t)0x00000004)
+#define CAN_RTR_Data ((uint32_t)0x00000000)
+#define CAN_RTR_Remote ((uint32_t)0x00000002)
+
+#define CAN_TxStatus_NoMailBox ((uint8_t)0x04)
+
+#define CAN_FIFO0 ((uint8_t)0x00)
+#define CAN_FIFO1 ((uint8_t)0x01)
+#define CAN_Filter_FIFO0 ((uint8_t)0x00)
+#define CAN_Filter_FIFO1 ((uint8_t)0x01)
+#define CAN_FilterMode_IdMask ((uint8_t)0x00)
+#define CAN_FilterMode_IdList ((uint8_t)0x01)
+#define CAN_FilterScale_16bit ((uint8_t)0x00)
+#define CAN_FilterScale_32bit ((uint8_t)0x01)
+
+#define CAN_IT_TME ((uint32_t)0x00000001)
+#define CAN_IT_FMP0 ((uint32_t)0x00000002)
+#define CAN_IT_FF0 ((uint32_t)0x00000004)
+#define CAN_IT_FOV0 ((uint32_t)0x00000008)
+#define CAN_IT_FMP1 ((uint32_t)0x00000010)
+#define CAN_IT_FF1 ((uint32_t)0x00000020)
+#define CAN_IT_FOV1 ((uint32_t)0x00000040)
+#define CAN_IT_EWG ((uint32_t)0x00000100)
+#define CAN_IT_EPV ((uint32_t)0x00000200)
+#define CAN_IT_BOF ((uint32_t)0x00000400)
+#define CAN_IT_LEC ((uint32_t)0x00000800)
+#define CAN_IT_ERR ((uint32_t)0x00008000)
+#define CAN_IT_WKU ((uint32_t)0x00010000)
+#define CAN_IT_SLK ((uint32_t)0x00020000)
+
+void CAN_DeInit(CAN_TypeDef *CANx);
+uint8_t CAN_Init(CAN_TypeDef *CANx, CAN_InitTypeDef *CAN_InitStruct);
+void CAN_FilterInit(CAN_FilterInitTypeDef *CAN_FilterInitStruct);
+void CAN_StructInit(CAN_InitTypeDef *CAN_InitStruct);
+uint8_t CAN_Transmit(CAN_TypeDef *CANx, CanTxMsg *TxMessage);
+void CAN_Receive(CAN_TypeDef *CANx, uint8_t FIFONumber, CanRxMsg *RxMessage);
+uint8_t CAN_MessagePending(CAN_TypeDef *CANx, uint8_t FIFONumber);
+void CAN_ITConfig(CAN_TypeDef *CANx, uint32_t CAN_IT, FunctionalState NewState);
+void CAN_ClearITPendingBit(CAN_TypeDef *CANx, uint32_t CAN_IT);
+
+/**********************************************************
+ * @brief CMSIS core: NVIC, PRIMASK and the system clock variable.
+ * @details SystemCoreClock keeps its value when the simulated clocks are
+ *          switched (Sim_SetClocks), like on the target until the
+ *          application calls SystemCoreClockUpdate.
+ **********************************************************/
+extern uint32_t SystemCoreClock;
+
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+void __enable_irq(void);
+void __disable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STM32F10X_H */
@@ -0,0 +1,16 @@
+/**********************************************************
+ * @file stm32f10x_gpio.h
+ * @brief Host replacement of the SPL GPIO header.
+ * @details The host subset of the SPL is declared in stm32f10x.h; this
+ *          header only lets the drivers keep their SPL includes.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef STM32F10X_GPIO_H
+#define STM32F10X_GPIO_H
+
+#include "stm32f10x.h"
+
+#endif /* STM32F10X_GPIO_H */
@@ -0,0 +1,653 @@
+/**********************************************************
+ * @file Lin_SimBench.c
+ * @brief Timing and CPU load benchmark of the LIN driver on the host simulator.
+ * @details Sends series of master frames (publisher and subscriber, 1 and 8
+ *          data bytes) in interrupt and DMA mode at 9600 and 19200 baud and
+ *          reports per frame:
+ *          - the latency from Lin_SendFrame to the falling edge of the break,
+ *          - the frame duration on the bus against the nominal
+ *            34 + 10 * (Dl + 1) bit times,
+ *          - the ISR entries, peripheral accesses and estimated CPU load.
+ *          A schedule table then runs on the three channels at once and the
+ *          break of each slot is compared with its nominal slot boundary.
+ *          Exits with status 1 if a frame fails or lasts longer than the
+ *          maximum frame time (1.4 * nominal), or if a break starts more
+ *          than one bit time after its slot boundary, so it also runs under
+ *          ctest. Last, a segmented diagnostic request and its segmented
+ *          response go through the MasterReq/SlaveResp slots (LinTp) and the
+ *          throughput and slots used are reported. The checksum routine
+ *          of the driver is finally timed against the former loop folding
+ *          the carry after every byte, in host TSC cycles per byte.
+ *          Each configuration runs in its own process (static driver state).
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Sim.h"
+#include "Lin.h"
+// The driver is built into the benchmark to reach its static checksum routine
+#include "Lin.c"
+#include "Lin_Sched.h"
+#include "LinTp.h"
+#include "Lin_Cfg.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#define BENCH_FRAMES 20U        /**< @brief Frames sent per configuration. */
+#define BENCH_GAP_US 500U       /**< @brief Idle time between two frames. */
+#define BENCH_HEADER_BITS 34U   /**< @brief Nominal header: break, delimiter, sync and PID. */
+#define BENCH_SCHED_MS 300U     /**< @brief Duration of the schedule case. */
+#define BENCH_SLOTS 64U         /**< @brief Slot boundaries recorded per channel. */
+#define BENCH_TP_LENGTH 40U     /**< @brief Diagnostic request and response length, SID included. */
+#define BENCH_TP_NAD 0x0AU      /**< @brief Node address of the diagnostic slave. */
+#define BENCH_CS_CALLS 100000U /**< @brief Checksums computed per payload length and run. */
+#define BENCH_CS_RUNS 5U        /**< @brief Runs per payload length, the fastest one is kept. */
+
+/**********************************************************
+ * @brief One benchmark configuration.
+ **********************************************************/
+typedef struct
+{
+    uint32 BaudRate;
+    boolean Dma;
+    Lin_FrameResponseType Drc;
+    uint8 Dl;
+} Bench_CaseType;
+
+static uint8 Bench_Data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+
+static boolean Bench_FrameDone(void *Arg)
+{
+    const uint8 *sdu;
+    Lin_StatusType status = Lin_GetStatus(0, &sdu);
+    (void)Arg;
+    return (status != LIN_TX_BUSY) && (status != LIN_RX_BUSY);
+}
+
+/**********************************************************
+ * @brief Run one configuration on channel 0 and print its row.
+ * @return 0 if every frame succeeded within the maximum frame time.
+ **********************************************************/
+static int Bench_Run(const void *Arg)
+{
+    const Bench_CaseType *Case = Arg;
+    Lin_ConfigType config;
+    Lin_PduType pdu = {0x21, LIN_ENHANCED_CS, Case->Drc, Case->Dl, Bench_Data};
+    Lin_StatusType expected = (Case->Drc == LIN_FRAMERESPONSE_TX) ? LIN_TX_OK : LIN_RX_OK;
+    uint64 bitNs = 1000000000ULL / Case->BaudRate;
+    uint64 nominal = (BENCH_HEADER_BITS + 10U * (Case->Dl + 1U)) * bitNs;
+    uint64 latency = 0, latencyMax = 0, duration = 0, durationMax = 0;
+    const uint8 *sdu;
+    Sim_StatsType stats;
+    int result = 0;
+
+    memset(&config, 0, sizeof(config));
+    config.Lin_BaudRate = Case->BaudRate;
+    config.Lin_Channel = 0;
+    config.Lin_DmaSupport = Case->Dma ? ENABLE : DISABLE;
+    config.Lin_Mode = LIN_MODE_MASTER;
+    Lin_Init(&config);
+
+    Sim_NodeType *node = Sim_NodeAdd(0, Case->BaudRate);
+    node->Length[0x21] = Case->Dl;
+    if (Case->Drc == LIN_FRAMERESPONSE_RX)
+    {
+        Sim_NodeRespond(node, 0x21, Bench_Data, Case->Dl, FALSE);
+        pdu.SduPtr = NULL;
+    }
+
+    Sim_Run(SIM_US(BENCH_GAP_US));
+    Sim_ResetStats();
+    for (uint32 i = 0; i < BENCH_FRAMES; i++)
+    {
+        uint64 start = Sim_Now();
+
+        if ((Lin_SendFrame(0, &pdu) != E_OK) || !Sim_RunUntil(Bench_FrameDone, NULL, SIM_MS(50)) ||
+            (Lin_GetStatus(0, &sdu) != expected))
+        {
+            printf("frame %u failed\n", i);
+            return 1;
+        }
+        Sim_Run(SIM_US(BENCH_GAP_US)); // Let the node close the frame
+
+        const Sim_FrameType *frame = Sim_NodeLastFrame(node);
+        if ((frame == NULL) || (frame->Start < start) || (frame->Count != Case->Dl + 1U) ||
+            !(frame->Flags & SIM_FRAME_ENHANCED_OK))
+        {
+            printf("frame %u not seen correctly on the bus\n", i);
+            return 1;
+        }
+
+        uint64 frameLatency = frame->Start - start;
+        uint64 frameDuration = frame->End - frame->Start;
+        latency += frameLatency;
+        duration += frameDuration;
+        latencyMax = (frameLatency > latencyMax) ? frameLatency : latencyMax;
+        durationMax = (frameDuration > durationMax) ? frameDuration : durationMax;
+        if (frameDuration * 10U > nominal * 14U)
+        {
+            result = 1; // Longer than the maximum frame time
+        }
+    }
+    Sim_GetStats(&stats);
+
+    double cpu = 100.0 * (double)(stats.IsrBusyNs + stats.TaskBusyNs) / (double)stats.ElapsedNs;
+    printf("%6u %-4s %-3s %u  %8.1f %8.1f  %7.1f %7.1f %5.3f  %5.1f %6.1f %4u  %5.2f%s\n", Case->BaudRate,
+           Case->Dma ? "dma" : "irq", (Case->Drc == LIN_FRAMERESPONSE_TX) ? "tx" : "rx", Case->Dl,
+           (double)latency / BENCH_FRAMES / 1e3, (double)latencyMax / 1e3, (double)duration / BENCH_FRAMES / 1e3,
+           (double)durationMax / 1e3, (double)durationMax / (double)nominal, (double)stats.IsrEntries / BENCH_FRAMES,
+           (double)(stats.IsrAccesses + stats.TaskAccesses) / BENCH_FRAMES, stats.MaxIsrAccesses, cpu,
+           result ? "  TOO LONG" : "");
+    return result;
+}
+
+/**********************************************************
+ * @brief Schedule of the jitter case: publisher and subscriber slots of 5 and 10 ms.
+ **********************************************************/
+static uint8 Bench_Rx[MAX_LIN_CHANNELS][2][8];
+
+static const Lin_ScheduleEntryType Bench_Entries[MAX_LIN_CHANNELS][4] = {
+    {{{0x10, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 8, Bench_Data}, 10},
+     {{0x20, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 8, Bench_Rx[0][0]}, 10},
+     {{0x11, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 1, Bench_Data}, 5},
+     {{0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 1, Bench_Rx[0][1]}, 5}},
+    {{{0x10, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 8, Bench_Data}, 10},
+     {{0x20, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 8, Bench_Rx[1][0]}, 10},
+     {{0x11, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 1, Bench_Data}, 5},
+     {{0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 1, Bench_Rx[1][1]}, 5}},
+    {{{0x10, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 8, Bench_Data}, 10},
+     {{0x20, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 8, Bench_Rx[2][0]}, 10},
+     {{0x11, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 1, Bench_Data}, 5},
+     {{0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 1, Bench_Rx[2][1]}, 5}},
+};
+
+static const Lin_ScheduleTableType Bench_Tables[MAX_LIN_CHANNELS] = {
+    {Bench_Entries[0], 4}, {Bench_Entries[1], 4}, {Bench_Entries[2], 4}};
+
+static const Lin_ScheduleConfigType Bench_ScheduleConfig[MAX_LIN_CHANNELS] = {
+    {&Bench_Tables[0], 1}, {&Bench_Tables[1], 1}, {&Bench_Tables[2], 1}};
+
+/**********************************************************
+ * @brief Nominal slot boundaries of each channel: the first tick, then the slot lengths.
+ **********************************************************/
+static struct
+{
+    uint64 Boundary[BENCH_SLOTS];
+    uint32 Count;
+} Bench_Slots[MAX_LIN_CHANNELS];
+
+/**********************************************************
+ * @brief Slot timer of the channel passed as Arg: one tick per millisecond.
+ **********************************************************/
+static uint64 Bench_ScheduleTask(void *Arg)
+{
+    uint8 channel = (uint8)(uintptr_t)Arg;
+    uint32 n = Bench_Slots[channel].Count;
+    uint16 delay = Lin_ScheduleTick(channel);
+
+    if (n == 0U)
+    {
+        Bench_Slots[channel].Boundary[0] = Sim_Now();
+    }
+    if (n + 1U < BENCH_SLOTS)
+    {
+        Bench_Slots[channel].Boundary[n + 1U] = Bench_Slots[channel].Boundary[n] + SIM_MS(delay);
+        Bench_Slots[channel].Count = n + 1U;
+    }
+    return SIM_MS(delay);
+}
+
+/**********************************************************
+ * @brief Run the schedule on the three channels and print the spread of the breaks.
+ * @param Arg Non-zero for DMA mode.
+ * @return 0 if every slot sent its frame within one bit time of its boundary.
+ **********************************************************/
+static int Bench_Schedule(const void *Arg)
+{
+    boolean dma = (*(const boolean *)Arg) ? TRUE : FALSE;
+    uint64 bitNs = 1000000000ULL / 19200U;
+    uint64 spread = 0, spreadMax = 0;
+    uint32 frames = 0;
+    Sim_NodeType *nodes[MAX_LIN_CHANNELS];
+    Sim_StatsType stats;
+    int result = 0;
+
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
+    {
+        Lin_ConfigType config;
+
+        memset(&config, 0, sizeof(config));
+        config.Lin_BaudRate = 19200;
+        config.Lin_Channel = ch;
+        config.Lin_DmaSupport = dma ? ENABLE : DISABLE;
+        config.Lin_Mode = LIN_MODE_MASTER;
+        Lin_Init(&config);
+
+        nodes[ch] = Sim_NodeAdd(ch, 19200);
+        nodes[ch]->Length[0x10] = 8;
+        nodes[ch]->Length[0x11] = 1;
+        Sim_NodeRespond(nodes[ch], 0x20, Bench_Data, 8, FALSE);
+        Sim_NodeRespond(nodes[ch], 0x21, Bench_Data, 1, FALSE);
+    }
+    Lin_ScheduleInit(Bench_ScheduleConfig);
+    Sim_SetStep(100); // Resolution of the spread
+
+    Sim_Run(SIM_US(BENCH_GAP_US));
+    Sim_ResetStats();
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
+    {
+        (void)Lin_ScheduleRequest(ch, 0);
+        Sim_StartTask(Bench_ScheduleTask, (void *)(uintptr_t)ch, 0);
+    }
+    Sim_Run(SIM_MS(BENCH_SCHED_MS));
+    Sim_GetStats(&stats);
+
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
+    {
+        // The last boundary may not have closed its frame yet
+        uint32 slots = (nodes[ch]->FrameCount < Bench_Slots[ch].Count) ? nodes[ch]->FrameCount : Bench_Slots[ch].Count;
+
+        for (uint32 k = 0; k < slots; k++)
+        {
+            const Sim_FrameType *frame = &nodes[ch]->Frames[k];
+            uint64 boundary = Bench_Slots[ch].Boundary[k];
+
+            if ((frame->Start < boundary) || !(frame->Flags & SIM_FRAME_ENHANCED_OK))
+            {
+                printf("channel %u slot %u: frame not seen correctly on the bus\n", ch, k);
+                return 1;
+            }
+            uint64 late = frame->Start - boundary;
+            spread += late;
+            spreadMax = (late > spreadMax) ? late : spreadMax;
+            frames++;
+            if (late > bitNs)
+            {
+                result = 1; // Slot boundary missed by more than a bit
+            }
+        }
+        if (Lin_ScheduleGetAndClearOverrunCount(ch) != 0U)
+        {
+            result = 1;
+        }
+    }
+
+    double cpu = 100.0 * (double)(stats.IsrBusyNs + stats.TaskBusyNs) / (double)stats.ElapsedNs;
+    printf(" 19200 %-4s 3 ch  %5u  %8.2f %8.2f  %5.2f%s\n", dma ? "dma" : "irq", frames,
+           (frames != 0U) ? (double)spread / frames / 1e3 : 0.0, (double)spreadMax / 1e3, cpu,
+           result ? "  LATE" : "");
+    return ((result == 0) && (frames != 0U)) ? 0 : 1;
+}
+
+/**********************************************************
+ * @brief Diagnostic slave: reassembles the master requests (0x3C) and
+ *        echoes them, with the positive RSID, in the SlaveResp slots (0x3D).
+ **********************************************************/
+static struct
+{
+    uint8 Request[LINTP_MAX_MESSAGE_LENGTH];
+    uint16 RequestLength, RequestOffset;
+    uint16 ResponseOffset;
+    uint8 ResponseSn;
+    uint32 MasterReqFrames, SlaveRespFrames;
+} Bench_Diag;
+
+static void Bench_DiagFrame(Sim_NodeType *Node, const Sim_FrameType *Frame)
+{
+    const uint8 *d = Frame->Data;
+    uint8 type = d[1] & LINTP_PCI_TYPE_MASK;
+    uint16 chunk;
+
+    (void)Node;
+    if ((Frame->Pid & 0x3FU) == LINTP_ID_SLAVE_RESP)
+    {
+        Bench_Diag.SlaveRespFrames += (Frame->Count == 9U) ? 1U : 0U;
+        return;
+    }
+    if (((Frame->Pid & 0x3FU) != LINTP_ID_MASTER_REQ) || (Frame->Count != 9U) || (d[0] != BENCH_TP_NAD))
+    {
+        return;
+    }
+
+    Bench_Diag.MasterReqFrames++;
+    if (type == LINTP_PCI_SF)
+    {
+        Bench_Diag.RequestLength = d[1] & 0x0FU;
+        memcpy(Bench_Diag.Request, d + 2, Bench_Diag.RequestLength);
+        Bench_Diag.RequestOffset = Bench_Diag.RequestLength;
+    }
+    else if (type == LINTP_PCI_FF)
+    {
+        Bench_Diag.RequestLength = (uint16)(((d[1] & 0x0FU) << 8) | d[2]);
+        memcpy(Bench_Diag.Request, d + 3, 5);
+        Bench_Diag.RequestOffset = 5;
+    }
+    else if ((type == LINTP_PCI_CF) && (Bench_Diag.RequestOffset < Bench_Diag.RequestLength))
+    {
+        chunk = Bench_Diag.RequestLength - Bench_Diag.RequestOffset;
+        chunk = (chunk < 6U) ? chunk : 6U;
+        memcpy(Bench_Diag.Request + Bench_Diag.RequestOffset, d + 2, chunk);
+        Bench_Diag.RequestOffset += chunk;
+    }
+    if (Bench_Diag.RequestOffset == Bench_Diag.RequestLength)
+    {
+        Bench_Diag.Request[0] += 0x40U; // The echo is the response
+        Bench_Diag.ResponseOffset = 0;
+    }
+}
+
+static void Bench_DiagHeader(Sim_NodeType *Node, uint8 Pid)
+{
+    uint8 frame[8] = {BENCH_TP_NAD, 0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint16 length = Bench_Diag.RequestLength;
+    uint16 offset = Bench_Diag.ResponseOffset;
+    uint8 pos = 2;
+    uint16 chunk;
+
+    if ((Pid & 0x3FU) != LINTP_ID_SLAVE_RESP)
+    {
+        return;
+    }
+    Node->Response[LINTP_ID_SLAVE_RESP].Publish = FALSE;
+    if ((length == 0U) || (Bench_Diag.RequestOffset != length) || (offset >= length))
+    {
+        return; // Nothing to answer: the slot stays empty
+    }
+
+    if ((offset == 0U) && (length <= 6U))
+    {
+        frame[1] = (uint8)(LINTP_PCI_SF | length);
+        chunk = length;
+    }
+    else if (offset == 0U)
+    {
+        frame[1] = (uint8)(LINTP_PCI_FF | (length >> 8));
+        frame[2] = (uint8)length;
+        pos = 3;
+        chunk = 5;
+        Bench_Diag.ResponseSn = 1;
+    }
+    else
+    {
+        frame[1] = (uint8)(LINTP_PCI_CF | (Bench_Diag.ResponseSn++ & 0x0FU));
+        chunk = length - offset;
+        chunk = (chunk < 6U) ? chunk : 6U;
+    }
+    memcpy(frame + pos, Bench_Diag.Request + offset, chunk);
+    Bench_Diag.ResponseOffset += chunk;
+    Sim_NodeRespond(Node, LINTP_ID_SLAVE_RESP, frame, 8, TRUE);
+}
+
+/**********************************************************
+ * @brief Schedules of the transport case: diagnostic slots only, and
+ *        diagnostic slots sharing the table with two application frames.
+ **********************************************************/
+static uint8 Bench_TpRx[2];
+
+static const Lin_ScheduleEntryType Bench_TpEntries[] = {
+    {{LINTP_ID_MASTER_REQ, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_TX, 8, NULL}, 10},
+    {{LINTP_ID_SLAVE_RESP, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_RX, 8, NULL}, 10},
+    {{0x10, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Bench_Data}, 5},
+    {{0x20, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 2, Bench_TpRx}, 5},
+};
+
+static const Lin_ScheduleTableType Bench_TpTables[] = {{Bench_TpEntries, 2}, {Bench_TpEntries, 4}};
+
+static const Lin_ScheduleConfigType Bench_TpScheduleConfig[MAX_LIN_CHANNELS] = {{Bench_TpTables, 2}};
+
+static struct
+{
+    uint8 NumEntries;   /**< @brief Slots of the running table. */
+    uint32 Ticks;       /**< @brief Slot boundaries since the request. */
+    uint32 DiagSlots;   /**< @brief MasterReq and SlaveResp slots since the request. */
+    boolean Done;
+    LinTp_StatusType Status;
+    uint16 Length;
+    boolean Echoed;     /**< @brief Response equal to the request with the RSID. */
+    uint64 End;
+} Bench_Tp;
+
+static uint64 Bench_TpTask(void *Arg)
+{
+    (void)Arg;
+    if (!Bench_Tp.Done)
+    {
+        Bench_Tp.DiagSlots += ((Bench_Tp.Ticks % Bench_Tp.NumEntries) < 2U) ? 1U : 0U;
+        Bench_Tp.Ticks++;
+    }
+    return SIM_MS(Lin_ScheduleTick(0));
+}
+
+static void Bench_TpNotification(uint8 Channel, uint8 Nad, LinTp_StatusType Status, const uint8 *Data, uint16 Length)
+{
+    (void)Channel;
+    (void)Nad;
+    Bench_Tp.Done = TRUE;
+    Bench_Tp.End = Sim_Now();
+    Bench_Tp.Status = Status;
+    Bench_Tp.Length = Length;
+    Bench_Tp.Echoed =
+        ((Length == Bench_Diag.RequestLength) && (memcmp(Data, Bench_Diag.Request, Length) == 0)) ? TRUE : FALSE;
+}
+
+static boolean Bench_TpDone(void *Arg)
+{
+    (void)Arg;
+    return Bench_Tp.Done;
+}
+
+/**********************************************************
+ * @brief Send a segmented request and receive its segmented response.
+ * @param Arg Index of the schedule table in Bench_TpTables.
+ * @return 0 if the response is correct and every segment used one slot.
+ **********************************************************/
+static int Bench_Transport(const void *Arg)
+{
+    static const LinTp_ConfigType tpConfig = {Bench_TpNotification, 3};
+    uint8 table = *(const uint8 *)Arg;
+    uint8 request[BENCH_TP_LENGTH];
+    Lin_ConfigType config;
+    // Each way: a first frame with 5 bytes, then consecutive frames with up to 6 bytes
+    uint32 segments = 2U * (1U + (BENCH_TP_LENGTH - 5U + 5U) / 6U);
+
+    memset(&config, 0, sizeof(config));
+    config.Lin_BaudRate = 19200;
+    config.Lin_Channel = 0;
+    config.Lin_Mode = LIN_MODE_MASTER;
+    Lin_Init(&config);
+
+    Sim_NodeType *node = Sim_NodeAdd(0, 19200);
+    node->OnFrame = Bench_DiagFrame;
+    node->OnHeader = Bench_DiagHeader;
+    node->Length[0x10] = 2;
+    Sim_NodeRespond(node, 0x20, Bench_Data, 2, FALSE);
+
+    request[0] = 0x22; // Any service: echoed by the slave
+    for (uint8 i = 1; i < BENCH_TP_LENGTH; i++)
+    {
+        request[i] = i;
+    }
+    LinTp_Init(&tpConfig);
+    Lin_ScheduleInit(Bench_TpScheduleConfig);
+    (void)Lin_ScheduleRequest(0, table);
+    Bench_Tp.NumEntries = Bench_TpTables[table].NumEntries;
+
+    Sim_Run(SIM_US(BENCH_GAP_US));
+    uint64 start = Sim_Now();
+    if (LinTp_Transmit(0, BENCH_TP_NAD, request, BENCH_TP_LENGTH) != E_OK)
+    {
+        return 1;
+    }
+    Sim_StartTask(Bench_TpTask, NULL, 0);
+    if (!Sim_RunUntil(Bench_TpDone, NULL, SIM_MS(2000)))
+    {
+        printf("request not answered\n");
+        return 1;
+    }
+
+    uint32 used = Bench_Diag.MasterReqFrames + Bench_Diag.SlaveRespFrames;
+    double seconds = (double)(Bench_Tp.End - start) / 1e9;
+    int result = ((Bench_Tp.Status == LINTP_OK) && Bench_Tp.Echoed && (used == segments)) ? 0 : 1;
+    printf(" 19200 %-5s %4u  %8.1f  %7.1f   %3u %3u  %4u %4u%s\n", (table == 0U) ? "diag" : "mixed",
+           2U * BENCH_TP_LENGTH, seconds * 1e3, 2.0 * BENCH_TP_LENGTH / seconds, Bench_Diag.MasterReqFrames,
+           Bench_Diag.SlaveRespFrames, Bench_Tp.DiagSlots, Bench_Tp.Ticks, result ? "  FAILED" : "");
+    return result;
+}
+
+/**********************************************************
+ * @brief Former checksum loop: the carry is tested and folded after every byte.
+ * @details Extended with the PID of the enhanced model to compute the same value.
+ **********************************************************/
+static uint8 Bench_ChecksumBaseline(uint8 Pid, Lin_FrameCsModelType Cs, const uint8 *data, uint8 length)
+{
+    uint16 checksum = (Cs == LIN_ENHANCED_CS) ? Pid : 0U;
+
+    for (uint8 i = 0; i < length; i++)
+    {
+        checksum += data[i];
+        if (checksum > 0xFF)
+        {
+            checksum = (checksum & 0xFF) + 1;
+        }
+    }
+    return (uint8)(~checksum);
+}
+
+/**********************************************************
+ * @brief Host TSC cycles per byte of a checksum routine, fastest of BENCH_CS_RUNS runs.
+ **********************************************************/
+static double Bench_ChecksumCost(uint8 (*Checksum)(uint8, Lin_FrameCsModelType, const uint8 *, uint8),
+                                 const uint8 *Data, uint8 Dl, volatile uint8 *Sink)
+{
+    uint64 best = ~0ULL;
+
+    for (uint32 run = 0; run < BENCH_CS_RUNS; run++)
+    {
+        uint8 sum = 0;
+        uint64 start = __rdtsc();
+        for (uint32 i = 0; i < BENCH_CS_CALLS; i++)
+        {
+            sum ^= Checksum(Lin_PidTable[0x21], LIN_ENHANCED_CS, Data + (i & 0xFFU), Dl);
+        }
+        uint64 cycles = __rdtsc() - start;
+        *Sink = sum;
+        best = (cycles < best) ? cycles : best;
+    }
+    return (double)best / BENCH_CS_CALLS / Dl;
+}
+
+/**********************************************************
+ * @brief Compare the checksum routines on 1...8 byte payloads.
+ * @return 0 if both routines give the same checksums.
+ **********************************************************/
+static int Bench_Checksum(const void *Arg)
+{
+    static uint8 data[256 + 8];
+    volatile uint8 sink;
+    uint32 seed = 1;
+    int result = 0;
+
+    (void)Arg;
+    for (uint32 i = 0; i < sizeof(data); i++)
+    {
+        seed = seed * 1103515245U + 12345U;
+        data[i] = (uint8)(seed >> 16);
+    }
+
+    for (uint8 dl = 1; dl <= 8U; dl++)
+    {
+        for (uint32 i = 0; i < 256U; i++)
+        {
+            for (uint8 cs = 0; cs < 2U; cs++)
+            {
+                Lin_FrameCsModelType model = (cs == 0U) ? LIN_CLASSIC_CS : LIN_ENHANCED_CS;
+                if (Bench_ChecksumBaseline(Lin_PidTable[0x21], model, data + i, dl) !=
+                    LIN_CalculateChecksum(Lin_PidTable[0x21], model, data + i, dl))
+                {
+                    result = 1;
+                }
+            }
+        }
+
+        double baseline = Bench_ChecksumCost(Bench_ChecksumBaseline, data, dl, &sink);
+        double folded = Bench_ChecksumCost(LIN_CalculateChecksum, data, dl, &sink);
+        printf("    %u   %8.2f %8.2f  %5.2f%s\n", dl, baseline, folded, baseline / folded,
+               result ? "  MISMATCH" : "");
+    }
+    return result;
+}
+
+/**********************************************************
+ * @brief Run a case in its own process (static driver state).
+ * @return 0 if the case passed.
+ **********************************************************/
+static int Bench_Fork(int (*Run)(const void *), const void *Arg)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        Sim_Init();
+        int result = Run(Arg);
+        fflush(stdout);
+        _exit(result);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) ? 0 : 1;
+}
+
+int main(void)
+{
+    static const uint32 baudRates[] = {9600, 19200};
+    static const uint8 lengths[] = {1, 8};
+    unsigned failed = 0;
+
+    printf("  baud mode dir dl  latency (us)      duration (us)  /nom    isr/f  acc/f  max  cpu %%\n");
+    printf("                     mean      max     mean     max                            \n");
+    for (unsigned b = 0; b < sizeof(baudRates) / sizeof(baudRates[0]); b++)
+    {
+        for (unsigned m = 0; m < 2U; m++)
+        {
+            for (unsigned d = 0; d < 2U; d++)
+            {
+                for (unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+                {
+                    Bench_CaseType benchCase = {baudRates[b], (m != 0U) ? TRUE : FALSE,
+                                                (d == 0U) ? LIN_FRAMERESPONSE_TX : LIN_FRAMERESPONSE_RX,
+                                                lengths[l]};
+
+                    failed += (unsigned)Bench_Fork(Bench_Run, &benchCase);
+                }
+            }
+        }
+    }
+
+    printf("\n  baud mode load  slots  break - slot boundary (us)  cpu %%\n");
+    printf("                            mean      max\n");
+    for (unsigned m = 0; m < 2U; m++)
+    {
+        boolean dma = (m != 0U) ? TRUE : FALSE;
+        failed += (unsigned)Bench_Fork(Bench_Schedule, &dma);
+    }
+
+    printf("\n  baud table bytes  time (ms)  bytes/s   frames    slots\n");
+    printf("                                        req rsp  diag  all\n");
+    for (uint8 t = 0; t < 2U; t++)
+    {
+        failed += (unsigned)Bench_Fork(Bench_Transport, &t);
+    }
+
+    printf("\n  dl  cycles per byte (enhanced)\n");
+    printf("      baseline   folded  ratio\n");
+    failed += (unsigned)Bench_Fork(Bench_Checksum, NULL);
+
+    printf("%u configurations failed\n", failed);
+    return (failed == 0U) ? 0 : 1;
+}
@@ -0,0 +1,1435 @@
+/**********************************************************
+ * @file Lin_SimTest.c
+ * @brief Functional tests of the LIN driver on the host simulator.
+ * @details Each test runs in its own process (the driver and the simulator
+ *          keep static state) and drives the unmodified driver through its
+ *          API while simulated nodes answer, disturb or record the frames.
+ *          Usage: lin_sim_test [name], without a name every test runs.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Sim.h"
+#include "Lin.h"
+#include "Lin_Sched.h"
+#include "LinTp.h"
+#include "Lin_NodeCfg.h"
+#include "Lin_Cfg.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**********************************************************
+ * @brief Test assertion: reports the failed condition with the simulated time.
+ **********************************************************/
+#define CHECK(cond)                                                              \
+    do                                                                           \
+    {                                                                            \
+        if (!(cond))                                                             \
+        {                                                                        \
+            Sim_Fail("%s:%d: %s", __FILE__, __LINE__, #cond);                    \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                               \
+    do                                                                           \
+    {                                                                            \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);          \
+        if (a_ != e_)                                                            \
+        {                                                                        \
+            Sim_Fail("%s:%d: %s is %lld, expected %lld", __FILE__, __LINE__,     \
+                     #actual, a_, e_);                                           \
+        }                                                                        \
+    } while (0)
+
+#define BAUD 19200U
+#define BIT_NS (1000000000U / BAUD)
+
+/**********************************************************
+ * @brief Configuration of a channel with the defaults of the tests.
+ **********************************************************/
+static Lin_ConfigType Test_Config(uint8 Channel, uint32 Mode, boolean Dma)
+{
+    Lin_ConfigType config;
+
+    memset(&config, 0, sizeof(config));
+    config.Lin_BaudRate = BAUD;
+    config.Lin_Channel = Channel;
+    config.Lin_WakeupSupport = ENABLE;
+    config.Lin_DmaSupport = Dma ? ENABLE : DISABLE;
+    config.Lin_Mode = Mode;
+    return config;
+}
+
+static void Test_InitMaster(uint8 Channel, boolean Dma)
+{
+    Lin_ConfigType config = Test_Config(Channel, LIN_MODE_MASTER, Dma);
+    Lin_Init(&config);
+}
+
+static boolean Test_FrameDone(void *Arg)
+{
+    const uint8 *sdu;
+    Lin_StatusType status = Lin_GetStatus((uint8)(uintptr_t)Arg, &sdu);
+    return (status != LIN_TX_BUSY) && (status != LIN_RX_BUSY);
+}
+
+/**********************************************************
+ * @brief Wait until the frame of a channel ends (maximum frame time at most 20 ms).
+ **********************************************************/
+static Lin_StatusType Test_Wait(uint8 Channel, const uint8 **Sdu)
+{
+    CHECK(Sim_RunUntil(Test_FrameDone, (void *)(uintptr_t)Channel, SIM_MS(20)));
+    return Lin_GetStatus(Channel, Sdu);
+}
+
+static uint16 Test_ErrorCount(uint8 Channel, Lin_SlaveErrorType Error)
+{
+    Lin_ErrorCountersType counters;
+    CHECK(Lin_GetErrorCounters(Channel, &counters) == E_OK);
+    return counters.Count[Error];
+}
+
+/**********************************************************
+ * @brief Send a frame and wait for its end.
+ **********************************************************/
+static Lin_StatusType Test_Frame(uint8 Channel, uint8 Id, Lin_FrameCsModelType Cs, Lin_FrameResponseType Drc,
+                                 uint8 *Data, uint8 Dl, const uint8 **Sdu)
+{
+    Lin_PduType pdu = {Id, Cs, Drc, Dl, Data};
+    const uint8 *sdu;
+
+    CHECK(Lin_SendFrame(Channel, &pdu) == E_OK);
+    return Test_Wait(Channel, (Sdu != NULL) ? Sdu : &sdu);
+}
+
+/**********************************************************
+ * @brief Check the last frame seen by a node.
+ **********************************************************/
+static void Test_CheckFrame(const Sim_NodeType *Node, uint8 Id, const uint8 *Data, uint8 Dl, uint8 Flags)
+{
+    const Sim_FrameType *frame = Sim_NodeLastFrame(Node);
+
+    CHECK(frame != NULL);
+    CHECK_EQ(frame->Pid, Sim_Pid(Id));
+    CHECK_EQ(frame->Count, Dl + 1U);
+    CHECK(memcmp(frame->Data, Data, Dl) == 0);
+    CHECK_EQ(frame->Flags & Flags, Flags);
+}
+
+/**********************************************************
+ * @brief Interrupt and DMA variants of a test taking the DMA switch.
+ **********************************************************/
+#define TEST_IRQ_DMA(name)                                                       \
+    static void name##Irq(void)                                                  \
+    {                                                                            \
+        name(FALSE);                                                             \
+    }                                                                            \
+    static void name##Dma(void)                                                  \
+    {                                                                            \
+        name(TRUE);                                                              \
+    }
+
+static uint8 Test_Data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+
+/**********************************************************
+ * @brief Master publishes a response: header and data on the bus, enhanced checksum.
+ **********************************************************/
+static void Test_MasterTx(boolean Dma)
+{
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+
+    node->Length[0x12] = 4;
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 4, NULL), LIN_TX_OK);
+    Sim_Run(SIM_US(200));
+    Test_CheckFrame(node, 0x12, Test_Data, 4, SIM_FRAME_SYNC_OK | SIM_FRAME_PID_OK | SIM_FRAME_ENHANCED_OK);
+    CHECK_EQ(node->FrameCount, 1);
+
+    CHECK_EQ(Test_Frame(0, 0x30, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 8, NULL), LIN_TX_OK);
+    Sim_Run(SIM_US(200));
+    Test_CheckFrame(node, 0x30, Test_Data, 8, SIM_FRAME_SYNC_OK | SIM_FRAME_PID_OK | SIM_FRAME_ENHANCED_OK);
+}
+
+/**********************************************************
+ * @brief Master receives a slave response.
+ **********************************************************/
+static void Test_MasterRx(boolean Dma)
+{
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    const uint8 *sdu;
+
+    Sim_NodeRespond(node, 0x21, Test_Data, 4, FALSE);
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, &sdu), LIN_RX_OK);
+    CHECK(memcmp(sdu, Test_Data, 4) == 0);
+
+    Sim_NodeRespond(node, 0x31, Test_Data + 1, 8, FALSE);
+    node->Response[0x31].ResponseSpaceNs = 5 * BIT_NS;
+    node->Response[0x31].InterByteNs = BIT_NS;
+    CHECK_EQ(Test_Frame(0, 0x31, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 8, &sdu), LIN_RX_OK);
+    CHECK(memcmp(sdu, Test_Data + 1, 7) == 0);
+}
+
+/**********************************************************
+ * @brief Signal buffer: responses swap the halves and set Updated, a corrupted
+ *        one leaves the front half alone; Lin_SignalBufferWrite does the same.
+ **********************************************************/
+static void Test_SignalBuffer(boolean Dma)
+{
+    static Lin_SignalBufferType buffer;
+    static Lin_SignalBufferType *signals[64] = {[0x21] = &buffer};
+    Lin_ConfigType config = Test_Config(0, LIN_MODE_MASTER, Dma);
+    const uint8 *sdu;
+
+    config.Lin_SignalBufferTable = signals;
+    Lin_Init(&config);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    CHECK_EQ(buffer.Front, 0);
+    CHECK(!buffer.Updated);
+
+    Sim_NodeRespond(node, 0x21, Test_Data, 4, FALSE);
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, &sdu), LIN_RX_OK);
+    CHECK_EQ(buffer.Front, 1);
+    CHECK(buffer.Updated);
+    CHECK(sdu == buffer.Data[1]);
+    CHECK(memcmp(buffer.Data[1], Test_Data, 4) == 0);
+
+    // The next response goes to the other half: a snapshot of the front half stays intact
+    const uint8 *snapshot = buffer.Data[buffer.Front];
+    buffer.Updated = FALSE;
+    Sim_NodeRespond(node, 0x21, Test_Data + 4, 4, FALSE);
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, NULL), LIN_RX_OK);
+    CHECK_EQ(buffer.Front, 0);
+    CHECK(buffer.Updated);
+    CHECK(memcmp(buffer.Data[0], Test_Data + 4, 4) == 0);
+    CHECK(memcmp(snapshot, Test_Data, 4) == 0);
+
+    // Wrong checksum: no swap, no update
+    buffer.Updated = FALSE;
+    Sim_NodeRespond(node, 0x21, Test_Data + 2, 4, FALSE);
+    node->Response[0x21].BadChecksum = TRUE;
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, NULL), LIN_RX_ERROR);
+    CHECK_EQ(buffer.Front, 0);
+    CHECK(!buffer.Updated);
+    CHECK(memcmp(buffer.Data[0], Test_Data + 4, 4) == 0);
+
+    // Written by software (e.g., an event-triggered response) like a received one
+    CHECK(Lin_SignalBufferWrite(0, 0x21, Test_Data + 1, 4) == E_OK);
+    CHECK_EQ(buffer.Front, 1);
+    CHECK(buffer.Updated);
+    CHECK(memcmp(buffer.Data[1], Test_Data + 1, 4) == 0);
+    CHECK(Lin_SignalBufferWrite(0, 0x22, Test_Data, 4) == E_NOT_OK);
+    CHECK(Lin_SignalBufferWrite(0, 0x21, Test_Data, 0) == E_NOT_OK);
+    CHECK(Lin_SignalBufferWrite(0, 0x21, Test_Data, 9) == E_NOT_OK);
+    CHECK(Lin_SignalBufferWrite(0, 0x40, Test_Data, 4) == E_NOT_OK);
+    CHECK(Lin_SignalBufferWrite(0, 0x21, NULL, 4) == E_NOT_OK);
+    CHECK_EQ(buffer.Front, 1);
+
+    // A frame without signal buffer is received into the driver buffer
+    Sim_NodeRespond(node, 0x22, Test_Data + 3, 4, FALSE);
+    CHECK_EQ(Test_Frame(0, 0x22, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, &sdu), LIN_RX_OK);
+    CHECK(memcmp(sdu, Test_Data + 3, 4) == 0);
+    CHECK((sdu != buffer.Data[0]) && (sdu != buffer.Data[1]));
+    CHECK_EQ(buffer.Front, 1);
+}
+
+/**********************************************************
+ * @brief Classic checksum on request, and always for the diagnostic frames.
+ **********************************************************/
+static void Test_Checksum(boolean Dma)
+{
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    const uint8 *sdu;
+
+    node->Length[0x12] = 4;
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_TX, Test_Data, 4, NULL), LIN_TX_OK);
+    Sim_Run(SIM_US(200));
+    Test_CheckFrame(node, 0x12, Test_Data, 4, SIM_FRAME_CLASSIC_OK);
+    CHECK(!(Sim_NodeLastFrame(node)->Flags & SIM_FRAME_ENHANCED_OK));
+
+    CHECK_EQ(Test_Frame(0, 0x3C, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 8, NULL), LIN_TX_OK);
+    Sim_Run(SIM_US(200));
+    Test_CheckFrame(node, 0x3C, Test_Data, 8, SIM_FRAME_CLASSIC_OK);
+
+    Sim_NodeRespond(node, 0x3D, Test_Data, 8, TRUE);
+    CHECK_EQ(Test_Frame(0, 0x3D, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 8, &sdu), LIN_RX_OK);
+    CHECK(memcmp(sdu, Test_Data, 8) == 0);
+
+    Sim_NodeRespond(node, 0x22, Test_Data, 2, TRUE);
+    CHECK_EQ(Test_Frame(0, 0x22, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_RX, NULL, 2, &sdu), LIN_RX_OK);
+    CHECK_EQ(Test_Frame(0, 0x22, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 2, &sdu), LIN_RX_ERROR);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_RESP_CHKSUM), 1);
+}
+
+/**********************************************************
+ * @brief Faulty slave responses: missing, incomplete, wrong checksum, stop bit error.
+ **********************************************************/
+static void Test_RxErrors(boolean Dma)
+{
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, NULL), LIN_RX_NO_RESPONSE);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_NO_RESP), 1);
+
+    Sim_NodeRespond(node, 0x21, Test_Data, 4, FALSE);
+    node->Response[0x21].Truncate = 2;
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, NULL), LIN_RX_ERROR);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_INC_RESP), 1);
+
+    node->Response[0x21].Truncate = 0;
+    node->Response[0x21].BadChecksum = TRUE;
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, NULL), LIN_RX_ERROR);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_RESP_CHKSUM), 1);
+
+    node->Response[0x21].BadChecksum = FALSE;
+    node->Disturb = (Sim_DisturbType){1, 0x21, 3, 9};
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, NULL), LIN_RX_ERROR);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_RESP_STOPBIT), 1);
+
+    // The channel still works after each error
+    Sim_Run(SIM_MS(2));
+    CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, NULL), LIN_RX_OK);
+}
+
+/**********************************************************
+ * @brief Readback errors of the master: header, response data bit and stop bit.
+ **********************************************************/
+static void Test_TxErrors(boolean Dma)
+{
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+
+    // Break and delimiter take 14 bits; data bit 0 of the sync byte 0x55 is recessive
+    Sim_BusGlitch(0, Sim_Now() + 15U * BIT_NS + BIT_NS / 4U, BIT_NS / 2U);
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_HEADER_ERROR);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_HEADER), 1);
+    Sim_Run(SIM_MS(2));
+
+    // Test_Data[1] = 0x22: data bit 1 (Bit 2) is recessive
+    node->Disturb = (Sim_DisturbType){1, 0x12, 3, 2};
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_ERROR);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_RESP_DATABIT), 1);
+    Sim_Run(SIM_MS(2));
+
+    node->Disturb = (Sim_DisturbType){1, 0x12, 2, 9};
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_ERROR);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_RESP_STOPBIT), 1);
+    Sim_Run(SIM_MS(2));
+
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_OK);
+    Sim_Run(SIM_US(200));
+    Test_CheckFrame(node, 0x12, Test_Data, 2, SIM_FRAME_ENHANCED_OK);
+}
+
+/**********************************************************
+ * @brief Slave response table of the tests: publishes 0x10 (2 bytes), subscribes to 0x20 (4 bytes).
+ **********************************************************/
+static uint8 Test_SlaveData[2] = {0xA5, 0x5A};
+static Lin_PduType Test_SlaveTable[64];
+
+static void Test_InitSlave(uint8 Channel, boolean Dma)
+{
+    Lin_ConfigType config = Test_Config(Channel, LIN_MODE_SLAVE, Dma);
+
+    Test_SlaveTable[0x10] = (Lin_PduType){0x10, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_SlaveData};
+    Test_SlaveTable[0x20] = (Lin_PduType){0x20, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 4, NULL};
+    config.Lin_SlaveResponseTable = Test_SlaveTable;
+    Lin_Init(&config);
+}
+
+/**********************************************************
+ * @brief Slave on channel 1 against a master whose clock is off by Ppm.
+ **********************************************************/
+static void Test_Slave(boolean Dma, sint32 Ppm)
+{
+    Test_InitSlave(1, Dma);
+    Sim_NodeType *master = Sim_NodeAdd(1, BAUD);
+    const uint8 *sdu;
+
+    master->ClockPpm = Ppm;
+    for (uint8 i = 0; i < 3U; i++)
+    {
+        Sim_NodeSendHeader(master, 0x10, SIM_US(500));
+        Sim_Run(SIM_MS(5));
+        Test_CheckFrame(master, 0x10, Test_SlaveData, 2, SIM_FRAME_SYNC_OK | SIM_FRAME_PID_OK | SIM_FRAME_ENHANCED_OK);
+        CHECK_EQ(Lin_GetStatus(1, &sdu), LIN_TX_OK);
+
+        Sim_NodeSendFrame(master, 0x20, Test_Data + i, 4, FALSE, SIM_US(500));
+        Sim_Run(SIM_MS(6));
+        CHECK_EQ(Lin_GetStatus(1, &sdu), LIN_RX_OK);
+        CHECK(memcmp(sdu, Test_Data + i, 4) == 0);
+    }
+    CHECK_EQ(master->FrameCount, 6);
+}
+
+static void Test_SlaveFast(boolean Dma)
+{
+    Test_Slave(Dma, 40000);
+}
+
+static void Test_SlaveSlow(boolean Dma)
+{
+    Test_Slave(Dma, -40000);
+}
+
+/**********************************************************
+ * @brief Master on channel 0 and slave on channel 1 sharing bus 0.
+ **********************************************************/
+static void Test_MasterSlave(boolean Dma)
+{
+    Sim_BusAttach(1, 0);
+    Test_InitMaster(0, Dma);
+    Test_InitSlave(1, Dma);
+    const uint8 *sdu;
+
+    CHECK_EQ(Test_Frame(0, 0x10, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 2, &sdu), LIN_RX_OK);
+    CHECK(memcmp(sdu, Test_SlaveData, 2) == 0);
+    Sim_Run(SIM_US(100));
+    CHECK_EQ(Lin_GetStatus(1, &sdu), LIN_TX_OK);
+
+    CHECK_EQ(Test_Frame(0, 0x20, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 4, NULL), LIN_TX_OK);
+    Sim_Run(SIM_US(100));
+    CHECK_EQ(Lin_GetStatus(1, &sdu), LIN_RX_OK);
+    CHECK(memcmp(sdu, Test_Data, 4) == 0);
+}
+
+/**********************************************************
+ * @brief Bus monitor on channel 2 records the frames of channel 0.
+ **********************************************************/
+static void Test_Monitor(void)
+{
+    Lin_ConfigType config = Test_Config(2, LIN_MODE_MONITOR, FALSE);
+    Lin_MonitorRecordType record;
+
+    Sim_BusAttach(2, 0);
+    Test_InitMaster(0, FALSE);
+    Lin_Init(&config);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    Sim_NodeRespond(node, 0x31, Test_Data, 4, FALSE);
+
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_OK);
+    Sim_Run(SIM_MS(2));
+    CHECK_EQ(Test_Frame(0, 0x31, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, NULL), LIN_RX_OK);
+    Sim_Run(SIM_MS(2));
+    CHECK_EQ(Test_Frame(0, 0x05, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 2, NULL), LIN_RX_NO_RESPONSE);
+    Sim_Run(SIM_MS(2));
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_OK);
+    Sim_Run(SIM_MS(2));
+
+    CHECK(Lin_MonitorRead(&record) == E_OK);
+    CHECK_EQ(record.Channel, 2);
+    CHECK_EQ(record.Pid, Sim_Pid(0x12));
+    CHECK_EQ(record.Count, 3);
+    CHECK(memcmp(record.Bytes, Test_Data, 2) == 0);
+    CHECK_EQ(record.Flags, LIN_MONITOR_HEADER_OK | LIN_MONITOR_CLASSIC_OK);
+
+    CHECK(Lin_MonitorRead(&record) == E_OK);
+    CHECK_EQ(record.Pid, Sim_Pid(0x31));
+    CHECK_EQ(record.Count, 5);
+    CHECK(memcmp(record.Bytes, Test_Data, 4) == 0);
+    CHECK_EQ(record.Flags, LIN_MONITOR_HEADER_OK | LIN_MONITOR_ENHANCED_OK);
+
+    CHECK(Lin_MonitorRead(&record) == E_OK);
+    CHECK_EQ(record.Pid, Sim_Pid(0x05));
+    CHECK_EQ(record.Count, 0);
+    CHECK_EQ(record.Flags, LIN_MONITOR_HEADER_OK);
+
+    // The last frame stays open over the pause, the next break stores it
+    CHECK(Lin_MonitorRead(&record) == E_NOT_OK);
+    CHECK_EQ(Test_Frame(0, 0x05, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 2, NULL), LIN_RX_NO_RESPONSE);
+    CHECK(Lin_MonitorRead(&record) == E_OK);
+    CHECK_EQ(record.Pid, Sim_Pid(0x12));
+    CHECK_EQ(record.Flags, LIN_MONITOR_HEADER_OK | LIN_MONITOR_ENHANCED_OK);
+    CHECK(Lin_MonitorRead(&record) == E_NOT_OK);
+}
+
+/**********************************************************
+ * @brief A response with long inter-byte spaces, whose second byte is the
+ *        classic checksum of the first, is recorded whole.
+ **********************************************************/
+static void Test_MonitorGap(void)
+{
+    Lin_ConfigType config = Test_Config(2, LIN_MODE_MONITOR, FALSE);
+    Lin_MonitorRecordType record;
+    uint8 data[2] = {0x12, 0xED};
+    const uint8 *sdu;
+
+    Sim_BusAttach(2, 0);
+    Test_InitMaster(0, FALSE);
+    Lin_Init(&config);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    Sim_NodeRespond(node, 0x31, data, 2, FALSE);
+    node->Response[0x31].InterByteNs = 15 * BIT_NS; // Bus idle after each byte
+
+    Lin_PduType pdu = {0x31, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 2, NULL};
+    CHECK(Lin_SendFrame(0, &pdu) == E_OK);
+    (void)Test_Wait(0, &sdu); // The master may time out, only the monitor matters
+    Sim_Run(SIM_MS(2));
+    CHECK(Lin_MonitorRead(&record) == E_NOT_OK);
+    CHECK_EQ(Test_Frame(0, 0x05, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 2, NULL), LIN_RX_NO_RESPONSE);
+
+    CHECK(Lin_MonitorRead(&record) == E_OK);
+    CHECK_EQ(record.Pid, Sim_Pid(0x31));
+    CHECK_EQ(record.Count, 3);
+    CHECK(memcmp(record.Bytes, data, 2) == 0);
+    CHECK_EQ(record.Bytes[2], Sim_Checksum(Sim_Pid(0x31), FALSE, data, 2));
+    CHECK_EQ(record.Flags, LIN_MONITOR_HEADER_OK | LIN_MONITOR_ENHANCED_OK | LIN_MONITOR_IDLE);
+}
+
+/**********************************************************
+ * @brief Diagnostic slave simulated on top of a node: reassembles the
+ *        master requests (0x3C) and answers them in the SlaveResp slots (0x3D).
+ * @details Implements AssignNAD, ReadByIdentifier 0 and SaveConfiguration;
+ *          any other service is answered positively with the request data.
+ *          Functional requests are not answered.
+ **********************************************************/
+#define TEST_SUPPLIER_ID 0x1234U
+#define TEST_FUNCTION_ID 0x5678U
+#define TEST_VARIANT 0x01U
+
+typedef struct
+{
+    uint8 Nad;               /**< @brief Current node address. */
+    uint8 Request[64];       /**< @brief Request being reassembled, starting with the SID. */
+    uint16 RequestLength;    /**< @brief Announced request length. */
+    uint16 RequestOffset;    /**< @brief Request bytes received. */
+    uint8 Response[64];      /**< @brief Response, starting with the RSID. */
+    uint16 ResponseLength;   /**< @brief Response bytes, 0 if none is pending. */
+    uint16 ResponseOffset;   /**< @brief Response bytes sent. */
+    uint8 ResponseNad;       /**< @brief NAD of the response frames. */
+    uint8 ResponseSn;        /**< @brief Next consecutive frame sequence number. */
+    uint32 Requests;         /**< @brief Complete requests received. */
+} Test_DiagNodeType;
+
+static void Test_DiagAnswer(Test_DiagNodeType *Diag)
+{
+    const uint8 *req = Diag->Request;
+    uint8 *resp = Diag->Response;
+
+    Diag->ResponseNad = Diag->Nad;
+    resp[0] = (uint8)(req[0] + LIN_NODECFG_RSID_OFFSET);
+    Diag->ResponseLength = 1;
+
+    switch (req[0])
+    {
+    case LIN_NODECFG_SID_ASSIGN_NAD:
+        if ((req[1] | (req[2] << 8)) == TEST_SUPPLIER_ID && (req[3] | (req[4] << 8)) == TEST_FUNCTION_ID)
+        {
+            Diag->Nad = req[5]; // Answered with the previous NAD
+        }
+        else
+        {
+            Diag->ResponseLength = 0;
+        }
+        break;
+    case LIN_NODECFG_SID_READ_BY_ID:
+        if (req[1] == 0U)
+        {
+            const uint8 id[5] = {(uint8)TEST_SUPPLIER_ID, (uint8)(TEST_SUPPLIER_ID >> 8), (uint8)TEST_FUNCTION_ID,
+                                 (uint8)(TEST_FUNCTION_ID >> 8), TEST_VARIANT};
+            memcpy(resp + 1, id, sizeof(id));
+            Diag->ResponseLength = 6;
+        }
+        else
+        {
+            const uint8 negative[3] = {LIN_NODECFG_SID_NEGATIVE_RESPONSE, req[0], 0x12U};
+            memcpy(resp, negative, sizeof(negative));
+            Diag->ResponseLength = 3;
+        }
+        break;
+    case LIN_NODECFG_SID_SAVE_CONFIGURATION:
+        break;
+    default:
+        memcpy(resp + 1, req + 1, Diag->RequestLength - 1U);
+        Diag->ResponseLength = Diag->RequestLength;
+        break;
+    }
+    Diag->ResponseOffset = 0;
+}
+
+static void Test_DiagFrame(Sim_NodeType *Node, const Sim_FrameType *Frame)
+{
+    Test_DiagNodeType *diag = Node->User;
+    const uint8 *d = Frame->Data;
+
+    if (((Frame->Pid & 0x3FU) != LINTP_ID_MASTER_REQ) || (Frame->Count != 9U) ||
+        !(Frame->Flags & SIM_FRAME_CLASSIC_OK))
+    {
+        return;
+    }
+    if ((d[0] != diag->Nad) && (d[0] != LINTP_NAD_BROADCAST) && (d[0] != LINTP_NAD_FUNCTIONAL))
+    {
+        return; // Other node, or the go-to-sleep command
+    }
+
+    uint8 type = d[1] & LINTP_PCI_TYPE_MASK;
+    if (type == LINTP_PCI_SF)
+    {
+        diag->RequestLength = d[1] & 0x0FU;
+        memcpy(diag->Request, d + 2, diag->RequestLength);
+        diag->RequestOffset = diag->RequestLength;
+    }
+    else if (type == LINTP_PCI_FF)
+    {
+        diag->RequestLength = (uint16)(((d[1] & 0x0FU) << 8) | d[2]);
+        memcpy(diag->Request, d + 3, 5);
+        diag->RequestOffset = 5;
+        return;
+    }
+    else if ((type == LINTP_PCI_CF) && (diag->RequestOffset < diag->RequestLength))
+    {
+        uint16 chunk = diag->RequestLength - diag->RequestOffset;
+        chunk = (chunk < 6U) ? chunk : 6U;
+        memcpy(diag->Request + diag->RequestOffset, d + 2, chunk);
+        diag->RequestOffset += chunk;
+    }
+    if ((diag->RequestLength == 0U) || (diag->RequestOffset != diag->RequestLength))
+    {
+        return;
+    }
+
+    diag->Requests++;
+    if (d[0] != LINTP_NAD_FUNCTIONAL)
+    {
+        Test_DiagAnswer(diag);
+    }
+}
+
+static void Test_DiagHeader(Sim_NodeType *Node, uint8 Pid)
+{
+    Test_DiagNodeType *diag = Node->User;
+    uint8 frame[8] = {diag->ResponseNad, 0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8 pos = 2;
+    uint16 chunk;
+
+    if ((Pid & 0x3FU) != LINTP_ID_SLAVE_RESP)
+    {
+        return;
+    }
+    Node->Response[LINTP_ID_SLAVE_RESP].Publish = FALSE;
+    if (diag->ResponseOffset >= diag->ResponseLength)
+    {
+        return; // Nothing to answer: the slot stays empty
+    }
+
+    if ((diag->ResponseOffset == 0U) && (diag->ResponseLength <= 6U))
+    {
+        frame[1] = (uint8)(LINTP_PCI_SF | diag->ResponseLength);
+        chunk = diag->ResponseLength;
+    }
+    else if (diag->ResponseOffset == 0U)
+    {
+        frame[1] = (uint8)(LINTP_PCI_FF | (diag->ResponseLength >> 8));
+        frame[2] = (uint8)diag->ResponseLength;
+        pos = 3;
+        chunk = 5;
+        diag->ResponseSn = 1;
+    }
+    else
+    {
+        frame[1] = (uint8)(LINTP_PCI_CF | (diag->ResponseSn++ & 0x0FU));
+        chunk = diag->ResponseLength - diag->ResponseOffset;
+        chunk = (chunk < 6U) ? chunk : 6U;
+    }
+    memcpy(frame + pos, diag->Response + diag->ResponseOffset, chunk);
+    diag->ResponseOffset += chunk;
+    Sim_NodeRespond(Node, LINTP_ID_SLAVE_RESP, frame, 8, TRUE);
+}
+
+static Sim_NodeType *Test_DiagNodeAdd(uint8 Bus, Test_DiagNodeType *Diag, uint8 Nad)
+{
+    Sim_NodeType *node = Sim_NodeAdd(Bus, BAUD);
+
+    memset(Diag, 0, sizeof(*Diag));
+    Diag->Nad = Nad;
+    node->User = Diag;
+    node->OnFrame = Test_DiagFrame;
+    node->OnHeader = Test_DiagHeader;
+    return node;
+}
+
+/**********************************************************
+ * @brief Schedule of the diagnostic tests: MasterReq, SlaveResp and a slave frame, 10 ms slots.
+ **********************************************************/
+static uint8 Test_SchedData[2];
+
+static const Lin_ScheduleEntryType Test_DiagEntries[] = {
+    {{LINTP_ID_MASTER_REQ, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_TX, 8, NULL}, 10},
+    {{LINTP_ID_SLAVE_RESP, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_RX, 8, NULL}, 10},
+    {{0x10, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 2, Test_SchedData}, 10},
+};
+
+static const Lin_ScheduleTableType Test_DiagTable = {Test_DiagEntries, 3};
+
+static const Lin_ScheduleConfigType Test_ScheduleConfig[MAX_LIN_CHANNELS] = {{&Test_DiagTable, 1}};
+
+/**********************************************************
+ * @brief Slot timer of the channel passed as Arg (NULL: channel 0): one tick per millisecond.
+ **********************************************************/
+static uint64 Test_ScheduleTask(void *Arg)
+{
+    return SIM_MS(Lin_ScheduleTick((uint8)(uintptr_t)Arg));
+}
+
+static struct
+{
+    boolean Done;
+    LinTp_StatusType Status;
+    uint8 Data[LINTP_MAX_MESSAGE_LENGTH];
+    uint16 Length;
+    Lin_NodeCfgResultType CfgResult;
+    uint8 CfgStep;
+} Test_Diag;
+
+static void Test_TpNotification(uint8 Channel, uint8 Nad, LinTp_StatusType Status, const uint8 *Data, uint16 Length)
+{
+    (void)Channel;
+    (void)Nad;
+    Test_Diag.Done = TRUE;
+    Test_Diag.Status = Status;
+    Test_Diag.Length = Length;
+    memcpy(Test_Diag.Data, Data, Length);
+}
+
+static void Test_CfgNotification(uint8 Channel, Lin_NodeCfgResultType Result, uint8 Step)
+{
+    (void)Channel;
+    Test_Diag.Done = TRUE;
+    Test_Diag.CfgResult = Result;
+    Test_Diag.CfgStep = Step;
+}
+
+static boolean Test_DiagDone(void *Arg)
+{
+    (void)Arg;
+    return Test_Diag.Done;
+}
+
+/**********************************************************
+ * @brief Schedule table with LinTp requests and a node configuration script.
+ **********************************************************/
+static void Test_Diagnostic(boolean Dma)
+{
+    static const LinTp_ConfigType tpConfig = {Test_TpNotification, 3};
+    static uint8 productId[LIN_NODECFG_DATA_LENGTH];
+    static const Lin_NodeCfgStepType script[] = {
+        LIN_NODECFG_ASSIGN_NAD(0x0A, TEST_SUPPLIER_ID, TEST_FUNCTION_ID, 0x0B),
+        LIN_NODECFG_READ_BY_ID(0x0B, 0, TEST_SUPPLIER_ID, TEST_FUNCTION_ID, productId),
+        LIN_NODECFG_SAVE_CONFIGURATION(0x0B),
+    };
+    const uint8 request[12] = {0x22, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    Test_DiagNodeType diag;
+
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Test_DiagNodeAdd(0, &diag, 0x0A);
+    Sim_NodeRespond(node, 0x10, Test_SlaveData, 2, FALSE);
+    LinTp_Init(&tpConfig);
+    Lin_ScheduleInit(Test_ScheduleConfig);
+    CHECK(Lin_ScheduleRequest(0, 0) == E_OK);
+    Sim_StartTask(Test_ScheduleTask, NULL, 0);
+
+    // Segmented request (FF + CF) and segmented response (FF + 2 CF)
+    CHECK(LinTp_Transmit(0, 0x0A, request, sizeof(request)) == E_OK);
+    CHECK(Sim_RunUntil(Test_DiagDone, NULL, SIM_MS(500)));
+    CHECK_EQ(Test_Diag.Status, LINTP_OK);
+    CHECK_EQ(Test_Diag.Length, sizeof(request));
+    CHECK_EQ(Test_Diag.Data[0], 0x62);
+    CHECK(memcmp(Test_Diag.Data + 1, request + 1, sizeof(request) - 1U) == 0);
+    CHECK_EQ(diag.Requests, 1);
+    CHECK(memcmp(Test_SchedData, Test_SlaveData, 2) == 0);
+
+    Test_Diag.Done = FALSE;
+    CHECK(Lin_NodeCfgStart(0, script, 3, Test_CfgNotification) == E_OK);
+    CHECK(Sim_RunUntil(Test_DiagDone, NULL, SIM_MS(500)));
+    CHECK_EQ(Test_Diag.CfgResult, LIN_NODECFG_OK);
+    CHECK_EQ(Test_Diag.CfgStep, 3);
+    CHECK_EQ(diag.Nad, 0x0B);
+    CHECK_EQ(productId[0] | (productId[1] << 8), TEST_SUPPLIER_ID);
+    CHECK_EQ(productId[2] | (productId[3] << 8), TEST_FUNCTION_ID);
+    CHECK_EQ(productId[4], TEST_VARIANT);
+
+    // Nobody answers NAD 0x20
+    Test_Diag.Done = FALSE;
+    CHECK(LinTp_Transmit(0, 0x20, request, 3) == E_OK);
+    CHECK(Sim_RunUntil(Test_DiagDone, NULL, SIM_MS(500)));
+    CHECK_EQ(Test_Diag.Status, LINTP_E_TIMEOUT);
+    CHECK_EQ(Lin_ScheduleGetAndClearOverrunCount(0), 0);
+}
+
+/**********************************************************
+ * @brief A MasterReq slot whose header cannot be sent keeps its segment for the next slot.
+ **********************************************************/
+static void Test_DiagnosticBlocked(boolean Dma)
+{
+    static const LinTp_ConfigType tpConfig = {Test_TpNotification, 3};
+    static Lin_PduType batch[4] = {
+        {0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data},
+        {0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data},
+        {0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data},
+        {0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data},
+    };
+    const uint8 request[12] = {0x22, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    Test_DiagNodeType diag;
+
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Test_DiagNodeAdd(0, &diag, 0x0A);
+    Sim_NodeRespond(node, 0x10, Test_SlaveData, 2, FALSE);
+    LinTp_Init(&tpConfig);
+    Lin_ScheduleInit(Test_ScheduleConfig);
+    CHECK(Lin_ScheduleRequest(0, 0) == E_OK);
+    Sim_StartTask(Test_ScheduleTask, NULL, 0);
+    Sim_Run(SIM_MS(35));
+
+    // The batch rejects Lin_SendFrame during the next MasterReq slot (60 ms)
+    CHECK(LinTp_Transmit(0, 0x0A, request, sizeof(request)) == E_OK);
+    CHECK(Lin_SendFrames(0, batch, 4, 10000, NULL) == E_OK);
+    CHECK(Sim_RunUntil(Test_DiagDone, NULL, SIM_MS(500)));
+    CHECK_EQ(Test_Diag.Status, LINTP_OK);
+    CHECK_EQ(Test_Diag.Length, sizeof(request));
+    CHECK(memcmp(Test_Diag.Data + 1, request + 1, sizeof(request) - 1U) == 0);
+    CHECK_EQ(diag.Requests, 1);
+}
+
+/**********************************************************
+ * @brief Schedules of the three channels: a master and a slave frame each, 10 ms slots.
+ **********************************************************/
+static uint8 Test_ClusterRx[MAX_LIN_CHANNELS][4];
+
+static const Lin_ScheduleEntryType Test_ClusterEntries[MAX_LIN_CHANNELS][2] = {
+    {{{0x10, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 4, Test_Data}, 10},
+     {{0x20, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 4, Test_ClusterRx[0]}, 10}},
+    {{{0x11, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 4, Test_Data + 1}, 10},
+     {{0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 4, Test_ClusterRx[1]}, 10}},
+    {{{0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 4, Test_Data + 2}, 10},
+     {{0x22, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 4, Test_ClusterRx[2]}, 10}},
+};
+
+static const Lin_ScheduleTableType Test_ClusterTables[MAX_LIN_CHANNELS] = {
+    {Test_ClusterEntries[0], 2},
+    {Test_ClusterEntries[1], 2},
+    {Test_ClusterEntries[2], 2},
+};
+
+static const Lin_ScheduleConfigType Test_ClusterConfig[MAX_LIN_CHANNELS] = {
+    {&Test_ClusterTables[0], 1},
+    {&Test_ClusterTables[1], 1},
+    {&Test_ClusterTables[2], 1},
+};
+
+/**********************************************************
+ * @brief Three masters run their schedules at the same slot boundaries.
+ * @details USART3 (PB10/PB11, DMA1 Ch2/3, CCR3) shares EXTI15_10 with
+ *          USART1 and TIM4 with both other channels; every bus must carry
+ *          its own frames only, on time and without slot overrun.
+ **********************************************************/
+static void Test_Clusters(boolean Dma)
+{
+    Sim_NodeType *nodes[MAX_LIN_CHANNELS];
+
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
+    {
+        Test_InitMaster(ch, Dma);
+        nodes[ch] = Sim_NodeAdd(ch, BAUD);
+        nodes[ch]->Length[0x10 + ch] = 4;
+        Sim_NodeRespond(nodes[ch], 0x20 + ch, Test_Data + 4 - ch, 4, FALSE);
+    }
+    Lin_ScheduleInit(Test_ClusterConfig);
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
+    {
+        CHECK(Lin_ScheduleRequest(ch, 0) == E_OK);
+        Sim_StartTask(Test_ScheduleTask, (void *)(uintptr_t)ch, 0);
+    }
+
+    // 20 slots per channel; the last frame ends well before 200 ms
+    Sim_Run(SIM_MS(199));
+
+    for (uint8 ch = 0; ch < MAX_LIN_CHANNELS; ch++)
+    {
+        const Sim_NodeType *node = nodes[ch];
+
+        CHECK_EQ(node->FrameCount, 20);
+        for (uint8 i = 0; i < 20U; i++)
+        {
+            const Sim_FrameType *frame = &node->Frames[i];
+            const uint8 *data = (i & 1U) ? (Test_Data + 4 - ch) : (Test_Data + ch);
+
+            CHECK_EQ(frame->Pid, Sim_Pid(((i & 1U) ? 0x20 : 0x10) + ch));
+            CHECK_EQ(frame->Count, 5);
+            CHECK(memcmp(frame->Data, data, 4) == 0);
+            CHECK(frame->Flags & SIM_FRAME_ENHANCED_OK);
+            if (i > 0U)
+            {
+                uint64 slot = frame->Start - node->Frames[i - 1U].Start;
+                CHECK((slot >= SIM_MS(10) - SIM_US(100)) && (slot <= SIM_MS(10) + SIM_US(100)));
+            }
+        }
+        CHECK(memcmp(Test_ClusterRx[ch], Test_Data + 4 - ch, 4) == 0);
+        CHECK_EQ(Lin_ScheduleGetAndClearOverrunCount(ch), 0);
+        CHECK_EQ(Test_ErrorCount(ch, LIN_ERR_HEADER), 0);
+        CHECK_EQ(Test_ErrorCount(ch, LIN_ERR_NO_RESP), 0);
+    }
+}
+
+/**********************************************************
+ * @brief Schedule with event-triggered and sporadic slots, 10 ms each.
+ * @details Table 0: event-triggered header 0x30 (associated 0x31 and 0x32),
+ *          master frame 0x13, sporadic slot (0x14 before 0x15). Table 1
+ *          resolves a collision by polling 0x31 and 0x32.
+ **********************************************************/
+static uint8 Test_EventRx[3];
+
+static const Lin_PduType Test_EventAssociated[] = {
+    {0x31, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 3, Test_EventRx},
+    {0x32, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 3, NULL}, // Signal buffer
+};
+
+static const Lin_PduType Test_SporadicFrames[] = {
+    {0x14, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data},
+    {0x15, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data + 2},
+};
+
+static const Lin_ScheduleEntryType Test_EventEntries[] = {
+    {{0x30, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 3, NULL}, 10, LIN_SCHED_EVENT_TRIGGERED, 1, Test_EventAssociated, 2},
+    {{0x13, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data}, 10},
+    {{0, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, NULL}, 10, LIN_SCHED_SPORADIC, LIN_SCHED_NULL_TABLE, Test_SporadicFrames, 2},
+};
+
+static const Lin_ScheduleEntryType Test_CollisionEntries[] = {
+    {{0x31, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 3, Test_EventRx}, 10},
+    {{0x32, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 3, NULL}, 10},
+};
+
+static const Lin_ScheduleTableType Test_EventTables[] = {
+    {Test_EventEntries, 3},
+    {Test_CollisionEntries, 2},
+};
+
+static const Lin_ScheduleConfigType Test_EventConfig[MAX_LIN_CHANNELS] = {{Test_EventTables, 2}};
+
+/**********************************************************
+ * @brief Check the frame IDs seen by a node since a given frame count.
+ **********************************************************/
+static void Test_CheckIds(const Sim_NodeType *Node, uint32 From, const uint8 *Ids, uint8 Count)
+{
+    CHECK_EQ(Node->FrameCount, From + Count);
+    for (uint8 i = 0; i < Count; i++)
+    {
+        CHECK_EQ(Node->Frames[(From + i) % SIM_FRAME_LOG].Pid, Sim_Pid(Ids[i]));
+    }
+}
+
+/**********************************************************
+ * @brief Event-triggered slot: routing by the PID in the first byte, collision
+ *        resolution and resume; sporadic slot silent until a flag is set.
+ **********************************************************/
+static void Test_EventTriggered(boolean Dma)
+{
+    static Lin_SignalBufferType buffer32;
+    static Lin_SignalBufferType *signals[64] = {[0x32] = &buffer32};
+    Lin_ConfigType config = Test_Config(0, LIN_MODE_MASTER, Dma);
+    const uint8 dataA[3] = {Sim_Pid(0x31), 0xA1, 0xA2};
+    const uint8 dataB[3] = {Sim_Pid(0x32), 0xB1, 0xB2};
+
+    config.Lin_SignalBufferTable = signals;
+    Lin_Init(&config);
+    Sim_NodeType *nodeA = Sim_NodeAdd(0, BAUD);
+    Sim_NodeType *nodeB = Sim_NodeAdd(0, BAUD);
+    nodeA->Length[0x13] = 2;
+    nodeA->Length[0x14] = 2;
+    nodeA->Length[0x15] = 2;
+    Sim_NodeRespond(nodeA, 0x30, dataA, 3, FALSE);
+    Sim_NodeRespond(nodeA, 0x31, dataA, 3, FALSE);
+    Sim_NodeRespond(nodeB, 0x32, dataB, 3, FALSE);
+
+    Lin_ScheduleInit(Test_EventConfig);
+    CHECK(Lin_ScheduleRequest(0, 0) == E_OK);
+    Sim_StartTask(Test_ScheduleTask, NULL, 0);
+
+    // Slave A has updated data: its response goes to the SduPtr of 0x31; the sporadic slot stays silent
+    Sim_Run(SIM_MS(29));
+    Test_CheckIds(nodeA, 0, (const uint8[]){0x30, 0x13}, 2);
+    CHECK(memcmp(Test_EventRx, dataA, 3) == 0);
+    CHECK(!buffer32.Updated);
+
+    // Slave B answers: 0x32 has no SduPtr, the response becomes the front half of its signal buffer
+    nodeA->Response[0x30].Publish = FALSE;
+    Sim_NodeRespond(nodeB, 0x30, dataB, 3, FALSE);
+    CHECK(Lin_ScheduleSetUpdateFlag(0, 0x15) == E_OK);
+    Sim_Run(SIM_MS(30));
+    Test_CheckIds(nodeA, 2, (const uint8[]){0x30, 0x13, 0x15}, 3);
+    CHECK(memcmp(Sim_NodeLastFrame(nodeA)->Data, Test_Data + 2, 2) == 0);
+    CHECK(buffer32.Updated);
+    CHECK(memcmp(buffer32.Data[buffer32.Front], dataB, 3) == 0);
+    CHECK_EQ(Lin_ScheduleGetAndClearCollisionCount(0), 0);
+
+    // Both answer: collision table (0x31, 0x32), then the main table resumes after the event-triggered slot
+    memset(Test_EventRx, 0, sizeof(Test_EventRx));
+    buffer32.Updated = FALSE;
+    nodeA->Response[0x30].Publish = TRUE;
+    Sim_Run(SIM_MS(40));
+    Test_CheckIds(nodeA, 5, (const uint8[]){0x30, 0x31, 0x32, 0x13}, 4);
+    CHECK(!(nodeA->Frames[5].Flags & SIM_FRAME_ENHANCED_OK));
+    CHECK_EQ(Lin_ScheduleGetAndClearCollisionCount(0), 1);
+    CHECK(memcmp(Test_EventRx, dataA, 3) == 0);
+    CHECK(buffer32.Updated);
+    CHECK(memcmp(buffer32.Data[buffer32.Front], dataB, 3) == 0);
+
+    // Both flags set: the sporadic slot sends 0x14 first, 0x15 one cycle later
+    nodeA->Response[0x30].Publish = FALSE;
+    nodeB->Response[0x30].Publish = FALSE;
+    CHECK(Lin_ScheduleSetUpdateFlag(0, 0x15) == E_OK);
+    CHECK(Lin_ScheduleSetUpdateFlag(0, 0x14) == E_OK);
+    Sim_Run(SIM_MS(40));
+    Test_CheckIds(nodeA, 9, (const uint8[]){0x14, 0x30, 0x13, 0x15}, 4);
+
+    // Flags consumed: the next sporadic slot is silent again
+    Sim_Run(SIM_MS(30));
+    Test_CheckIds(nodeA, 13, (const uint8[]){0x30, 0x13}, 2);
+    CHECK_EQ(Lin_ScheduleGetAndClearOverrunCount(0), 0);
+}
+
+static boolean Test_StatusIs(void *Arg)
+{
+    const uint8 *sdu;
+    return Lin_GetStatus(0, &sdu) == (Lin_StatusType)(uintptr_t)Arg;
+}
+
+static boolean Test_BusRecessive(void *Arg)
+{
+    return Sim_BusLevel((uint8)(uintptr_t)Arg) == 1U;
+}
+
+/**********************************************************
+ * @brief Go-to-sleep command, wake-up detection and wake-up pulse.
+ **********************************************************/
+static void Test_Sleep(boolean Dma)
+{
+    static const uint8 sleepCommand[8] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    const uint8 *sdu;
+
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    node->Length[0x12] = 2;
+
+    CHECK(Lin_GoToSleep(0) == E_OK);
+    CHECK(Sim_RunUntil(Test_StatusIs, (void *)(uintptr_t)LIN_CH_SLEEP, SIM_MS(20)));
+    Sim_Run(SIM_US(200));
+    Test_CheckFrame(node, LINTP_ID_MASTER_REQ, sleepCommand, 8, SIM_FRAME_CLASSIC_OK);
+    CHECK(Lin_SendFrame(0, &(Lin_PduType){0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data}) == E_NOT_OK);
+
+    // A spike is ignored, a pulse of 250 us is a wake-up, reported once
+    Sim_NodeSendPulse(node, SIM_US(50), SIM_US(100));
+    Sim_Run(SIM_MS(1));
+    CHECK(Lin_CheckWakeup(0) == E_NOT_OK);
+    Sim_NodeSendPulse(node, SIM_US(250), SIM_US(100));
+    Sim_Run(SIM_MS(1));
+    CHECK(Lin_CheckWakeup(0) == E_OK);
+    CHECK(Lin_CheckWakeup(0) == E_NOT_OK);
+    CHECK_EQ(Lin_GetStatus(0, &sdu), LIN_CH_SLEEP);
+    CHECK(Lin_WakeupInternal(0) == E_OK);
+    CHECK_EQ(Lin_GetStatus(0, &sdu), LIN_OPERATIONAL);
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_OK);
+
+    // Wake-up pulse of this node: about 1 ms dominant, not taken for a remote wake-up
+    CHECK(Lin_GoToSleepInternal(0) == E_OK);
+    Sim_Run(SIM_MS(1));
+    CHECK(Lin_Wakeup(0) == E_OK);
+    Sim_Run(SIM_US(10));
+    CHECK_EQ(Sim_BusLevel(0), 0);
+    CHECK(Sim_RunUntil(Test_BusRecessive, (void *)(uintptr_t)0, SIM_MS(10)));
+    uint64 width = Sim_Now() - Sim_BusLastFall(0);
+    CHECK((width >= SIM_US(980)) && (width <= SIM_US(1100)));
+    CHECK_EQ(Lin_GetStatus(0, &sdu), LIN_OPERATIONAL);
+    CHECK(Lin_CheckWakeup(0) == E_NOT_OK);
+    Sim_Run(SIM_MS(2));
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_OK);
+    Sim_Run(SIM_US(200));
+    Test_CheckFrame(node, 0x12, Test_Data, 2, SIM_FRAME_ENHANCED_OK);
+}
+
+/**********************************************************
+ * @brief Wake-up detection after the clock fell back to HSI (as after STOP):
+ *        SystemCoreClock still says 72 MHz, the pulse must be timed right anyway.
+ **********************************************************/
+static void Test_WakeupHsi(void)
+{
+    Test_InitMaster(0, FALSE);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+
+    CHECK(Lin_GoToSleepInternal(0) == E_OK);
+    Sim_SetClocks(8000000U, 8000000U, 8000000U);
+
+    Sim_NodeSendPulse(node, SIM_US(100), SIM_US(100));
+    Sim_Run(SIM_MS(1));
+    CHECK(Lin_CheckWakeup(0) == E_NOT_OK);
+    Sim_NodeSendPulse(node, SIM_US(250), SIM_US(100));
+    Sim_Run(SIM_MS(1));
+    CHECK(Lin_CheckWakeup(0) == E_OK);
+}
+
+/**********************************************************
+ * @brief Bus shorted to ground: the channel degrades, then recovers once the bus is released.
+ **********************************************************/
+static void Test_StuckBus(boolean Dma)
+{
+    Lin_PduType pdu = {0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data};
+    const uint8 *sdu;
+
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    node->Length[0x12] = 2;
+
+    Sim_BusSetStuck(0, TRUE);
+    for (uint8 i = 0; i < 3U; i++)
+    {
+        CHECK(Lin_SendFrame(0, &pdu) == E_OK);
+        CHECK_EQ(Test_Wait(0, &sdu), (i < 2U) ? LIN_TX_HEADER_ERROR : LIN_NOT_OK);
+    }
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_HEADER), 3);
+    CHECK(Lin_SendFrame(0, &pdu) == E_NOT_OK);
+
+    // A recovery attempt with the bus still stuck keeps the channel degraded
+    Sim_Run(SIM_MS(60));
+    CHECK_EQ(Lin_GetStatus(0, &sdu), LIN_NOT_OK);
+
+    Sim_BusSetStuck(0, FALSE);
+    uint64 released = Sim_Now();
+    CHECK(Sim_RunUntil(Test_StatusIs, (void *)(uintptr_t)LIN_OPERATIONAL, SIM_MS(60)));
+    CHECK(Sim_Now() - released <= SIM_MS(50));
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 2, NULL), LIN_TX_OK);
+    Sim_Run(SIM_US(200));
+    Test_CheckFrame(node, 0x12, Test_Data, 2, SIM_FRAME_ENHANCED_OK);
+}
+
+static struct
+{
+    boolean Done;
+    uint8 NumOk;
+} Test_Batch;
+
+static void Test_BatchNotification(uint8 Channel, uint8 NumOk)
+{
+    (void)Channel;
+    Test_Batch.Done = TRUE;
+    Test_Batch.NumOk = NumOk;
+}
+
+static boolean Test_BatchDone(void *Arg)
+{
+    (void)Arg;
+    return Test_Batch.Done;
+}
+
+/**********************************************************
+ * @brief Batch of four frames paced by the driver timer; a failed frame does not stop it.
+ **********************************************************/
+static void Test_Batches(boolean Dma)
+{
+    static uint8 rx[2][4];
+    static Lin_PduType frames[4] = {
+        {0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 4, Test_Data},
+        {0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 4, rx[0]},
+        {0x13, LIN_CLASSIC_CS, LIN_FRAMERESPONSE_TX, 2, Test_Data + 4},
+        {0x22, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, 4, rx[1]},
+    };
+
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    node->Length[0x12] = 4;
+    node->Length[0x13] = 2;
+    Sim_NodeRespond(node, 0x21, Test_Data, 4, FALSE);
+    Sim_NodeRespond(node, 0x22, Test_Data + 4, 4, FALSE);
+
+    CHECK(Lin_SendFrames(0, frames, 4, 1000, Test_BatchNotification) == E_OK);
+    CHECK(Lin_SendFrame(0, &frames[0]) == E_NOT_OK);
+    CHECK(Sim_RunUntil(Test_BatchDone, NULL, SIM_MS(100)));
+    CHECK_EQ(Test_Batch.NumOk, 4);
+    Sim_Run(SIM_US(200));
+    CHECK_EQ(node->FrameCount, 4);
+    CHECK(memcmp(rx[0], Test_Data, 4) == 0);
+    CHECK(memcmp(rx[1], Test_Data + 4, 4) == 0);
+    CHECK_EQ(node->Frames[2].Pid, Sim_Pid(0x13));
+    CHECK(node->Frames[2].Flags & SIM_FRAME_CLASSIC_OK);
+    for (uint8 i = 1; i < 4U; i++)
+    {
+        CHECK(node->Frames[i].Start - node->Frames[i - 1U].End >= SIM_US(1000));
+    }
+
+    // No response to the second frame
+    node->Response[0x21].Publish = FALSE;
+    Test_Batch.Done = FALSE;
+    CHECK(Lin_SendFrames(0, frames, 4, 1000, Test_BatchNotification) == E_OK);
+    CHECK(Sim_RunUntil(Test_BatchDone, NULL, SIM_MS(100)));
+    CHECK_EQ(Test_Batch.NumOk, 3);
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_NO_RESP), 1);
+}
+
+/**********************************************************
+ * @brief Bit time of the last frame on the bus, from its header (34 bits).
+ **********************************************************/
+static uint32 Test_HeaderBitNs(const Sim_NodeType *Node)
+{
+    const Sim_FrameType *frame = Sim_NodeLastFrame(Node);
+
+    CHECK((frame != NULL) && (frame->HeaderEnd != 0U));
+    return (uint32)((frame->HeaderEnd - frame->Start) / 34U);
+}
+
+/**********************************************************
+ * @brief Baud rate switched between frames: 19200, 9600 and back.
+ **********************************************************/
+static void Test_Baudrate(boolean Dma)
+{
+    static const uint32 rates[] = {9600, BAUD};
+    const uint8 *sdu;
+
+    Test_InitMaster(0, Dma);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    node->Length[0x12] = 4;
+    Sim_NodeRespond(node, 0x21, Test_Data, 4, FALSE);
+
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 4, NULL), LIN_TX_OK);
+    uint32 bitNs = Test_HeaderBitNs(node);
+    CHECK((bitNs >= BIT_NS * 98U / 100U) && (bitNs <= BIT_NS * 102U / 100U));
+
+    for (uint8 i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+    {
+        uint32 nominalNs = 1000000000U / rates[i];
+
+        Sim_Run(SIM_MS(1));
+        CHECK(Lin_SetBaudrate(0, rates[i]) == E_OK);
+        node->BaudRate = rates[i];
+
+        CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 4, NULL), LIN_TX_OK);
+        Test_CheckFrame(node, 0x12, Test_Data, 4, SIM_FRAME_ENHANCED_OK);
+        bitNs = Test_HeaderBitNs(node);
+        CHECK((bitNs >= nominalNs * 98U / 100U) && (bitNs <= nominalNs * 102U / 100U));
+
+        // The response timeout follows the new bit time
+        CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, NULL, 4, &sdu), LIN_RX_OK);
+        CHECK(memcmp(sdu, Test_Data, 4) == 0);
+        bitNs = Test_HeaderBitNs(node);
+        CHECK((bitNs >= nominalNs * 98U / 100U) && (bitNs <= nominalNs * 102U / 100U));
+    }
+    CHECK_EQ(Test_ErrorCount(0, LIN_ERR_NO_RESP), 0);
+
+    // Rate without BRR value, invalid channel
+    Sim_Run(SIM_MS(1));
+    CHECK(Lin_SetBaudrate(0, 10400) == E_NOT_OK);
+    CHECK(Lin_SetBaudrate(0, 0) == E_NOT_OK);
+    CHECK(Lin_SetBaudrate(MAX_LIN_CHANNELS, BAUD) == E_NOT_OK);
+
+    // Frame in flight: refused, the frame ends at the old rate
+    Lin_PduType pdu = {0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, 4, Test_Data};
+    CHECK(Lin_SendFrame(0, &pdu) == E_OK);
+    Sim_Run(SIM_US(500));
+    CHECK(Lin_SetBaudrate(0, 9600) == E_NOT_OK);
+    CHECK_EQ(Test_Wait(0, &sdu), LIN_TX_OK);
+    Test_CheckFrame(node, 0x12, Test_Data, 4, SIM_FRAME_ENHANCED_OK);
+    bitNs = Test_HeaderBitNs(node);
+    CHECK((bitNs >= BIT_NS * 98U / 100U) && (bitNs <= BIT_NS * 102U / 100U));
+}
+
+/**********************************************************
+ * @brief Bit times between two cycle counter values.
+ **********************************************************/
+static uint32 Test_Bits(uint32 From, uint32 To)
+{
+    return (To - From) / (SystemCoreClock / BAUD);
+}
+
+/**********************************************************
+ * @brief Timing records, response time histogram and slot utilization.
+ * @details Interrupt mode only: the first response byte is not seen by DMA.
+ **********************************************************/
+static void Test_Timing(void)
+{
+    static const struct
+    {
+        uint8 SpaceBits; /* Response space before the first byte */
+        uint8 Bin;       /* (50 + SpaceBits) / 50 in tenths, from 1.0 */
+    } delays[] = {{1, 1}, {12, 3}, {19, 4}};
+    Lin_TimingRecordType record;
+    Lin_TimingStatsType stats;
+    uint8 rx[4];
+
+    Test_InitMaster(0, FALSE);
+    Sim_NodeType *node = Sim_NodeAdd(0, BAUD);
+    Sim_NodeRespond(node, 0x21, Test_Data, 4, FALSE);
+    CHECK(Lin_GetTimingRecord(&record) == E_NOT_OK);
+    CHECK(Lin_GetTimingRecord(NULL) == E_NOT_OK);
+    Sim_Run(SIM_US(10));
+
+    for (uint8 i = 0; i < sizeof(delays) / sizeof(delays[0]); i++)
+    {
+        node->Response[0x21].ResponseSpaceNs = delays[i].SpaceBits * BIT_NS;
+        CHECK_EQ(Test_Frame(0, 0x21, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_RX, rx, 4, NULL), LIN_RX_OK);
+
+        CHECK(Lin_GetTimingRecord(&record) == E_OK);
+        CHECK_EQ(record.Channel, 0);
+        CHECK_EQ(record.Pid, Sim_Pid(0x21));
+        CHECK_EQ(record.Status, LIN_RX_OK);
+        CHECK((record.BreakStart != 0U) && (record.BreakStart < record.HeaderEnd));
+        CHECK(record.HeaderEnd < record.FirstByte);
+        CHECK(record.FirstByte < record.End);
+
+        // Break, delimiter, sync and PID; one byte; four data bytes and the checksum
+        uint32 header = Test_Bits(record.BreakStart, record.HeaderEnd);
+        CHECK((header >= 33U) && (header <= 35U));
+        uint32 first = Test_Bits(record.HeaderEnd, record.FirstByte);
+        CHECK((first >= 10U + delays[i].SpaceBits - 1U) && (first <= 10U + delays[i].SpaceBits + 1U));
+        uint32 response = Test_Bits(record.HeaderEnd, record.End);
+        CHECK((response >= 50U + delays[i].SpaceBits - 1U) && (response <= 50U + delays[i].SpaceBits + 1U));
+
+        CHECK(Lin_GetTimingStats(0, 0x21, &stats) == E_OK);
+        CHECK_EQ(stats.Frames, i + 1U);
+        CHECK_EQ(stats.ResponseHistogram[delays[i].Bin], 1);
+        Sim_Run(SIM_MS(1));
+    }
+    CHECK(Lin_GetTimingRecord(&record) == E_NOT_OK);
+    CHECK_EQ(stats.ResponseHistogram[0] + stats.ResponseHistogram[2] + stats.ResponseHistogram[5], 0);
+
+    // Maxima from the slowest frame, just below the 1.4 response timeout: 34 + 69 bits
+    CHECK((stats.MaxHeaderUs >= 33U * BIT_NS / 1000U) && (stats.MaxHeaderUs <= 35U * BIT_NS / 1000U));
+    CHECK((stats.MaxResponseUs >= 68U * BIT_NS / 1000U) && (stats.MaxResponseUs <= 70U * BIT_NS / 1000U));
+    CHECK((stats.MaxFrameUs >= 102U * BIT_NS / 1000U) && (stats.MaxFrameUs <= 104U * BIT_NS / 1000U));
+
+    // A TX frame has no response time class
+    node->Length[0x12] = 4;
+    CHECK_EQ(Test_Frame(0, 0x12, LIN_ENHANCED_CS, LIN_FRAMERESPONSE_TX, Test_Data, 4, NULL), LIN_TX_OK);
+    CHECK(Lin_GetTimingRecord(&record) == E_OK);
+    CHECK_EQ(record.Status, LIN_TX_OK);
+    CHECK(record.BreakStart < record.HeaderEnd);
+    CHECK(record.HeaderEnd < record.End);
+    CHECK(Lin_GetTimingStats(0, 0x12, &stats) == E_OK);
+    CHECK_EQ(stats.Frames, 1);
+    for (uint8 bin = 0; bin < LIN_TIMING_HISTOGRAM_BINS; bin++)
+    {
+        CHECK_EQ(stats.ResponseHistogram[bin], 0);
+    }
+
+    // Utilization of a 10 ms slot by the slowest frame: 53 %
+    CHECK(Lin_GetTimingStats(0, 0x21, &stats) == E_OK);
+    CHECK_EQ(Lin_GetSlotUtilization(0, 0x21, 10000), stats.MaxFrameUs * 100U / 10000U);
+    CHECK_EQ(Lin_GetSlotUtilization(0, 0x21, 10000), 53);
+    CHECK_EQ(Lin_GetSlotUtilization(0, 0x21, 5000), stats.MaxFrameUs * 100U / 5000U);
+    CHECK_EQ(Lin_GetSlotUtilization(0, 0x21, 100), 255);
+    CHECK_EQ(Lin_GetSlotUtilization(0, 0x21, 0), 0);
+    CHECK_EQ(Lin_GetSlotUtilization(0, 0x22, 10000), 0);
+    CHECK_EQ(Lin_GetSlotUtilization(0, 0x40, 10000), 0);
+    CHECK(Lin_GetTimingStats(0, 0x40, &stats) == E_NOT_OK);
+    CHECK(Lin_GetTimingStats(MAX_LIN_CHANNELS, 0x21, &stats) == E_NOT_OK);
+    CHECK(Lin_GetTimingStats(0, 0x21, NULL) == E_NOT_OK);
+}
+
+TEST_IRQ_DMA(Test_MasterTx)
+TEST_IRQ_DMA(Test_MasterRx)
+TEST_IRQ_DMA(Test_SignalBuffer)
+TEST_IRQ_DMA(Test_Checksum)
+TEST_IRQ_DMA(Test_RxErrors)
+TEST_IRQ_DMA(Test_TxErrors)
+TEST_IRQ_DMA(Test_SlaveFast)
+TEST_IRQ_DMA(Test_SlaveSlow)
+TEST_IRQ_DMA(Test_MasterSlave)
+TEST_IRQ_DMA(Test_Diagnostic)
+TEST_IRQ_DMA(Test_DiagnosticBlocked)
+TEST_IRQ_DMA(Test_Clusters)
+TEST_IRQ_DMA(Test_EventTriggered)
+TEST_IRQ_DMA(Test_Sleep)
+TEST_IRQ_DMA(Test_StuckBus)
+TEST_IRQ_DMA(Test_Batches)
+TEST_IRQ_DMA(Test_Baudrate)
+
+/**********************************************************
+ * @brief Test registry.
+ **********************************************************/
+static const struct
+{
+    const char *Name;
+    void (*Run)(void);
+} Test_List[] = {
+    {"master_tx", Test_MasterTxIrq},
+    {"master_tx_dma", Test_MasterTxDma},
+    {"master_rx", Test_MasterRxIrq},
+    {"master_rx_dma", Test_MasterRxDma},
+    {"signal_buffer", Test_SignalBufferIrq},
+    {"signal_buffer_dma", Test_SignalBufferDma},
+    {"checksum", Test_ChecksumIrq},
+    {"checksum_dma", Test_ChecksumDma},
+    {"rx_errors", Test_RxErrorsIrq},
+    {"rx_errors_dma", Test_RxErrorsDma},
+    {"tx_errors", Test_TxErrorsIrq},
+    {"tx_errors_dma", Test_TxErrorsDma},
+    {"slave_fast", Test_SlaveFastIrq},
+    {"slave_fast_dma", Test_SlaveFastDma},
+    {"slave_slow", Test_SlaveSlowIrq},
+    {"slave_slow_dma", Test_SlaveSlowDma},
+    {"master_slave", Test_MasterSlaveIrq},
+    {"master_slave_dma", Test_MasterSlaveDma},
+    {"monitor", Test_Monitor},
+    {"monitor_gap", Test_MonitorGap},
+    {"diagnostic", Test_DiagnosticIrq},
+    {"diagnostic_dma", Test_DiagnosticDma},
+    {"diagnostic_blocked", Test_DiagnosticBlockedIrq},
+    {"diagnostic_blocked_dma", Test_DiagnosticBlockedDma},
+    {"clusters", Test_ClustersIrq},
+    {"clusters_dma", Test_ClustersDma},
+    {"event_triggered", Test_EventTriggeredIrq},
+    {"event_triggered_dma", Test_EventTriggeredDma},
+    {"sleep", Test_SleepIrq},
+    {"sleep_dma", Test_SleepDma},
+    {"wakeup_hsi", Test_WakeupHsi},
+    {"stuck_bus", Test_StuckBusIrq},
+    {"stuck_bus_dma", Test_StuckBusDma},
+    {"batch", Test_BatchesIrq},
+    {"batch_dma", Test_BatchesDma},
+    {"baudrate", Test_BaudrateIrq},
+    {"baudrate_dma", Test_BaudrateDma},
+    {"timing", Test_Timing},
+};
+
+#define TEST_COUNT (sizeof(Test_List) / sizeof(Test_List[0]))
+
+int main(int argc, char **argv)
+{
+    unsigned failed = 0;
+    unsigned run = 0;
+
+    for (unsigned i = 0; i < TEST_COUNT; i++)
+    {
+        if ((argc > 1) && (strcmp(argv[1], Test_List[i].Name) != 0))
+        {
+            continue;
+        }
+
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            Sim_Init();
+            Test_List[i].Run();
+            _exit(0);
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        boolean ok = (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) ? TRUE : FALSE;
+        printf("%-28s %s\n", Test_List[i].Name, ok ? "ok" : "FAILED");
+        failed += ok ? 0U : 1U;
+        run++;
+    }
+
+    if (run == 0U)
+    {
+        fprintf(stderr, "no test named %s\n", argv[1]);
+        return 2;
+    }
+    printf("%u tests, %u failed\n", run, failed);
+    return (failed == 0U) ? 0 : 1;
+}
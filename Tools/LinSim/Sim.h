@@ -0,0 +1,306 @@
+/**********************************************************
+ * @file Sim.h
+ * @brief Host simulator of the STM32F103 LIN and CAN hardware.
+ * @details Runs the unmodified LIN and CAN drivers (MCAL/Lin, MCAL/Can) on an
+ *          x86-64 Linux host:
+ *          - Register models of USART1...3, DMA1, TIM4, EXTI, AFIO, GPIOA/B,
+ *            bxCAN1, RCC and the DWT cycle counter, mapped at their real
+ *            addresses.
+ *            Every driver access is trapped, so read and write side effects
+ *            (rc_w0 flags, SR-then-DR sequences, TXE/TC/RXNE/LBD/IDLE timing
+ *            from BRR and the bus clocks) behave as on the device.
+ *          - An NVIC dispatching the driver's IRQ handlers one at a time,
+ *            lowest IRQ number first, with PRIMASK and per-line enables.
+ *          - Up to SIM_BUSES virtual LIN buses (wired-AND), each channel's
+ *            Tx/Rx pins attached through a transceiver, and simulated nodes
+ *            (slaves with response tables, or masters) with bit errors,
+ *            response delays, clock deviation and bus faults.
+ *          - One CAN bus at frame level: the frames of CAN1 and of the test
+ *            (Sim_CanSendFrame) are sent one after the other, the lowest
+ *            identifier winning the arbitration.
+ *          Time advances in fixed steps (1 us by default). Interrupts are
+ *          taken between steps; tasks (Sim_StartTask) run to completion
+ *          between interrupts, like a cooperative main loop. The CPU time of
+ *          ISRs and tasks is estimated from their register accesses: the CPU
+ *          stays busy for SIM_CYCLES_ENTRY plus SIM_CYCLES_PER_ACCESS per
+ *          access and cannot take another interrupt meanwhile.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "stm32f10x.h"
+#include "Std_Types.h"
+
+/**********************************************************
+ * @brief Simulator limits and CPU cost estimate.
+ **********************************************************/
+#define SIM_BUSES 3U                 /**< @brief Virtual LIN buses. */
+#define SIM_NODES 8U                 /**< @brief Simulated nodes over all buses. */
+#define SIM_FRAME_LOG 256U           /**< @brief Frames kept by each node (ring buffer). */
+#define SIM_TX_QUEUE 64U             /**< @brief Symbols a node can queue for transmission. */
+#define SIM_TASKS 8U                 /**< @brief Concurrent tasks. */
+#define SIM_CYCLES_ENTRY 24U         /**< @brief Exception entry and return, in CPU cycles. */
+#define SIM_CYCLES_PER_ACCESS 20U    /**< @brief Peripheral access and the code around it, in CPU cycles. */
+#define SIM_STORM_LIMIT 500U         /**< @brief Dispatches of one IRQ within 1 ms taken as an interrupt storm. */
+#define SIM_CAN_LOG 256U             /**< @brief Frames of CAN1 kept by the CAN bus (ring buffer). */
+#define SIM_CAN_QUEUE 16U            /**< @brief Frames the test can queue on the CAN bus. */
+
+/**********************************************************
+ * @brief Time conversions (simulated time is in nanoseconds).
+ **********************************************************/
+#define SIM_US(us) ((uint64)(us) * 1000U)
+#define SIM_MS(ms) ((uint64)(ms) * 1000000U)
+
+/**********************************************************
+ * @brief Flags of a frame recorded by a node (Sim_FrameType.Flags).
+ **********************************************************/
+#define SIM_FRAME_SYNC_OK 0x01U     /**< @brief Sync byte 0x55 received. */
+#define SIM_FRAME_PID_OK 0x02U      /**< @brief PID received with correct parity. */
+#define SIM_FRAME_CLASSIC_OK 0x04U  /**< @brief Last byte is the classic checksum of the data. */
+#define SIM_FRAME_ENHANCED_OK 0x08U /**< @brief Last byte is the enhanced checksum of PID and data. */
+#define SIM_FRAME_LINE_ERROR 0x10U  /**< @brief Framing error in a byte after the break. */
+#define SIM_FRAME_INCOMPLETE 0x20U  /**< @brief Fewer bytes than Dl + 1 before the response timeout. */
+
+/**********************************************************
+ * @brief Frame identifier meaning "any frame" (Sim_DisturbType.Id).
+ **********************************************************/
+#define SIM_ANY_ID 0xFFU
+
+/**********************************************************
+ * @typedef Sim_ResponseType
+ * @brief Response of a node to the header of one frame ID.
+ * @details With Publish FALSE the node only records the frame. The faults
+ *          apply to every response sent from the entry.
+ **********************************************************/
+typedef struct
+{
+    boolean Publish;       /**< @brief The node sends the response. */
+    boolean Classic;       /**< @brief Classic checksum (always for 0x3C/0x3D). */
+    uint8 Dl;              /**< @brief Data length (1...8). */
+    uint8 Data[8];         /**< @brief Data bytes. */
+    uint32 ResponseSpaceNs; /**< @brief Delay from the end of the PID to the first byte. */
+    uint32 InterByteNs;    /**< @brief Delay between the response bytes. */
+    boolean BadChecksum;   /**< @brief Send an inverted checksum. */
+    uint8 Truncate;        /**< @brief Send only this many bytes (0: all Dl + 1). */
+} Sim_ResponseType;
+
+/**********************************************************
+ * @typedef Sim_FrameType
+ * @brief One frame seen on the bus by a node.
+ * @details The frame starts at a break (11 bits dominant) and ends once
+ *          Dl + 1 bytes follow the PID, on the next break, or at the
+ *          response timeout (1.4 * 10 * (Dl + 1) bits after the PID).
+ **********************************************************/
+typedef struct
+{
+    uint64 Start;     /**< @brief Falling edge of the break. */
+    uint64 HeaderEnd; /**< @brief Stop bit of the PID, 0 if not received. */
+    uint64 End;       /**< @brief Stop bit of the last byte, or time of the timeout. */
+    uint8 Pid;        /**< @brief Protected identifier as received. */
+    uint8 Count;      /**< @brief Bytes received after the PID. */
+    uint8 Data[9];    /**< @brief Data bytes followed by the checksum. */
+    uint8 Flags;      /**< @brief SIM_FRAME_* flags. */
+} Sim_FrameType;
+
+/**********************************************************
+ * @typedef Sim_DisturbType
+ * @brief Bit error injected by a node: one bit forced dominant.
+ * @details Char 0 is the sync byte, 1 the PID and 2... the response bytes;
+ *          Bit 0 is the start bit, 1...8 the data bits and 9 the stop bit.
+ *          Frames are matched by ID from the response on (Char >= 2).
+ **********************************************************/
+typedef struct
+{
+    uint8 Count; /**< @brief Frames still to disturb (0: off). */
+    uint8 Id;    /**< @brief Frame ID, or SIM_ANY_ID. */
+    uint8 Char;  /**< @brief Character of the frame. */
+    uint8 Bit;   /**< @brief Bit of the character. */
+} Sim_DisturbType;
+
+/**********************************************************
+ * @typedef Sim_CanFrameType
+ * @brief One data frame on the CAN bus.
+ * @details A frame lasts 47 (standard) or 67 (extended) bits plus 8 bits
+ *          per data byte at the bit rate of CAN1; stuff bits are not counted.
+ **********************************************************/
+typedef struct
+{
+    uint32 Id;        /**< @brief Identifier (11 or 29 bits). */
+    boolean Extended; /**< @brief 29-bit identifier. */
+    uint8 Dlc;        /**< @brief Data length (0...8). */
+    uint8 Data[8];    /**< @brief Data bytes. */
+    uint64 Start;     /**< @brief Start of frame. */
+    uint64 End;       /**< @brief End of the interframe space. */
+} Sim_CanFrameType;
+
+typedef struct Sim_Node Sim_NodeType;
+
+/**********************************************************
+ * @typedef Sim_HeaderCallbackType
+ * @brief Called when a node has received a PID, before its response is looked up.
+ **********************************************************/
+typedef void (*Sim_HeaderCallbackType)(Sim_NodeType *Node, uint8 Pid);
+
+/**********************************************************
+ * @typedef Sim_FrameCallbackType
+ * @brief Called when a node closes a frame.
+ **********************************************************/
+typedef void (*Sim_FrameCallbackType)(Sim_NodeType *Node, const Sim_FrameType *Frame);
+
+/**********************************************************
+ * @struct Sim_Node
+ * @brief Simulated LIN node; the fields up to User may be set by the test.
+ **********************************************************/
+struct Sim_Node
+{
+    uint8 Bus;                       /**< @brief Bus the node is connected to. */
+    uint32 BaudRate;                 /**< @brief Nominal baud rate. */
+    sint32 ClockPpm;                 /**< @brief Clock deviation: positive runs fast (shorter bits). */
+    Sim_ResponseType Response[64];   /**< @brief Response of each frame ID. */
+    uint8 Length[64];                /**< @brief Expected Dl of frames the node does not publish. */
+    Sim_HeaderCallbackType OnHeader; /**< @brief May be NULL. */
+    Sim_FrameCallbackType OnFrame;   /**< @brief May be NULL. */
+    Sim_DisturbType Disturb;         /**< @brief Bit error to inject. */
+    void *User;                      /**< @brief Free for the test. */
+
+    Sim_FrameType Frames[SIM_FRAME_LOG]; /**< @brief Frames closed, FrameCount % SIM_FRAME_LOG is the next slot. */
+    uint32 FrameCount;                   /**< @brief Frames closed since Sim_NodeAdd. */
+
+    /* Internal state */
+    struct
+    {
+        uint8 Kind;
+        uint8 Value;
+        uint64 Gap;
+        uint64 Length;
+    } Queue[SIM_TX_QUEUE];
+    uint8 QueueHead, QueueTail;
+    boolean TxActive;
+    uint64 TxStart, TxFree;
+    uint8 TxOut;
+    uint8 RxState, RxBit, RxData, PrevLevel;
+    uint64 RxStart, LowSince;
+    boolean BreakSeen;
+    boolean FrameOpen;
+    uint8 FrameChar;
+    Sim_FrameType Frame;
+    uint64 DisturbFrom, DisturbTo;
+};
+
+/**********************************************************
+ * @typedef Sim_TaskType
+ * @brief Task run by the simulator; returns the delay to its next run in ns, 0 to stop.
+ **********************************************************/
+typedef uint64 (*Sim_TaskType)(void *Arg);
+
+/**********************************************************
+ * @typedef Sim_StatsType
+ * @brief CPU statistics since Sim_Init or Sim_ResetStats.
+ **********************************************************/
+typedef struct
+{
+    uint32 IsrEntries;     /**< @brief Interrupt handlers run. */
+    uint32 IsrAccesses;    /**< @brief Peripheral accesses from the handlers. */
+    uint32 TaskAccesses;   /**< @brief Peripheral accesses from the tasks. */
+    uint32 MaxIsrAccesses; /**< @brief Most accesses of a single handler run. */
+    uint64 IsrBusyNs;      /**< @brief Estimated CPU time in the handlers. */
+    uint64 TaskBusyNs;     /**< @brief Estimated CPU time in the tasks. */
+    uint64 ElapsedNs;      /**< @brief Simulated time. */
+    uint32 Entries[64];    /**< @brief Handler runs per IRQ number. */
+} Sim_StatsType;
+
+/**********************************************************
+ * @brief Map the registers, reset every model and the time.
+ * @details Clocks: 72 MHz SYSCLK/HCLK, PCLK1 36 MHz, PCLK2 72 MHz; the
+ *          channels are attached to the bus of the same number. Call once
+ *          per process.
+ **********************************************************/
+void Sim_Init(void);
+
+/**********************************************************
+ * @brief Set the time step (default 1000 ns).
+ **********************************************************/
+void Sim_SetStep(uint32 StepNs);
+
+/**********************************************************
+ * @brief Switch the clocks; SystemCoreClock is left unchanged, as on the device.
+ **********************************************************/
+void Sim_SetClocks(uint32 SysClk, uint32 Pclk1, uint32 Pclk2);
+
+/**********************************************************
+ * @brief Current simulated time in ns.
+ **********************************************************/
+uint64 Sim_Now(void);
+
+/**********************************************************
+ * @brief Advance the simulation.
+ **********************************************************/
+void Sim_Run(uint64 Ns);
+
+/**********************************************************
+ * @brief Advance until a condition holds or a timeout elapses.
+ * @return TRUE if the condition held.
+ **********************************************************/
+boolean Sim_RunUntil(boolean (*Condition)(void *Arg), void *Arg, uint64 TimeoutNs);
+
+/**********************************************************
+ * @brief Start a task; it first runs after FirstDelayNs.
+ **********************************************************/
+void Sim_StartTask(Sim_TaskType Task, void *Arg, uint64 FirstDelayNs);
+
+/**********************************************************
+ * @brief Stop every task.
+ **********************************************************/
+void Sim_StopTasks(void);
+
+/**********************************************************
+ * @brief Report a failure with the simulated time and exit with status 1.
+ **********************************************************/
+void Sim_Fail(const char *Format, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+/**********************************************************
+ * @brief CPU statistics.
+ **********************************************************/
+void Sim_GetStats(Sim_StatsType *Stats);
+void Sim_ResetStats(void);
+
+/**********************************************************
+ * @brief Bus wiring and faults.
+ **********************************************************/
+uint8 Sim_BusLevel(uint8 Bus);                           /**< @brief 1 recessive, 0 dominant. */
+uint64 Sim_BusLastFall(uint8 Bus);                       /**< @brief Time of the last recessive to dominant edge. */
+void Sim_BusAttach(uint8 Channel, uint8 Bus);            /**< @brief Connect a channel's transceiver to a bus. */
+void Sim_BusSetStuck(uint8 Bus, boolean Dominant);       /**< @brief Short the bus to ground (TRUE) or release it. */
+void Sim_BusGlitch(uint8 Bus, uint64 Start, uint64 Ns);  /**< @brief Force the bus dominant for a while. */
+
+/**********************************************************
+ * @brief Simulated nodes.
+ **********************************************************/
+Sim_NodeType *Sim_NodeAdd(uint8 Bus, uint32 BaudRate); /**< @brief Listening node, no response configured. */
+void Sim_NodeRespond(Sim_NodeType *Node, uint8 Id, const uint8 *Data, uint8 Dl, boolean Classic);
+void Sim_NodeSendHeader(Sim_NodeType *Node, uint8 Id, uint64 GapNs);
+void Sim_NodeSendFrame(Sim_NodeType *Node, uint8 Id, const uint8 *Data, uint8 Dl, boolean Classic, uint64 GapNs);
+void Sim_NodeSendPulse(Sim_NodeType *Node, uint64 Ns, uint64 GapNs);
+boolean Sim_NodeIdle(const Sim_NodeType *Node);          /**< @brief Nothing queued or being sent. */
+const Sim_FrameType *Sim_NodeLastFrame(const Sim_NodeType *Node); /**< @brief NULL if none closed yet. */
+uint8 Sim_Pid(uint8 Id);                                 /**< @brief Protected identifier of a frame ID. */
+uint8 Sim_Checksum(uint8 Pid, boolean Classic, const uint8 *Data, uint8 Dl);
+
+/**********************************************************
+ * @brief CAN bus.
+ * @details A frame of the test is received by CAN1 at its end if CAN1 is
+ *          in normal mode and a filter accepts it; in Sleep mode its start
+ *          of frame is a wake-up (WKUI, with AWUM CAN1 leaves Sleep mode)
+ *          and the frame itself is lost.
+ **********************************************************/
+void Sim_CanSendFrame(uint32 Id, boolean Extended, const uint8 *Data, uint8 Dlc); /**< @brief Queue a frame of another node. */
+void Sim_CanSetErrors(uint16 Tec, uint8 Rec, uint8 Lec);  /**< @brief Error counters (TEC above 255: bus-off) and last error code. */
+boolean Sim_CanIdle(void);                                /**< @brief No frame queued, pending in CAN1 or on the bus. */
+uint32 Sim_CanTxCount(void);                              /**< @brief Frames sent by CAN1 since Sim_Init. */
+const Sim_CanFrameType *Sim_CanTxFrame(uint32 Index);     /**< @brief Frame Index (0: first) sent by CAN1, NULL if not kept. */
+
+#endif /* SIM_H */
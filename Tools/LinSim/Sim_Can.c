@@ -0,0 +1,865 @@
+/**********************************************************
+ * @file Sim_Can.c
+ * @brief Register model of bxCAN1 and a frame-level CAN bus.
+ * @details Operating modes (initialization, normal, sleep) with the
+ *          INAK/SLAK handshakes, master reset, automatic wake-up (AWUM),
+ *          the SLAKI/WKUI/ERRI status change flags, three transmit
+ *          mailboxes (identifier or request order, abort), two 3-deep
+ *          receive FIFOs with full/overrun and locked mode, 32-bit
+ *          mask/list filter banks, the error counters and flags, and the
+ *          SPL functions the CAN driver calls. Mode changes are
+ *          acknowledged at once, as the driver polls INAK/SLAK without
+ *          letting the time advance. Only the behaviour the driver relies
+ *          on is modelled.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Sim_Internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_CAN_BANKS 14U            /**< @brief Filter banks of CAN1 (medium density). */
+#define SIM_CAN_NO_MAILBOX 0xFFU     /**< @brief Frame on the bus sent by the test. */
+#define SIM_CAN_MSR_RC_W1 (CAN_MSR_ERRI | CAN_MSR_WKUI | CAN_MSR_SLAKI)
+#define SIM_CAN_TSR_STATUS 0x0FUL    /**< @brief RQCP, TXOK, ALST and TERR of mailbox 0 (next ones 8 bits up). */
+
+/**********************************************************
+ * @brief Transmit mailbox: registers and order of the request.
+ **********************************************************/
+typedef struct
+{
+    uint32 Tir, Tdtr, Tdlr, Tdhr;
+    uint32 Sequence;
+} Sim_CanMailboxType;
+
+/**********************************************************
+ * @brief Receive FIFO: stored frames in RIR/RDTR/RDLR/RDHR layout, Entry[0] is the output mailbox.
+ **********************************************************/
+typedef struct
+{
+    uint32 Entry[3][4];
+    uint8 Count;
+    uint32 Flags; /**< @brief FULL and FOVR. */
+} Sim_CanFifoType;
+
+static struct
+{
+    uint32 Mcr, Msr, Tsr, Ier, Esr, Btr; /**< @brief Msr: INAK, SLAK and the rc_w1 flags; Tsr: mailbox status bits only. */
+    Sim_CanMailboxType Mailbox[3];
+    uint32 Sequence;
+    Sim_CanFifoType Fifo[2];
+    uint32 Fmr, Fm1r, Fs1r, Ffa1r, Fa1r;
+    uint32 Filter[SIM_CAN_BANKS][2];
+} Sim_Can;
+
+static struct
+{
+    Sim_CanFrameType Queue[SIM_CAN_QUEUE];
+    uint8 QueueHead, QueueCount;
+    boolean Busy;
+    Sim_CanFrameType Frame;  /**< @brief Frame on the bus. */
+    uint8 Mailbox;           /**< @brief Mailbox sending it, SIM_CAN_NO_MAILBOX for a frame of the test. */
+    boolean Listening;       /**< @brief CAN1 was in normal mode at its start of frame. */
+    Sim_CanFrameType Log[SIM_CAN_LOG];
+    uint32 LogCount;
+} Sim_CanBus;
+
+/**********************************************************
+ * @brief Image helper (valid while the range is opened by the trap).
+ **********************************************************/
+static void Sim_CanPut(uint32 Offset, uint32 Value)
+{
+    *(volatile uint32 *)(CAN1_BASE + Offset) = Value;
+}
+
+/**********************************************************
+ * @brief Reset values: Sleep mode, filters in initialization mode.
+ **********************************************************/
+static void Sim_CanResetRegisters(void)
+{
+    memset(&Sim_Can, 0, sizeof(Sim_Can));
+    Sim_Can.Mcr = 0x00010002UL;
+    Sim_Can.Msr = CAN_MSR_SLAK;
+    Sim_Can.Btr = 0x01230000UL;
+    Sim_Can.Fmr = 0x2A1C0E01UL;
+    if (Sim_CanBus.Busy && (Sim_CanBus.Mailbox != SIM_CAN_NO_MAILBOX))
+    {
+        Sim_CanBus.Busy = FALSE; // Frame of CAN1 cut short
+    }
+    Sim_CanBus.Listening = FALSE;
+}
+
+void Sim_CanReset(void)
+{
+    memset(&Sim_CanBus, 0, sizeof(Sim_CanBus));
+    Sim_CanResetRegisters();
+}
+
+static boolean Sim_CanNormal(void)
+{
+    return ((Sim_Can.Msr & (CAN_MSR_INAK | CAN_MSR_SLAK)) == 0U) ? TRUE : FALSE;
+}
+
+/**********************************************************
+ * @brief Mode requested by INRQ/SLEEP; both set keeps the current mode.
+ **********************************************************/
+static void Sim_CanUpdateMode(void)
+{
+    boolean inrq = (Sim_Can.Mcr & CAN_MCR_INRQ) ? TRUE : FALSE;
+    boolean sleep = (Sim_Can.Mcr & CAN_MCR_SLEEP) ? TRUE : FALSE;
+
+    if (inrq && !sleep)
+    {
+        Sim_Can.Msr = (Sim_Can.Msr & ~CAN_MSR_SLAK) | CAN_MSR_INAK;
+    }
+    else if (!inrq && sleep)
+    {
+        if (!(Sim_Can.Msr & CAN_MSR_SLAK) && (Sim_Can.Ier & CAN_IER_SLKIE))
+        {
+            Sim_Can.Msr |= CAN_MSR_SLAKI; // Only set with SLKIE
+        }
+        Sim_Can.Msr = (Sim_Can.Msr & ~CAN_MSR_INAK) | CAN_MSR_SLAK;
+    }
+    else if (!inrq && !sleep)
+    {
+        Sim_Can.Msr &= ~(CAN_MSR_INAK | CAN_MSR_SLAK);
+    }
+    if (!(Sim_Can.Msr & CAN_MSR_SLAK))
+    {
+        Sim_Can.Msr &= ~CAN_MSR_SLAKI; // Cleared by hardware with SLAK
+    }
+}
+
+static void Sim_CanWriteMcr(uint32 Value)
+{
+    if (Value & CAN_MCR_RESET)
+    {
+        Sim_CanResetRegisters(); // Master reset: back to Sleep mode, RESET reads 0
+        return;
+    }
+    Sim_Can.Mcr = Value & 0x000100FFUL;
+    Sim_CanUpdateMode();
+}
+
+/**********************************************************
+ * @brief Start of frame seen in Sleep mode.
+ **********************************************************/
+static void Sim_CanWakeup(void)
+{
+    Sim_Can.Msr |= CAN_MSR_WKUI;
+    if (Sim_Can.Mcr & CAN_MCR_AWUM)
+    {
+        Sim_Can.Mcr &= ~CAN_MCR_SLEEP;
+        Sim_CanUpdateMode();
+    }
+}
+
+/**********************************************************
+ * @brief Transmit mailboxes.
+ **********************************************************/
+static boolean Sim_CanMailboxEmpty(uint8 Mailbox)
+{
+    return (Sim_Can.Mailbox[Mailbox].Tir & CAN_TI0R_TXRQ) ? FALSE : TRUE;
+}
+
+static void Sim_CanRequest(uint8 Mailbox)
+{
+    Sim_Can.Mailbox[Mailbox].Sequence = ++Sim_Can.Sequence;
+    Sim_Can.Tsr &= ~(SIM_CAN_TSR_STATUS << (8U * Mailbox)); // RQCP cleared on a new request
+}
+
+static void Sim_CanAbort(uint8 Mailbox)
+{
+    // A frame already on the bus is completed
+    if (Sim_CanMailboxEmpty(Mailbox) || (Sim_CanBus.Busy && (Sim_CanBus.Mailbox == Mailbox)))
+    {
+        return;
+    }
+    Sim_Can.Mailbox[Mailbox].Tir &= ~CAN_TI0R_TXRQ;
+    Sim_Can.Tsr = (Sim_Can.Tsr & ~(SIM_CAN_TSR_STATUS << (8U * Mailbox))) | (CAN_TSR_RQCP0 << (8U * Mailbox));
+}
+
+static void Sim_CanWriteTsr(uint32 Value)
+{
+    for (uint8 n = 0; n < 3U; n++)
+    {
+        if (Value & (CAN_TSR_RQCP0 << (8U * n)))
+        {
+            Sim_Can.Tsr &= ~(SIM_CAN_TSR_STATUS << (8U * n));
+        }
+        if (Value & (CAN_TSR_ABRQ0 << (8U * n)))
+        {
+            Sim_CanAbort(n);
+        }
+    }
+}
+
+static uint32 Sim_CanTsr(void)
+{
+    uint32 tsr = Sim_Can.Tsr;
+    uint32 code = 0xFFU;
+
+    for (uint8 n = 0; n < 3U; n++)
+    {
+        if (Sim_CanMailboxEmpty(n))
+        {
+            tsr |= CAN_TSR_TME0 << n;
+            code = (code == 0xFFU) ? n : code;
+        }
+    }
+    return tsr | (((code == 0xFFU) ? 0U : code) << 24);
+}
+
+/**********************************************************
+ * @brief Receive FIFOs.
+ **********************************************************/
+static uint32 Sim_CanRfr(uint8 Fifo)
+{
+    return Sim_Can.Fifo[Fifo].Count | Sim_Can.Fifo[Fifo].Flags;
+}
+
+static void Sim_CanRelease(uint8 Fifo)
+{
+    Sim_CanFifoType *fifo = &Sim_Can.Fifo[Fifo];
+
+    if (fifo->Count == 0U)
+    {
+        return;
+    }
+    memmove(fifo->Entry[0], fifo->Entry[1], sizeof(fifo->Entry[0]) * 2U);
+    memset(fifo->Entry[2], 0, sizeof(fifo->Entry[2]));
+    fifo->Count--;
+}
+
+static void Sim_CanWriteRfr(uint8 Fifo, uint32 Value)
+{
+    Sim_Can.Fifo[Fifo].Flags &= ~(Value & (CAN_RF0R_FULL0 | CAN_RF0R_FOVR0)); // rc_w1
+    if (Value & CAN_RF0R_RFOM0)
+    {
+        Sim_CanRelease(Fifo);
+    }
+}
+
+static boolean Sim_CanFifoIrq(uint8 Fifo)
+{
+    uint32 ier = Sim_Can.Ier >> (4U * Fifo);
+    const Sim_CanFifoType *fifo = &Sim_Can.Fifo[Fifo];
+
+    return (((fifo->Count != 0U) && (ier & CAN_IER_FMPIE0)) || ((fifo->Flags & CAN_RF0R_FULL0) && (ier & CAN_IER_FFIE0)) ||
+            ((fifo->Flags & CAN_RF0R_FOVR0) && (ier & CAN_IER_FOVIE0))) ? TRUE : FALSE;
+}
+
+/**********************************************************
+ * @brief Filter banks: FIFO and filter match index of a data frame.
+ * @return FALSE if no active bank accepts the frame.
+ * @details Filter numbers are given per FIFO in bank order (one per 32-bit
+ *          mask, two per 32-bit list, two or four per 16-bit bank, active
+ *          or not). The first bank accepting the frame is taken.
+ **********************************************************/
+static boolean Sim_CanAccept(const Sim_CanFrameType *Frame, uint8 *Fifo, uint8 *Fmi)
+{
+    uint32 word = Frame->Extended ? ((Frame->Id << 3) | CAN_TI0R_IDE) : (Frame->Id << 21);
+    uint8 number[2] = {0, 0};
+
+    for (uint8 bank = 0; bank < SIM_CAN_BANKS; bank++)
+    {
+        uint32 bit = 1UL << bank;
+        uint8 fifo = (Sim_Can.Ffa1r & bit) ? 1U : 0U;
+        boolean list = (Sim_Can.Fm1r & bit) ? TRUE : FALSE;
+
+        if (!(Sim_Can.Fs1r & bit))
+        {
+            if (Sim_Can.Fa1r & bit)
+            {
+                Sim_Fail("CAN filter bank %u: 16-bit scale not modelled", bank);
+            }
+            number[fifo] = (uint8)(number[fifo] + (list ? 4U : 2U));
+            continue;
+        }
+        if (Sim_Can.Fa1r & bit)
+        {
+            uint32 r1 = Sim_Can.Filter[bank][0] & ~1UL;
+            uint32 r2 = Sim_Can.Filter[bank][1] & ~1UL;
+
+            if ((list && ((word == r1) || (word == r2))) || (!list && (((word ^ r1) & r2) == 0U)))
+            {
+                *Fifo = fifo;
+                *Fmi = (uint8)(number[fifo] + ((list && (word != r1)) ? 1U : 0U));
+                return TRUE;
+            }
+        }
+        number[fifo] = (uint8)(number[fifo] + (list ? 2U : 1U));
+    }
+    return FALSE;
+}
+
+/**********************************************************
+ * @brief Frame of the test received by CAN1.
+ **********************************************************/
+static void Sim_CanReceived(const Sim_CanFrameType *Frame)
+{
+    uint8 fifoNumber, fmi;
+
+    if (!Sim_CanBus.Listening || !Sim_CanNormal() || (Sim_Can.Fmr & CAN_FMR_FINIT) || !Sim_CanAccept(Frame, &fifoNumber, &fmi))
+    {
+        return;
+    }
+
+    Sim_CanFifoType *fifo = &Sim_Can.Fifo[fifoNumber];
+    uint32 *entry;
+    if (fifo->Count == 3U)
+    {
+        fifo->Flags |= CAN_RF0R_FOVR0;
+        if (Sim_Can.Mcr & CAN_MCR_RFLM)
+        {
+            return; // Locked: the new frame is discarded
+        }
+        entry = fifo->Entry[2]; // Else it overwrites the last one
+    }
+    else
+    {
+        entry = fifo->Entry[fifo->Count++];
+        if (fifo->Count == 3U)
+        {
+            fifo->Flags |= CAN_RF0R_FULL0;
+        }
+    }
+
+    entry[0] = Frame->Extended ? ((Frame->Id << 3) | CAN_TI0R_IDE) : (Frame->Id << 21);
+    entry[1] = Frame->Dlc | ((uint32)fmi << 8);
+    entry[2] = 0;
+    entry[3] = 0;
+    for (uint8 i = 0; i < Frame->Dlc; i++)
+    {
+        entry[2U + i / 4U] |= (uint32)Frame->Data[i] << (8U * (i % 4U));
+    }
+}
+
+/**********************************************************
+ * @brief Frame of a mailbox sent: logged, the mailbox reports success.
+ **********************************************************/
+static void Sim_CanTransmitted(uint8 Mailbox)
+{
+    Sim_CanBus.Log[Sim_CanBus.LogCount % SIM_CAN_LOG] = Sim_CanBus.Frame;
+    Sim_CanBus.LogCount++;
+    Sim_Can.Mailbox[Mailbox].Tir &= ~CAN_TI0R_TXRQ;
+    Sim_Can.Tsr |= (CAN_TSR_RQCP0 | CAN_TSR_TXOK0) << (8U * Mailbox);
+    Sim_Can.Esr &= ~CAN_ESR_LEC; // No error
+}
+
+/**********************************************************
+ * @brief Frame held by a mailbox.
+ **********************************************************/
+static Sim_CanFrameType Sim_CanMailboxFrame(uint8 Mailbox)
+{
+    const Sim_CanMailboxType *box = &Sim_Can.Mailbox[Mailbox];
+    Sim_CanFrameType frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.Extended = (box->Tir & CAN_TI0R_IDE) ? TRUE : FALSE;
+    frame.Id = frame.Extended ? (box->Tir >> 3) : (box->Tir >> 21);
+    frame.Dlc = (uint8)(((box->Tdtr & 0xFU) > 8U) ? 8U : (box->Tdtr & 0xFU));
+    for (uint8 i = 0; i < 8U; i++)
+    {
+        frame.Data[i] = (uint8)(((i < 4U) ? box->Tdlr : box->Tdhr) >> (8U * (i % 4U)));
+    }
+    return frame;
+}
+
+/**********************************************************
+ * @brief Arbitration field as a number: the lower one wins.
+ * @details A standard data frame beats an extended one with the same base
+ *          identifier (its IDE bit is dominant, SRR is recessive).
+ **********************************************************/
+static uint32 Sim_CanArbitration(const Sim_CanFrameType *Frame)
+{
+    if (Frame->Extended)
+    {
+        return (((Frame->Id >> 18) & 0x7FFUL) << 20) | (1UL << 19) | (Frame->Id & 0x3FFFFUL);
+    }
+    return (Frame->Id & 0x7FFUL) << 20;
+}
+
+/**********************************************************
+ * @brief Mailbox CAN1 sends next: request order with TXFP, else identifier priority.
+ **********************************************************/
+static uint8 Sim_CanNextMailbox(void)
+{
+    uint8 next = SIM_CAN_NO_MAILBOX;
+
+    for (uint8 n = 0; n < 3U; n++)
+    {
+        if (Sim_CanMailboxEmpty(n))
+        {
+            continue;
+        }
+        if (next == SIM_CAN_NO_MAILBOX)
+        {
+            next = n;
+        }
+        else if (Sim_Can.Mcr & CAN_MCR_TXFP)
+        {
+            next = (Sim_Can.Mailbox[n].Sequence < Sim_Can.Mailbox[next].Sequence) ? n : next;
+        }
+        else
+        {
+            Sim_CanFrameType a = Sim_CanMailboxFrame(n);
+            Sim_CanFrameType b = Sim_CanMailboxFrame(next);
+            next = (Sim_CanArbitration(&a) < Sim_CanArbitration(&b)) ? n : next;
+        }
+    }
+    return next;
+}
+
+/**********************************************************
+ * @brief Duration of a frame at the bit rate set in BTR.
+ **********************************************************/
+static uint64 Sim_CanFrameNs(const Sim_CanFrameType *Frame)
+{
+    uint32 brp = (Sim_Can.Btr & 0x3FFU) + 1U;
+    uint32 tq = 3U + ((Sim_Can.Btr >> 16) & 0xFU) + ((Sim_Can.Btr >> 20) & 0x7U);
+    uint32 bits = (Frame->Extended ? 67U : 47U) + 8U * Frame->Dlc;
+
+    return (uint64)bits * brp * tq * 1000000000ULL / Sim_Clocks.Pclk1;
+}
+
+void Sim_CanStep(uint64 Now, uint32 Clock)
+{
+    if (Sim_CanBus.Busy && (Now >= Sim_CanBus.Frame.End))
+    {
+        Sim_CanBus.Busy = FALSE;
+        if (Sim_CanBus.Mailbox != SIM_CAN_NO_MAILBOX)
+        {
+            Sim_CanTransmitted(Sim_CanBus.Mailbox);
+        }
+        else
+        {
+            Sim_CanReceived(&Sim_CanBus.Frame);
+        }
+    }
+    if (Sim_CanBus.Busy)
+    {
+        return;
+    }
+
+    boolean sending = ((Clock != 0U) && Sim_CanNormal() && !(Sim_Can.Esr & CAN_ESR_BOFF)) ? TRUE : FALSE;
+    uint8 mailbox = sending ? Sim_CanNextMailbox() : SIM_CAN_NO_MAILBOX;
+    const Sim_CanFrameType *queued = (Sim_CanBus.QueueCount != 0U) ? &Sim_CanBus.Queue[Sim_CanBus.QueueHead] : NULL;
+    Sim_CanFrameType own;
+
+    if (mailbox != SIM_CAN_NO_MAILBOX)
+    {
+        own = Sim_CanMailboxFrame(mailbox);
+    }
+    if ((queued != NULL) && ((mailbox == SIM_CAN_NO_MAILBOX) || (Sim_CanArbitration(queued) < Sim_CanArbitration(&own))))
+    {
+        Sim_CanBus.Frame = *queued;
+        Sim_CanBus.Mailbox = SIM_CAN_NO_MAILBOX;
+        Sim_CanBus.QueueHead = (uint8)((Sim_CanBus.QueueHead + 1U) % SIM_CAN_QUEUE);
+        Sim_CanBus.QueueCount--;
+        boolean asleep = ((Clock != 0U) && (Sim_Can.Msr & CAN_MSR_SLAK)) ? TRUE : FALSE;
+        if (asleep)
+        {
+            Sim_CanWakeup(); // The frame itself is lost
+        }
+        Sim_CanBus.Listening = ((Clock != 0U) && !asleep && Sim_CanNormal()) ? TRUE : FALSE;
+    }
+    else if (mailbox != SIM_CAN_NO_MAILBOX)
+    {
+        Sim_CanBus.Frame = own;
+        Sim_CanBus.Mailbox = mailbox;
+    }
+    else
+    {
+        return;
+    }
+
+    Sim_CanBus.Frame.Start = Now;
+    Sim_CanBus.Frame.End = Now + Sim_CanFrameNs(&Sim_CanBus.Frame);
+    Sim_CanBus.Busy = TRUE;
+    if (Sim_TraceOn)
+    {
+        printf("%12.3f us  CAN %s 0x%lX [%u]\n", (double)Now / 1e3,
+               (Sim_CanBus.Mailbox != SIM_CAN_NO_MAILBOX) ? "tx" : "rx", (unsigned long)Sim_CanBus.Frame.Id,
+               Sim_CanBus.Frame.Dlc);
+    }
+}
+
+boolean Sim_CanIrq(IRQn_Type IRQn)
+{
+    switch (IRQn)
+    {
+    case CAN1_TX_IRQn:
+        return ((Sim_Can.Tsr & (CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2)) && (Sim_Can.Ier & CAN_IER_TMEIE)) ? TRUE : FALSE;
+    case USB_LP_CAN1_RX0_IRQn:
+        return Sim_CanFifoIrq(0);
+    case CAN1_SCE_IRQn:
+        return (((Sim_Can.Msr & CAN_MSR_ERRI) && (Sim_Can.Ier & CAN_IER_ERRIE)) ||
+                ((Sim_Can.Msr & CAN_MSR_WKUI) && (Sim_Can.Ier & CAN_IER_WKUIE)) ||
+                ((Sim_Can.Msr & CAN_MSR_SLAKI) && (Sim_Can.Ier & CAN_IER_SLKIE))) ? TRUE : FALSE;
+    default:
+        return FALSE;
+    }
+}
+
+/**********************************************************
+ * @brief CAN1: register image and side effects.
+ **********************************************************/
+void Sim_CanSync(void)
+{
+    uint32 msr = Sim_Can.Msr;
+
+    if (Sim_CanBus.Busy)
+    {
+        msr |= (Sim_CanBus.Mailbox != SIM_CAN_NO_MAILBOX) ? CAN_MSR_TXM : (Sim_CanBus.Listening ? CAN_MSR_RXM : 0U);
+    }
+    Sim_CanPut(0x00U, Sim_Can.Mcr);
+    Sim_CanPut(0x04U, msr);
+    Sim_CanPut(0x08U, Sim_CanTsr());
+    Sim_CanPut(0x0CU, Sim_CanRfr(0));
+    Sim_CanPut(0x10U, Sim_CanRfr(1));
+    Sim_CanPut(0x14U, Sim_Can.Ier);
+    Sim_CanPut(0x18U, Sim_Can.Esr);
+    Sim_CanPut(0x1CU, Sim_Can.Btr);
+    for (uint8 n = 0; n < 3U; n++)
+    {
+        Sim_CanPut(0x180U + 0x10U * n, Sim_Can.Mailbox[n].Tir);
+        Sim_CanPut(0x184U + 0x10U * n, Sim_Can.Mailbox[n].Tdtr);
+        Sim_CanPut(0x188U + 0x10U * n, Sim_Can.Mailbox[n].Tdlr);
+        Sim_CanPut(0x18CU + 0x10U * n, Sim_Can.Mailbox[n].Tdhr);
+    }
+    for (uint8 f = 0; f < 2U; f++)
+    {
+        for (uint8 i = 0; i < 4U; i++)
+        {
+            Sim_CanPut(0x1B0U + 0x10U * f + 4U * i, Sim_Can.Fifo[f].Entry[0][i]);
+        }
+    }
+    Sim_CanPut(0x200U, Sim_Can.Fmr);
+    Sim_CanPut(0x204U, Sim_Can.Fm1r);
+    Sim_CanPut(0x20CU, Sim_Can.Fs1r);
+    Sim_CanPut(0x214U, Sim_Can.Ffa1r);
+    Sim_CanPut(0x21CU, Sim_Can.Fa1r);
+    for (uint8 bank = 0; bank < SIM_CAN_BANKS; bank++)
+    {
+        Sim_CanPut(0x240U + 8U * bank, Sim_Can.Filter[bank][0]);
+        Sim_CanPut(0x244U + 8U * bank, Sim_Can.Filter[bank][1]);
+    }
+}
+
+void Sim_CanAccess(uint32 Offset, boolean Write, uint32 Value)
+{
+    if (!Write)
+    {
+        return;
+    }
+
+    switch (Offset)
+    {
+    case 0x00U: Sim_CanWriteMcr(Value); break;
+    case 0x04U: Sim_Can.Msr &= ~(Value & SIM_CAN_MSR_RC_W1); break;
+    case 0x08U: Sim_CanWriteTsr(Value); break;
+    case 0x0CU: Sim_CanWriteRfr(0, Value); break;
+    case 0x10U: Sim_CanWriteRfr(1, Value); break;
+    case 0x14U: Sim_Can.Ier = Value & 0x00038F7FUL; break;
+    case 0x18U: Sim_Can.Esr = (Sim_Can.Esr & ~CAN_ESR_LEC) | (Value & CAN_ESR_LEC); break; // Only LEC is writable
+    case 0x1CU:
+        if (Sim_Can.Msr & CAN_MSR_INAK)
+        {
+            Sim_Can.Btr = Value & 0xC37F03FFUL; // Initialization mode only
+        }
+        break;
+    case 0x200U: Sim_Can.Fmr = Value; break;
+    case 0x204U: Sim_Can.Fm1r = Value & 0x3FFFU; break;
+    case 0x20CU: Sim_Can.Fs1r = Value & 0x3FFFU; break;
+    case 0x214U: Sim_Can.Ffa1r = Value & 0x3FFFU; break;
+    case 0x21CU: Sim_Can.Fa1r = Value & 0x3FFFU; break;
+    default:
+        if ((Offset >= 0x180U) && (Offset < 0x1B0U))
+        {
+            uint8 n = (uint8)((Offset - 0x180U) / 0x10U);
+            if (Sim_CanMailboxEmpty(n))
+            {
+                (&Sim_Can.Mailbox[n].Tir)[(Offset & 0xFU) / 4U] = Value; // Writable while empty
+                if ((Offset & 0xFU) == 0U && (Value & CAN_TI0R_TXRQ))
+                {
+                    Sim_CanRequest(n);
+                }
+            }
+        }
+        else if ((Offset >= 0x240U) && (Offset < SIM_CAN_SIZE))
+        {
+            uint8 bank = (uint8)((Offset - 0x240U) / 8U);
+            if ((Sim_Can.Fmr & CAN_FMR_FINIT) || !(Sim_Can.Fa1r & (1UL << bank)))
+            {
+                Sim_Can.Filter[bank][(Offset & 0x7U) / 4U] = Value; // Inactive bank or FINIT only
+            }
+        }
+        break;
+    }
+}
+
+/**********************************************************
+ * @brief CAN bus interface of the tests.
+ **********************************************************/
+void Sim_CanSendFrame(uint32 Id, boolean Extended, const uint8 *Data, uint8 Dlc)
+{
+    if ((Dlc > 8U) || (Sim_CanBus.QueueCount == SIM_CAN_QUEUE))
+    {
+        Sim_Fail("CAN frame 0x%lX: bad length or queue full", (unsigned long)Id);
+    }
+
+    Sim_CanFrameType *frame = &Sim_CanBus.Queue[(Sim_CanBus.QueueHead + Sim_CanBus.QueueCount) % SIM_CAN_QUEUE];
+    memset(frame, 0, sizeof(*frame));
+    frame->Id = Id & (Extended ? 0x1FFFFFFFUL : 0x7FFUL);
+    frame->Extended = Extended;
+    frame->Dlc = Dlc;
+    if (Dlc != 0U)
+    {
+        memcpy(frame->Data, Data, Dlc);
+    }
+    Sim_CanBus.QueueCount++;
+}
+
+void Sim_CanSetErrors(uint16 Tec, uint8 Rec, uint8 Lec)
+{
+    uint32 flags = 0;
+
+    if ((Tec >= 96U) || (Rec >= 96U))
+    {
+        flags |= CAN_ESR_EWGF;
+    }
+    if ((Tec > 127U) || (Rec > 127U))
+    {
+        flags |= CAN_ESR_EPVF;
+    }
+    if (Tec > 255U)
+    {
+        flags |= CAN_ESR_BOFF;
+    }
+
+    // ERRI follows a flag getting set or a new error code, if its source is enabled
+    uint32 rising = flags & ~Sim_Can.Esr;
+    if (((rising & CAN_ESR_EWGF) && (Sim_Can.Ier & CAN_IER_EWGIE)) ||
+        ((rising & CAN_ESR_EPVF) && (Sim_Can.Ier & CAN_IER_EPVIE)) ||
+        ((rising & CAN_ESR_BOFF) && (Sim_Can.Ier & CAN_IER_BOFIE)) ||
+        ((Lec >= 1U) && (Lec <= 6U) && (Sim_Can.Ier & CAN_IER_LECIE)))
+    {
+        Sim_Can.Msr |= CAN_MSR_ERRI;
+    }
+    Sim_Can.Esr = flags | ((uint32)(Lec & 0x7U) << 4) | ((uint32)((Tec > 255U) ? 255U : Tec) << 16) | ((uint32)Rec << 24);
+}
+
+boolean Sim_CanIdle(void)
+{
+    return ((Sim_CanBus.QueueCount == 0U) && !Sim_CanBus.Busy && Sim_CanMailboxEmpty(0) && Sim_CanMailboxEmpty(1) &&
+            Sim_CanMailboxEmpty(2)) ? TRUE : FALSE;
+}
+
+uint32 Sim_CanTxCount(void)
+{
+    return Sim_CanBus.LogCount;
+}
+
+const Sim_CanFrameType *Sim_CanTxFrame(uint32 Index)
+{
+    if ((Index >= Sim_CanBus.LogCount) || (Sim_CanBus.LogCount - Index > SIM_CAN_LOG))
+    {
+        return NULL;
+    }
+    return &Sim_CanBus.Log[Index % SIM_CAN_LOG];
+}
+
+/**********************************************************
+ * @brief Register pointer passed to an SPL function: only CAN1 is modelled.
+ **********************************************************/
+static void Sim_CanCheck(const CAN_TypeDef *CANx)
+{
+    if (CANx != CAN1)
+    {
+        Sim_Fail("SPL call on an unmodelled CAN controller");
+    }
+}
+
+/**********************************************************
+ * @brief SPL functions used by the driver; each counts the accesses it makes on the device.
+ **********************************************************/
+void CAN_DeInit(CAN_TypeDef *CANx)
+{
+    Sim_CanCheck(CANx);
+    Sim_CanResetRegisters(); // RCC_APB1RSTR pulse
+    Sim_CountAccess(2);
+}
+
+uint8_t CAN_Init(CAN_TypeDef *CANx, CAN_InitTypeDef *CAN_InitStruct)
+{
+    static const uint32 options[6] = {CAN_MCR_TTCM, CAN_MCR_ABOM, CAN_MCR_AWUM, CAN_MCR_NART, CAN_MCR_RFLM, CAN_MCR_TXFP};
+    const FunctionalState states[6] = {CAN_InitStruct->CAN_TTCM, CAN_InitStruct->CAN_ABOM, CAN_InitStruct->CAN_AWUM,
+                                       CAN_InitStruct->CAN_NART, CAN_InitStruct->CAN_RFLM, CAN_InitStruct->CAN_TXFP};
+
+    Sim_CanCheck(CANx);
+    if (CAN_InitStruct->CAN_Mode != CAN_Mode_Normal)
+    {
+        Sim_Fail("CAN loop back and silent modes are not modelled");
+    }
+    Sim_CountAccess(8);
+
+    Sim_CanWriteMcr(Sim_Can.Mcr & ~CAN_MCR_SLEEP);
+    Sim_CanWriteMcr(Sim_Can.Mcr | CAN_MCR_INRQ);
+    if (!(Sim_Can.Msr & CAN_MSR_INAK))
+    {
+        return CAN_InitStatus_Failed;
+    }
+
+    uint32 mcr = Sim_Can.Mcr;
+    for (uint8 i = 0; i < 6U; i++)
+    {
+        mcr = (states[i] == ENABLE) ? (mcr | options[i]) : (mcr & ~options[i]);
+    }
+    Sim_CanWriteMcr(mcr);
+    Sim_Can.Btr = ((uint32)CAN_InitStruct->CAN_SJW << 24) | ((uint32)CAN_InitStruct->CAN_BS1 << 16) |
+                  ((uint32)CAN_InitStruct->CAN_BS2 << 20) | ((uint32)CAN_InitStruct->CAN_Prescaler - 1U);
+    Sim_CanWriteMcr(Sim_Can.Mcr & ~CAN_MCR_INRQ);
+
+    return (Sim_Can.Msr & CAN_MSR_INAK) ? CAN_InitStatus_Failed : CAN_InitStatus_Success;
+}
+
+void CAN_FilterInit(CAN_FilterInitTypeDef *CAN_FilterInitStruct)
+{
+    uint8 bank = CAN_FilterInitStruct->CAN_FilterNumber;
+    uint32 bit = 1UL << bank;
+
+    if (bank >= SIM_CAN_BANKS)
+    {
+        Sim_Fail("CAN filter bank %u does not exist", bank);
+    }
+    Sim_Can.Fmr |= CAN_FMR_FINIT;
+    Sim_Can.Fa1r &= ~bit;
+    if (CAN_FilterInitStruct->CAN_FilterScale == CAN_FilterScale_16bit)
+    {
+        Sim_Can.Fs1r &= ~bit;
+        Sim_Can.Filter[bank][0] = ((uint32)CAN_FilterInitStruct->CAN_FilterMaskIdLow << 16) | CAN_FilterInitStruct->CAN_FilterIdLow;
+        Sim_Can.Filter[bank][1] = ((uint32)CAN_FilterInitStruct->CAN_FilterMaskIdHigh << 16) | CAN_FilterInitStruct->CAN_FilterIdHigh;
+    }
+    else
+    {
+        Sim_Can.Fs1r |= bit;
+        Sim_Can.Filter[bank][0] = ((uint32)CAN_FilterInitStruct->CAN_FilterIdHigh << 16) | CAN_FilterInitStruct->CAN_FilterIdLow;
+        Sim_Can.Filter[bank][1] = ((uint32)CAN_FilterInitStruct->CAN_FilterMaskIdHigh << 16) | CAN_FilterInitStruct->CAN_FilterMaskIdLow;
+    }
+    Sim_Can.Fm1r = (CAN_FilterInitStruct->CAN_FilterMode == CAN_FilterMode_IdList) ? (Sim_Can.Fm1r | bit) : (Sim_Can.Fm1r & ~bit);
+    Sim_Can.Ffa1r = (CAN_FilterInitStruct->CAN_FilterFIFOAssignment == CAN_Filter_FIFO1) ? (Sim_Can.Ffa1r | bit) : (Sim_Can.Ffa1r & ~bit);
+    if (CAN_FilterInitStruct->CAN_FilterActivation == ENABLE)
+    {
+        Sim_Can.Fa1r |= bit;
+    }
+    Sim_Can.Fmr &= ~CAN_FMR_FINIT;
+    Sim_CountAccess(10);
+}
+
+void CAN_StructInit(CAN_InitTypeDef *CAN_InitStruct)
+{
+    CAN_InitStruct->CAN_TTCM = DISABLE;
+    CAN_InitStruct->CAN_ABOM = DISABLE;
+    CAN_InitStruct->CAN_AWUM = DISABLE;
+    CAN_InitStruct->CAN_NART = DISABLE;
+    CAN_InitStruct->CAN_RFLM = DISABLE;
+    CAN_InitStruct->CAN_TXFP = DISABLE;
+    CAN_InitStruct->CAN_Mode = CAN_Mode_Normal;
+    CAN_InitStruct->CAN_SJW = CAN_SJW_1tq;
+    CAN_InitStruct->CAN_BS1 = CAN_BS1_4tq;
+    CAN_InitStruct->CAN_BS2 = CAN_BS2_3tq;
+    CAN_InitStruct->CAN_Prescaler = 1;
+}
+
+uint8_t CAN_Transmit(CAN_TypeDef *CANx, CanTxMsg *TxMessage)
+{
+    uint8 n = 0;
+
+    Sim_CanCheck(CANx);
+    Sim_CountAccess(1);
+    while ((n < 3U) && !Sim_CanMailboxEmpty(n))
+    {
+        n++;
+    }
+    if (n == 3U)
+    {
+        return CAN_TxStatus_NoMailBox;
+    }
+
+    Sim_CanMailboxType *box = &Sim_Can.Mailbox[n];
+    box->Tir = (TxMessage->IDE == CAN_Id_Standard) ? (((TxMessage->StdId & 0x7FFUL) << 21) | TxMessage->RTR)
+                                                   : (((TxMessage->ExtId & 0x1FFFFFFFUL) << 3) | CAN_TI0R_IDE | TxMessage->RTR);
+    box->Tdtr = (box->Tdtr & ~0xFUL) | (TxMessage->DLC & 0xFU);
+    box->Tdlr = 0;
+    box->Tdhr = 0;
+    for (uint8 i = 0; i < 8U; i++)
+    {
+        *((i < 4U) ? &box->Tdlr : &box->Tdhr) |= (uint32)TxMessage->Data[i] << (8U * (i % 4U));
+    }
+    box->Tir |= CAN_TI0R_TXRQ;
+    Sim_CanRequest(n);
+    Sim_CountAccess(6);
+    return n;
+}
+
+void CAN_Receive(CAN_TypeDef *CANx, uint8_t FIFONumber, CanRxMsg *RxMessage)
+{
+    const uint32 *entry = Sim_Can.Fifo[FIFONumber & 1U].Entry[0];
+
+    Sim_CanCheck(CANx);
+    RxMessage->IDE = (uint8_t)(entry[0] & CAN_TI0R_IDE);
+    RxMessage->StdId = (RxMessage->IDE == CAN_Id_Standard) ? (entry[0] >> 21) : 0U;
+    RxMessage->ExtId = (RxMessage->IDE == CAN_Id_Standard) ? 0U : (entry[0] >> 3);
+    RxMessage->RTR = (uint8_t)(entry[0] & CAN_TI0R_RTR);
+    RxMessage->DLC = (uint8_t)(entry[1] & 0xFU);
+    RxMessage->FMI = (uint8_t)(entry[1] >> 8);
+    for (uint8 i = 0; i < 8U; i++)
+    {
+        RxMessage->Data[i] = (uint8_t)(entry[2U + i / 4U] >> (8U * (i % 4U)));
+    }
+    Sim_CanRelease(FIFONumber & 1U);
+    Sim_CountAccess(6);
+}
+
+uint8_t CAN_MessagePending(CAN_TypeDef *CANx, uint8_t FIFONumber)
+{
+    Sim_CanCheck(CANx);
+    Sim_CountAccess(1);
+    return Sim_Can.Fifo[FIFONumber & 1U].Count;
+}
+
+void CAN_ITConfig(CAN_TypeDef *CANx, uint32_t CAN_IT, FunctionalState NewState)
+{
+    Sim_CanCheck(CANx);
+    Sim_Can.Ier = (NewState != DISABLE) ? ((Sim_Can.Ier | CAN_IT) & 0x00038F7FUL) : (Sim_Can.Ier & ~CAN_IT);
+    Sim_CountAccess(2);
+}
+
+void CAN_ClearITPendingBit(CAN_TypeDef *CANx, uint32_t CAN_IT)
+{
+    Sim_CanCheck(CANx);
+    switch (CAN_IT)
+    {
+    case CAN_IT_TME: Sim_CanWriteTsr(CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2); break;
+    case CAN_IT_FF0: Sim_Can.Fifo[0].Flags &= ~CAN_RF0R_FULL0; break;
+    case CAN_IT_FOV0: Sim_Can.Fifo[0].Flags &= ~CAN_RF0R_FOVR0; break;
+    case CAN_IT_FF1: Sim_Can.Fifo[1].Flags &= ~CAN_RF0R_FULL0; break;
+    case CAN_IT_FOV1: Sim_Can.Fifo[1].Flags &= ~CAN_RF0R_FOVR0; break;
+    case CAN_IT_WKU: Sim_Can.Msr &= ~CAN_MSR_WKUI; break;
+    case CAN_IT_SLK: Sim_Can.Msr &= ~CAN_MSR_SLAKI; break;
+    case CAN_IT_EWG:
+    case CAN_IT_EPV:
+    case CAN_IT_BOF: Sim_Can.Msr &= ~CAN_MSR_ERRI; break;
+    case CAN_IT_LEC:
+    case CAN_IT_ERR:
+        Sim_Can.Esr &= ~CAN_ESR_LEC;
+        Sim_Can.Msr &= ~CAN_MSR_ERRI;
+        break;
+    default: break; // FMP0/FMP1 follow the FIFO level
+    }
+    Sim_CountAccess(1);
+}
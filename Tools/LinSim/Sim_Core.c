@@ -0,0 +1,513 @@
+/**********************************************************
+ * @file Sim_Core.c
+ * @brief Simulator core: register traps, time, NVIC and tasks.
+ * @details The peripheral address ranges are mapped without access rights.
+ *          A driver access faults (SIGSEGV): the handler refreshes the image
+ *          of the peripheral from its model, opens the range and single-steps
+ *          the instruction with the trap flag. The following SIGTRAP applies
+ *          the side effects of the access (the image then holds a written
+ *          value) and closes the range again. x86-64 Linux only.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Sim_Internal.h"
+
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#if !defined(__x86_64__) || !defined(__linux__)
+#error "The LIN simulator traps register accesses with x86-64 Linux signals"
+#endif
+
+/**********************************************************
+ * @brief Trapped address ranges: APB1/APB2/AHB peripherals, and DWT up to CoreDebug.
+ **********************************************************/
+typedef struct
+{
+    uintptr_t Base; /**< @brief First address, page aligned. */
+    size_t Size;    /**< @brief Size in bytes, multiple of the page size. */
+} Sim_RegionType;
+
+static const Sim_RegionType Sim_Regions[] = {
+    {0x40000000UL, 0x22000UL},
+    {0xE0000000UL, 0xF000UL},
+};
+
+#define SIM_REGIONS (sizeof(Sim_Regions) / sizeof(Sim_Regions[0]))
+#define SIM_EFLAGS_TF 0x100UL   /**< @brief Trap flag: single step. */
+#define SIM_PF_WRITE 0x2UL      /**< @brief Page fault error code: write access. */
+
+/**********************************************************
+ * @brief Interrupt handlers of the driver (weak: an unused one is NULL).
+ **********************************************************/
+extern void USART1_IRQHandler(void) __attribute__((weak));
+extern void USART2_IRQHandler(void) __attribute__((weak));
+extern void USART3_IRQHandler(void) __attribute__((weak));
+extern void EXTI3_IRQHandler(void) __attribute__((weak));
+extern void EXTI15_10_IRQHandler(void) __attribute__((weak));
+extern void DMA1_Channel3_IRQHandler(void) __attribute__((weak));
+extern void DMA1_Channel5_IRQHandler(void) __attribute__((weak));
+extern void DMA1_Channel6_IRQHandler(void) __attribute__((weak));
+extern void CAN1_TX_IRQHandler(void) __attribute__((weak));
+extern void USB_LP_CAN1_RX0_IRQHandler(void) __attribute__((weak));
+extern void CAN1_SCE_IRQHandler(void) __attribute__((weak));
+extern void TIM4_IRQHandler(void) __attribute__((weak));
+
+/**********************************************************
+ * @brief Vector table: IRQ number and handler of each modelled interrupt line.
+ **********************************************************/
+static const struct
+{
+    IRQn_Type IRQn;
+    void (*Handler)(void);
+    const char *Name;
+} Sim_Vectors[] = {
+    {EXTI3_IRQn, EXTI3_IRQHandler, "EXTI3"},
+    {DMA1_Channel3_IRQn, DMA1_Channel3_IRQHandler, "DMA1_Channel3"},
+    {DMA1_Channel5_IRQn, DMA1_Channel5_IRQHandler, "DMA1_Channel5"},
+    {DMA1_Channel6_IRQn, DMA1_Channel6_IRQHandler, "DMA1_Channel6"},
+    {CAN1_TX_IRQn, CAN1_TX_IRQHandler, "CAN1_TX"},
+    {USB_LP_CAN1_RX0_IRQn, USB_LP_CAN1_RX0_IRQHandler, "USB_LP_CAN1_RX0"},
+    {CAN1_SCE_IRQn, CAN1_SCE_IRQHandler, "CAN1_SCE"},
+    {TIM4_IRQn, TIM4_IRQHandler, "TIM4"},
+    {USART1_IRQn, USART1_IRQHandler, "USART1"},
+    {USART2_IRQn, USART2_IRQHandler, "USART2"},
+    {USART3_IRQn, USART3_IRQHandler, "USART3"},
+    {EXTI15_10_IRQn, EXTI15_10_IRQHandler, "EXTI15_10"},
+};
+
+#define SIM_VECTORS (sizeof(Sim_Vectors) / sizeof(Sim_Vectors[0]))
+
+/**********************************************************
+ * @brief Access being single-stepped.
+ **********************************************************/
+static volatile struct
+{
+    boolean Active;
+    uintptr_t Address;
+    const Sim_RegionType *Region;
+    boolean Write;
+    uint32 Before;
+} Sim_Pending;
+
+/**********************************************************
+ * @brief Task slots.
+ **********************************************************/
+static struct
+{
+    Sim_TaskType Task;
+    void *Arg;
+    uint64 Due;
+} Sim_Tasks[SIM_TASKS];
+
+uint32_t SystemCoreClock;
+Sim_ClocksType Sim_Clocks;
+boolean Sim_TraceOn;
+
+static uint64 Sim_Time;          /**< @brief Current time, ns. */
+static uint32 Sim_StepNs;        /**< @brief Time step, ns. */
+static uint64 Sim_CycleCount;    /**< @brief Cycles at Sim_Time. */
+static uint64 Sim_CycleFraction; /**< @brief Remainder of the cycle count, in Hz * ns. */
+static uint64 Sim_CycleRead;     /**< @brief Last count returned: the counter never goes back. */
+static uint64 Sim_BusyUntil;     /**< @brief The CPU runs a handler or a task until then. */
+static uint32 Sim_Primask;
+static uint64 Sim_NvicEnabled;   /**< @brief Bit n: IRQ n enabled. */
+static boolean Sim_InIsr;
+static boolean Sim_Running;      /**< @brief A handler or a task is executing. */
+static uint32 Sim_Accesses;      /**< @brief Peripheral accesses of the running handler or task. */
+static uint32 Sim_StormCount[64];
+static uint64 Sim_StormWindow[64];
+static Sim_StatsType Sim_Stats;
+
+/**********************************************************
+ * @brief Region containing an address, NULL if none.
+ **********************************************************/
+static const Sim_RegionType *Sim_FindRegion(uintptr_t Address)
+{
+    for (uint8 i = 0; i < SIM_REGIONS; i++)
+    {
+        if ((Address >= Sim_Regions[i].Base) && (Address < Sim_Regions[i].Base + Sim_Regions[i].Size))
+        {
+            return &Sim_Regions[i];
+        }
+    }
+    return NULL;
+}
+
+/**********************************************************
+ * @brief First half of an access: open the range and step over the instruction.
+ **********************************************************/
+static void Sim_SegvHandler(int Signal, siginfo_t *Info, void *Context)
+{
+    ucontext_t *uc = (ucontext_t *)Context;
+    uintptr_t address = (uintptr_t)Info->si_addr;
+    const Sim_RegionType *region = Sim_FindRegion(address);
+
+    (void)Signal;
+    if ((region == NULL) || Sim_Pending.Active)
+    {
+        signal(SIGSEGV, SIG_DFL); // A real fault: crash on return
+        return;
+    }
+
+    mprotect((void *)region->Base, region->Size, PROT_READ | PROT_WRITE);
+    (void)Sim_PeriphSync(address);
+    Sim_Pending.Address = address;
+    Sim_Pending.Region = region;
+    Sim_Pending.Write = (uc->uc_mcontext.gregs[REG_ERR] & SIM_PF_WRITE) ? TRUE : FALSE;
+    Sim_Pending.Before = *(volatile uint32 *)(address & ~(uintptr_t)3U);
+    Sim_Pending.Active = TRUE;
+    uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+/**********************************************************
+ * @brief Second half of an access: apply its side effects and close the range.
+ **********************************************************/
+static void Sim_TrapHandler(int Signal, siginfo_t *Info, void *Context)
+{
+    ucontext_t *uc = (ucontext_t *)Context;
+
+    (void)Signal;
+    (void)Info;
+    if (!Sim_Pending.Active)
+    {
+        signal(SIGTRAP, SIG_DFL);
+        return;
+    }
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+    uint32 after = *(volatile uint32 *)(Sim_Pending.Address & ~(uintptr_t)3U);
+    Sim_PeriphAccess(Sim_Pending.Address, Sim_Pending.Write || (after != Sim_Pending.Before));
+    mprotect((void *)Sim_Pending.Region->Base, Sim_Pending.Region->Size, PROT_NONE);
+    Sim_Pending.Active = FALSE;
+    Sim_Accesses++;
+}
+
+void Sim_Fail(const char *Format, ...)
+{
+    va_list args;
+
+    fflush(stdout);
+    fprintf(stderr, "[%10.3f ms] FAIL: ", (double)Sim_Time / 1e6);
+    va_start(args, Format);
+    vfprintf(stderr, Format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+void Sim_Init(void)
+{
+    struct sigaction action;
+
+    for (uint8 i = 0; i < SIM_REGIONS; i++)
+    {
+        void *map = mmap((void *)Sim_Regions[i].Base, Sim_Regions[i].Size, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if (map != (void *)Sim_Regions[i].Base)
+        {
+            Sim_Fail("cannot map the registers at 0x%08lx", (unsigned long)Sim_Regions[i].Base);
+        }
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    action.sa_sigaction = Sim_SegvHandler;
+    sigaction(SIGSEGV, &action, NULL);
+    action.sa_sigaction = Sim_TrapHandler;
+    sigaction(SIGTRAP, &action, NULL);
+
+    Sim_TraceOn = (getenv("LINSIM_TRACE") != NULL) ? TRUE : FALSE;
+    Sim_Time = 0;
+    Sim_StepNs = 1000;
+    Sim_CycleCount = 0;
+    Sim_CycleRead = 0;
+    Sim_CycleFraction = 0;
+    Sim_BusyUntil = 0;
+    Sim_Primask = 0;
+    Sim_NvicEnabled = 0;
+    Sim_Clocks.SysClk = 72000000U;
+    Sim_Clocks.Pclk1 = 36000000U;
+    Sim_Clocks.Pclk2 = 72000000U;
+    SystemCoreClock = Sim_Clocks.SysClk;
+    memset(Sim_Tasks, 0, sizeof(Sim_Tasks));
+    memset(Sim_StormCount, 0, sizeof(Sim_StormCount));
+    memset(Sim_StormWindow, 0, sizeof(Sim_StormWindow));
+    Sim_ResetStats();
+    Sim_PeriphReset();
+    Sim_NodeReset();
+}
+
+void Sim_SetStep(uint32 StepNs)
+{
+    Sim_StepNs = (StepNs == 0U) ? 1U : StepNs;
+}
+
+void Sim_SetClocks(uint32 SysClk, uint32 Pclk1, uint32 Pclk2)
+{
+    Sim_Clocks.SysClk = SysClk;
+    Sim_Clocks.Pclk1 = Pclk1;
+    Sim_Clocks.Pclk2 = Pclk2;
+}
+
+uint64 Sim_Now(void)
+{
+    return Sim_Time;
+}
+
+/**********************************************************
+ * @details Inside a handler or a task the count also covers its accesses so
+ *          far, so timestamps taken by the driver advance with its work.
+ **********************************************************/
+uint64 Sim_Cycles(void)
+{
+    uint64 cycles = Sim_CycleCount;
+
+    if (Sim_Running)
+    {
+        cycles += (uint64)Sim_Accesses * SIM_CYCLES_PER_ACCESS + (Sim_InIsr ? SIM_CYCLES_ENTRY / 2U : 0U);
+    }
+    if (cycles < Sim_CycleRead)
+    {
+        cycles = Sim_CycleRead;
+    }
+    Sim_CycleRead = cycles;
+    return cycles;
+}
+
+void Sim_CountAccess(uint32 Accesses)
+{
+    Sim_Accesses += Accesses;
+}
+
+void Sim_GetStats(Sim_StatsType *Stats)
+{
+    *Stats = Sim_Stats;
+}
+
+void Sim_ResetStats(void)
+{
+    memset(&Sim_Stats, 0, sizeof(Sim_Stats));
+}
+
+/**********************************************************
+ * @brief CPU time of a number of cycles at the current SYSCLK.
+ **********************************************************/
+static uint64 Sim_CyclesToNs(uint64 Cycles)
+{
+    return (Cycles * 1000000000ULL + Sim_Clocks.SysClk - 1U) / Sim_Clocks.SysClk;
+}
+
+/**********************************************************
+ * @brief Run the handler of the highest priority pending interrupt.
+ * @return FALSE if no enabled interrupt is pending.
+ * @details Every interrupt has the same priority, so they do not nest and
+ *          the lowest IRQ number goes first.
+ **********************************************************/
+static boolean Sim_Dispatch(void)
+{
+    if (Sim_Primask != 0U)
+    {
+        return FALSE;
+    }
+
+    for (uint8 i = 0; i < SIM_VECTORS; i++)
+    {
+        IRQn_Type irqn = Sim_Vectors[i].IRQn;
+        if (!(Sim_NvicEnabled & (1ULL << irqn)) || !Sim_PeriphIrq(irqn))
+        {
+            continue;
+        }
+        if (Sim_Vectors[i].Handler == NULL)
+        {
+            Sim_Fail("%s interrupt enabled and pending without handler", Sim_Vectors[i].Name);
+        }
+
+        if (Sim_Time - Sim_StormWindow[irqn] >= SIM_MS(1))
+        {
+            Sim_StormWindow[irqn] = Sim_Time;
+            Sim_StormCount[irqn] = 0;
+        }
+        if (++Sim_StormCount[irqn] > SIM_STORM_LIMIT)
+        {
+            Sim_Fail("%s interrupt storm: the handler does not clear its source", Sim_Vectors[i].Name);
+        }
+
+        if (Sim_TraceOn)
+        {
+            printf("%12.3f us  %s\n", (double)Sim_Time / 1e3, Sim_Vectors[i].Name);
+        }
+        Sim_Accesses = 0;
+        Sim_InIsr = TRUE;
+        Sim_Running = TRUE;
+        Sim_Vectors[i].Handler();
+        Sim_Running = FALSE;
+        Sim_InIsr = FALSE;
+        if (Sim_Primask != 0U)
+        {
+            Sim_Fail("%s handler returned with interrupts disabled", Sim_Vectors[i].Name);
+        }
+
+        uint64 busy = Sim_CyclesToNs(SIM_CYCLES_ENTRY + (uint64)Sim_Accesses * SIM_CYCLES_PER_ACCESS);
+        Sim_BusyUntil = Sim_Time + busy;
+        Sim_Stats.IsrEntries++;
+        Sim_Stats.Entries[irqn]++;
+        Sim_Stats.IsrAccesses += Sim_Accesses;
+        Sim_Stats.IsrBusyNs += busy;
+        if (Sim_Accesses > Sim_Stats.MaxIsrAccesses)
+        {
+            Sim_Stats.MaxIsrAccesses = Sim_Accesses;
+        }
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**********************************************************
+ * @brief Run the first task due.
+ **********************************************************/
+static void Sim_RunTask(void)
+{
+    for (uint8 i = 0; i < SIM_TASKS; i++)
+    {
+        if ((Sim_Tasks[i].Task == NULL) || (Sim_Tasks[i].Due > Sim_Time))
+        {
+            continue;
+        }
+
+        Sim_Accesses = 0;
+        Sim_Running = TRUE;
+        uint64 next = Sim_Tasks[i].Task(Sim_Tasks[i].Arg);
+        Sim_Running = FALSE;
+        if (Sim_Primask != 0U)
+        {
+            Sim_Fail("task returned with interrupts disabled");
+        }
+
+        if (next == 0U)
+        {
+            Sim_Tasks[i].Task = NULL;
+        }
+        else
+        {
+            Sim_Tasks[i].Due += next;
+        }
+
+        uint64 busy = Sim_CyclesToNs((uint64)Sim_Accesses * SIM_CYCLES_PER_ACCESS);
+        Sim_BusyUntil = Sim_Time + busy;
+        Sim_Stats.TaskAccesses += Sim_Accesses;
+        Sim_Stats.TaskBusyNs += busy;
+        return;
+    }
+}
+
+/**********************************************************
+ * @brief Advance the time by one step.
+ **********************************************************/
+static void Sim_Step(void)
+{
+    Sim_Time += Sim_StepNs;
+    Sim_Stats.ElapsedNs += Sim_StepNs;
+    Sim_CycleFraction += (uint64)Sim_StepNs * Sim_Clocks.SysClk;
+    Sim_CycleCount += Sim_CycleFraction / 1000000000ULL;
+    Sim_CycleFraction %= 1000000000ULL;
+
+    Sim_PeriphTx(Sim_Time);
+    Sim_NodesTx(Sim_Time);
+    Sim_BusUpdate(Sim_Time);
+    Sim_PeriphRx(Sim_Time);
+    Sim_NodesRx(Sim_Time);
+
+    if ((Sim_Time >= Sim_BusyUntil) && !Sim_Dispatch())
+    {
+        Sim_RunTask();
+    }
+}
+
+void Sim_Run(uint64 Ns)
+{
+    uint64 end = Sim_Time + Ns;
+
+    while (Sim_Time < end)
+    {
+        Sim_Step();
+    }
+}
+
+boolean Sim_RunUntil(boolean (*Condition)(void *Arg), void *Arg, uint64 TimeoutNs)
+{
+    uint64 end = Sim_Time + TimeoutNs;
+
+    while (!Condition(Arg))
+    {
+        if (Sim_Time >= end)
+        {
+            return FALSE;
+        }
+        Sim_Step();
+    }
+    return TRUE;
+}
+
+void Sim_StartTask(Sim_TaskType Task, void *Arg, uint64 FirstDelayNs)
+{
+    for (uint8 i = 0; i < SIM_TASKS; i++)
+    {
+        if (Sim_Tasks[i].Task == NULL)
+        {
+            Sim_Tasks[i].Task = Task;
+            Sim_Tasks[i].Arg = Arg;
+            Sim_Tasks[i].Due = Sim_Time + FirstDelayNs;
+            return;
+        }
+    }
+    Sim_Fail("too many tasks");
+}
+
+void Sim_StopTasks(void)
+{
+    memset(Sim_Tasks, 0, sizeof(Sim_Tasks));
+}
+
+/**********************************************************
+ * @brief CMSIS core functions of the simulated CPU.
+ **********************************************************/
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    Sim_NvicEnabled |= 1ULL << IRQn;
+    Sim_Accesses++;
+}
+
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    Sim_NvicEnabled &= ~(1ULL << IRQn);
+    Sim_Accesses++;
+}
+
+void __enable_irq(void)
+{
+    Sim_Primask = 0;
+}
+
+void __disable_irq(void)
+{
+    Sim_Primask = 1;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return Sim_Primask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+    Sim_Primask = priMask & 1U;
+}
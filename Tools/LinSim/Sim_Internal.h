@@ -0,0 +1,77 @@
+/**********************************************************
+ * @file Sim_Internal.h
+ * @brief Interfaces between the parts of the simulator.
+ * @details Sim_Core.c owns the time, the register traps, the NVIC and the
+ *          tasks; Sim_Periph.c the register models; Sim_Can.c the bxCAN
+ *          model and the CAN bus; Sim_Node.c the LIN buses and the simulated
+ *          nodes. Each step runs the transmitters, resolves the bus levels,
+ *          then runs the receivers, the DMA and the timer.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#ifndef SIM_INTERNAL_H
+#define SIM_INTERNAL_H
+
+#include "Sim.h"
+
+/**********************************************************
+ * @brief Clocks of the simulated device, in Hz.
+ **********************************************************/
+typedef struct
+{
+    uint32 SysClk; /**< @brief SYSCLK = HCLK. */
+    uint32 Pclk1;  /**< @brief APB1: USART2, USART3, bxCAN, TIM4 (doubled when divided). */
+    uint32 Pclk2;  /**< @brief APB2: USART1. */
+} Sim_ClocksType;
+
+extern Sim_ClocksType Sim_Clocks;
+
+/**********************************************************
+ * @brief Trace of the interrupts and bus edges on stdout (environment variable LINSIM_TRACE).
+ **********************************************************/
+extern boolean Sim_TraceOn;
+
+/**********************************************************
+ * @brief Cycle count of the CPU at the current time (DWT CYCCNT).
+ **********************************************************/
+uint64 Sim_Cycles(void);
+
+/**********************************************************
+ * @brief Count peripheral accesses made by a host SPL function.
+ **********************************************************/
+void Sim_CountAccess(uint32 Accesses);
+
+/**********************************************************
+ * @brief Register models (Sim_Periph.c).
+ **********************************************************/
+void Sim_PeriphReset(void);
+boolean Sim_PeriphSync(uintptr_t Address);               /**< @brief Refresh the image of the block; FALSE: plain memory. */
+void Sim_PeriphAccess(uintptr_t Address, boolean Write); /**< @brief Side effects of an access, the image holds the written value. */
+void Sim_PeriphTx(uint64 Now);                           /**< @brief Advance the USART transmitters and the CAN bus. */
+void Sim_PeriphRx(uint64 Now);                           /**< @brief Receivers, EXTI, DMA and timer. */
+boolean Sim_PeriphIrq(IRQn_Type IRQn);                   /**< @brief Level of an interrupt line. */
+uint8 Sim_ChannelDrive(uint8 Channel);                   /**< @brief Level driven by a channel's Tx pin. */
+
+/**********************************************************
+ * @brief bxCAN model and CAN bus (Sim_Can.c).
+ **********************************************************/
+#define SIM_CAN_SIZE 0x2B0U /**< @brief Bytes of the CAN1 register block up to the last filter bank. */
+
+void Sim_CanReset(void);
+void Sim_CanSync(void);                                 /**< @brief Refresh the image of the CAN1 block. */
+void Sim_CanAccess(uint32 Offset, boolean Write, uint32 Value);
+void Sim_CanStep(uint64 Now, uint32 Clock);             /**< @brief Advance the bus; Clock is PCLK1, 0 while CAN1 is gated. */
+boolean Sim_CanIrq(IRQn_Type IRQn);
+
+/**********************************************************
+ * @brief Buses and nodes (Sim_Node.c).
+ **********************************************************/
+void Sim_NodeReset(void);
+void Sim_NodesTx(uint64 Now);
+void Sim_BusUpdate(uint64 Now);
+void Sim_NodesRx(uint64 Now);
+uint8 Sim_ChannelBus(uint8 Channel); /**< @brief Bus of a channel's transceiver. */
+
+#endif /* SIM_INTERNAL_H */
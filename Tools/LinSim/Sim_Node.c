@@ -0,0 +1,568 @@
+/**********************************************************
+ * @file Sim_Node.c
+ * @brief Virtual LIN buses and simulated nodes.
+ * @details A bus is the wired-AND of the Tx pins of its channels, of its
+ *          nodes and of the faults (short to ground, glitches). A node
+ *          receives the bus like a UART sampling in the middle of each bit
+ *          of its own clock, records every frame it sees, answers headers
+ *          from its response table and transmits queued symbols (breaks,
+ *          characters, dominant pulses).
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Sim_Internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**********************************************************
+ * @brief Symbols of the node transmit queue.
+ **********************************************************/
+#define SIM_SYMBOL_CHAR 0U
+#define SIM_SYMBOL_BREAK 1U
+#define SIM_SYMBOL_PULSE 2U
+
+#define SIM_NODE_RX_WAIT_HIGH 0U
+#define SIM_NODE_RX_IDLE 1U
+#define SIM_NODE_RX_CHAR 2U
+
+#define SIM_NODE_BREAK_BITS 11U  /**< @brief Dominant bits taken as a break. */
+#define SIM_NO_CHANNEL 0xFFU
+
+static struct
+{
+    boolean Stuck;
+    uint64 GlitchStart, GlitchEnd;
+    uint8 Level;
+    uint64 LastFall;
+} Sim_Bus[SIM_BUSES];
+
+static uint8 Sim_ChannelBusMap[3];
+static Sim_NodeType Sim_Nodes[SIM_NODES];
+static uint8 Sim_NodeCount;
+
+/**********************************************************
+ * @brief Bit time of a node in ps, from its baud rate and clock deviation.
+ **********************************************************/
+static uint64 Sim_NodeBitPs(const Sim_NodeType *Node)
+{
+    return 1000000000000000000ULL / ((uint64)Node->BaudRate * (uint64)(1000000 + Node->ClockPpm));
+}
+
+uint8 Sim_Pid(uint8 Id)
+{
+    uint8 id = Id & 0x3FU;
+    uint8 p0 = (uint8)(((id >> 0) ^ (id >> 1) ^ (id >> 2) ^ (id >> 4)) & 1U);
+    uint8 p1 = (uint8)(~((id >> 1) ^ (id >> 3) ^ (id >> 4) ^ (id >> 5)) & 1U);
+
+    return (uint8)(id | (p0 << 6) | (p1 << 7));
+}
+
+uint8 Sim_Checksum(uint8 Pid, boolean Classic, const uint8 *Data, uint8 Dl)
+{
+    uint16 sum = Classic ? 0U : Pid;
+
+    for (uint8 i = 0; i < Dl; i++)
+    {
+        sum += Data[i];
+        if (sum > 0xFFU)
+        {
+            sum -= 0xFFU;
+        }
+    }
+    return (uint8)~sum;
+}
+
+void Sim_NodeReset(void)
+{
+    memset(Sim_Bus, 0, sizeof(Sim_Bus));
+    for (uint8 i = 0; i < SIM_BUSES; i++)
+    {
+        Sim_Bus[i].Level = 1;
+    }
+    for (uint8 ch = 0; ch < 3U; ch++)
+    {
+        Sim_ChannelBusMap[ch] = ch;
+    }
+    memset(Sim_Nodes, 0, sizeof(Sim_Nodes));
+    Sim_NodeCount = 0;
+}
+
+uint8 Sim_ChannelBus(uint8 Channel)
+{
+    return Sim_ChannelBusMap[Channel];
+}
+
+uint8 Sim_BusLevel(uint8 Bus)
+{
+    return (Bus < SIM_BUSES) ? Sim_Bus[Bus].Level : 1U;
+}
+
+uint64 Sim_BusLastFall(uint8 Bus)
+{
+    return Sim_Bus[Bus].LastFall;
+}
+
+void Sim_BusAttach(uint8 Channel, uint8 Bus)
+{
+    Sim_ChannelBusMap[Channel] = (Bus < SIM_BUSES) ? Bus : SIM_NO_CHANNEL;
+}
+
+void Sim_BusSetStuck(uint8 Bus, boolean Dominant)
+{
+    Sim_Bus[Bus].Stuck = Dominant;
+}
+
+void Sim_BusGlitch(uint8 Bus, uint64 Start, uint64 Ns)
+{
+    Sim_Bus[Bus].GlitchStart = Start;
+    Sim_Bus[Bus].GlitchEnd = Start + Ns;
+}
+
+Sim_NodeType *Sim_NodeAdd(uint8 Bus, uint32 BaudRate)
+{
+    if ((Sim_NodeCount >= SIM_NODES) || (Bus >= SIM_BUSES))
+    {
+        Sim_Fail("cannot add a node on bus %u", Bus);
+    }
+
+    Sim_NodeType *node = &Sim_Nodes[Sim_NodeCount++];
+    node->Bus = Bus;
+    node->BaudRate = BaudRate;
+    for (uint8 id = 0; id < 64U; id++)
+    {
+        node->Length[id] = (id < 32U) ? 2U : ((id < 48U) ? 4U : 8U); // LIN 1.3 ID ranges
+    }
+    node->TxOut = 1;
+    node->PrevLevel = 1;
+    node->RxState = SIM_NODE_RX_WAIT_HIGH;
+    return node;
+}
+
+/**********************************************************
+ * @brief Append a symbol to the transmit queue.
+ * @param Gap Recessive time before the symbol, from the end of the previous one or from now.
+ **********************************************************/
+static void Sim_NodeQueue(Sim_NodeType *Node, uint8 Kind, uint8 Value, uint64 Gap, uint64 Length)
+{
+    uint8 next = (uint8)((Node->QueueTail + 1U) % SIM_TX_QUEUE);
+
+    if (next == Node->QueueHead)
+    {
+        Sim_Fail("node transmit queue full");
+    }
+    if (!Node->TxActive && (Node->QueueHead == Node->QueueTail) && (Node->TxFree < Sim_Now()))
+    {
+        Node->TxFree = Sim_Now();
+    }
+    Node->Queue[Node->QueueTail].Kind = Kind;
+    Node->Queue[Node->QueueTail].Value = Value;
+    Node->Queue[Node->QueueTail].Gap = Gap;
+    Node->Queue[Node->QueueTail].Length = Length;
+    Node->QueueTail = next;
+}
+
+void Sim_NodeRespond(Sim_NodeType *Node, uint8 Id, const uint8 *Data, uint8 Dl, boolean Classic)
+{
+    Sim_ResponseType *response = &Node->Response[Id & 0x3FU];
+
+    memset(response, 0, sizeof(*response));
+    response->Publish = TRUE;
+    response->Classic = Classic;
+    response->Dl = Dl;
+    memcpy(response->Data, Data, Dl);
+}
+
+void Sim_NodeSendHeader(Sim_NodeType *Node, uint8 Id, uint64 GapNs)
+{
+    Sim_NodeQueue(Node, SIM_SYMBOL_BREAK, 0, GapNs, 0);
+    Sim_NodeQueue(Node, SIM_SYMBOL_CHAR, 0x55U, 0, 0);
+    Sim_NodeQueue(Node, SIM_SYMBOL_CHAR, Sim_Pid(Id), 0, 0);
+}
+
+void Sim_NodeSendFrame(Sim_NodeType *Node, uint8 Id, const uint8 *Data, uint8 Dl, boolean Classic, uint64 GapNs)
+{
+    uint8 pid = Sim_Pid(Id);
+
+    Sim_NodeSendHeader(Node, Id, GapNs);
+    for (uint8 i = 0; i < Dl; i++)
+    {
+        Sim_NodeQueue(Node, SIM_SYMBOL_CHAR, Data[i], 0, 0);
+    }
+    Sim_NodeQueue(Node, SIM_SYMBOL_CHAR, Sim_Checksum(pid, Classic || ((Id & 0x3FU) >= 0x3CU), Data, Dl), 0, 0);
+}
+
+void Sim_NodeSendPulse(Sim_NodeType *Node, uint64 Ns, uint64 GapNs)
+{
+    Sim_NodeQueue(Node, SIM_SYMBOL_PULSE, 0, GapNs, Ns);
+}
+
+boolean Sim_NodeIdle(const Sim_NodeType *Node)
+{
+    return !Node->TxActive && (Node->QueueHead == Node->QueueTail);
+}
+
+const Sim_FrameType *Sim_NodeLastFrame(const Sim_NodeType *Node)
+{
+    return (Node->FrameCount == 0U) ? NULL : &Node->Frames[(Node->FrameCount - 1U) % SIM_FRAME_LOG];
+}
+
+/**********************************************************
+ * @brief Node transmitter: level of the symbol at the head of the queue.
+ **********************************************************/
+static void Sim_NodeTx(Sim_NodeType *Node, uint64 Now)
+{
+    uint64 bitPs = Sim_NodeBitPs(Node);
+
+    for (;;)
+    {
+        if (!Node->TxActive)
+        {
+            if (Node->QueueHead == Node->QueueTail)
+            {
+                Node->TxOut = 1;
+                return;
+            }
+            uint64 start = Node->TxFree + Node->Queue[Node->QueueHead].Gap;
+            if (Now < start)
+            {
+                Node->TxOut = 1;
+                return;
+            }
+            Node->TxActive = TRUE;
+            Node->TxStart = start;
+        }
+
+        uint8 kind = Node->Queue[Node->QueueHead].Kind;
+        uint64 length = (kind == SIM_SYMBOL_PULSE) ? Node->Queue[Node->QueueHead].Length
+                                                   : (((kind == SIM_SYMBOL_BREAK) ? 14U : 10U) * bitPs / 1000U);
+        uint64 elapsed = Now - Node->TxStart;
+        if (elapsed >= length)
+        {
+            Node->TxFree = Node->TxStart + length;
+            Node->TxActive = FALSE;
+            Node->QueueHead = (uint8)((Node->QueueHead + 1U) % SIM_TX_QUEUE);
+            continue;
+        }
+
+        uint64 bit = elapsed * 1000U / bitPs;
+        switch (kind)
+        {
+        case SIM_SYMBOL_PULSE:
+            Node->TxOut = 0;
+            break;
+        case SIM_SYMBOL_BREAK:
+            Node->TxOut = (bit < 13U) ? 0U : 1U;
+            break;
+        default:
+            Node->TxOut = (bit == 0U) ? 0U
+                                      : ((bit >= 9U) ? 1U : (uint8)((Node->Queue[Node->QueueHead].Value >> (bit - 1U)) & 1U));
+            break;
+        }
+        return;
+    }
+}
+
+void Sim_NodesTx(uint64 Now)
+{
+    for (uint8 i = 0; i < Sim_NodeCount; i++)
+    {
+        Sim_NodeTx(&Sim_Nodes[i], Now);
+    }
+}
+
+void Sim_BusUpdate(uint64 Now)
+{
+    for (uint8 bus = 0; bus < SIM_BUSES; bus++)
+    {
+        uint8 level = 1;
+
+        for (uint8 ch = 0; ch < 3U; ch++)
+        {
+            if (Sim_ChannelBusMap[ch] == bus)
+            {
+                level &= Sim_ChannelDrive(ch);
+            }
+        }
+        for (uint8 i = 0; i < Sim_NodeCount; i++)
+        {
+            const Sim_NodeType *node = &Sim_Nodes[i];
+            if (node->Bus == bus)
+            {
+                level &= node->TxOut;
+                if ((Now >= node->DisturbFrom) && (Now < node->DisturbTo))
+                {
+                    level = 0;
+                }
+            }
+        }
+        if (Sim_Bus[bus].Stuck || ((Now >= Sim_Bus[bus].GlitchStart) && (Now < Sim_Bus[bus].GlitchEnd)))
+        {
+            level = 0;
+        }
+
+        if ((Sim_Bus[bus].Level == 1U) && (level == 0U))
+        {
+            Sim_Bus[bus].LastFall = Now;
+        }
+        if (Sim_TraceOn && (Sim_Bus[bus].Level != level))
+        {
+            printf("%12.3f us  bus %u %s\n", (double)Now / 1e3, bus, level ? "recessive" : "dominant");
+        }
+        Sim_Bus[bus].Level = level;
+    }
+}
+
+/**********************************************************
+ * @brief Data length expected after the PID of a frame.
+ **********************************************************/
+static uint8 Sim_NodeDl(const Sim_NodeType *Node, uint8 Id)
+{
+    return Node->Response[Id].Publish ? Node->Response[Id].Dl : Node->Length[Id];
+}
+
+/**********************************************************
+ * @brief Close the current frame: checksum flags, log and callback.
+ **********************************************************/
+static void Sim_NodeClose(Sim_NodeType *Node, uint64 End)
+{
+    Sim_FrameType *frame = &Node->Frame;
+
+    Node->FrameOpen = FALSE;
+    frame->End = End;
+    if (frame->Count >= 2U)
+    {
+        uint8 dl = frame->Count - 1U;
+        if (Sim_Checksum(frame->Pid, TRUE, frame->Data, dl) == frame->Data[dl])
+        {
+            frame->Flags |= SIM_FRAME_CLASSIC_OK;
+        }
+        if (Sim_Checksum(frame->Pid, FALSE, frame->Data, dl) == frame->Data[dl])
+        {
+            frame->Flags |= SIM_FRAME_ENHANCED_OK;
+        }
+    }
+    if ((frame->HeaderEnd != 0U) && (frame->Count > 0U) &&
+        (frame->Count < Sim_NodeDl(Node, frame->Pid & 0x3FU) + 1U))
+    {
+        frame->Flags |= SIM_FRAME_INCOMPLETE;
+    }
+
+    Node->Frames[Node->FrameCount % SIM_FRAME_LOG] = *frame;
+    Node->FrameCount++;
+    if (Node->OnFrame != NULL)
+    {
+        Node->OnFrame(Node, frame);
+    }
+}
+
+/**********************************************************
+ * @brief PID received: callback, then the response if the node publishes the frame.
+ **********************************************************/
+static void Sim_NodeHeader(Sim_NodeType *Node, uint64 Now)
+{
+    uint8 pid = Node->Frame.Pid;
+    uint8 id = pid & 0x3FU;
+
+    if (Node->OnHeader != NULL)
+    {
+        Node->OnHeader(Node, pid);
+    }
+
+    const Sim_ResponseType *response = &Node->Response[id];
+    if (!(Node->Frame.Flags & SIM_FRAME_PID_OK) || !response->Publish || (response->Dl == 0U) || (response->Dl > 8U))
+    {
+        return;
+    }
+
+    uint8 bytes[9];
+    uint8 count = (response->Truncate != 0U) ? response->Truncate : (uint8)(response->Dl + 1U);
+    memcpy(bytes, response->Data, response->Dl);
+    bytes[response->Dl] = Sim_Checksum(pid, response->Classic || (id >= 0x3CU), response->Data, response->Dl);
+    if (response->BadChecksum)
+    {
+        bytes[response->Dl] ^= 0xFFU;
+    }
+
+    // The response starts after the stop bit of the PID (sampled half a bit ago)
+    if (!Node->TxActive && (Node->QueueHead == Node->QueueTail))
+    {
+        Node->TxFree = Now + Sim_NodeBitPs(Node) / 2000U;
+    }
+    for (uint8 i = 0; (i < count) && (i < 9U); i++)
+    {
+        Sim_NodeQueue(Node, SIM_SYMBOL_CHAR, bytes[i], (i == 0U) ? response->ResponseSpaceNs : response->InterByteNs, 0);
+    }
+}
+
+/**********************************************************
+ * @brief A character was received.
+ **********************************************************/
+static void Sim_NodeChar(Sim_NodeType *Node, uint8 Data, boolean StopOk, uint64 Now)
+{
+    Sim_FrameType *frame = &Node->Frame;
+
+    if (!StopOk && (Data == 0U))
+    {
+        return; // Break character
+    }
+    if (!Node->FrameOpen)
+    {
+        return;
+    }
+    if (!StopOk)
+    {
+        frame->Flags |= SIM_FRAME_LINE_ERROR;
+    }
+
+    uint8 index = Node->FrameChar++;
+    if (index == 0U)
+    {
+        if ((Data == 0x55U) && StopOk)
+        {
+            frame->Flags |= SIM_FRAME_SYNC_OK;
+        }
+    }
+    else if (index == 1U)
+    {
+        frame->Pid = Data;
+        frame->HeaderEnd = Now;
+        if ((Sim_Pid(Data) == Data) && StopOk)
+        {
+            frame->Flags |= SIM_FRAME_PID_OK;
+        }
+        Sim_NodeHeader(Node, Now);
+    }
+    else
+    {
+        if (frame->Count < 9U)
+        {
+            frame->Data[frame->Count++] = Data;
+        }
+        if (frame->Count >= Sim_NodeDl(Node, frame->Pid & 0x3FU) + 1U)
+        {
+            Sim_NodeClose(Node, Now);
+        }
+    }
+}
+
+/**********************************************************
+ * @brief Node receiver: break detection, mid-bit sampling, frame timeouts and bit errors.
+ **********************************************************/
+static void Sim_NodeRx(Sim_NodeType *Node, uint64 Now)
+{
+    uint8 level = Sim_BusLevel(Node->Bus);
+    uint8 prev = Node->PrevLevel;
+    uint64 bitPs = Sim_NodeBitPs(Node);
+
+    Node->PrevLevel = level;
+
+    // Break: the open frame ends, a new one starts at the falling edge
+    if (level == 0U)
+    {
+        if (prev == 1U)
+        {
+            Node->LowSince = Now;
+            Node->BreakSeen = FALSE;
+        }
+        else if (!Node->BreakSeen && ((Now - Node->LowSince) * 1000U >= SIM_NODE_BREAK_BITS * bitPs))
+        {
+            Node->BreakSeen = TRUE;
+            if (Node->FrameOpen)
+            {
+                Sim_NodeClose(Node, Node->LowSince);
+            }
+            memset(&Node->Frame, 0, sizeof(Node->Frame));
+            Node->Frame.Start = Node->LowSince;
+            Node->FrameOpen = TRUE;
+            Node->FrameChar = 0;
+        }
+    }
+
+    // Response timeout: 1.4 * 10 * (Dl + 1) bits after the PID, or a header that never completes
+    if (Node->FrameOpen)
+    {
+        uint64 limit;
+        if (Node->Frame.HeaderEnd != 0U)
+        {
+            uint8 dl = Sim_NodeDl(Node, Node->Frame.Pid & 0x3FU);
+            limit = Node->Frame.HeaderEnd + (14U * (dl + 1U) + 1U) * bitPs / 1000U;
+        }
+        else
+        {
+            limit = Node->Frame.Start + 60U * bitPs / 1000U;
+        }
+        if ((Now > limit) && (Node->RxState != SIM_NODE_RX_CHAR))
+        {
+            Sim_NodeClose(Node, Now);
+        }
+    }
+
+    switch (Node->RxState)
+    {
+    case SIM_NODE_RX_WAIT_HIGH:
+        if (level == 1U)
+        {
+            Node->RxState = SIM_NODE_RX_IDLE;
+        }
+        break;
+    case SIM_NODE_RX_IDLE:
+        if ((prev == 1U) && (level == 0U))
+        {
+            Node->RxState = SIM_NODE_RX_CHAR;
+            Node->RxStart = Now;
+            Node->RxBit = 0;
+            Node->RxData = 0;
+
+            const Sim_DisturbType *disturb = &Node->Disturb;
+            if ((disturb->Count != 0U) && Node->FrameOpen && (Node->FrameChar == disturb->Char) &&
+                ((disturb->Char < 2U) || (disturb->Id == SIM_ANY_ID) || ((Node->Frame.Pid & 0x3FU) == disturb->Id)))
+            {
+                Node->DisturbFrom = Now + disturb->Bit * bitPs / 1000U;
+                Node->DisturbTo = Node->DisturbFrom + bitPs / 1000U;
+                Node->Disturb.Count--;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    while (Node->RxState == SIM_NODE_RX_CHAR)
+    {
+        uint64 at = Node->RxStart + (2U * Node->RxBit + 1U) * bitPs / 2000U;
+        if (at > Now)
+        {
+            break;
+        }
+        if (Node->RxBit == 0U)
+        {
+            if (level == 1U)
+            {
+                Node->RxState = SIM_NODE_RX_IDLE; // False start bit
+                break;
+            }
+        }
+        else if (Node->RxBit <= 8U)
+        {
+            Node->RxData |= (uint8)(level << (Node->RxBit - 1U));
+        }
+        else
+        {
+            Node->RxState = (level == 1U) ? SIM_NODE_RX_IDLE : SIM_NODE_RX_WAIT_HIGH;
+            Sim_NodeChar(Node, Node->RxData, (level == 1U) ? TRUE : FALSE, Now);
+            break;
+        }
+        Node->RxBit++;
+    }
+}
+
+void Sim_NodesRx(uint64 Now)
+{
+    for (uint8 i = 0; i < Sim_NodeCount; i++)
+    {
+        Sim_NodeRx(&Sim_Nodes[i], Now);
+    }
+}
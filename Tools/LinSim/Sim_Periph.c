@@ -0,0 +1,1159 @@
+/**********************************************************
+ * @file Sim_Periph.c
+ * @brief Register models of the peripherals used by the LIN and CAN drivers.
+ * @details USART1...3 (LIN mode, break generation and detection, 3-sample
+ *          receiver with noise, framing and overrun errors, IDLE), DMA1
+ *          channels 1...7 on the fixed USART requests, TIM4 (counter,
+ *          prescaler, compare flags), EXTI lines 0...15 through AFIO,
+ *          GPIOA/GPIOB pin modes, RCC clock enables and the DWT cycle
+ *          counter, plus the SPL functions the driver calls. Only the
+ *          behaviour the driver relies on is modelled. bxCAN1 is in
+ *          Sim_Can.c.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Sim_Internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**********************************************************
+ * @brief States of the USART transmitter and receiver.
+ **********************************************************/
+#define SIM_TX_IDLE 0U
+#define SIM_TX_BREAK 1U
+#define SIM_TX_CHAR 2U
+
+#define SIM_RX_OFF 0U       /**< @brief Receiver disabled. */
+#define SIM_RX_WAIT_HIGH 1U /**< @brief Waiting for a recessive line before the next start bit. */
+#define SIM_RX_IDLE 2U      /**< @brief Waiting for a start bit. */
+#define SIM_RX_CHAR 3U      /**< @brief Sampling a character. */
+
+#define SIM_BREAK_BITS 13U           /**< @brief Dominant bits of a break in LIN mode. */
+#define SIM_USART_SR_RC_W0 (USART_SR_LBD | USART_SR_TC | USART_SR_RXNE | USART_SR_CTS)
+
+/**********************************************************
+ * @brief USART model.
+ **********************************************************/
+typedef struct
+{
+    uintptr_t Base;
+    uint8 Channel;     /**< @brief LIN channel whose pins it drives. */
+    boolean OnApb2;
+    uint32 ClockBit;   /**< @brief RCC APB1/APB2 enable bit. */
+    uint16 Sr, Brr, Cr1, Cr2, Cr3, Gtpr;
+    uint8 Rdr, Tdr;
+    boolean SrRead;    /**< @brief SR read since the last DR access. */
+    uint8 TxState;
+    uint64 TxStart, TxEnd;
+    boolean TxChain;   /**< @brief The previous symbol ended in this step: the next one follows at once. */
+    uint8 TxShift;
+    uint8 TxOut;
+    uint8 RxState;
+    uint64 RxStart;
+    uint8 RxSample;
+    uint8 RxVotes[10];
+    uint8 PrevLevel;
+    uint64 LowSince;
+    boolean LowValid, LbdDone;
+    boolean IdleArmed;
+    uint64 IdleFrom;
+} Sim_UsartType;
+
+/**********************************************************
+ * @brief DMA1 channel model.
+ **********************************************************/
+typedef struct
+{
+    uint32 Ccr, Cndtr, Cpar, Cmar;
+    uint32 Index;
+} Sim_DmaChannelType;
+
+static Sim_UsartType Sim_Usart[3];
+static Sim_DmaChannelType Sim_Dma[8]; /**< @brief Index 1...7. */
+static uint32 Sim_DmaIsr;
+
+static struct
+{
+    uint16 Cr1, Cr2, Smcr, Dier, Sr, Ccmr1, Ccmr2, Ccer, Cnt, Psc, Arr, Rcr;
+    uint16 Ccr[4];
+    uint16 ActivePsc;
+    uint64 FractionPs;
+    uint64 Last;
+} Sim_Tim;
+
+static struct
+{
+    uint32 Imr, Emr, Rtsr, Ftsr, Swier, Pr;
+    uint16 Prev; /**< @brief Pin levels of the lines at the last step. */
+} Sim_Exti;
+
+static struct
+{
+    uint32 Evcr, Mapr, Exticr[4];
+} Sim_Afio;
+
+static struct
+{
+    uint32 Crl, Crh, Odr, Lckr;
+} Sim_Gpio[2]; /**< @brief GPIOA, GPIOB. */
+
+static struct
+{
+    uint32 Cr, Cfgr, Cir, Apb2rstr, Apb1rstr, Ahbenr, Apb2enr, Apb1enr, Bdcr, Csr;
+} Sim_Rcc;
+
+static uint32 Sim_DwtCtrl;
+
+/**********************************************************
+ * @brief Pins of each LIN channel (port index 0 = A, 1 = B).
+ **********************************************************/
+static const struct
+{
+    uint8 Port;
+    uint8 TxPin;
+    uint8 RxPin;
+} Sim_ChannelPins[3] = {{0, 9, 10}, {0, 2, 3}, {1, 10, 11}};
+
+/**********************************************************
+ * @brief USART request of each DMA1 channel: USART index, TRUE for TX.
+ **********************************************************/
+static const struct
+{
+    sint8 Usart;
+    boolean Tx;
+} Sim_DmaRequest[8] = {{-1, FALSE}, {-1, FALSE}, {2, TRUE}, {2, FALSE}, {0, TRUE}, {0, FALSE}, {1, FALSE}, {1, TRUE}};
+
+/**********************************************************
+ * @brief Image helpers (valid while the range is opened by the trap).
+ **********************************************************/
+static void Sim_Put(uintptr_t Address, uint32 Value)
+{
+    *(volatile uint32 *)Address = Value;
+}
+
+static uint32 Sim_Get(uintptr_t Address)
+{
+    return *(volatile uint32 *)Address;
+}
+
+/**********************************************************
+ * @brief Clock of a USART in Hz, 0 while gated.
+ **********************************************************/
+static uint32 Sim_UsartClock(const Sim_UsartType *Usart)
+{
+    if (Usart->OnApb2)
+    {
+        return (Sim_Rcc.Apb2enr & Usart->ClockBit) ? Sim_Clocks.Pclk2 : 0U;
+    }
+    return (Sim_Rcc.Apb1enr & Usart->ClockBit) ? Sim_Clocks.Pclk1 : 0U;
+}
+
+/**********************************************************
+ * @brief Bit time of a USART in ps, 0 if it cannot run.
+ **********************************************************/
+static uint64 Sim_UsartBitPs(const Sim_UsartType *Usart)
+{
+    uint32 clock = Sim_UsartClock(Usart);
+
+    if ((clock == 0U) || (Usart->Brr == 0U))
+    {
+        return 0;
+    }
+    return (uint64)Usart->Brr * 1000000000000ULL / clock;
+}
+
+/**********************************************************
+ * @brief Mode nibble of a pin (CNF[1:0] MODE[1:0]).
+ **********************************************************/
+static uint8 Sim_PinMode(uint8 Port, uint8 Pin)
+{
+    uint32 cr = (Pin < 8U) ? Sim_Gpio[Port].Crl : Sim_Gpio[Port].Crh;
+    return (uint8)((cr >> (4U * (Pin & 7U))) & 0xFU);
+}
+
+/**********************************************************
+ * @brief Level driven by a pin: recessive as an input, else ODR or the USART TX output.
+ **********************************************************/
+static uint8 Sim_PinDrive(uint8 Port, uint8 Pin)
+{
+    uint8 mode = Sim_PinMode(Port, Pin);
+
+    if ((mode & 0x3U) == 0U)
+    {
+        return 1;
+    }
+    if (mode & 0x8U)
+    {
+        for (uint8 ch = 0; ch < 3U; ch++)
+        {
+            if ((Sim_ChannelPins[ch].Port == Port) && (Sim_ChannelPins[ch].TxPin == Pin))
+            {
+                return Sim_Usart[ch].TxOut;
+            }
+        }
+        return 1;
+    }
+    return (uint8)((Sim_Gpio[Port].Odr >> Pin) & 1U);
+}
+
+/**********************************************************
+ * @brief Level read on a pin: Rx pins follow their bus through the transceiver.
+ **********************************************************/
+static uint8 Sim_PinInput(uint8 Port, uint8 Pin)
+{
+    for (uint8 ch = 0; ch < 3U; ch++)
+    {
+        if ((Sim_ChannelPins[ch].Port == Port) && (Sim_ChannelPins[ch].RxPin == Pin))
+        {
+            return Sim_BusLevel(Sim_ChannelBus(ch));
+        }
+    }
+    return Sim_PinDrive(Port, Pin);
+}
+
+uint8 Sim_ChannelDrive(uint8 Channel)
+{
+    return Sim_PinDrive(Sim_ChannelPins[Channel].Port, Sim_ChannelPins[Channel].TxPin);
+}
+
+void Sim_PeriphReset(void)
+{
+    static const uintptr_t bases[3] = {USART1_BASE, USART2_BASE, USART3_BASE};
+    static const uint32 clocks[3] = {RCC_APB2Periph_USART1, RCC_APB1Periph_USART2, RCC_APB1Periph_USART3};
+
+    memset(Sim_Usart, 0, sizeof(Sim_Usart));
+    for (uint8 i = 0; i < 3U; i++)
+    {
+        Sim_Usart[i].Base = bases[i];
+        Sim_Usart[i].Channel = i;
+        Sim_Usart[i].OnApb2 = (i == 0U) ? TRUE : FALSE;
+        Sim_Usart[i].ClockBit = clocks[i];
+        Sim_Usart[i].Sr = USART_SR_TXE | USART_SR_TC;
+        Sim_Usart[i].TxOut = 1;
+        Sim_Usart[i].PrevLevel = 1;
+    }
+    memset(Sim_Dma, 0, sizeof(Sim_Dma));
+    Sim_DmaIsr = 0;
+    memset(&Sim_Tim, 0, sizeof(Sim_Tim));
+    Sim_Tim.Arr = 0xFFFF;
+    Sim_CanReset();
+    memset(&Sim_Exti, 0, sizeof(Sim_Exti));
+    Sim_Exti.Prev = 0xFFFF;
+    memset(&Sim_Afio, 0, sizeof(Sim_Afio));
+    for (uint8 i = 0; i < 2U; i++)
+    {
+        Sim_Gpio[i].Crl = 0x44444444UL; // Floating inputs after reset
+        Sim_Gpio[i].Crh = 0x44444444UL;
+        Sim_Gpio[i].Odr = 0;
+        Sim_Gpio[i].Lckr = 0;
+    }
+    memset(&Sim_Rcc, 0, sizeof(Sim_Rcc));
+    Sim_Rcc.Ahbenr = 0x14;
+    Sim_DwtCtrl = 0;
+}
+
+/**********************************************************
+ * @brief USART: register image and side effects.
+ **********************************************************/
+static void Sim_UsartSync(Sim_UsartType *Usart)
+{
+    Sim_Put(Usart->Base + 0x00U, Usart->Sr);
+    Sim_Put(Usart->Base + 0x04U, Usart->Rdr);
+    Sim_Put(Usart->Base + 0x08U, Usart->Brr);
+    Sim_Put(Usart->Base + 0x0CU, Usart->Cr1);
+    Sim_Put(Usart->Base + 0x10U, Usart->Cr2);
+    Sim_Put(Usart->Base + 0x14U, Usart->Cr3);
+    Sim_Put(Usart->Base + 0x18U, Usart->Gtpr);
+}
+
+static void Sim_UsartAccess(Sim_UsartType *Usart, uint32 Offset, boolean Write, uint16 Value)
+{
+    switch (Offset)
+    {
+    case 0x00U:
+        if (Write)
+        {
+            Usart->Sr &= (uint16)(Value | ~SIM_USART_SR_RC_W0);
+        }
+        else
+        {
+            Usart->SrRead = TRUE;
+        }
+        break;
+    case 0x04U:
+        if (Write)
+        {
+            Usart->Tdr = (uint8)Value;
+            Usart->Sr &= (uint16)~USART_SR_TXE;
+            if (Usart->SrRead)
+            {
+                Usart->Sr &= (uint16)~USART_SR_TC;
+            }
+        }
+        else
+        {
+            Usart->Sr &= (uint16)~USART_SR_RXNE;
+            if (Usart->SrRead)
+            {
+                Usart->Sr &= (uint16)~(USART_SR_PE | USART_SR_FE | USART_SR_NE | USART_SR_ORE | USART_SR_IDLE);
+            }
+        }
+        Usart->SrRead = FALSE;
+        break;
+    case 0x08U:
+        if (Write)
+        {
+            Usart->Brr = Value;
+        }
+        break;
+    case 0x0CU:
+        if (Write)
+        {
+            uint16 old = Usart->Cr1;
+            Usart->Cr1 = Value;
+            if (((old & USART_CR1_UE) && !(Value & USART_CR1_UE)) || ((old & USART_CR1_TE) && !(Value & USART_CR1_TE)))
+            {
+                Usart->TxState = SIM_TX_IDLE; // Transfer aborted
+                Usart->TxOut = 1;
+                Usart->Cr1 &= (uint16)~USART_CR1_SBK;
+            }
+            if (!(Value & USART_CR1_UE) || !(Value & USART_CR1_RE))
+            {
+                Usart->RxState = SIM_RX_OFF;
+            }
+        }
+        break;
+    case 0x10U:
+        if (Write)
+        {
+            Usart->Cr2 = Value;
+        }
+        break;
+    case 0x14U:
+        if (Write)
+        {
+            Usart->Cr3 = Value;
+        }
+        break;
+    case 0x18U:
+        if (Write)
+        {
+            Usart->Gtpr = Value;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**********************************************************
+ * @brief USART transmitter: break (13 dominant bits and a delimiter) or 10-bit characters.
+ **********************************************************/
+static void Sim_UsartTx(Sim_UsartType *Usart, uint64 Now)
+{
+    uint64 bitPs = Sim_UsartBitPs(Usart);
+
+    if ((bitPs == 0U) || !(Usart->Cr1 & USART_CR1_UE) || !(Usart->Cr1 & USART_CR1_TE))
+    {
+        Usart->TxState = SIM_TX_IDLE;
+        Usart->TxChain = FALSE;
+        Usart->TxOut = 1;
+        return;
+    }
+
+    for (;;)
+    {
+        if (Usart->TxState == SIM_TX_IDLE)
+        {
+            uint64 start = Usart->TxChain ? Usart->TxEnd : Now;
+            Usart->TxChain = FALSE;
+            if (Usart->Cr1 & USART_CR1_SBK)
+            {
+                Usart->TxState = SIM_TX_BREAK;
+            }
+            else if (!(Usart->Sr & USART_SR_TXE))
+            {
+                Usart->TxShift = Usart->Tdr;
+                Usart->Sr |= USART_SR_TXE;
+                Usart->TxState = SIM_TX_CHAR;
+            }
+            else
+            {
+                Usart->TxOut = 1;
+                return;
+            }
+            Usart->TxStart = start;
+        }
+
+        uint64 bits = (Now - Usart->TxStart) * 1000U / bitPs;
+        uint8 total = (Usart->TxState == SIM_TX_BREAK) ? (SIM_BREAK_BITS + 1U) : 10U;
+        if (bits >= total)
+        {
+            Usart->TxEnd = Usart->TxStart + total * bitPs / 1000U;
+            Usart->TxState = SIM_TX_IDLE;
+            Usart->TxChain = TRUE;
+            Usart->Cr1 &= (uint16)~USART_CR1_SBK;
+            if (Usart->Sr & USART_SR_TXE)
+            {
+                Usart->Sr |= USART_SR_TC;
+            }
+            continue;
+        }
+
+        if (Usart->TxState == SIM_TX_BREAK)
+        {
+            if (bits >= SIM_BREAK_BITS)
+            {
+                Usart->Cr1 &= (uint16)~USART_CR1_SBK; // Cleared during the stop bit of the break
+            }
+            Usart->TxOut = (bits < SIM_BREAK_BITS) ? 0U : 1U;
+        }
+        else
+        {
+            Usart->TxOut = (bits == 0U) ? 0U : ((bits == 9U) ? 1U : (uint8)((Usart->TxShift >> (bits - 1U)) & 1U));
+        }
+        return;
+    }
+}
+
+/**********************************************************
+ * @brief End of a received character: RDR, RXNE and the error flags.
+ **********************************************************/
+static void Sim_UsartReceived(Sim_UsartType *Usart, uint64 BitPs)
+{
+    uint8 data = 0;
+    boolean noise = FALSE;
+
+    for (uint8 bit = 0; bit < 10U; bit++)
+    {
+        if ((Usart->RxVotes[bit] != 0U) && (Usart->RxVotes[bit] != 3U))
+        {
+            noise = TRUE;
+        }
+        if ((bit >= 1U) && (bit <= 8U) && (Usart->RxVotes[bit] >= 2U))
+        {
+            data |= (uint8)(1U << (bit - 1U));
+        }
+    }
+
+    if (Usart->Sr & USART_SR_RXNE)
+    {
+        Usart->Sr |= USART_SR_ORE; // Previous character not read: this one is lost
+    }
+    else
+    {
+        Usart->Rdr = data;
+        Usart->Sr |= USART_SR_RXNE;
+    }
+    if (noise)
+    {
+        Usart->Sr |= USART_SR_NE;
+    }
+    if (Usart->RxVotes[9] < 2U)
+    {
+        Usart->Sr |= USART_SR_FE;
+        Usart->RxState = SIM_RX_WAIT_HIGH;
+    }
+    else
+    {
+        Usart->RxState = SIM_RX_IDLE;
+    }
+    Usart->IdleArmed = TRUE;
+    Usart->IdleFrom = Usart->RxStart + 10U * BitPs / 1000U;
+    if (Sim_TraceOn)
+    {
+        printf("%12.3f us  USART%u received 0x%02X%s%s\n", (double)Sim_Now() / 1e3, Usart->Channel + 1U, data,
+               noise ? " noise" : "", (Usart->RxVotes[9] < 2U) ? " framing error" : "");
+    }
+}
+
+/**********************************************************
+ * @brief USART receiver: LIN break detection, 3 samples per bit (7/16, 8/16, 9/16) and IDLE.
+ **********************************************************/
+static void Sim_UsartRx(Sim_UsartType *Usart, uint64 Now, uint8 Level)
+{
+    uint64 bitPs = Sim_UsartBitPs(Usart);
+    uint8 prev = Usart->PrevLevel;
+
+    Usart->PrevLevel = Level;
+    if ((bitPs == 0U) || !(Usart->Cr1 & USART_CR1_UE) || !(Usart->Cr1 & USART_CR1_RE))
+    {
+        Usart->RxState = SIM_RX_OFF;
+        return;
+    }
+    if (Usart->RxState == SIM_RX_OFF)
+    {
+        Usart->RxState = SIM_RX_WAIT_HIGH;
+        Usart->IdleArmed = FALSE;
+        Usart->LowSince = Now; // A dominant level at enable is timed from here
+        Usart->LowValid = (Level == 0U) ? TRUE : FALSE;
+        Usart->LbdDone = FALSE;
+        prev = Level;
+    }
+
+    // LIN break: dominant for 10.5 bits (11-bit detection) or 9.5 bits
+    if (Level == 0U)
+    {
+        if (prev == 1U)
+        {
+            Usart->LowSince = Now;
+            Usart->LowValid = TRUE;
+            Usart->LbdDone = FALSE;
+        }
+        uint64 threshold = ((Usart->Cr2 & USART_CR2_LBDL) ? 21U : 19U) * bitPs / 2U;
+        if ((Usart->Cr2 & USART_CR2_LINEN) && Usart->LowValid && !Usart->LbdDone &&
+            ((Now - Usart->LowSince) * 1000U >= threshold))
+        {
+            Usart->Sr |= USART_SR_LBD;
+            Usart->LbdDone = TRUE;
+        }
+        Usart->IdleArmed = FALSE;
+    }
+    else if (Usart->IdleArmed && (Now >= Usart->IdleFrom) && ((Now - Usart->IdleFrom) * 1000U >= 10U * bitPs))
+    {
+        Usart->Sr |= USART_SR_IDLE;
+        Usart->IdleArmed = FALSE;
+    }
+
+    switch (Usart->RxState)
+    {
+    case SIM_RX_WAIT_HIGH:
+        if (Level == 1U)
+        {
+            Usart->RxState = SIM_RX_IDLE;
+        }
+        break;
+    case SIM_RX_IDLE:
+        if ((prev == 1U) && (Level == 0U))
+        {
+            Usart->RxState = SIM_RX_CHAR;
+            Usart->RxStart = Now;
+            Usart->RxSample = 0;
+            memset(Usart->RxVotes, 0, sizeof(Usart->RxVotes));
+        }
+        break;
+    default:
+        break;
+    }
+
+    while ((Usart->RxState == SIM_RX_CHAR) && (Usart->RxSample < 30U))
+    {
+        uint8 bit = Usart->RxSample / 3U;
+        uint64 at = Usart->RxStart + ((uint64)bit * 16U + 7U + Usart->RxSample % 3U) * bitPs / 16000U;
+        if (at > Now)
+        {
+            break;
+        }
+        Usart->RxVotes[bit] += Level;
+        Usart->RxSample++;
+        if ((Usart->RxSample == 3U) && (Usart->RxVotes[0] >= 2U))
+        {
+            Usart->RxState = SIM_RX_IDLE; // False start bit
+        }
+        else if (Usart->RxSample == 30U)
+        {
+            Sim_UsartReceived(Usart, bitPs);
+        }
+    }
+}
+
+static boolean Sim_UsartIrq(const Sim_UsartType *Usart)
+{
+    uint16 sr = Usart->Sr;
+    uint16 cr1 = Usart->Cr1;
+
+    return ((sr & USART_SR_TXE) && (cr1 & USART_CR1_TXEIE)) || ((sr & USART_SR_TC) && (cr1 & USART_CR1_TCIE)) ||
+           ((sr & (USART_SR_RXNE | USART_SR_ORE)) && (cr1 & USART_CR1_RXNEIE)) ||
+           ((sr & USART_SR_IDLE) && (cr1 & USART_CR1_IDLEIE)) || ((sr & USART_SR_PE) && (cr1 & USART_CR1_PEIE)) ||
+           ((sr & USART_SR_LBD) && (Usart->Cr2 & USART_CR2_LBDIE)) ||
+           ((sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE)) && (Usart->Cr3 & USART_CR3_EIE) &&
+            (Usart->Cr3 & USART_CR3_DMAR));
+}
+
+/**********************************************************
+ * @brief DMA1: register image and side effects.
+ **********************************************************/
+static void Sim_DmaSync(void)
+{
+    Sim_Put(DMA1_BASE + 0x00U, Sim_DmaIsr);
+    Sim_Put(DMA1_BASE + 0x04U, 0);
+    for (uint8 n = 1; n <= 7U; n++)
+    {
+        uintptr_t base = DMA1_BASE + 0x08U + 0x14U * (n - 1U);
+        Sim_Put(base + 0x0U, Sim_Dma[n].Ccr);
+        Sim_Put(base + 0x4U, Sim_Dma[n].Cndtr);
+        Sim_Put(base + 0x8U, Sim_Dma[n].Cpar);
+        Sim_Put(base + 0xCU, Sim_Dma[n].Cmar);
+    }
+}
+
+static void Sim_DmaAccess(uint32 Offset, boolean Write, uint32 Value)
+{
+    if (!Write)
+    {
+        return;
+    }
+    if (Offset == 0x04U)
+    {
+        for (uint8 n = 0; n < 7U; n++)
+        {
+            if (Value & (1UL << (4U * n)))
+            {
+                Value |= 0xFUL << (4U * n); // CGIF clears every flag of the channel
+            }
+        }
+        Sim_DmaIsr &= ~Value;
+        return;
+    }
+    if (Offset < 0x08U)
+    {
+        return;
+    }
+
+    uint8 n = (uint8)((Offset - 0x08U) / 0x14U + 1U);
+    Sim_DmaChannelType *dma = &Sim_Dma[n];
+    boolean enabled = (dma->Ccr & DMA_CCR1_EN) ? TRUE : FALSE;
+    switch ((Offset - 0x08U) % 0x14U)
+    {
+    case 0x0U:
+        if (!enabled && (Value & DMA_CCR1_EN))
+        {
+            dma->Index = 0;
+        }
+        dma->Ccr = Value & 0x7FFFU;
+        break;
+    case 0x4U:
+        if (!enabled)
+        {
+            dma->Cndtr = Value & 0xFFFFU;
+        }
+        break;
+    case 0x8U:
+        if (!enabled)
+        {
+            dma->Cpar = Value;
+        }
+        break;
+    case 0xCU:
+        if (!enabled)
+        {
+            dma->Cmar = Value;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**********************************************************
+ * @brief DMA1 transfers: one byte per step and channel on the USART TXE/RXNE requests.
+ **********************************************************/
+static void Sim_DmaStep(void)
+{
+    if (!(Sim_Rcc.Ahbenr & RCC_AHBPeriph_DMA1))
+    {
+        return;
+    }
+
+    for (uint8 n = 1; n <= 7U; n++)
+    {
+        Sim_DmaChannelType *dma = &Sim_Dma[n];
+        if (!(dma->Ccr & DMA_CCR1_EN) || (dma->Cndtr == 0U) || (Sim_DmaRequest[n].Usart < 0))
+        {
+            continue;
+        }
+
+        Sim_UsartType *usart = &Sim_Usart[Sim_DmaRequest[n].Usart];
+        if (dma->Cpar != (uint32)(usart->Base + 0x04U))
+        {
+            Sim_Fail("DMA1 channel %u: CPAR 0x%08x is not the DR of its USART", n, (unsigned)dma->Cpar);
+        }
+        if (((dma->Ccr & DMA_CCR1_DIR) ? TRUE : FALSE) != Sim_DmaRequest[n].Tx)
+        {
+            Sim_Fail("DMA1 channel %u: wrong direction", n);
+        }
+
+        uint8 *memory = (uint8 *)(uintptr_t)(dma->Cmar + ((dma->Ccr & DMA_CCR1_MINC) ? dma->Index : 0U));
+        if (Sim_DmaRequest[n].Tx)
+        {
+            if (!(usart->Cr3 & USART_CR3_DMAT) || !(usart->Sr & USART_SR_TXE))
+            {
+                continue;
+            }
+            usart->Tdr = *memory;
+            usart->Sr &= (uint16)~USART_SR_TXE;
+        }
+        else
+        {
+            if (!(usart->Cr3 & USART_CR3_DMAR) || !(usart->Sr & USART_SR_RXNE))
+            {
+                continue;
+            }
+            *memory = usart->Rdr;
+            usart->Sr &= (uint16)~USART_SR_RXNE;
+        }
+
+        dma->Index++;
+        if (--dma->Cndtr == 0U)
+        {
+            Sim_DmaIsr |= 0x3UL << (4U * (n - 1U)); // TCIF and GIF
+        }
+    }
+}
+
+/**********************************************************
+ * @brief TIM4: register image, side effects and counting.
+ **********************************************************/
+static void Sim_TimSync(void)
+{
+    static const uint8 offsets[] = {0x00, 0x04, 0x08, 0x0C, 0x10, 0x18, 0x1C, 0x20, 0x24, 0x28, 0x2C, 0x30};
+    const uint16 values[] = {Sim_Tim.Cr1, Sim_Tim.Cr2, Sim_Tim.Smcr, Sim_Tim.Dier, Sim_Tim.Sr, Sim_Tim.Ccmr1,
+                             Sim_Tim.Ccmr2, Sim_Tim.Ccer, Sim_Tim.Cnt, Sim_Tim.Psc, Sim_Tim.Arr, Sim_Tim.Rcr};
+
+    for (uint8 i = 0; i < sizeof(offsets); i++)
+    {
+        Sim_Put(TIM4_BASE + offsets[i], values[i]);
+    }
+    Sim_Put(TIM4_BASE + 0x14U, 0);
+    for (uint8 i = 0; i < 4U; i++)
+    {
+        Sim_Put(TIM4_BASE + 0x34U + 4U * i, Sim_Tim.Ccr[i]);
+    }
+}
+
+static void Sim_TimAccess(uint32 Offset, boolean Write, uint16 Value)
+{
+    if (!Write)
+    {
+        return;
+    }
+
+    switch (Offset)
+    {
+    case 0x00U:
+        if (!(Sim_Tim.Cr1 & TIM_CR1_CEN) && (Value & TIM_CR1_CEN))
+        {
+            Sim_Tim.FractionPs = 0; // Counting starts now
+        }
+        Sim_Tim.Cr1 = Value;
+        break;
+    case 0x04U: Sim_Tim.Cr2 = Value; break;
+    case 0x08U: Sim_Tim.Smcr = Value; break;
+    case 0x0CU: Sim_Tim.Dier = Value; break;
+    case 0x10U: Sim_Tim.Sr &= Value; break; // rc_w0
+    case 0x14U:
+        if (Value & TIM_EGR_UG)
+        {
+            Sim_Tim.Cnt = 0;
+            Sim_Tim.ActivePsc = Sim_Tim.Psc;
+            Sim_Tim.FractionPs = 0;
+            Sim_Tim.Sr |= TIM_SR_UIF;
+        }
+        break;
+    case 0x18U: Sim_Tim.Ccmr1 = Value; break;
+    case 0x1CU: Sim_Tim.Ccmr2 = Value; break;
+    case 0x20U: Sim_Tim.Ccer = Value; break;
+    case 0x24U: Sim_Tim.Cnt = Value; break;
+    case 0x28U: Sim_Tim.Psc = Value; break; // Loaded at the next update event
+    case 0x2CU: Sim_Tim.Arr = Value; break;
+    case 0x30U: Sim_Tim.Rcr = Value; break;
+    default:
+        if ((Offset >= 0x34U) && (Offset <= 0x40U))
+        {
+            Sim_Tim.Ccr[(Offset - 0x34U) / 4U] = Value;
+        }
+        break;
+    }
+}
+
+/**********************************************************
+ * @brief TIM4 counting from its clock (2 * PCLK1 when APB1 is divided).
+ **********************************************************/
+static void Sim_TimStep(uint64 Now)
+{
+    uint64 elapsed = Now - Sim_Tim.Last;
+
+    Sim_Tim.Last = Now;
+    if (!(Sim_Tim.Cr1 & TIM_CR1_CEN) || !(Sim_Rcc.Apb1enr & RCC_APB1Periph_TIM4))
+    {
+        return;
+    }
+
+    uint32 clock = (Sim_Clocks.SysClk == Sim_Clocks.Pclk1) ? Sim_Clocks.Pclk1 : 2U * Sim_Clocks.Pclk1;
+    uint64 tickPs = ((uint64)Sim_Tim.ActivePsc + 1U) * 1000000000000ULL / clock;
+    Sim_Tim.FractionPs += elapsed * 1000U;
+    while (Sim_Tim.FractionPs >= tickPs)
+    {
+        Sim_Tim.FractionPs -= tickPs;
+        if (Sim_Tim.Cnt >= Sim_Tim.Arr)
+        {
+            Sim_Tim.Cnt = 0;
+            Sim_Tim.ActivePsc = Sim_Tim.Psc;
+            Sim_Tim.Sr |= TIM_SR_UIF;
+        }
+        else
+        {
+            Sim_Tim.Cnt++;
+        }
+        for (uint8 i = 0; i < 4U; i++)
+        {
+            if (Sim_Tim.Cnt == Sim_Tim.Ccr[i])
+            {
+                Sim_Tim.Sr |= (uint16)(TIM_SR_CC1IF << i);
+            }
+        }
+    }
+}
+
+/**********************************************************
+ * @brief EXTI lines 0...15: edges of the pins selected in AFIO_EXTICR.
+ **********************************************************/
+static void Sim_ExtiStep(void)
+{
+    for (uint8 line = 0; line < 16U; line++)
+    {
+        uint8 port = (uint8)((Sim_Afio.Exticr[line / 4U] >> (4U * (line % 4U))) & 0xFU);
+        uint16 bit = (uint16)(1U << line);
+        uint8 level = (port < 2U) ? Sim_PinInput(port, line) : 1U;
+        uint8 prev = (Sim_Exti.Prev & bit) ? 1U : 0U;
+
+        if ((level != prev) && (Sim_Exti.Imr & bit) &&
+            (((level == 0U) && (Sim_Exti.Ftsr & bit)) || ((level == 1U) && (Sim_Exti.Rtsr & bit))))
+        {
+            Sim_Exti.Pr |= bit;
+        }
+        Sim_Exti.Prev = (uint16)(level ? (Sim_Exti.Prev | bit) : (Sim_Exti.Prev & ~bit));
+    }
+}
+
+/**********************************************************
+ * @brief GPIO: register image and side effects.
+ **********************************************************/
+static void Sim_GpioSync(uint8 Port, uintptr_t Base)
+{
+    uint32 idr = 0;
+
+    for (uint8 pin = 0; pin < 16U; pin++)
+    {
+        idr |= (uint32)Sim_PinInput(Port, pin) << pin;
+    }
+    Sim_Put(Base + 0x00U, Sim_Gpio[Port].Crl);
+    Sim_Put(Base + 0x04U, Sim_Gpio[Port].Crh);
+    Sim_Put(Base + 0x08U, idr);
+    Sim_Put(Base + 0x0CU, Sim_Gpio[Port].Odr);
+    Sim_Put(Base + 0x10U, 0);
+    Sim_Put(Base + 0x14U, 0);
+    Sim_Put(Base + 0x18U, Sim_Gpio[Port].Lckr);
+}
+
+static void Sim_GpioAccess(uint8 Port, uint32 Offset, boolean Write, uint32 Value)
+{
+    if (!Write)
+    {
+        return;
+    }
+
+    switch (Offset)
+    {
+    case 0x00U: Sim_Gpio[Port].Crl = Value; break;
+    case 0x04U: Sim_Gpio[Port].Crh = Value; break;
+    case 0x0CU: Sim_Gpio[Port].Odr = Value & 0xFFFFU; break;
+    case 0x10U:
+        Sim_Gpio[Port].Odr |= Value & 0xFFFFU;
+        Sim_Gpio[Port].Odr &= ~(Value >> 16);
+        break;
+    case 0x14U: Sim_Gpio[Port].Odr &= ~(Value & 0xFFFFU); break;
+    case 0x18U: Sim_Gpio[Port].Lckr = Value; break;
+    default: break;
+    }
+}
+
+/**********************************************************
+ * @brief Plain registers: image and writes of a block of 32-bit words.
+ **********************************************************/
+static void Sim_WordsSync(uintptr_t Base, const uint32 *Words, uint8 Count)
+{
+    for (uint8 i = 0; i < Count; i++)
+    {
+        Sim_Put(Base + 4U * i, Words[i]);
+    }
+}
+
+boolean Sim_PeriphSync(uintptr_t Address)
+{
+    for (uint8 i = 0; i < 3U; i++)
+    {
+        if ((Address >= Sim_Usart[i].Base) && (Address < Sim_Usart[i].Base + 0x1CU))
+        {
+            Sim_UsartSync(&Sim_Usart[i]);
+            return TRUE;
+        }
+    }
+    if ((Address >= DMA1_BASE) && (Address < DMA1_BASE + 0x90U))
+    {
+        Sim_DmaSync();
+    }
+    else if ((Address >= TIM4_BASE) && (Address < TIM4_BASE + 0x50U))
+    {
+        Sim_TimSync();
+    }
+    else if ((Address >= EXTI_BASE) && (Address < EXTI_BASE + 0x18U))
+    {
+        Sim_WordsSync(EXTI_BASE, &Sim_Exti.Imr, 6);
+    }
+    else if ((Address >= AFIO_BASE) && (Address < AFIO_BASE + 0x18U))
+    {
+        Sim_WordsSync(AFIO_BASE, &Sim_Afio.Evcr, 6);
+    }
+    else if ((Address >= GPIOA_BASE) && (Address < GPIOA_BASE + 0x1CU))
+    {
+        Sim_GpioSync(0, GPIOA_BASE);
+    }
+    else if ((Address >= GPIOB_BASE) && (Address < GPIOB_BASE + 0x1CU))
+    {
+        Sim_GpioSync(1, GPIOB_BASE);
+    }
+    else if ((Address >= RCC_BASE) && (Address < RCC_BASE + 0x28U))
+    {
+        Sim_WordsSync(RCC_BASE, &Sim_Rcc.Cr, 10);
+    }
+    else if ((Address >= CAN1_BASE) && (Address < CAN1_BASE + SIM_CAN_SIZE))
+    {
+        Sim_CanSync();
+    }
+    else if ((Address >= DWT_BASE) && (Address < DWT_BASE + 0x08U))
+    {
+        Sim_Put(DWT_BASE + 0x0U, Sim_DwtCtrl);
+        Sim_Put(DWT_BASE + 0x4U, (uint32)Sim_Cycles());
+    }
+    else
+    {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void Sim_PeriphAccess(uintptr_t Address, boolean Write)
+{
+    uintptr_t word = Address & ~(uintptr_t)3U;
+    uint32 value = Sim_Get(word);
+
+    for (uint8 i = 0; i < 3U; i++)
+    {
+        if ((Address >= Sim_Usart[i].Base) && (Address < Sim_Usart[i].Base + 0x1CU))
+        {
+            Sim_UsartAccess(&Sim_Usart[i], (uint32)(word - Sim_Usart[i].Base), Write, (uint16)value);
+            return;
+        }
+    }
+    if ((Address >= DMA1_BASE) && (Address < DMA1_BASE + 0x90U))
+    {
+        Sim_DmaAccess((uint32)(word - DMA1_BASE), Write, value);
+    }
+    else if ((Address >= TIM4_BASE) && (Address < TIM4_BASE + 0x50U))
+    {
+        Sim_TimAccess((uint32)(word - TIM4_BASE), Write, (uint16)value);
+    }
+    else if ((Address >= EXTI_BASE) && (Address < EXTI_BASE + 0x18U) && Write)
+    {
+        uint32 offset = (uint32)(word - EXTI_BASE);
+        if (offset == 0x14U)
+        {
+            Sim_Exti.Pr &= ~value; // rc_w1
+        }
+        else if (offset == 0x10U)
+        {
+            Sim_Exti.Pr |= value & Sim_Exti.Imr;
+        }
+        else
+        {
+            (&Sim_Exti.Imr)[offset / 4U] = value;
+        }
+    }
+    else if ((Address >= AFIO_BASE) && (Address < AFIO_BASE + 0x18U) && Write)
+    {
+        (&Sim_Afio.Evcr)[(word - AFIO_BASE) / 4U] = value;
+    }
+    else if ((Address >= GPIOA_BASE) && (Address < GPIOA_BASE + 0x1CU))
+    {
+        Sim_GpioAccess(0, (uint32)(word - GPIOA_BASE), Write, value);
+    }
+    else if ((Address >= GPIOB_BASE) && (Address < GPIOB_BASE + 0x1CU))
+    {
+        Sim_GpioAccess(1, (uint32)(word - GPIOB_BASE), Write, value);
+    }
+    else if ((Address >= RCC_BASE) && (Address < RCC_BASE + 0x28U) && Write)
+    {
+        (&Sim_Rcc.Cr)[(word - RCC_BASE) / 4U] = value;
+    }
+    else if ((Address >= CAN1_BASE) && (Address < CAN1_BASE + SIM_CAN_SIZE))
+    {
+        Sim_CanAccess((uint32)(word - CAN1_BASE), Write, value);
+    }
+    else if ((word == DWT_BASE) && Write)
+    {
+        Sim_DwtCtrl = value;
+    }
+}
+
+void Sim_PeriphTx(uint64 Now)
+{
+    for (uint8 i = 0; i < 3U; i++)
+    {
+        Sim_UsartTx(&Sim_Usart[i], Now);
+    }
+    Sim_CanStep(Now, (Sim_Rcc.Apb1enr & RCC_APB1Periph_CAN1) ? Sim_Clocks.Pclk1 : 0U);
+}
+
+void Sim_PeriphRx(uint64 Now)
+{
+    for (uint8 i = 0; i < 3U; i++)
+    {
+        Sim_UsartRx(&Sim_Usart[i], Now, Sim_PinInput(Sim_ChannelPins[i].Port, Sim_ChannelPins[i].RxPin));
+    }
+    Sim_ExtiStep();
+    Sim_DmaStep();
+    Sim_TimStep(Now);
+}
+
+boolean Sim_PeriphIrq(IRQn_Type IRQn)
+{
+    switch (IRQn)
+    {
+    case USART1_IRQn:
+    case USART2_IRQn:
+    case USART3_IRQn:
+        return Sim_UsartIrq(&Sim_Usart[IRQn - USART1_IRQn]);
+    case TIM4_IRQn:
+        return (Sim_Tim.Sr & Sim_Tim.Dier & 0x1FU) ? TRUE : FALSE;
+    case EXTI3_IRQn:
+        return (Sim_Exti.Pr & Sim_Exti.Imr & 0x0008U) ? TRUE : FALSE;
+    case EXTI15_10_IRQn:
+        return (Sim_Exti.Pr & Sim_Exti.Imr & 0xFC00U) ? TRUE : FALSE;
+    case CAN1_TX_IRQn:
+    case USB_LP_CAN1_RX0_IRQn:
+    case CAN1_SCE_IRQn:
+        return Sim_CanIrq(IRQn);
+    default:
+        if ((IRQn >= DMA1_Channel1_IRQn) && (IRQn <= DMA1_Channel7_IRQn))
+        {
+            uint8 n = (uint8)(IRQn - DMA1_Channel1_IRQn + 1);
+            return ((Sim_DmaIsr >> (4U * (n - 1U))) & Sim_Dma[n].Ccr & 0xEU) ? TRUE : FALSE;
+        }
+        return FALSE;
+    }
+}
+
+/**********************************************************
+ * @brief USART model of a register pointer passed to an SPL function.
+ **********************************************************/
+static Sim_UsartType *Sim_UsartOf(const USART_TypeDef *USARTx)
+{
+    for (uint8 i = 0; i < 3U; i++)
+    {
+        if ((uintptr_t)USARTx == Sim_Usart[i].Base)
+        {
+            return &Sim_Usart[i];
+        }
+    }
+    Sim_Fail("SPL call on an unmodelled USART");
+}
+
+/**********************************************************
+ * @brief SPL functions used by the driver; each counts the accesses it makes on the device.
+ **********************************************************/
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct)
+{
+    uint8 port = (GPIOx == GPIOA) ? 0U : ((GPIOx == GPIOB) ? 1U : 0xFFU);
+    uint32 mode = (uint32)GPIO_InitStruct->GPIO_Mode & 0x0FU;
+
+    if (port == 0xFFU)
+    {
+        Sim_Fail("GPIO_Init on an unmodelled port");
+    }
+    if ((uint32)GPIO_InitStruct->GPIO_Mode & 0x10U)
+    {
+        mode |= (uint32)GPIO_InitStruct->GPIO_Speed;
+    }
+    for (uint8 pin = 0; pin < 16U; pin++)
+    {
+        if (!(GPIO_InitStruct->GPIO_Pin & (1U << pin)))
+        {
+            continue;
+        }
+        uint32 *cr = (pin < 8U) ? &Sim_Gpio[port].Crl : &Sim_Gpio[port].Crh;
+        uint8 shift = (uint8)(4U * (pin & 7U));
+        *cr = (*cr & ~(0xFUL << shift)) | (mode << shift);
+        if (GPIO_InitStruct->GPIO_Mode == GPIO_Mode_IPD)
+        {
+            Sim_Gpio[port].Odr &= ~(1UL << pin);
+        }
+        else if (GPIO_InitStruct->GPIO_Mode == GPIO_Mode_IPU)
+        {
+            Sim_Gpio[port].Odr |= 1UL << pin;
+        }
+    }
+    Sim_CountAccess(4);
+}
+
+void GPIO_EXTILineConfig(uint8_t GPIO_PortSource, uint8_t GPIO_PinSource)
+{
+    uint8 shift = (uint8)(4U * (GPIO_PinSource & 3U));
+
+    Sim_Afio.Exticr[GPIO_PinSource >> 2] = (Sim_Afio.Exticr[GPIO_PinSource >> 2] & ~(0xFUL << shift)) |
+                                           ((uint32)GPIO_PortSource << shift);
+    Sim_CountAccess(2);
+}
+
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState)
+{
+    Sim_Rcc.Ahbenr = (NewState != DISABLE) ? (Sim_Rcc.Ahbenr | RCC_AHBPeriph) : (Sim_Rcc.Ahbenr & ~RCC_AHBPeriph);
+    Sim_CountAccess(2);
+}
+
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState)
+{
+    Sim_Rcc.Apb2enr = (NewState != DISABLE) ? (Sim_Rcc.Apb2enr | RCC_APB2Periph) : (Sim_Rcc.Apb2enr & ~RCC_APB2Periph);
+    Sim_CountAccess(2);
+}
+
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState)
+{
+    Sim_Rcc.Apb1enr = (NewState != DISABLE) ? (Sim_Rcc.Apb1enr | RCC_APB1Periph) : (Sim_Rcc.Apb1enr & ~RCC_APB1Periph);
+    Sim_CountAccess(2);
+}
+
+void RCC_GetClocksFreq(RCC_ClocksTypeDef *RCC_Clocks)
+{
+    RCC_Clocks->SYSCLK_Frequency = Sim_Clocks.SysClk;
+    RCC_Clocks->HCLK_Frequency = Sim_Clocks.SysClk;
+    RCC_Clocks->PCLK1_Frequency = Sim_Clocks.Pclk1;
+    RCC_Clocks->PCLK2_Frequency = Sim_Clocks.Pclk2;
+    RCC_Clocks->ADCCLK_Frequency = Sim_Clocks.Pclk2 / 2U;
+    Sim_CountAccess(1);
+}
+
+void USART_SendBreak(USART_TypeDef *USARTx)
+{
+    Sim_UsartOf(USARTx)->Cr1 |= USART_CR1_SBK;
+    Sim_CountAccess(2);
+}
+
+void USART_LINCmd(USART_TypeDef *USARTx, FunctionalState NewState)
+{
+    Sim_UsartType *usart = Sim_UsartOf(USARTx);
+
+    usart->Cr2 = (NewState != DISABLE) ? (uint16)(usart->Cr2 | USART_CR2_LINEN) : (uint16)(usart->Cr2 & ~USART_CR2_LINEN);
+    Sim_CountAccess(2);
+}
+
+void USART_LINBreakDetectLengthConfig(USART_TypeDef *USARTx, uint16_t USART_LINBreakDetectLength)
+{
+    Sim_UsartType *usart = Sim_UsartOf(USARTx);
+
+    usart->Cr2 = (uint16)((usart->Cr2 & ~USART_CR2_LBDL) | USART_LINBreakDetectLength);
+    Sim_CountAccess(2);
+}
@@ -0,0 +1,390 @@
+/**********************************************************
+ * @file Xcp_SimTest.c
+ * @brief Functional tests of the XCP slave on the host simulator.
+ * @details Each test runs in its own process (the modules and the simulator
+ *          keep static state). The test plays the XCP master: commands are
+ *          sent as CAN frames through the bxCAN1 model and the CAN driver
+ *          into Xcp_RxIndication, responses and DAQ packets are read back
+ *          from the frames CAN1 sent.
+ *          Usage: xcp_sim_test [name], without a name every test runs.
+ * @version 1.0
+ * @date 2024-11-01
+ * @author Tong Xuan Hoang
+ **********************************************************/
+
+#include "Sim.h"
+#include "Can.h"
+#include "Xcp.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**********************************************************
+ * @brief Test assertion: reports the failed condition with the simulated time.
+ **********************************************************/
+#define CHECK(cond)                                                              \
+    do                                                                           \
+    {                                                                            \
+        if (!(cond))                                                             \
+        {                                                                        \
+            Sim_Fail("%s:%d: %s", __FILE__, __LINE__, #cond);                    \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                               \
+    do                                                                           \
+    {                                                                            \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);          \
+        if (a_ != e_)                                                            \
+        {                                                                        \
+            Sim_Fail("%s:%d: %s is %lld, expected %lld", __FILE__, __LINE__,     \
+                     #actual, a_, e_);                                           \
+        }                                                                        \
+    } while (0)
+
+#define CRO_ID 0x550U        /**< @brief Outside the rate limited 0x700-0x7FF class of Can_ConfigData. */
+#define DTO_ID 0x551U
+#define XCP_PDU 7U
+#define TIMEOUT_NS 50000000U
+
+/**********************************************************
+ * @brief Measured variables (32-bit addresses: SHORT_UPLOAD takes a 32-bit address).
+ **********************************************************/
+static volatile uint32 Test_Speed;
+static volatile uint16 Test_Torque;
+static volatile uint8 Test_Gear;
+static volatile uint16 Test_Voltage;
+static volatile uint8 Test_Temperature[3];
+
+/**********************************************************
+ * @brief DAQ list 0 (event 0): ODT 0 packs three variables into 7 bytes, ODT 1 holds one.
+ *        DAQ list 1 (event 1): one ODT.
+ **********************************************************/
+static const Xcp_OdtEntryType Test_Odt0Entries[3] = {
+    {(const volatile uint8 *)&Test_Speed, 4},
+    {(const volatile uint8 *)&Test_Torque, 2},
+    {&Test_Gear, 1},
+};
+static const Xcp_OdtEntryType Test_Odt1Entries[1] = {{(const volatile uint8 *)&Test_Voltage, 2}};
+static const Xcp_OdtEntryType Test_Odt2Entries[1] = {{Test_Temperature, 3}};
+
+static const Xcp_OdtType Test_Daq0Odts[2] = {{Test_Odt0Entries, 3}, {Test_Odt1Entries, 1}};
+static const Xcp_OdtType Test_Daq1Odts[1] = {{Test_Odt2Entries, 1}};
+
+static const Xcp_DaqListType Test_DaqLists[2] = {
+    {Test_Daq0Odts, 2, 0},
+    {Test_Daq1Odts, 1, 1},
+};
+
+static const Xcp_ConfigType Test_XcpConfig = {
+    .CroId = CRO_ID,
+    .DtoId = DTO_ID,
+    .TxPduId = XCP_PDU,
+    .NumEventChannels = 2,
+    .DaqLists = Test_DaqLists,
+    .NumDaqLists = 2,
+};
+
+/**********************************************************
+ * @brief CAN driver callbacks routed to the XCP slave, as the upper layer would.
+ **********************************************************/
+static void Test_RxIndication(const Can_HwType *Mailbox, const Can_PduType *PduInfo)
+{
+    (void)Mailbox;
+    Xcp_RxIndication(PduInfo);
+}
+
+static void Test_TxConfirmation(PduIdType TxPduId)
+{
+    if (TxPduId == XCP_PDU)
+    {
+        Xcp_TxConfirmation();
+    }
+}
+
+static Can_ConfigType Test_CanConfig;
+
+static void Test_Init(void)
+{
+    Test_CanConfig = Can_ConfigData;
+    Test_CanConfig.Can_NotificationConfig.RxIndication = Test_RxIndication;
+    Test_CanConfig.Can_NotificationConfig.TxConfirmation = Test_TxConfirmation;
+    Can_Init(&Test_CanConfig);
+    Can_EnableControllerInterrupts(0);
+    Xcp_Init(&Test_XcpConfig);
+}
+
+static boolean Test_CanIdle(void *Arg)
+{
+    (void)Arg;
+    return Sim_CanIdle();
+}
+
+static void Test_RunIdle(void)
+{
+    CHECK(Sim_RunUntil(Test_CanIdle, NULL, TIMEOUT_NS));
+    Sim_Run(10000U); // Interrupts of the last frame
+}
+
+/**********************************************************
+ * @brief Check a frame sent by the slave: DTO ID and payload.
+ **********************************************************/
+static const Sim_CanFrameType *Test_CheckPacket(uint32 Index, const uint8 *Data, uint8 Length)
+{
+    const Sim_CanFrameType *frame = Sim_CanTxFrame(Index);
+
+    CHECK(frame != NULL);
+    CHECK_EQ(frame->Id, DTO_ID);
+    CHECK_EQ(frame->Extended, FALSE);
+    CHECK_EQ(frame->Dlc, Length);
+    for (uint8 i = 0; i < Length; i++)
+    {
+        CHECK_EQ(frame->Data[i], Data[i]);
+    }
+    return frame;
+}
+
+/**********************************************************
+ * @brief Send a command on the CRO ID and check the single response (NULL: none expected).
+ **********************************************************/
+static void Test_Command(const uint8 *Command, uint8 Length, const uint8 *Response, uint8 ResponseLength)
+{
+    uint32 sent = Sim_CanTxCount();
+
+    Sim_CanSendFrame(CRO_ID, FALSE, Command, Length);
+    Test_RunIdle();
+    if (Response == NULL)
+    {
+        CHECK_EQ(Sim_CanTxCount(), sent);
+        return;
+    }
+    CHECK_EQ(Sim_CanTxCount(), sent + 1U);
+    Test_CheckPacket(sent, Response, ResponseLength);
+}
+
+static void Test_Connect(void)
+{
+    static const uint8 connect[2] = {XCP_CMD_CONNECT, 0x00};
+    static const uint8 response[8] = {XCP_PID_RES, 0x04, 0x00, XCP_MAX_CTO, XCP_MAX_DTO, 0x00, 0x01, 0x01};
+
+    Test_Command(connect, 2, response, 8);
+}
+
+/**********************************************************
+ * @brief Start both DAQ lists: list 0 directly, list 1 through select and START_STOP_SYNCH.
+ **********************************************************/
+static void Test_StartDaq(void)
+{
+    static const uint8 start0[4] = {XCP_CMD_START_STOP_DAQ_LIST, 1, 0, 0};
+    static const uint8 select1[4] = {XCP_CMD_START_STOP_DAQ_LIST, 2, 1, 0};
+    static const uint8 synch[2] = {XCP_CMD_START_STOP_SYNCH, 1};
+    static const uint8 firstPid0[2] = {XCP_PID_RES, 0};
+    static const uint8 firstPid1[2] = {XCP_PID_RES, 2};
+    static const uint8 ok[1] = {XCP_PID_RES};
+
+    Test_Command(start0, 4, firstPid0, 2);
+    Test_Command(select1, 4, firstPid1, 2);
+    Test_Command(synch, 2, ok, 1);
+}
+
+/**********************************************************
+ * @brief Commands: connection, DAQ processor info, upload, DAQ list control, errors.
+ **********************************************************/
+static void Test_Commands(void)
+{
+    static const uint8 info[1] = {XCP_CMD_GET_DAQ_PROCESSOR_INFO};
+    static const uint8 infoResponse[8] = {XCP_PID_RES, 0x00, 2, 0, 2, 0, 2, 0x00};
+    static const uint8 tooShort[3] = {XCP_CMD_SHORT_UPLOAD, 4, 0};
+    static const uint8 syntax[2] = {XCP_PID_ERR, XCP_ERR_CMD_SYNTAX};
+    static const uint8 badList[4] = {XCP_CMD_START_STOP_DAQ_LIST, 1, 2, 0};
+    static const uint8 badMode[2] = {XCP_CMD_START_STOP_SYNCH, 3};
+    static const uint8 unknown[1] = {0xC0};
+    static const uint8 outOfRange[2] = {XCP_PID_ERR, XCP_ERR_OUT_OF_RANGE};
+    static const uint8 modeNotValid[2] = {XCP_PID_ERR, XCP_ERR_MODE_NOT_VALID};
+    static const uint8 unknownResponse[2] = {XCP_PID_ERR, XCP_ERR_CMD_UNKNOWN};
+    static const uint8 stopAll[2] = {XCP_CMD_START_STOP_SYNCH, 0};
+    static const uint8 ok[1] = {XCP_PID_RES};
+
+    Test_Init();
+
+    // Only CONNECT is answered while disconnected
+    Test_Command(info, 1, NULL, 0);
+    Test_Connect();
+    Test_Command(info, 1, infoResponse, 8);
+
+    Test_Speed = 0x12345678UL;
+    uint32 address = (uint32)(uintptr_t)&Test_Speed;
+    CHECK_EQ(address, (uintptr_t)&Test_Speed);
+    const uint8 upload[8] = {XCP_CMD_SHORT_UPLOAD, 4, 0, 0, (uint8)address, (uint8)(address >> 8), (uint8)(address >> 16),
+                             (uint8)(address >> 24)};
+    const uint8 uploadResponse[5] = {XCP_PID_RES, 0x78, 0x56, 0x34, 0x12};
+    Test_Command(upload, 8, uploadResponse, 5);
+    Test_Command(tooShort, 3, syntax, 2);
+
+    Test_StartDaq();
+    Test_Command(badList, 4, outOfRange, 2);
+    Test_Command(badMode, 2, modeNotValid, 2);
+    Test_Command(unknown, 1, unknownResponse, 2);
+
+    // A stopped list no longer samples
+    Test_Command(stopAll, 2, ok, 1);
+    uint32 sent = Sim_CanTxCount();
+    Xcp_Event(0);
+    Xcp_Event(1);
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), sent);
+
+    // Frames on other IDs are not commands
+    Sim_CanSendFrame(CRO_ID + 2U, FALSE, info, 1);
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), sent);
+}
+
+/**********************************************************
+ * @brief Event sampling: PIDs, packing, back-to-back DTOs in ODT order, refills after confirmation.
+ **********************************************************/
+static void Test_Daq(void)
+{
+    static const uint8 disconnect[1] = {XCP_CMD_DISCONNECT};
+    static const uint8 ok[1] = {XCP_PID_RES};
+
+    Test_Init();
+    Test_Connect();
+    Test_StartDaq();
+
+    Test_Speed = 0xA1B2C3D4UL;
+    Test_Torque = 0x0E0F;
+    Test_Gear = 5;
+    Test_Voltage = 0x3344;
+    Test_Temperature[0] = 20;
+    Test_Temperature[1] = 21;
+    Test_Temperature[2] = 22;
+
+    uint32 first = Sim_CanTxCount();
+    Xcp_Event(0);
+    Xcp_Event(1);
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), first + 3U);
+
+    static const uint8 odt0[8] = {0, 0xD4, 0xC3, 0xB2, 0xA1, 0x0F, 0x0E, 5};
+    static const uint8 odt1[3] = {1, 0x44, 0x33};
+    static const uint8 odt2[4] = {2, 20, 21, 22};
+    const Sim_CanFrameType *a = Test_CheckPacket(first, odt0, 8);
+    const Sim_CanFrameType *b = Test_CheckPacket(first + 1U, odt1, 3);
+    const Sim_CanFrameType *c = Test_CheckPacket(first + 2U, odt2, 4);
+    CHECK_EQ(b->Start, a->End);
+    CHECK_EQ(c->Start, b->End);
+
+    // More ODTs than mailboxes: the TX confirmations keep the bus busy
+    Test_Gear = 6;
+    first = Sim_CanTxCount();
+    for (uint8 i = 0; i < 4U; i++)
+    {
+        Xcp_Event(0);
+    }
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), first + 8U);
+    for (uint32 i = 0; i < 8U; i++)
+    {
+        const Sim_CanFrameType *frame = Sim_CanTxFrame(first + i);
+        CHECK_EQ(frame->Data[0], i % 2U);
+        CHECK_EQ(frame->Dlc, (i % 2U) ? 3 : 8);
+        if (i > 0U)
+        {
+            CHECK_EQ(frame->Start, Sim_CanTxFrame(first + i - 1U)->End);
+        }
+    }
+    CHECK_EQ(Sim_CanTxFrame(first)->Data[7], 6);
+    CHECK_EQ(Xcp_GetAndClearOverloadCount(), 0);
+
+    // DISCONNECT stops the lists
+    Test_Command(disconnect, 1, ok, 1);
+    first = Sim_CanTxCount();
+    Xcp_Event(0);
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), first);
+}
+
+/**********************************************************
+ * @brief Overload: samples that do not fit in the ODT buffers are dropped whole and counted.
+ **********************************************************/
+static void Test_Overload(void)
+{
+    Test_Init();
+    Test_Connect();
+    Test_StartDaq();
+
+    // 2 ODTs per sample: 3 go to the mailboxes, 15 fill the buffers, samples 10-12 are dropped
+    uint32 first = Sim_CanTxCount();
+    for (uint8 i = 0; i < 12U; i++)
+    {
+        Xcp_Event(0);
+    }
+    CHECK_EQ(Xcp_GetAndClearOverloadCount(), 3);
+    CHECK_EQ(Xcp_GetAndClearOverloadCount(), 0);
+
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), first + 18U);
+    for (uint32 i = 0; i < 18U; i++)
+    {
+        CHECK_EQ(Sim_CanTxFrame(first + i)->Data[0], i % 2U); // Never a partial sample
+    }
+
+    // Room again once sent
+    Xcp_Event(0);
+    Test_RunIdle();
+    CHECK_EQ(Sim_CanTxCount(), first + 20U);
+    CHECK_EQ(Xcp_GetAndClearOverloadCount(), 0);
+}
+
+static const struct
+{
+    const char *Name;
+    void (*Run)(void);
+} Test_List[] = {
+    {"commands", Test_Commands},
+    {"daq", Test_Daq},
+    {"overload", Test_Overload},
+};
+
+#define TEST_COUNT (sizeof(Test_List) / sizeof(Test_List[0]))
+
+int main(int argc, char **argv)
+{
+    unsigned failed = 0;
+    unsigned run = 0;
+
+    for (unsigned i = 0; i < TEST_COUNT; i++)
+    {
+        if ((argc > 1) && (strcmp(argv[1], Test_List[i].Name) != 0))
+        {
+            continue;
+        }
+
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            Sim_Init();
+            Test_List[i].Run();
+            _exit(0);
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        boolean ok = (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) ? TRUE : FALSE;
+        printf("%-28s %s\n", Test_List[i].Name, ok ? "ok" : "FAILED");
+        failed += ok ? 0U : 1U;
+        run++;
+    }
+
+    if (run == 0U)
+    {
+        fprintf(stderr, "no test named %s\n", argv[1]);
+        return 2;
+    }
+    printf("%u tests, %u failed\n", run, failed);
+    return (failed == 0U) ? 0 : 1;
+}